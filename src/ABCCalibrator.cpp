@@ -0,0 +1,329 @@
+// ====================================================================================
+// 模块名称: ABCCalibrator Implementation
+// 功能描述:
+//   实现 ABC-SMC 的代际循环：先验采样 -> 并行模拟与接受/拒绝 -> 重要性权重 -> 自适应容差。
+//   每个工作线程独占一个 SIRModel 与随机链式二项模拟缓冲区，内层循环不做任何内存分配。
+// ====================================================================================
+
+#include "ABCCalibrator.h"
+#include "ThreadPool.h"
+#include <algorithm> // For std::nth_element, std::upper_bound, std::min, std::max
+#include <chrono>
+#include <cmath>     // For std::exp, std::sqrt
+#include <limits>
+#include <random>
+
+// --- ObservedSeries Implementation ---
+
+ObservedSeries ObservedSeries::FromRegion(const Region& region) {
+    ObservedSeries series;
+    series.population = region.getPopulation();
+    series.days.reserve(region.history.size());
+    series.infected.reserve(region.history.size());
+    series.removed.reserve(region.history.size());
+
+    for (const auto& rec : region.history) {
+        // History is kept sorted by day; skip duplicated days defensively
+        if (!series.days.empty() && rec.day <= series.days.back()) continue;
+        series.days.push_back(rec.day);
+        series.infected.push_back(static_cast<double>(rec.confirmed - rec.recovered - rec.deaths));
+        series.removed.push_back(static_cast<double>(rec.recovered + rec.deaths));
+    }
+    return series;
+}
+
+// --- Simulation helpers ---
+
+namespace {
+
+// Perturbations rejected for leaving the prior before the draw is clamped into it instead
+const int MaxPerturbAttempts = 100;
+
+// Per-worker state, allocated once per calibration run and reused by every particle
+struct WorkerScratch {
+    SIRModel model;
+    std::vector<double> simInfected;
+    std::vector<double> simRemoved;
+    std::mt19937_64 rng;
+};
+
+// [算法] 距离函数 (Distance)
+// 逻辑:
+//   在每个观测日比较模拟与观测的 I、R，取均方根误差，再除以观测序列的最大值做归一化，
+//   这样不同规模的城市可以共用同一套容差。
+double ComputeDistance(const ObservedSeries& obs, const double* simI, const double* simR, double scale) {
+    const int firstDay = obs.days.front();
+    double sum = 0.0;
+    for (size_t k = 1; k < obs.days.size(); ++k) {
+        int offset = obs.days[k] - firstDay;
+        double dI = simI[offset] - obs.infected[k];
+        double dR = simR[offset] - obs.removed[k];
+        sum += dI * dI + dR * dR;
+    }
+    return std::sqrt(sum / (2.0 * (obs.days.size() - 1))) / scale;
+}
+
+double SimulateDeterministic(WorkerScratch& ws, const ObservedSeries& obs, double beta, double gamma, double scale) {
+    const int span = obs.getSpan();
+    int initialInfected = std::max(1, static_cast<int>(obs.infected.front() + 0.5));
+    int initialRemoved = static_cast<int>(obs.removed.front() + 0.5);
+
+    ws.model.setBeta(beta);
+    ws.model.setGamma(gamma);
+    ws.model.reset(obs.population, initialInfected, initialRemoved, obs.days.front());
+    ws.model.run(span);
+
+    const auto& history = ws.model.getHistory();
+    for (int t = 0; t <= span; ++t) {
+        ws.simInfected[t] = history[t].infected;
+        ws.simRemoved[t] = history[t].recovered;
+    }
+    return ComputeDistance(obs, ws.simInfected.data(), ws.simRemoved.data(), scale);
+}
+
+// [算法] 随机链式二项SIR (Chain-Binomial SIR)
+// 逻辑:
+//   每天新增感染 ~ Binomial(S, 1 - exp(-beta * I / N))
+//   每天新增移出 ~ Binomial(I, 1 - exp(-gamma))
+//   该模型没有可解析的似然函数，正是 ABC 方法的适用场景。
+double SimulateStochastic(WorkerScratch& ws, const ObservedSeries& obs, double beta, double gamma, double scale) {
+    const int span = obs.getSpan();
+    const double N = static_cast<double>(obs.population);
+    long long I = std::max(1LL, static_cast<long long>(obs.infected.front() + 0.5));
+    long long R = static_cast<long long>(obs.removed.front() + 0.5);
+    long long S = std::max(0LL, static_cast<long long>(obs.population) - I - R);
+    const double pRecover = 1.0 - std::exp(-gamma);
+
+    ws.simInfected[0] = static_cast<double>(I);
+    ws.simRemoved[0] = static_cast<double>(R);
+    for (int t = 1; t <= span; ++t) {
+        double pInfect = 1.0 - std::exp(-beta * static_cast<double>(I) / N);
+        long long newInfections = (S > 0 && pInfect > 0) ? std::binomial_distribution<long long>(S, pInfect)(ws.rng) : 0;
+        long long newRecoveries = (I > 0 && pRecover > 0) ? std::binomial_distribution<long long>(I, pRecover)(ws.rng) : 0;
+        S -= newInfections;
+        I += newInfections - newRecoveries;
+        R += newRecoveries;
+        ws.simInfected[t] = static_cast<double>(I);
+        ws.simRemoved[t] = static_cast<double>(R);
+    }
+    return ComputeDistance(obs, ws.simInfected.data(), ws.simRemoved.data(), scale);
+}
+
+void WeightedMoments(const std::vector<ABCParticle>& particles, double& betaMean, double& betaVar,
+                     double& gammaMean, double& gammaVar) {
+    betaMean = gammaMean = 0.0;
+    for (const auto& p : particles) {
+        betaMean += p.weight * p.beta;
+        gammaMean += p.weight * p.gamma;
+    }
+    betaVar = gammaVar = 0.0;
+    for (const auto& p : particles) {
+        betaVar += p.weight * (p.beta - betaMean) * (p.beta - betaMean);
+        gammaVar += p.weight * (p.gamma - gammaMean) * (p.gamma - gammaMean);
+    }
+}
+
+} // namespace
+
+// --- ABCSMCCalibrator Class Implementation ---
+
+ABCSMCCalibrator::ABCSMCCalibrator()
+    : running(false), cancelRequested(false), generation(0), accepted(0) {}
+
+ABCSMCCalibrator::~ABCSMCCalibrator() {
+    cancel();
+    if (worker.joinable()) worker.join();
+}
+
+// [算法] ABC-SMC 主循环
+// 核心逻辑:
+//   第0代: 从均匀先验采样，容差为无穷大，直接接受 N 个粒子。
+//   第t代: 按上一代权重抽取粒子，用高斯核扰动(方差为上一代加权方差的2倍)，
+//          模拟后距离小于容差 eps_t 则接受；eps_t 取上一代距离的分位数(自适应容差)。
+//   权重: w_i = prior(θ_i) / Σ_j w_j K(θ_i | θ_j)，先验为均匀分布时分子为常数。
+//   所有工作线程共享一个原子接受计数器，凑满 N 个粒子后本代结束。
+ABCResult ABCSMCCalibrator::run(const ObservedSeries& observed, const ABCConfig& config,
+                                std::atomic<int>* generationOut, std::atomic<long long>* acceptedOut,
+                                const std::atomic<bool>* cancelFlag) {
+    ABCResult result;
+    if (!observed.isUsable() || config.particleCount <= 0) return result;
+
+    auto startTime = std::chrono::steady_clock::now();
+    ThreadPool& pool = ThreadPool::instance();
+    const unsigned workerCount = pool.getWorkerCount();
+    const size_t N = static_cast<size_t>(config.particleCount);
+    const int span = observed.getSpan();
+
+    double scale = 1.0;
+    for (size_t k = 0; k < observed.days.size(); ++k) {
+        scale = std::max(scale, std::max(observed.infected[k], observed.removed[k]));
+    }
+
+    // All buffers are allocated here and reused by every generation
+    std::vector<WorkerScratch> scratch(workerCount);
+    for (unsigned w = 0; w < workerCount; ++w) {
+        scratch[w].simInfected.resize(span + 1);
+        scratch[w].simRemoved.resize(span + 1);
+        scratch[w].rng.seed(config.seed + 7919ULL * w);
+        // Warm-up run so the model's history vector reaches its final capacity
+        scratch[w].model.reset(observed.population, 1, 0, 0);
+        scratch[w].model.run(span);
+    }
+    std::vector<ABCParticle> previous(N), current(N);
+    std::vector<double> cdf(N);
+    std::vector<double> distanceScratch(N);
+
+    double epsilon = std::numeric_limits<double>::infinity();
+    double betaSigma = 0, gammaSigma = 0;
+    long long totalAccepted = 0;
+    long long totalSimulations = 0;
+    int completedGenerations = 0;
+
+    for (int gen = 0; gen < config.maxGenerations; ++gen) {
+        if (generationOut) generationOut->store(gen);
+        std::atomic<size_t> acceptedCount(0);
+        std::atomic<long long> simulations(0);
+        const bool firstGeneration = (gen == 0);
+
+        pool.parallelFor(workerCount, [&](size_t, size_t, unsigned w) {
+            WorkerScratch& ws = scratch[w];
+            std::uniform_real_distribution<double> uniform(0.0, 1.0);
+            std::normal_distribution<double> normal(0.0, 1.0);
+
+            while (acceptedCount.load(std::memory_order_relaxed) < N) {
+                if (cancelFlag && cancelFlag->load(std::memory_order_relaxed)) return;
+                if (simulations.fetch_add(1, std::memory_order_relaxed) >= config.maxSimulationsPerGeneration) return;
+
+                double beta, gamma;
+                if (firstGeneration) {
+                    beta = config.betaMin + (config.betaMax - config.betaMin) * uniform(ws.rng);
+                    gamma = config.gammaMin + (config.gammaMax - config.gammaMin) * uniform(ws.rng);
+                } else {
+                    // Resample from the previous population and perturb inside the prior support. A zero-width
+                    // prior range never accepts a perturbed value, so the retries are capped and the last draw clamped
+                    int attempt = 0;
+                    do {
+                        size_t idx = std::upper_bound(cdf.begin(), cdf.end(), uniform(ws.rng)) - cdf.begin();
+                        if (idx >= N) idx = N - 1;
+                        beta = previous[idx].beta + betaSigma * normal(ws.rng);
+                        gamma = previous[idx].gamma + gammaSigma * normal(ws.rng);
+                    } while (++attempt < MaxPerturbAttempts &&
+                             (beta < config.betaMin || beta > config.betaMax ||
+                              gamma < config.gammaMin || gamma > config.gammaMax));
+                    beta = std::min(std::max(beta, config.betaMin), config.betaMax);
+                    gamma = std::min(std::max(gamma, config.gammaMin), config.gammaMax);
+                }
+
+                double d = (config.model == ABCConfig::Stochastic)
+                    ? SimulateStochastic(ws, observed, beta, gamma, scale)
+                    : SimulateDeterministic(ws, observed, beta, gamma, scale);
+
+                if (d <= epsilon) {
+                    size_t slot = acceptedCount.fetch_add(1, std::memory_order_relaxed);
+                    if (slot < N) {
+                        current[slot] = { beta, gamma, d, 0.0 };
+                        if (acceptedOut) acceptedOut->fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        });
+
+        totalSimulations += std::min(simulations.load(), config.maxSimulationsPerGeneration);
+        if (acceptedCount.load() < N) break; // Cancelled or simulation budget exhausted: keep the previous generation
+        totalAccepted += static_cast<long long>(N);
+
+        // Importance weights
+        if (firstGeneration) {
+            for (auto& p : current) p.weight = 1.0 / N;
+        } else {
+            const double invBeta2 = 1.0 / (2.0 * betaSigma * betaSigma);
+            const double invGamma2 = 1.0 / (2.0 * gammaSigma * gammaSigma);
+            pool.parallelFor(N, [&](size_t begin, size_t end, unsigned) {
+                for (size_t i = begin; i < end; ++i) {
+                    double denom = 0.0;
+                    for (size_t j = 0; j < N; ++j) {
+                        double db = current[i].beta - previous[j].beta;
+                        double dg = current[i].gamma - previous[j].gamma;
+                        denom += previous[j].weight * std::exp(-db * db * invBeta2 - dg * dg * invGamma2);
+                    }
+                    current[i].weight = (denom > 0.0) ? 1.0 / denom : 0.0;
+                }
+            }, 64);
+            double total = 0.0;
+            for (const auto& p : current) total += p.weight;
+            for (auto& p : current) p.weight = (total > 0.0) ? p.weight / total : 1.0 / N;
+        }
+
+        std::swap(previous, current);
+        completedGenerations = gen + 1;
+
+        // Adaptive tolerance: quantile of this generation's distances
+        for (size_t i = 0; i < N; ++i) distanceScratch[i] = previous[i].distance;
+        size_t q = std::min(N - 1, static_cast<size_t>(config.quantile * (N - 1)));
+        std::nth_element(distanceScratch.begin(), distanceScratch.begin() + q, distanceScratch.end());
+        double nextEpsilon = distanceScratch[q];
+
+        // Perturbation kernel: twice the weighted variance (Beaumont et al.)
+        double bm, bv, gm, gv;
+        WeightedMoments(previous, bm, bv, gm, gv);
+        betaSigma = std::max(1e-6, std::sqrt(2.0 * bv));
+        gammaSigma = std::max(1e-6, std::sqrt(2.0 * gv));
+
+        double cumulative = 0.0;
+        for (size_t i = 0; i < N; ++i) {
+            cumulative += previous[i].weight;
+            cdf[i] = cumulative;
+        }
+
+        bool converged = !firstGeneration && epsilon > 0.0 &&
+                         (epsilon - nextEpsilon) / epsilon < config.minEpsilonChange;
+        result.epsilon = firstGeneration ? *std::max_element(distanceScratch.begin(), distanceScratch.end()) : epsilon;
+        epsilon = nextEpsilon;
+        if (converged) break;
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    result.generations = completedGenerations;
+    result.acceptedParticles = totalAccepted;
+    result.totalSimulations = totalSimulations;
+    result.elapsedSeconds = elapsed;
+    result.acceptedPerSecond = (elapsed > 0.0) ? totalAccepted / elapsed : 0.0;
+
+    if (completedGenerations > 0) {
+        double bv, gv;
+        WeightedMoments(previous, result.betaMean, bv, result.gammaMean, gv);
+        result.betaStd = std::sqrt(bv);
+        result.gammaStd = std::sqrt(gv);
+        result.particles = std::move(previous);
+        result.valid = true;
+    }
+    return result;
+}
+
+void ABCSMCCalibrator::start(const ObservedSeries& observed, const ABCConfig& config) {
+    if (running.load()) return;
+    if (worker.joinable()) worker.join();
+
+    cancelRequested = false;
+    generation = 0;
+    accepted = 0;
+    running = true;
+    worker = std::thread([this, observed, config]() {
+        ABCResult r = run(observed, config, &generation, &accepted, &cancelRequested);
+        {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            result = std::move(r);
+        }
+        running = false;
+    });
+}
+
+void ABCSMCCalibrator::cancel() { cancelRequested = true; }
+bool ABCSMCCalibrator::isRunning() const { return running.load(); }
+int ABCSMCCalibrator::getGeneration() const { return generation.load(); }
+long long ABCSMCCalibrator::getAcceptedCount() const { return accepted.load(); }
+
+ABCResult ABCSMCCalibrator::getResult() {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    return result;
+}
@@ -0,0 +1,109 @@
+// ====================================================================================
+// 模块名称: ABCCalibrator (近似贝叶斯计算参数校准)
+// 功能描述:
+//   针对没有解析似然函数的模型变体(如随机链式二项SIR)，使用 ABC-SMC
+//   (Approximate Bayesian Computation - Sequential Monte Carlo) 从历史数据反推 Beta/Gamma 的后验分布。
+//   粒子在线程池上并行模拟，容差按代自适应收缩，粒子缓冲区在代与代之间复用。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] ObservedSeries
+// 描述: 从 Region::history 提取出的观测序列
+// 作用: 把累计确诊/治愈/死亡换算成SIR模型可以直接比较的 I(活跃) 与 R(移出) 序列。
+// ------------------------------------------------------------------------------------
+struct ObservedSeries {
+    int population = 0;
+    std::vector<int> days;        // Absolute day numbers, ascending
+    std::vector<double> infected; // Active = confirmed - recovered - deaths
+    std::vector<double> removed;  // Removed = recovered + deaths
+
+    static ObservedSeries FromRegion(const Region& region);
+
+    bool isUsable() const { return population > 0 && days.size() >= 2; }
+    int getSpan() const { return days.empty() ? 0 : days.back() - days.front(); }
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] ABCParticle
+// 描述: 一个候选参数组合(粒子)
+// ------------------------------------------------------------------------------------
+struct ABCParticle {
+    double beta = 0;
+    double gamma = 0;
+    double distance = 0;
+    double weight = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] ABCConfig / ABCResult
+// 描述: 校准参数与结果
+// ------------------------------------------------------------------------------------
+struct ABCConfig {
+    enum ModelKind { Deterministic, Stochastic };
+
+    ModelKind model = Stochastic;
+    int particleCount = 1000;
+    int maxGenerations = 10;
+    double quantile = 0.5;          // Next tolerance = this quantile of the current distances
+    double minEpsilonChange = 0.01; // Stop when the tolerance shrinks by less than this fraction
+    long long maxSimulationsPerGeneration = 2000000;
+    double betaMin = 0.0, betaMax = 2.0;   // Uniform prior, matches the Beta slider range
+    double gammaMin = 0.0, gammaMax = 1.0; // Uniform prior, matches the Gamma slider range
+    unsigned long long seed = 12345;
+};
+
+struct ABCResult {
+    bool valid = false;
+    std::vector<ABCParticle> particles; // Final weighted population
+    double betaMean = 0, betaStd = 0;
+    double gammaMean = 0, gammaStd = 0;
+    double epsilon = 0;
+    int generations = 0;
+    long long acceptedParticles = 0;
+    long long totalSimulations = 0;
+    double elapsedSeconds = 0;
+    double acceptedPerSecond = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [类] ABCSMCCalibrator
+// 描述: ABC-SMC 校准器
+// 作用:
+//   run() 同步执行完整校准；start() 在后台线程执行，UI 通过 getProgress()/isRunning() 轮询，
+//   结束后用 getResult() 取回结果。
+// ------------------------------------------------------------------------------------
+class ABCSMCCalibrator {
+public:
+    ABCSMCCalibrator();
+    ~ABCSMCCalibrator();
+
+    static ABCResult run(const ObservedSeries& observed, const ABCConfig& config,
+                         std::atomic<int>* generationOut = nullptr,
+                         std::atomic<long long>* acceptedOut = nullptr,
+                         const std::atomic<bool>* cancelFlag = nullptr);
+
+    // Background execution
+    void start(const ObservedSeries& observed, const ABCConfig& config);
+    void cancel();
+    bool isRunning() const;
+    int getGeneration() const;
+    long long getAcceptedCount() const;
+    ABCResult getResult();
+
+private:
+    std::thread worker;
+    std::mutex resultMutex;
+    ABCResult result;
+    std::atomic<bool> running;
+    std::atomic<bool> cancelRequested;
+    std::atomic<int> generation;
+    std::atomic<long long> accepted;
+};
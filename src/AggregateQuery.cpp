@@ -0,0 +1,531 @@
+// ====================================================================================
+// 模块名称: AggregateQuery Implementation
+// 功能描述:
+//   逐日对齐矩阵的建立与增量维护、分块汇总与前缀和查询，以及与逐个地区遍历历史的对比基准测试。
+// ====================================================================================
+
+#include "AggregateQuery.h"
+#include "ThreadPool.h"
+#include <algorithm>  // For std::min, std::max, std::copy, std::fill, std::remove
+#include <chrono>
+#include <climits>    // For INT_MAX, INT_MIN, LLONG_MIN
+#include <cstdio>     // For std::snprintf
+#include <random>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+inline int32_t MetricValue(const HistoricalRecord& record, SeriesMetric metric) {
+    switch (metric) {
+        case SeriesMetric::Confirmed: return record.confirmed;
+        case SeriesMetric::Recovered: return record.recovered;
+        case SeriesMetric::Deaths:    return record.deaths;
+        default:                      return record.confirmed - record.recovered - record.deaths;
+    }
+}
+
+// Range covered by every history; false when there is none
+bool HistoryDayRange(const std::vector<Region>& regions, int& firstDay, int& lastDay) {
+    firstDay = INT_MAX;
+    lastDay = INT_MIN;
+    for (const Region& r : regions) {
+        if (r.history.empty()) continue;
+        firstDay = std::min(firstDay, r.history.front().day);
+        lastDay = std::max(lastDay, r.history.back().day);
+    }
+    return firstDay <= lastDay;
+}
+
+// The reduction kernels: plain loops over consecutive days, which the compiler vectorizes
+inline void AddRow(int64_t* acc, const int32_t* row, size_t n) {
+    for (size_t d = 0; d < n; ++d) acc[d] += row[d];
+}
+
+inline void MaxRow(int64_t* acc, const int32_t* row, size_t n) {
+    for (size_t d = 0; d < n; ++d) acc[d] = std::max<int64_t>(acc[d], row[d]);
+}
+
+inline void AddPrefixSpan(int64_t* acc, const int64_t* upper, const int64_t* lower, size_t n) {
+    for (size_t d = 0; d < n; ++d) acc[d] += upper[d] - lower[d];
+}
+
+void Finish(const std::vector<int64_t>& acc, SeriesReduce reduce, size_t regionCount, int firstDay, SeriesResult& out) {
+    out.firstDay = firstDay;
+    out.values.resize(acc.size());
+    out.total = 0;
+    out.peak = 0;
+    out.peakDay = firstDay;
+    for (size_t d = 0; d < acc.size(); ++d) {
+        const double v = reduce == SeriesReduce::Mean ? static_cast<double>(acc[d]) / regionCount : static_cast<double>(acc[d]);
+        out.values[d] = v;
+        out.total += v;
+        if (d == 0 || v > out.peak) {
+            out.peak = v;
+            out.peakDay = firstDay + static_cast<int>(d);
+        }
+    }
+    out.mean = acc.empty() ? 0 : out.total / acc.size();
+}
+
+} // namespace
+
+// --- Maintenance ---
+
+AggregateQueryEngine::AggregateQueryEngine()
+    : target(nullptr), firstDay(0), dayCount(0), regionCount(0), stale(true), version(0), builds(0) {}
+
+AggregateQueryEngine::~AggregateQueryEngine() {
+    detach();
+}
+
+void AggregateQueryEngine::attach(EpidemicData& data) {
+    detach();
+    target = &data;
+    target->addChangeListener(this);
+    stale = true;
+    ++version;
+}
+
+void AggregateQueryEngine::detach() {
+    if (target) target->removeChangeListener(this);
+    target = nullptr;
+    for (Matrix& m : matrices) m = Matrix();
+    dirtyRegions.clear();
+    regionDirty.clear();
+    regionCount = 0;
+    dayCount = 0;
+    stale = true;
+}
+
+size_t AggregateQueryEngine::getMemoryBytes() const {
+    size_t bytes = 0;
+    for (const Matrix& m : matrices) {
+        bytes += m.cells.capacity() * sizeof(int32_t) + m.blockSum.capacity() * sizeof(int64_t) +
+                 m.blockMax.capacity() * sizeof(int32_t) + m.prefix.capacity() * sizeof(int64_t);
+    }
+    return bytes;
+}
+
+void AggregateQueryEngine::resetRange() {
+    for (Matrix& m : matrices) m = Matrix();
+    dirtyRegions.clear();
+    const std::vector<Region>& regions = target->getRegions();
+    regionCount = regions.size();
+    regionDirty.assign(regionCount, 0);
+    int lastDay = 0;
+    if (HistoryDayRange(regions, firstDay, lastDay)) {
+        dayCount = lastDay - firstDay + 1;
+    } else {
+        firstDay = 0;
+        dayCount = 0;
+    }
+    stale = false;
+}
+
+void AggregateQueryEngine::fillRow(Matrix& matrix, SeriesMetric metric, size_t index) const {
+    const HistorySeries& history = target->getRegions()[index].history;
+    int32_t* row = matrix.cells.data() + index * dayCount;
+    int32_t value = 0;
+    size_t k = 0;
+    for (int d = 0; d < dayCount; ++d) {
+        // Each record holds until the next one
+        while (k < history.size() && history[k].day <= firstDay + d) value = MetricValue(history[k++], metric);
+        row[d] = value;
+    }
+}
+
+void AggregateQueryEngine::build(SeriesMetric metric) {
+    Matrix& m = matrices[static_cast<int>(metric)];
+    m.cells.assign(regionCount * dayCount, 0);
+    ThreadPool::instance().parallelFor(regionCount, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) fillRow(m, metric, i);
+    }, 256);
+    m.dirtyBlock.assign(blockCount(), 1);
+    m.dirty = true;
+    m.built = true;
+    ++builds;
+}
+
+void AggregateQueryEngine::recomputeBlock(Matrix& matrix, size_t block) const {
+    int64_t* sum = matrix.blockSum.data() + block * dayCount;
+    int32_t* max = matrix.blockMax.data() + block * dayCount;
+    const size_t first = block * BlockSize;
+    const size_t last = std::min(first + BlockSize, regionCount);
+    const int32_t* row = matrix.cells.data() + first * dayCount;
+    for (int d = 0; d < dayCount; ++d) {
+        sum[d] = row[d];
+        max[d] = row[d];
+    }
+    for (size_t i = first + 1; i < last; ++i) {
+        row += dayCount;
+        for (int d = 0; d < dayCount; ++d) {
+            sum[d] += row[d];
+            max[d] = std::max(max[d], row[d]);
+        }
+    }
+}
+
+void AggregateQueryEngine::recomputePrefix(Matrix& matrix) const {
+    const size_t blocks = blockCount();
+    std::fill(matrix.prefix.begin(), matrix.prefix.begin() + dayCount, 0);
+    for (size_t b = 0; b < blocks; ++b) {
+        const int64_t* below = matrix.prefix.data() + b * dayCount;
+        const int64_t* sum = matrix.blockSum.data() + b * dayCount;
+        int64_t* above = matrix.prefix.data() + (b + 1) * dayCount;
+        for (int d = 0; d < dayCount; ++d) above[d] = below[d] + sum[d];
+    }
+}
+
+// [算法] 延迟刷新
+// 逻辑:
+//   通知只记录哪些行需要重写；查询某个指标之前才把脏行从历史重写进所有已建立的矩阵 (每行 O(天数))，
+//   再重算该指标的脏块 (每块 O(BlockSize × 天数)) 与块前缀和 (O(块数 × 天数))。
+//   连续的多次编辑 (如一次合并多条记录) 因此只付一次分块与前缀和的代价。
+void AggregateQueryEngine::refresh(SeriesMetric metric) {
+    if (stale) resetRange();
+    if (!dirtyRegions.empty()) {
+        for (int j = 0; j < 4; ++j) {
+            Matrix& m = matrices[j];
+            if (!m.built) continue;
+            for (uint32_t index : dirtyRegions) {
+                if (index >= regionCount) continue;  // Deleted since
+                fillRow(m, static_cast<SeriesMetric>(j), index);
+                m.dirtyBlock[index / BlockSize] = 1;
+                m.dirty = true;
+            }
+        }
+        for (uint32_t index : dirtyRegions) {
+            if (index < regionCount) regionDirty[index] = 0;
+        }
+        dirtyRegions.clear();
+    }
+
+    Matrix& m = matrices[static_cast<int>(metric)];
+    if (!m.built) build(metric);
+    if (m.dirty) {
+        const size_t blocks = blockCount();
+        m.blockSum.resize(blocks * dayCount);
+        m.blockMax.resize(blocks * dayCount);
+        m.prefix.resize((blocks + 1) * dayCount);
+        m.dirtyBlock.resize(blocks, 1);
+        ThreadPool::instance().parallelFor(blocks, [&](size_t begin, size_t end, unsigned) {
+            for (size_t b = begin; b < end; ++b) {
+                if (m.dirtyBlock[b]) recomputeBlock(m, b);
+            }
+        }, 16);
+        std::fill(m.dirtyBlock.begin(), m.dirtyBlock.end(), 0);
+        recomputePrefix(m);
+        m.dirty = false;
+    }
+}
+
+void AggregateQueryEngine::markRegion(size_t index) {
+    if (!regionDirty[index]) {
+        regionDirty[index] = 1;
+        dirtyRegions.push_back(static_cast<uint32_t>(index));
+    }
+}
+
+void AggregateQueryEngine::onRegionAdded(int index, const Region& region) {
+    ++version;
+    if (stale) return;
+    if (static_cast<size_t>(index) != regionCount ||
+        (!region.history.empty() && (region.history.front().day < firstDay || region.history.back().day >= firstDay + dayCount))) {
+        stale = true;
+        return;
+    }
+    // A new row at the end (zero before its first record, like every other row)
+    ++regionCount;
+    regionDirty.push_back(0);
+    for (int j = 0; j < 4; ++j) {
+        Matrix& m = matrices[j];
+        if (!m.built) continue;
+        m.cells.resize(regionCount * dayCount, 0);
+        fillRow(m, static_cast<SeriesMetric>(j), index);
+        m.dirtyBlock.resize(blockCount(), 1);
+        m.dirtyBlock[index / BlockSize] = 1;
+        m.dirty = true;
+    }
+}
+
+void AggregateQueryEngine::onRegionDeleted(int index) {
+    ++version;
+    if (stale) return;
+    if (index < 0 || static_cast<size_t>(index) >= regionCount) {
+        stale = true;
+        return;
+    }
+    // Mirrors the data model: the later rows move down by one, so every block from index on changes
+    for (Matrix& m : matrices) {
+        if (!m.built) continue;
+        m.cells.erase(m.cells.begin() + index * dayCount, m.cells.begin() + (index + 1) * dayCount);
+        std::fill(m.dirtyBlock.begin() + index / BlockSize, m.dirtyBlock.end(), 1);
+        m.dirty = true;
+    }
+    --regionCount;
+    regionDirty.erase(regionDirty.begin() + index);
+    // Pending rewrites follow their rows
+    const uint32_t removed = static_cast<uint32_t>(index);
+    dirtyRegions.erase(std::remove(dirtyRegions.begin(), dirtyRegions.end(), removed), dirtyRegions.end());
+    for (uint32_t& pending : dirtyRegions) pending -= pending > removed;
+}
+
+void AggregateQueryEngine::onRegionRenamed(int /*index*/, const char* /*name*/) {
+    ++version;
+}
+
+void AggregateQueryEngine::onPopulationChanged(int /*index*/, int /*population*/) {
+    ++version;
+}
+
+void AggregateQueryEngine::onCountsChanged(int /*index*/, int /*confirmed*/, int /*recovered*/, int /*deaths*/) {
+    ++version;
+}
+
+void AggregateQueryEngine::onHistoryUpserted(int index, const HistoricalRecord& record) {
+    ++version;
+    if (stale) return;
+    if (index < 0 || static_cast<size_t>(index) >= regionCount || record.day < firstDay || record.day >= firstDay + dayCount) {
+        stale = true;   // A new day outside the columns: the range grows
+        return;
+    }
+    markRegion(index);
+}
+
+void AggregateQueryEngine::onHistoryDeleted(int index, int /*day*/) {
+    ++version;
+    if (stale) return;
+    if (index < 0 || static_cast<size_t>(index) >= regionCount) {
+        stale = true;
+        return;
+    }
+    markRegion(index);
+}
+
+void AggregateQueryEngine::onBulkChange() {
+    ++version;
+    stale = true;
+}
+
+// --- Query ---
+
+// [算法] 子集查询
+// 逻辑:
+//   子集按下标升序给出，逐块统计落在块内的地区数。整块都在子集中的块连成一段，求和时用块前缀和
+//   相减 (一段无论多少块都是 O(天数))，求最大值时用块的逐日最大值；其余地区逐行累加/取最大。
+//   全部地区即前缀和的最后一行。
+bool AggregateQueryEngine::query(const SeriesQuery& q, SeriesResult& out) {
+    out.values.clear();
+    if (!target) return false;
+    refresh(q.metric);
+    const size_t count = q.regions ? q.regionCount : regionCount;
+    const int from = std::max(q.firstDay, firstDay);
+    const int to = std::min(q.lastDay, firstDay + dayCount - 1);
+    if (dayCount == 0 || count == 0 || from > to) return false;
+
+    const Matrix& m = matrices[static_cast<int>(q.metric)];
+    const size_t offset = static_cast<size_t>(from - firstDay);
+    const size_t n = static_cast<size_t>(to - from + 1);
+    const bool max = q.reduce == SeriesReduce::Max;
+    std::vector<int64_t> acc(n, max ? LLONG_MIN : 0);
+
+    if (!q.regions) {
+        if (max) {
+            for (size_t b = 0; b < blockCount(); ++b) {
+                const int32_t* blockMax = m.blockMax.data() + b * dayCount + offset;
+                for (size_t d = 0; d < n; ++d) acc[d] = std::max<int64_t>(acc[d], blockMax[d]);
+            }
+        } else {
+            const int64_t* total = m.prefix.data() + blockCount() * dayCount + offset;
+            for (size_t d = 0; d < n; ++d) acc[d] = total[d];
+        }
+        Finish(acc, q.reduce, count, from, out);
+        return true;
+    }
+
+    size_t runStart = 0, runEnd = 0;    // Blocks [runStart, runEnd) wholly in the subset
+    auto flushRun = [&]() {
+        if (runStart == runEnd) return;
+        if (max) {
+            for (size_t b = runStart; b < runEnd; ++b) {
+                const int32_t* blockMax = m.blockMax.data() + b * dayCount + offset;
+                for (size_t d = 0; d < n; ++d) acc[d] = std::max<int64_t>(acc[d], blockMax[d]);
+            }
+        } else {
+            AddPrefixSpan(acc.data(), m.prefix.data() + runEnd * dayCount + offset,
+                          m.prefix.data() + runStart * dayCount + offset, n);
+        }
+        runStart = runEnd = 0;
+    };
+    for (size_t i = 0; i < count;) {
+        if (q.regions[i] >= regionCount) return false;
+        const size_t block = q.regions[i] / BlockSize;
+        const size_t blockEnd = std::min((block + 1) * BlockSize, regionCount);
+        size_t j = i;
+        while (j < count && q.regions[j] < blockEnd) ++j;
+        if (j - i == blockEnd - block * BlockSize) {
+            if (runStart == runEnd || runEnd != block) {
+                flushRun();
+                runStart = block;
+            }
+            runEnd = block + 1;
+        } else {
+            for (size_t k = i; k < j; ++k) {
+                const int32_t* row = m.cells.data() + static_cast<size_t>(q.regions[k]) * dayCount + offset;
+                if (max) MaxRow(acc.data(), row, n);
+                else AddRow(acc.data(), row, n);
+            }
+        }
+        i = j;
+    }
+    flushRun();
+    Finish(acc, q.reduce, count, from, out);
+    return true;
+}
+
+bool AggregateQueryEngine::QueryDirect(const std::vector<Region>& regions, const SeriesQuery& q, SeriesResult& out) {
+    out.values.clear();
+    int first = 0, last = 0;
+    if (!HistoryDayRange(regions, first, last)) return false;
+    const size_t count = q.regions ? q.regionCount : regions.size();
+    const int from = std::max(q.firstDay, first);
+    const int to = std::min(q.lastDay, last);
+    if (count == 0 || from > to) return false;
+
+    const bool max = q.reduce == SeriesReduce::Max;
+    std::vector<int64_t> acc(static_cast<size_t>(to - from + 1), max ? LLONG_MIN : 0);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t index = q.regions ? q.regions[i] : i;
+        if (index >= regions.size()) return false;
+        const HistorySeries& history = regions[index].history;
+        int64_t value = 0;
+        size_t k = 0;
+        for (int day = from; day <= to; ++day) {
+            while (k < history.size() && history[k].day <= day) value = MetricValue(history[k++], q.metric);
+            int64_t& a = acc[day - from];
+            a = max ? std::max(a, value) : a + value;
+        }
+    }
+    Finish(acc, q.reduce, count, from, out);
+    return true;
+}
+
+// --- Benchmark ---
+
+// [算法] 查询引擎与逐个地区遍历的对比
+// 逻辑:
+//   生成地区及约 120 天中每 3 天一条的历史 (批量载入)，引擎作为监听器挂接。
+//   第一次查询建立现存病例矩阵；之后比较全国/随机十分之一地区/连续十分之一地区的查询与逐个地区遍历历史，
+//   再做随机的记录修改、地区删除与新增 (每次修改后做一次全国查询)，前后的所有查询都与遍历结果逐日比较。
+AggregateQueryBenchmarkResult AggregateQueryEngine::RunBenchmark(size_t regions) {
+    AggregateQueryBenchmarkResult result;
+    result.regions = regions;
+    const int days = 120;
+    result.days = days;
+
+    EpidemicData data;
+    std::mt19937 rng(31);
+    std::uniform_int_distribution<int> startDist(0, 30);
+    std::uniform_int_distribution<int> growthDist(0, 60);
+    char name[32];
+    data.beginBulkUpdate();
+    data.reserveRegions(regions);
+    for (size_t i = 0; i < regions; ++i) {
+        std::snprintf(name, sizeof(name), "Region %zu", i);
+        data.addRegion(name, 1000000, 0, 0, 0);
+        HistorySeries& history = data.getMutableHistory(static_cast<int>(i));
+        int confirmed = 0;
+        for (int day = startDist(rng); day < days; day += 3) {
+            confirmed += growthDist(rng);
+            history.push_back({ day, confirmed, confirmed * 2 / 3, confirmed / 50 });
+        }
+        result.records += history.size();
+    }
+    data.endBulkUpdate();
+
+    AggregateQueryEngine engine;
+    engine.attach(data);
+    const std::vector<Region>& rows = data.getRegions();
+
+    SeriesQuery national;
+    national.firstDay = 10;
+    national.lastDay = 90;
+    SeriesResult fromEngine, direct;
+    auto t0 = Clock::now();
+    engine.query(national, fromEngine);
+    result.buildMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    std::vector<uint32_t> tenth, range;
+    for (size_t i = 0; i < regions; ++i) {
+        if (rng() % 10 == 0) tenth.push_back(static_cast<uint32_t>(i));
+    }
+    for (size_t i = regions * 3 / 10; i < regions * 4 / 10; ++i) range.push_back(static_cast<uint32_t>(i));
+    SeriesQuery subset = national;
+    subset.regions = tenth.data();
+    subset.regionCount = tenth.size();
+    SeriesQuery block = national;
+    block.reduce = SeriesReduce::Max;
+    block.regions = range.data();
+    block.regionCount = range.size();
+
+    auto averageUs = [&](const SeriesQuery& q, int repeats) {
+        const auto start = Clock::now();
+        for (int r = 0; r < repeats; ++r) engine.query(q, fromEngine);
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / repeats;
+    };
+    result.nationalUs = averageUs(national, 200);
+    result.subsetUs = averageUs(subset, 20);
+    result.rangeUs = averageUs(block, 50);
+
+    t0 = Clock::now();
+    AggregateQueryEngine::QueryDirect(rows, national, direct);
+    result.directNationalMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    t0 = Clock::now();
+    AggregateQueryEngine::QueryDirect(rows, subset, direct);
+    result.directSubsetMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+
+    // Every reduction and metric against the direct walk
+    auto verifyAll = [&]() {
+        bool ok = true;
+        for (int metric = 0; metric < 4; ++metric) {
+            for (int reduce = 0; reduce < 3; ++reduce) {
+                for (SeriesQuery q : { national, subset, block }) {
+                    q.metric = static_cast<SeriesMetric>(metric);
+                    q.reduce = static_cast<SeriesReduce>(reduce);
+                    const bool a = engine.query(q, fromEngine);
+                    const bool b = AggregateQueryEngine::QueryDirect(rows, q, direct);
+                    ok = ok && a == b && fromEngine.firstDay == direct.firstDay && fromEngine.values == direct.values;
+                }
+            }
+        }
+        return ok;
+    };
+    bool verified = verifyAll();
+
+    std::uniform_int_distribution<int> dayDist(0, days - 1);
+    const int updates = 200;
+    t0 = Clock::now();
+    for (int u = 0; u < updates; ++u) {
+        const int index = static_cast<int>(rng() % rows.size());
+        const int confirmed = growthDist(rng) * 40;
+        data.upsertHistoryRecord(index, { dayDist(rng), confirmed, confirmed / 3, confirmed / 60 });
+        engine.query(national, fromEngine);
+    }
+    result.updateUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / updates;
+
+    // Rows moving and arriving (the subsets keep their indices, which now name other regions)
+    for (int u = 0; u < 50; ++u) {
+        data.deleteHistoryRecord(static_cast<int>(rng() % rows.size()), dayDist(rng));
+        data.deleteRegion(static_cast<int>(rng() % rows.size()));
+        std::snprintf(name, sizeof(name), "Added %d", u);
+        data.addRegion(name, 1000000, 0, 0, 0);
+        data.upsertHistoryRecord(static_cast<int>(rows.size()) - 1, { dayDist(rng), 900, 300, 10 });
+    }
+    verified = verified && verifyAll();
+
+    result.memoryBytes = engine.getMemoryBytes();
+    result.verified = verified;
+    result.valid = true;
+    return result;
+}
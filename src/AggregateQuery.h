@@ -0,0 +1,137 @@
+// ====================================================================================
+// 模块名称: AggregateQuery (跨地区逐日汇总查询)
+// 功能描述:
+//   回答 "某一组地区在第 10 - 90 天的现存病例总数/平均/最大值" 这类查询。
+//   每个指标按需建立一张逐日对齐的矩阵: 每个地区一行，每天一列，值为该地区当天延续的累计数
+//   (首条记录之前为 0，记录之间沿用上一条)。行按 BlockSize 个地区分块，缓存每块逐日的和与最大值，
+//   以及各块之和的前缀和:
+//     全部地区    前缀和相减，O(天数)
+//     地区子集    子集覆盖的整块连续段用前缀和相减，其余地区逐行累加 (按天连续的向量化循环)
+//   作为 EpidemicData 的变更监听器: 历史记录的增删改只重写该地区的一行并标记所在块，
+//   下一次查询时才重算脏块与前缀和；新增/删除地区移动行；超出已有天数范围或批量操作后整体重建。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <cstdint>
+#include <vector>
+
+enum class SeriesMetric { Confirmed, Recovered, Deaths, Active };
+enum class SeriesReduce { Sum, Mean, Max };    // Across the regions, per day
+
+// ------------------------------------------------------------------------------------
+// [结构体] SeriesQuery / SeriesResult
+// 描述: 查询条件与结果 (天数范围为闭区间，会被裁剪到已有记录的范围内)
+// ------------------------------------------------------------------------------------
+struct SeriesQuery {
+    SeriesMetric metric = SeriesMetric::Active;
+    SeriesReduce reduce = SeriesReduce::Sum;
+    int firstDay = 0;
+    int lastDay = 0;
+    const uint32_t* regions = nullptr;          // Ascending region indices; nullptr selects every region
+    size_t regionCount = 0;
+};
+
+struct SeriesResult {
+    int firstDay = 0;
+    std::vector<double> values;                 // One per day from firstDay
+    // Over the days of values
+    double total = 0;
+    double mean = 0;
+    double peak = 0;
+    int peakDay = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] AggregateQueryBenchmarkResult
+// 描述: 查询引擎与逐个地区遍历历史的对比 (查询用时为多次查询的平均值)
+// ------------------------------------------------------------------------------------
+struct AggregateQueryBenchmarkResult {
+    bool valid = false;
+    size_t regions = 0;
+    int days = 0;
+    size_t records = 0;
+    double buildMs = 0;                 // One metric's matrix, blocks and prefix sums
+    double nationalUs = 0;              // Every region, whole range, sum
+    double subsetUs = 0;                // A random tenth of the regions, sum
+    double rangeUs = 0;                 // A contiguous tenth of the regions (mostly whole blocks), max
+    double directNationalMs = 0;        // The national query walking every history
+    double directSubsetMs = 0;
+    double updateUs = 0;                // One history upsert followed by a national query
+    size_t memoryBytes = 0;
+    bool verified = false;              // Every query equals the direct walk, before and after the updates
+};
+
+// ------------------------------------------------------------------------------------
+// [类] AggregateQueryEngine
+// 描述: 逐日对齐矩阵 + 分块汇总缓存 + 前缀和
+// 作用: attach() 之后在 UI 线程上调用 query()；各指标的矩阵在第一次被查询时建立。
+// ------------------------------------------------------------------------------------
+class AggregateQueryEngine : public DataChangeListener {
+public:
+    static const size_t BlockSize = 128;
+
+    AggregateQueryEngine();
+    ~AggregateQueryEngine();
+
+    void attach(EpidemicData& data);
+    void detach();
+
+    // Returns false (and an empty result) when no region has history in the range
+    bool query(const SeriesQuery& query, SeriesResult& out);
+
+    // Brute force over the regions' histories (reference for the benchmark and checks)
+    static bool QueryDirect(const std::vector<Region>& regions, const SeriesQuery& query, SeriesResult& out);
+    // Synthetic regions, engine against QueryDirect on the calling thread
+    static AggregateQueryBenchmarkResult RunBenchmark(size_t regions);
+
+    // Changes with every notification received (renames and population edits too, which move regions
+    // between name and risk subsets)
+    uint64_t getVersion() const { return version; }
+    int getFirstDay() const { return firstDay; }
+    int getDayCount() const { return dayCount; }
+    size_t getMemoryBytes() const;
+    size_t getBuildCount() const { return builds; }      // Whole-matrix builds so far
+
+    // DataChangeListener
+    void onRegionAdded(int index, const Region& region) override;
+    void onRegionDeleted(int index) override;
+    void onRegionRenamed(int index, const char* name) override;
+    void onPopulationChanged(int index, int population) override;
+    void onCountsChanged(int index, int confirmed, int recovered, int deaths) override;
+    void onHistoryUpserted(int index, const HistoricalRecord& record) override;
+    void onHistoryDeleted(int index, int day) override;
+    void onBulkChange() override;
+
+private:
+    struct Matrix {
+        bool built = false;
+        std::vector<int32_t> cells;             // regions x days, one row per region
+        std::vector<int64_t> blockSum;          // blocks x days
+        std::vector<int32_t> blockMax;          // blocks x days
+        std::vector<int64_t> prefix;            // (blocks + 1) x days: sums of the blocks before
+        std::vector<uint8_t> dirtyBlock;
+        bool dirty = false;                     // Some block (and so the prefix sums) needs recomputing
+    };
+
+    void refresh(SeriesMetric metric);
+    void resetRange();
+    void build(SeriesMetric metric);
+    void fillRow(Matrix& matrix, SeriesMetric metric, size_t index) const;
+    void recomputeBlock(Matrix& matrix, size_t block) const;
+    void recomputePrefix(Matrix& matrix) const;
+    void markRegion(size_t index);
+    size_t blockCount() const { return (regionCount + BlockSize - 1) / BlockSize; }
+
+    EpidemicData* target;
+    Matrix matrices[4];                         // By SeriesMetric
+    int firstDay;
+    int dayCount;
+    size_t regionCount;                         // Rows in the built matrices
+    bool stale;                                 // Day range or layout changed: rebuild before the next query
+    std::vector<uint32_t> dirtyRegions;         // Rows to rewrite from their histories
+    std::vector<uint8_t> regionDirty;
+    uint64_t version;
+    size_t builds;
+};
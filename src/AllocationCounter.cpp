@@ -0,0 +1,109 @@
+// ====================================================================================
+// 模块名称: AllocationCounter
+// 功能描述:
+//   替换全局 operator new/delete 以统计进程内的堆分配次数 (MemoryArena::AllocationCount)，
+//   并可让 ImGui 的分配经过同一计数。单独成一个编译单元，不与使用容器的代码内联在一起。
+// ====================================================================================
+
+#include "MemoryArena.h"
+#include "imgui.h"
+#include <algorithm>  // For std::max
+#include <atomic>
+#include <cstdlib>    // For std::malloc, std::free
+#include <new>        // For std::bad_alloc, std::get_new_handler
+
+namespace {
+
+std::atomic<uint64_t> g_Allocations(0);
+
+void* CountedImGuiAlloc(size_t size, void*) {
+    g_Allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size);
+}
+
+void CountedImGuiFree(void* p, void*) {
+    std::free(p);
+}
+
+} // namespace
+
+// --- Counting operator new ---
+// Replaces the global allocation functions of the program so that every C++ heap allocation
+// (containers, strings, make_shared, and std::pmr::new_delete_resource, which uses the aligned forms) is counted.
+
+void* operator new(std::size_t size) {
+    g_Allocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void* p = std::malloc(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return ::operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return ::operator new(size, std::nothrow);
+}
+
+// Over-aligned blocks: malloc with room to align, the malloc pointer stored just before the block
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    const size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    void* raw = ::operator new(size + align + sizeof(void*));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+    void* p = reinterpret_cast<void*>((start + align - 1) & ~static_cast<uintptr_t>(align - 1));
+    static_cast<void**>(p)[-1] = raw;
+    return p;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return ::operator new(size, alignment);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return ::operator new(size, alignment, std::nothrow);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { ::operator delete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { ::operator delete(p); }
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    if (p) ::operator delete(static_cast<void**>(p)[-1]);
+}
+void operator delete[](void* p, std::align_val_t alignment) noexcept { ::operator delete(p, alignment); }
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept { ::operator delete(p, alignment); }
+void operator delete[](void* p, std::size_t, std::align_val_t alignment) noexcept { ::operator delete(p, alignment); }
+void operator delete(void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept { ::operator delete(p, alignment); }
+void operator delete[](void* p, std::align_val_t alignment, const std::nothrow_t&) noexcept { ::operator delete(p, alignment); }
+
+uint64_t MemoryArena::AllocationCount() {
+    return g_Allocations.load(std::memory_order_relaxed);
+}
+
+void MemoryArena::CountImGuiAllocations() {
+    ImGui::SetAllocatorFunctions(CountedImGuiAlloc, CountedImGuiFree, nullptr);
+}
@@ -0,0 +1,1193 @@
+// ====================================================================================
+// 模块名称: ApiServer Implementation
+// 功能描述:
+//   套接字封装 (Winsock / POSIX)、poll 事件循环与 HTTP/1.1 请求解析、工作线程路由、
+//   JSON 读写、UI 线程上的写请求执行与快照发布，以及压测客户端。
+// ====================================================================================
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include "ApiServer.h"
+#include "CsvImporter.h" // For CsvImporter::CopyRegionName
+#include <algorithm>     // For std::nth_element, std::max_element, std::min
+#include <charconv>      // For std::from_chars, std::to_chars
+#include <cmath>         // For std::isfinite
+#include <cstring>
+#include <random>
+#include <string_view>
+#include <unordered_map>
+
+// --- Sockets ---
+
+namespace {
+
+#ifdef _WIN32
+typedef SOCKET SocketHandle;
+typedef WSAPOLLFD PollEntry;
+const SocketHandle kInvalidSocket = INVALID_SOCKET;
+const int kSendFlags = 0;
+
+bool NetworkStartup() {
+    static const bool ok = [] {
+        WSADATA wsa;
+        return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+    }();
+    return ok;
+}
+void CloseSocket(SocketHandle s) { closesocket(s); }
+bool WouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+bool SetNonBlocking(SocketHandle s) { u_long on = 1; return ioctlsocket(s, FIONBIO, &on) == 0; }
+int PollSockets(PollEntry* entries, size_t count, int timeoutMillis) {
+    return WSAPoll(entries, static_cast<ULONG>(count), timeoutMillis);
+}
+#else
+typedef int SocketHandle;
+typedef pollfd PollEntry;
+const SocketHandle kInvalidSocket = -1;
+#ifdef MSG_NOSIGNAL
+const int kSendFlags = MSG_NOSIGNAL; // A peer that went away must not raise SIGPIPE
+#else
+const int kSendFlags = 0;
+#endif
+
+bool NetworkStartup() { return true; }
+void CloseSocket(SocketHandle s) { close(s); }
+bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+bool SetNonBlocking(SocketHandle s) { return fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK) == 0; }
+int PollSockets(PollEntry* entries, size_t count, int timeoutMillis) {
+    return poll(entries, static_cast<nfds_t>(count), timeoutMillis);
+}
+#endif
+
+sockaddr_in LoopbackAddress(int port) {
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(static_cast<unsigned short>(port));
+    return address;
+}
+
+void SetNoDelay(SocketHandle s) {
+    int on = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&on), sizeof(on));
+}
+
+int BoundPort(SocketHandle s) {
+    sockaddr_in address;
+    socklen_t length = sizeof(address);
+    if (getsockname(s, reinterpret_cast<sockaddr*>(&address), &length) != 0) return 0;
+    return ntohs(address.sin_port);
+}
+
+double Percentile(std::vector<float>& values, double q) {
+    if (values.empty()) return 0;
+    size_t k = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+const size_t kLatencyRing = 4096;
+const size_t kMaxHeaderBytes = 16 << 10;
+const size_t kMaxConnections = 1024;
+
+// --- HTTP / JSON helpers ---
+
+const char* StatusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        default:  return "Internal Server Error";
+    }
+}
+
+std::string HttpResponse(int status, const std::string& body, bool keepAlive) {
+    char head[192];
+    int n = std::snprintf(head, sizeof(head),
+                          "HTTP/1.1 %d %s\r\nContent-Type: application/json; charset=utf-8\r\n"
+                          "Content-Length: %zu\r\nConnection: %s\r\n\r\n",
+                          status, StatusText(status), body.size(), keepAlive ? "keep-alive" : "close");
+    std::string response;
+    response.reserve(n + body.size());
+    response.append(head, n);
+    response.append(body);
+    return response;
+}
+
+void AppendJsonString(std::string& out, const char* s, size_t length) {
+    out.push_back('"');
+    for (size_t i = 0; i < length; ++i) {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c == '"' || c == '\\') { out.push_back('\\'); out.push_back(static_cast<char>(c)); }
+        else if (c == '\n') out += "\\n";
+        else if (c == '\r') out += "\\r";
+        else if (c == '\t') out += "\\t";
+        else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        }
+        else out.push_back(static_cast<char>(c));
+    }
+    out.push_back('"');
+}
+
+void AppendInt(std::string& out, long long value) {
+    char buffer[24];
+    auto r = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, r.ptr - buffer);
+}
+
+void AppendDouble(std::string& out, double value) {
+    if (!std::isfinite(value)) { out += "null"; return; }
+    char buffer[32];
+    auto r = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 10);
+    out.append(buffer, r.ptr - buffer);
+}
+
+std::string ErrorBody(const char* message) {
+    std::string body = "{\"error\":";
+    AppendJsonString(body, message, std::strlen(message));
+    body.push_back('}');
+    return body;
+}
+
+const char* RiskName(RiskLevel level) {
+    return level == RiskLevel::High ? "high" : (level == RiskLevel::Medium ? "medium" : "low");
+}
+
+void AppendRegion(std::string& out, int index, const char* name, size_t nameLength, int population,
+                  int confirmed, int recovered, int deaths, size_t historyDays) {
+    out += "{\"index\":"; AppendInt(out, index);
+    out += ",\"name\":"; AppendJsonString(out, name, nameLength);
+    out += ",\"population\":"; AppendInt(out, population);
+    out += ",\"confirmed\":"; AppendInt(out, confirmed);
+    out += ",\"recovered\":"; AppendInt(out, recovered);
+    out += ",\"deaths\":"; AppendInt(out, deaths);
+    out += ",\"risk\":\"";
+    out += RiskName(EpidemicData::calculateRiskLevel(population, confirmed, recovered, deaths));
+    out += "\",\"historyDays\":"; AppendInt(out, static_cast<long long>(historyDays));
+    out.push_back('}');
+}
+
+bool ParseInt(std::string_view text, int& value) {
+    auto r = std::from_chars(text.data(), text.data() + text.size(), value);
+    return r.ec == std::errc() && r.ptr == text.data() + text.size();
+}
+
+// Value of key in "a=1&b=2" (no percent-decoding: the API only takes numbers in the query)
+bool QueryValue(std::string_view query, std::string_view key, std::string_view& value) {
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        std::string_view pair = query.substr(0, amp);
+        size_t eq = pair.find('=');
+        if (pair.substr(0, eq) == key) {
+            value = eq == std::string_view::npos ? std::string_view() : pair.substr(eq + 1);
+            return true;
+        }
+        if (amp == std::string_view::npos) break;
+        query.remove_prefix(amp + 1);
+    }
+    return false;
+}
+
+template <typename T>
+bool QueryNumber(std::string_view query, std::string_view key, T& value) {
+    std::string_view text;
+    if (!QueryValue(query, key, text)) return true; // Absent: keep the default
+    auto r = std::from_chars(text.data(), text.data() + text.size(), value);
+    return r.ec == std::errc() && r.ptr == text.data() + text.size();
+}
+
+void AppendUtf8(std::string& out, unsigned code) {
+    if (code < 0x80) out.push_back(static_cast<char>(code));
+    else if (code < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+        out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+}
+
+bool ParseHex4(const char*& p, const char* end, unsigned& code) {
+    if (end - p < 4) return false;
+    code = 0;
+    for (int i = 0; i < 4; ++i, ++p) {
+        char c = *p;
+        code <<= 4;
+        if (c >= '0' && c <= '9') code |= c - '0';
+        else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+        else return false;
+    }
+    return true;
+}
+
+bool ParseJsonString(const char*& p, const char* end, std::string& out) {
+    out.clear();
+    ++p; // Opening quote
+    while (p < end && *p != '"') {
+        if (*p != '\\') { out.push_back(*p++); continue; }
+        if (++p == end) return false;
+        char c = *p++;
+        switch (c) {
+            case '"': case '\\': case '/': out.push_back(c); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u': {
+                unsigned code;
+                if (!ParseHex4(p, end, code)) return false;
+                if (code >= 0xD800 && code < 0xDC00) { // Surrogate pair
+                    unsigned low;
+                    if (end - p < 6 || p[0] != '\\' || p[1] != 'u') return false;
+                    p += 2;
+                    if (!ParseHex4(p, end, low) || low < 0xDC00 || low > 0xDFFF) return false;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                AppendUtf8(out, code);
+                break;
+            }
+            default: return false;
+        }
+    }
+    if (p == end) return false;
+    ++p; // Closing quote
+    return true;
+}
+
+struct JsonField {
+    std::string key;
+    std::string value;
+    bool isString;
+};
+
+// Flat object of string / number / true / false / null values; nested values are rejected
+bool ParseFlatObject(const std::string& text, std::vector<JsonField>& fields) {
+    const char* p = text.data();
+    const char* end = p + text.size();
+    auto skipSpace = [&] { while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')) ++p; };
+    skipSpace();
+    if (p == end || *p++ != '{') return false;
+    skipSpace();
+    if (p < end && *p == '}') return true;
+    for (;;) {
+        JsonField field;
+        skipSpace();
+        if (p == end || *p != '"' || !ParseJsonString(p, end, field.key)) return false;
+        skipSpace();
+        if (p == end || *p++ != ':') return false;
+        skipSpace();
+        if (p == end) return false;
+        field.isString = *p == '"';
+        if (field.isString) {
+            if (!ParseJsonString(p, end, field.value)) return false;
+        } else {
+            const char* start = p;
+            while (p < end && *p != ',' && *p != '}' && *p != ' ' && *p != '\r' && *p != '\n' && *p != '\t') ++p;
+            field.value.assign(start, p - start);
+            if (field.value.empty() || field.value[0] == '{' || field.value[0] == '[') return false;
+        }
+        fields.push_back(std::move(field));
+        skipSpace();
+        if (p == end) return false;
+        if (*p == '}') return true;
+        if (*p++ != ',') return false;
+    }
+}
+
+const JsonField* FindField(const std::vector<JsonField>& fields, const char* key) {
+    for (const auto& f : fields) if (f.key == key) return &f;
+    return nullptr;
+}
+
+// false when present but not an integer; present tells whether the key was there
+bool FieldInt(const std::vector<JsonField>& fields, const char* key, int& value, bool& present) {
+    const JsonField* f = FindField(fields, key);
+    present = f != nullptr && f->value != "null";
+    if (!present) return true;
+    return !f->isString && ParseInt(f->value, value);
+}
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i], y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+std::string_view Trim(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+struct Connection {
+    SocketHandle socket = kInvalidSocket;
+    std::string in;
+    std::string out;
+    size_t sent = 0;
+    bool busy = false;              // A request is with the workers or the UI thread
+    bool closeAfterWrite = false;
+};
+
+} // namespace
+
+struct ApiServer::Sockets {
+    SocketHandle listener = kInvalidSocket;
+    SocketHandle wake = kInvalidSocket;        // UDP socket polled by the event loop
+    SocketHandle wakeSender = kInvalidSocket;
+    sockaddr_in wakeAddress;
+
+    void signal() {
+        const char byte = 1;
+        sendto(wakeSender, &byte, 1, 0, reinterpret_cast<const sockaddr*>(&wakeAddress), sizeof(wakeAddress));
+    }
+    void drain() {
+        char buffer[256];
+        while (recv(wake, buffer, sizeof(buffer), 0) > 0) {}
+    }
+    void closeAll() {
+        for (SocketHandle* s : { &listener, &wake, &wakeSender }) {
+            if (*s != kInvalidSocket) CloseSocket(*s);
+            *s = kInvalidSocket;
+        }
+    }
+};
+
+ApiServer::ApiServer()
+    : target(nullptr), port(0), stopping(false), dirty(false), latencyNext(0) {}
+
+ApiServer::~ApiServer() {
+    stop();
+}
+
+bool ApiServer::start(EpidemicData& data, int listenPort, unsigned workerCount, std::string* error) {
+    stop();
+    auto fail = [&](const std::string& message) {
+        if (sockets) sockets->closeAll();
+        if (error) *error = message;
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.error = message;
+        return false;
+    };
+    if (!NetworkStartup()) return fail("网络初始化失败");
+
+    sockets.reset(new Sockets());
+    Sockets& s = *sockets;
+    s.listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s.listener == kInvalidSocket) return fail("无法创建套接字");
+#ifndef _WIN32
+    int reuse = 1;
+    setsockopt(s.listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+#endif
+    sockaddr_in address = LoopbackAddress(listenPort);
+    if (bind(s.listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(s.listener, SOMAXCONN) != 0 || !SetNonBlocking(s.listener)) {
+        return fail("无法监听端口 " + std::to_string(listenPort) + " (可能已被占用)");
+    }
+    s.wake = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    s.wakeSender = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    s.wakeAddress = LoopbackAddress(0);
+    if (s.wake == kInvalidSocket || s.wakeSender == kInvalidSocket ||
+        bind(s.wake, reinterpret_cast<sockaddr*>(&s.wakeAddress), sizeof(s.wakeAddress)) != 0 ||
+        !SetNonBlocking(s.wake)) {
+        return fail("无法创建唤醒套接字");
+    }
+    s.wakeAddress.sin_port = htons(static_cast<unsigned short>(BoundPort(s.wake)));
+    port = BoundPort(s.listener);
+
+    target = &data;
+    target->addChangeListener(this);
+    stopping = false;
+    if (workerCount == 0) workerCount = std::max(2u, std::thread::hardware_concurrency());
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats = ApiServerStats();
+        stats.running = true;
+        stats.port = port;
+        stats.workers = workerCount;
+        latencyMs.clear();
+        latencyNext = 0;
+    }
+    publish();
+    for (unsigned i = 0; i < workerCount; ++i) workers.emplace_back(&ApiServer::workerLoop, this);
+    loopThread = std::thread(&ApiServer::eventLoop, this);
+    return true;
+}
+
+void ApiServer::stop() {
+    if (!loopThread.joinable()) return;
+    stopping = true;
+    sockets->signal();
+    loopThread.join();
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        tasks.clear();
+    }
+    taskReady.notify_all();
+    for (auto& w : workers) w.join();
+    workers.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutationMutex);
+        mutations.clear();
+    }
+    mutationReady.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        completions.clear();
+    }
+    sockets->closeAll();
+    target->removeChangeListener(this);
+    target = nullptr;
+    std::atomic_store(&published, std::shared_ptr<const DataSnapshot>());
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.running = false;
+    stats.openConnections = 0;
+}
+
+// --- Event loop ---
+
+// [算法] 单线程事件循环 (poll)
+// 逻辑:
+//   1. 每轮把监听套接字、唤醒套接字和所有连接交给 poll；有待发送数据的连接同时关注可写。
+//   2. 唤醒套接字可读说明工作线程或 UI 线程完成了请求: 把响应追加到对应连接的发送缓冲并立即尝试发送。
+//   3. 每个连接同一时刻最多只有一个请求在处理 (HTTP/1.1 响应必须按序)，
+//      流水线发来的后续请求留在接收缓冲中，上一个响应写出后再解析。
+//   4. 请求解析只做请求行、Content-Length 与 Connection 头，完整后移交工作线程，事件线程从不阻塞。
+void ApiServer::eventLoop() {
+    Sockets& s = *sockets;
+    std::unordered_map<uint64_t, Connection> connections;
+    uint64_t nextId = 1;
+    std::vector<PollEntry> entries;
+    std::vector<uint64_t> entryIds;
+    std::vector<Completion> done;
+    char buffer[16384];
+
+    auto reject = [&](Connection& c, int status, const char* message) {
+        c.out += HttpResponse(status, ErrorBody(message), false);
+        c.closeAfterWrite = true;
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.requests++;
+        stats.clientErrors++;
+    };
+
+    // Hands the next complete request of a connection to the workers
+    auto dispatch = [&](uint64_t id, Connection& c) {
+        if (c.busy || c.closeAfterWrite) return;
+        const size_t headerEnd = c.in.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            if (c.in.size() > kMaxHeaderBytes) reject(c, 431, "request header too large");
+            return;
+        }
+        std::string_view head(c.in.data(), headerEnd);
+        size_t lineEnd = head.find("\r\n");
+        std::string_view line = head.substr(0, lineEnd);
+        const size_t sp1 = line.find(' ');
+        const size_t sp2 = sp1 == std::string_view::npos ? sp1 : line.find(' ', sp1 + 1);
+        if (sp2 == std::string_view::npos) { reject(c, 400, "malformed request line"); return; }
+        std::string_view method = line.substr(0, sp1);
+        std::string_view uri = line.substr(sp1 + 1, sp2 - sp1 - 1);
+        std::string_view version = line.substr(sp2 + 1);
+
+        bool keepAlive = version == "HTTP/1.1";
+        size_t contentLength = 0;
+        while (lineEnd != std::string_view::npos) {
+            size_t next = head.find("\r\n", lineEnd + 2);
+            std::string_view header = head.substr(lineEnd + 2, next == std::string_view::npos ? std::string_view::npos : next - lineEnd - 2);
+            lineEnd = next;
+            size_t colon = header.find(':');
+            if (colon == std::string_view::npos) continue;
+            std::string_view name = Trim(header.substr(0, colon));
+            std::string_view value = Trim(header.substr(colon + 1));
+            if (EqualsIgnoreCase(name, "content-length")) {
+                auto r = std::from_chars(value.data(), value.data() + value.size(), contentLength);
+                if (r.ec != std::errc()) { reject(c, 400, "bad Content-Length"); return; }
+            } else if (EqualsIgnoreCase(name, "connection")) {
+                if (EqualsIgnoreCase(value, "close")) keepAlive = false;
+                else if (EqualsIgnoreCase(value, "keep-alive")) keepAlive = true;
+            } else if (EqualsIgnoreCase(name, "transfer-encoding")) {
+                reject(c, 501, "chunked request bodies are not supported");
+                return;
+            }
+        }
+        if (contentLength > MaxBodyBytes) { reject(c, 413, "request body too large"); return; }
+        const size_t total = headerEnd + 4 + contentLength;
+        if (c.in.size() < total) return;
+
+        Request request;
+        request.connection = id;
+        request.method.assign(method.data(), method.size());
+        size_t question = uri.find('?');
+        request.path.assign(uri.substr(0, question));
+        if (question != std::string_view::npos) request.query.assign(uri.substr(question + 1));
+        request.body.assign(c.in, headerEnd + 4, contentLength);
+        request.keepAlive = keepAlive;
+        request.received = Clock::now();
+        c.in.erase(0, total);
+        c.busy = true;
+        {
+            std::lock_guard<std::mutex> lock(taskMutex);
+            tasks.push_back(std::move(request));
+        }
+        taskReady.notify_one();
+    };
+
+    // Returns false when the connection has to be dropped
+    auto flush = [&](Connection& c) {
+        while (c.sent < c.out.size()) {
+            auto n = send(c.socket, c.out.data() + c.sent, static_cast<int>(c.out.size() - c.sent), kSendFlags);
+            if (n > 0) { c.sent += static_cast<size_t>(n); continue; }
+            if (n < 0 && WouldBlock()) return true;
+            return false;
+        }
+        c.out.clear();
+        c.sent = 0;
+        return !c.closeAfterWrite;
+    };
+
+    auto drop = [&](uint64_t id) {
+        auto it = connections.find(id);
+        if (it == connections.end()) return;
+        CloseSocket(it->second.socket);
+        connections.erase(it);
+    };
+
+    while (!stopping) {
+        entries.clear();
+        entryIds.clear();
+        entries.push_back(PollEntry{ s.listener, POLLIN, 0 });
+        entries.push_back(PollEntry{ s.wake, POLLIN, 0 });
+        for (auto& kv : connections) {
+            short events = POLLIN;
+            if (!kv.second.out.empty()) events |= POLLOUT;
+            entries.push_back(PollEntry{ kv.second.socket, events, 0 });
+            entryIds.push_back(kv.first);
+        }
+        if (PollSockets(entries.data(), entries.size(), 250) < 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        if (stopping) break;
+
+        // Finished requests
+        if (entries[1].revents) s.drain();
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            done.swap(completions);
+        }
+        for (Completion& item : done) {
+            auto it = connections.find(item.connection);
+            if (it == connections.end()) continue; // Client went away meanwhile
+            Connection& c = it->second;
+            c.out += item.response;
+            c.busy = false;
+            if (item.close) c.closeAfterWrite = true;
+            {
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.requests++;
+                if (latencyMs.size() < kLatencyRing) latencyMs.resize(kLatencyRing);
+                latencyMs[latencyNext % kLatencyRing] = std::chrono::duration<float, std::milli>(Clock::now() - item.received).count();
+                ++latencyNext;
+            }
+            if (!flush(c)) { drop(item.connection); continue; }
+            dispatch(item.connection, c);
+        }
+        done.clear();
+
+        // New connections
+        if (entries[0].revents & POLLIN) {
+            for (;;) {
+                SocketHandle client = accept(s.listener, nullptr, nullptr);
+                if (client == kInvalidSocket) break;
+                if (connections.size() >= kMaxConnections || !SetNonBlocking(client)) {
+                    CloseSocket(client);
+                    continue;
+                }
+                SetNoDelay(client);
+                Connection c;
+                c.socket = client;
+                connections.emplace(nextId++, std::move(c));
+                std::lock_guard<std::mutex> lock(statsMutex);
+                stats.acceptedConnections++;
+            }
+        }
+
+        // Connection I/O
+        for (size_t i = 0; i < entryIds.size(); ++i) {
+            const short revents = entries[i + 2].revents;
+            if (!revents) continue;
+            auto it = connections.find(entryIds[i]);
+            if (it == connections.end()) continue;
+            Connection& c = it->second;
+            bool alive = true;
+            if (revents & (POLLIN | POLLHUP | POLLERR)) {
+                for (;;) {
+                    auto n = recv(c.socket, buffer, sizeof(buffer), 0);
+                    if (n > 0) {
+                        c.in.append(buffer, static_cast<size_t>(n));
+                        if (c.in.size() > MaxBodyBytes + kMaxHeaderBytes) break; // dispatch() rejects it
+                        continue;
+                    }
+                    if (n < 0 && WouldBlock()) break;
+                    alive = false; // Orderly close or error
+                    break;
+                }
+                if (alive) dispatch(entryIds[i], c);
+            }
+            if (alive && (revents & POLLNVAL)) alive = false;
+            if (alive && !c.out.empty()) alive = flush(c);
+            if (!alive) drop(entryIds[i]);
+        }
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.openConnections = connections.size();
+    }
+    for (auto& kv : connections) CloseSocket(kv.second.socket);
+}
+
+// --- Workers ---
+
+void ApiServer::workerLoop() {
+    for (;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(taskMutex);
+            taskReady.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (stopping) return;
+            request = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        handle(request);
+    }
+}
+
+void ApiServer::complete(const Request& request, int status, const std::string& body) {
+    Completion c;
+    c.connection = request.connection;
+    c.response = HttpResponse(status, body, request.keepAlive);
+    c.close = !request.keepAlive;
+    c.received = request.received;
+    if (status >= 400 && status < 500) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.clientErrors++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        completions.push_back(std::move(c));
+    }
+    sockets->signal();
+}
+
+// [算法] 请求路由
+// 逻辑:
+//   GET 在工作线程上读取当前发布的快照直接作答；其余方法先在工作线程上解析并校验请求体，
+//   再把编辑排进 UI 线程的队列 (EpidemicData 只能在 UI 线程修改)，由 pump() 执行并回复。
+void ApiServer::handle(Request& request) {
+    std::vector<std::string> segments;
+    for (size_t begin = 0; begin < request.path.size();) {
+        size_t slash = request.path.find('/', begin);
+        if (slash == std::string::npos) slash = request.path.size();
+        if (slash > begin) segments.push_back(request.path.substr(begin, slash - begin));
+        begin = slash + 1;
+    }
+    if (segments.size() < 2 || segments[0] != "api") {
+        complete(request, 404, ErrorBody("unknown endpoint"));
+        return;
+    }
+    if (request.method == "GET") {
+        handleRead(request, segments);
+        return;
+    }
+
+    Mutation m;
+    const bool regions = segments[1] == "regions";
+    const bool history = regions && segments.size() == 5 && segments[3] == "history";
+    if (regions && segments.size() >= 3 && !ParseInt(segments[2], m.index)) {
+        complete(request, 404, ErrorBody("region index must be an integer"));
+        return;
+    }
+    if (history && !ParseInt(segments[4], m.record.day)) {
+        complete(request, 404, ErrorBody("day must be an integer"));
+        return;
+    }
+    std::vector<JsonField> fields;
+    const bool needsBody = request.method == "POST" || request.method == "PUT";
+    if (needsBody && !ParseFlatObject(request.body, fields)) {
+        complete(request, 400, ErrorBody("body must be a flat JSON object"));
+        return;
+    }
+
+    bool ok = true, present = false;
+    if (regions && segments.size() == 2 && request.method == "POST") {
+        m.kind = Mutation_CreateRegion;
+        const JsonField* name = FindField(fields, "name");
+        if (!name || !name->isString || name->value.empty()) {
+            complete(request, 400, ErrorBody("\"name\" is required"));
+            return;
+        }
+        m.name = name->value;
+        ok = FieldInt(fields, "population", m.population, present) &&
+             FieldInt(fields, "confirmed", m.record.confirmed, present) &&
+             FieldInt(fields, "recovered", m.record.recovered, present) &&
+             FieldInt(fields, "deaths", m.record.deaths, present);
+    } else if (regions && segments.size() == 3 && request.method == "PUT") {
+        m.kind = Mutation_UpdateRegion;
+        const JsonField* name = FindField(fields, "name");
+        if (name) {
+            ok = name->isString && !name->value.empty();
+            m.hasName = true;
+            m.name = name->value;
+        }
+        ok = ok && FieldInt(fields, "population", m.population, m.hasPopulation);
+        if (ok && !m.hasName && !m.hasPopulation) {
+            complete(request, 400, ErrorBody("expected \"name\" and/or \"population\""));
+            return;
+        }
+    } else if (regions && segments.size() == 3 && request.method == "DELETE") {
+        m.kind = Mutation_DeleteRegion;
+    } else if (history && request.method == "PUT") {
+        m.kind = Mutation_UpsertHistory;
+        bool c = false, r = false, d = false;
+        ok = FieldInt(fields, "confirmed", m.record.confirmed, c) &&
+             FieldInt(fields, "recovered", m.record.recovered, r) &&
+             FieldInt(fields, "deaths", m.record.deaths, d) && c && r && d;
+        if (!ok) {
+            complete(request, 400, ErrorBody("\"confirmed\", \"recovered\" and \"deaths\" are required integers"));
+            return;
+        }
+    } else if (history && request.method == "DELETE") {
+        m.kind = Mutation_DeleteHistory;
+    } else {
+        const bool known = regions && (segments.size() == 2 || segments.size() == 3 || history);
+        complete(request, known ? 405 : 404, ErrorBody(known ? "method not allowed" : "unknown endpoint"));
+        return;
+    }
+    if (!ok) {
+        complete(request, 400, ErrorBody("numeric fields must be integers"));
+        return;
+    }
+    if (m.population < 0 || m.record.confirmed < 0 || m.record.recovered < 0 || m.record.deaths < 0) {
+        complete(request, 400, ErrorBody("counts must not be negative"));
+        return;
+    }
+
+    m.request = std::move(request);
+    {
+        std::lock_guard<std::mutex> lock(mutationMutex);
+        mutations.push_back(std::move(m));
+    }
+    mutationReady.notify_one();
+}
+
+void ApiServer::handleRead(const Request& request, const std::vector<std::string>& segments) {
+    std::shared_ptr<const DataSnapshot> snapshot = std::atomic_load(&published);
+    if (!snapshot) {
+        complete(request, 503, ErrorBody("server is stopping"));
+        return;
+    }
+    const DataSnapshot& snap = *snapshot;
+    const std::string& resource = segments[1];
+    std::string body;
+
+    if (resource == "health" && segments.size() == 2) {
+        body = "{\"status\":\"ok\",\"regions\":";
+        AppendInt(body, static_cast<long long>(snap.rows.size()));
+        body += ",\"epoch\":";
+        AppendInt(body, static_cast<long long>(snap.epoch));
+        body.push_back('}');
+    } else if (resource == "summary" && segments.size() == 2) {
+        long long population = 0, confirmed = 0, recovered = 0, deaths = 0;
+        size_t risk[3] = { 0, 0, 0 };
+        for (const auto& row : snap.rows) {
+            population += row.population;
+            confirmed += row.confirmed;
+            recovered += row.recovered;
+            deaths += row.deaths;
+            risk[static_cast<int>(EpidemicData::calculateRiskLevel(row.population, row.confirmed, row.recovered, row.deaths))]++;
+        }
+        body = "{\"regions\":"; AppendInt(body, static_cast<long long>(snap.rows.size()));
+        body += ",\"records\":"; AppendInt(body, static_cast<long long>(snap.recordCount));
+        body += ",\"population\":"; AppendInt(body, population);
+        body += ",\"confirmed\":"; AppendInt(body, confirmed);
+        body += ",\"recovered\":"; AppendInt(body, recovered);
+        body += ",\"deaths\":"; AppendInt(body, deaths);
+        body += ",\"active\":"; AppendInt(body, confirmed - recovered - deaths);
+        body += ",\"risk\":{\"low\":"; AppendInt(body, static_cast<long long>(risk[static_cast<int>(RiskLevel::Low)]));
+        body += ",\"medium\":"; AppendInt(body, static_cast<long long>(risk[static_cast<int>(RiskLevel::Medium)]));
+        body += ",\"high\":"; AppendInt(body, static_cast<long long>(risk[static_cast<int>(RiskLevel::High)]));
+        body += "}}";
+    } else if (resource == "regions" && segments.size() == 2) {
+        size_t offset = 0, limit = 1000;
+        if (!QueryNumber(request.query, "offset", offset) || !QueryNumber(request.query, "limit", limit)) {
+            complete(request, 400, ErrorBody("offset and limit must be non-negative integers"));
+            return;
+        }
+        const size_t begin = std::min(offset, snap.rows.size());
+        const size_t end = begin + std::min(limit, snap.rows.size() - begin);
+        body.reserve(64 + (end - begin) * 160);
+        body = "{\"total\":"; AppendInt(body, static_cast<long long>(snap.rows.size()));
+        body += ",\"offset\":"; AppendInt(body, static_cast<long long>(begin));
+        body += ",\"regions\":[";
+        for (size_t i = begin; i < end; ++i) {
+            const auto& row = snap.rows[i];
+            if (i > begin) body.push_back(',');
+            AppendRegion(body, static_cast<int>(i), snap.getName(row), row.nameLength, row.population,
+                         row.confirmed, row.recovered, row.deaths, row.historyCount);
+        }
+        body += "]}";
+    } else if (resource == "regions" && segments.size() == 3) {
+        int index = -1;
+        if (!ParseInt(segments[2], index) || index < 0 || static_cast<size_t>(index) >= snap.rows.size()) {
+            complete(request, 404, ErrorBody("region not found"));
+            return;
+        }
+        const auto& row = snap.rows[index];
+        AppendRegion(body, index, snap.getName(row), row.nameLength, row.population,
+                     row.confirmed, row.recovered, row.deaths, row.historyCount);
+        body.pop_back(); // Extend the region object with its history
+        body += ",\"history\":[";
+        for (size_t i = 0; i < row.historyCount; ++i) {
+            const HistoricalRecord& rec = row.history[i];
+            if (i > 0) body.push_back(',');
+            body += "{\"day\":"; AppendInt(body, rec.day);
+            body += ",\"confirmed\":"; AppendInt(body, rec.confirmed);
+            body += ",\"recovered\":"; AppendInt(body, rec.recovered);
+            body += ",\"deaths\":"; AppendInt(body, rec.deaths);
+            body.push_back('}');
+        }
+        body += "]}";
+    } else if (resource == "forecast" && segments.size() == 2) {
+        int index = -1, days = 90;
+        double beta = 0.3, gamma = 0.1;
+        std::string_view regionText;
+        if (!QueryValue(request.query, "region", regionText) || !ParseInt(regionText, index) ||
+            index < 0 || static_cast<size_t>(index) >= snap.rows.size()) {
+            complete(request, 404, ErrorBody("region not found (?region=index)"));
+            return;
+        }
+        if (!QueryNumber(request.query, "beta", beta) || !QueryNumber(request.query, "gamma", gamma) ||
+            !QueryNumber(request.query, "days", days) || beta < 0 || gamma < 0 || days < 1 || days > 3650) {
+            complete(request, 400, ErrorBody("beta/gamma must be >= 0 and days in [1, 3650]"));
+            return;
+        }
+        // Same origin as Region::getForecastOrigin: continue from the last history record
+        const auto& row = snap.rows[index];
+        int startDay = 0, infected, removed;
+        if (row.historyCount > 0) {
+            const HistoricalRecord& last = row.history[row.historyCount - 1];
+            startDay = last.day + 1;
+            infected = last.confirmed - last.recovered - last.deaths;
+            removed = last.recovered + last.deaths;
+        } else {
+            infected = row.confirmed - row.recovered - row.deaths;
+            removed = row.recovered + row.deaths;
+        }
+        if (infected <= 0) infected = 1;
+        SIRModel model;
+        model.setBeta(beta);
+        model.setGamma(gamma);
+        model.reset(row.population, infected, removed, startDay);
+        model.run(days);
+
+        const auto& points = model.getHistory();
+        size_t peak = 0;
+        for (size_t i = 1; i < points.size(); ++i) if (points[i].infected > points[peak].infected) peak = i;
+        body.reserve(160 + points.size() * 80);
+        body = "{\"region\":"; AppendInt(body, index);
+        body += ",\"name\":"; AppendJsonString(body, snap.getName(row), row.nameLength);
+        body += ",\"beta\":"; AppendDouble(body, beta);
+        body += ",\"gamma\":"; AppendDouble(body, gamma);
+        body += ",\"startDay\":"; AppendInt(body, startDay);
+        body += ",\"peakDay\":"; AppendInt(body, points.empty() ? startDay : points[peak].day);
+        body += ",\"peakInfected\":"; AppendDouble(body, points.empty() ? 0.0 : points[peak].infected);
+        body += ",\"points\":[";
+        for (size_t i = 0; i < points.size(); ++i) {
+            if (i > 0) body.push_back(',');
+            body += "{\"day\":"; AppendInt(body, points[i].day);
+            body += ",\"susceptible\":"; AppendDouble(body, points[i].susceptible);
+            body += ",\"infected\":"; AppendDouble(body, points[i].infected);
+            body += ",\"recovered\":"; AppendDouble(body, points[i].recovered);
+            body.push_back('}');
+        }
+        body += "]}";
+    } else {
+        complete(request, 404, ErrorBody("unknown endpoint"));
+        return;
+    }
+    complete(request, 200, body);
+}
+
+// --- UI thread ---
+
+std::string ApiServer::applyMutation(const Mutation& m, int& status) {
+    auto& regions = target->getRegions();
+    if (m.kind != Mutation_CreateRegion && (m.index < 0 || static_cast<size_t>(m.index) >= regions.size())) {
+        status = 404;
+        return ErrorBody("region not found");
+    }
+    char name[sizeof(Region::name)];
+    std::string body;
+    status = 200;
+    switch (m.kind) {
+    case Mutation_CreateRegion:
+        CsvImporter::CopyRegionName(m.name, name, sizeof(name));
+        target->addRegion(name, m.population, m.record.confirmed, m.record.recovered, m.record.deaths);
+        status = 201;
+        break;
+    case Mutation_UpdateRegion:
+        if (m.hasName) {
+            CsvImporter::CopyRegionName(m.name, name, sizeof(name));
+            target->renameRegion(m.index, name);
+        }
+        if (m.hasPopulation) target->setRegionPopulation(m.index, m.population);
+        break;
+    case Mutation_DeleteRegion:
+        target->deleteRegion(m.index);
+        body = "{\"deleted\":";
+        AppendInt(body, m.index);
+        body.push_back('}');
+        return body;
+    case Mutation_UpsertHistory:
+        target->upsertHistoryRecord(m.index, m.record);
+        break;
+    case Mutation_DeleteHistory: {
+        if (!regions[m.index].history.find(m.record.day)) {
+            status = 404;
+            return ErrorBody("no record for that day");
+        }
+        target->deleteHistoryRecord(m.index, m.record.day);
+        break;
+    }
+    }
+    const int index = m.kind == Mutation_CreateRegion ? static_cast<int>(regions.size()) - 1 : m.index;
+    const Region& r = regions[index];
+    AppendRegion(body, index, r.name, std::strlen(r.name), r.getPopulation(), r.getConfirmedCases(),
+                 r.getRecoveredCases(), r.getDeaths(), r.history.size());
+    return body;
+}
+
+void ApiServer::publish() {
+    auto t0 = Clock::now();
+    std::shared_ptr<const DataSnapshot> snapshot = target->captureSnapshot();
+    std::atomic_store(&published, snapshot);
+    dirty = false;
+    lastPublish = Clock::now();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.snapshotsPublished++;
+    stats.lastPublishMs = std::chrono::duration<double, std::milli>(lastPublish - t0).count();
+}
+
+// [算法] UI 线程泵
+// 逻辑:
+//   取出排队的全部编辑依次执行，随后重新截取并发布快照 (编辑者随后的读请求一定能读到自己的修改)，
+//   最后才放出这些编辑的响应。界面或其他来源的编辑只置脏标记，最多每 PublishIntervalMillis 重新发布一次。
+void ApiServer::pump() {
+    if (!isRunning()) return;
+    std::vector<Mutation> work;
+    {
+        std::lock_guard<std::mutex> lock(mutationMutex);
+        work.swap(mutations);
+    }
+    std::vector<int> status(work.size());
+    std::vector<std::string> bodies(work.size());
+    for (size_t i = 0; i < work.size(); ++i) bodies[i] = applyMutation(work[i], status[i]);
+
+    if (!work.empty() ||
+        (dirty && Clock::now() - lastPublish >= std::chrono::milliseconds(PublishIntervalMillis))) {
+        publish();
+    }
+    if (!work.empty()) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.mutations += work.size();
+    }
+    for (size_t i = 0; i < work.size(); ++i) complete(work[i].request, status[i], bodies[i]);
+}
+
+void ApiServer::waitForWork(int timeoutMillis) {
+    std::unique_lock<std::mutex> lock(mutationMutex);
+    mutationReady.wait_for(lock, std::chrono::milliseconds(timeoutMillis),
+                           [this] { return stopping || !mutations.empty(); });
+}
+
+ApiServerStats ApiServer::getStats() {
+    ApiServerStats copy;
+    std::vector<float> samples;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        copy = stats;
+        samples.assign(latencyMs.begin(), latencyMs.begin() + std::min(latencyNext, latencyMs.size()));
+    }
+    copy.latencyP50Ms = Percentile(samples, 0.50);
+    copy.latencyP99Ms = Percentile(samples, 0.99);
+    return copy;
+}
+
+// --- Load test ---
+
+namespace {
+
+SocketHandle ConnectLoopback(int port) {
+    SocketHandle s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == kInvalidSocket) return s;
+    SetNoDelay(s);
+    sockaddr_in address = LoopbackAddress(port);
+    if (connect(s, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        CloseSocket(s);
+        return kInvalidSocket;
+    }
+    return s;
+}
+
+// Blocking request/response on a keep-alive connection; body receives the response body
+bool Exchange(SocketHandle s, const std::string& request, std::string& buffer, std::string& body, int& status) {
+    for (size_t sent = 0; sent < request.size();) {
+        auto n = send(s, request.data() + sent, static_cast<int>(request.size() - sent), kSendFlags);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    char chunk[16384];
+    size_t headerEnd;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        auto n = recv(s, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    if (buffer.compare(0, 9, "HTTP/1.1 ") != 0 || !ParseInt(std::string_view(buffer).substr(9, 3), status)) return false;
+    size_t length = 0;
+    size_t at = buffer.find("Content-Length:");
+    if (at == std::string::npos || at > headerEnd) return false;
+    at += 15;
+    while (buffer[at] == ' ') ++at;
+    std::from_chars(buffer.data() + at, buffer.data() + headerEnd, length);
+    const size_t total = headerEnd + 4 + length;
+    while (buffer.size() < total) {
+        auto n = recv(s, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, static_cast<size_t>(n));
+    }
+    body.assign(buffer, headerEnd + 4, length);
+    buffer.erase(0, total);
+    return true;
+}
+
+} // namespace
+
+// [算法] 压测客户端
+// 逻辑:
+//   先请求 /api/summary 得到地区数，然后开 connections 个线程，每个线程一条 keep-alive 连接，
+//   从共享计数器领取请求编号直到总数用完: 70% 为随机地区的90天预测，25% 为随机地区详情 (含历史)，
+//   5% 为汇总。逐个请求记录 "发出 -> 收完响应" 的延迟，汇总 p50/p99 与每秒请求数。
+//   只发只读请求，压测不会修改正在使用的数据。
+ApiLoadTestResult ApiServer::RunLoadTest(int port, int connections, size_t requests) {
+    ApiLoadTestResult result;
+    result.connections = connections;
+    if (!NetworkStartup()) {
+        result.error = "网络初始化失败";
+        return result;
+    }
+    int regionCount = 0;
+    {
+        SocketHandle probe = ConnectLoopback(port);
+        if (probe == kInvalidSocket) {
+            result.error = "无法连接到 127.0.0.1:" + std::to_string(port);
+            return result;
+        }
+        std::string buffer, body;
+        int status = 0;
+        const bool ok = Exchange(probe, "GET /api/summary HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n", buffer, body, status);
+        CloseSocket(probe);
+        size_t at = body.find("\"regions\":");
+        if (!ok || status != 200 || at == std::string::npos) {
+            result.error = "服务没有正确响应 /api/summary";
+            return result;
+        }
+        std::from_chars(body.data() + at + 10, body.data() + body.size(), regionCount);
+    }
+
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> failures(0);
+    std::vector<std::vector<float>> latencies(connections);
+    std::vector<std::thread> clients;
+    auto t0 = Clock::now();
+    for (int c = 0; c < connections; ++c) {
+        clients.emplace_back([&, c] {
+            std::mt19937 rng(static_cast<unsigned>(c) * 7919u + 1u);
+            SocketHandle s = ConnectLoopback(port);
+            std::string buffer, body, request;
+            char line[160];
+            for (;;) {
+                const size_t i = next.fetch_add(1);
+                if (i >= requests) break;
+                if (s == kInvalidSocket) { failures++; s = ConnectLoopback(port); continue; }
+                const int region = regionCount > 0 ? static_cast<int>(rng() % regionCount) : 0;
+                const size_t kind = i % 20;
+                if (regionCount == 0 || kind == 19) {
+                    std::snprintf(line, sizeof(line), "GET /api/summary HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+                } else if (kind < 14) {
+                    std::snprintf(line, sizeof(line), "GET /api/forecast?region=%d&days=90 HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n", region);
+                } else {
+                    std::snprintf(line, sizeof(line), "GET /api/regions/%d HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n", region);
+                }
+                request = line;
+                int status = 0;
+                auto start = Clock::now();
+                if (!Exchange(s, request, buffer, body, status)) {
+                    failures++;
+                    CloseSocket(s);
+                    buffer.clear();
+                    s = ConnectLoopback(port);
+                    continue;
+                }
+                latencies[c].push_back(std::chrono::duration<float, std::milli>(Clock::now() - start).count());
+                if (status / 100 != 2) failures++;
+            }
+            if (s != kInvalidSocket) CloseSocket(s);
+        });
+    }
+    for (auto& t : clients) t.join();
+    result.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    std::vector<float> all;
+    for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    result.requests = all.size();
+    result.failures = failures;
+    result.requestsPerSecond = result.seconds > 0 ? all.size() / result.seconds : 0.0;
+    result.latencyMaxMs = all.empty() ? 0.0 : *std::max_element(all.begin(), all.end());
+    result.latencyP50Ms = Percentile(all, 0.50);
+    result.latencyP99Ms = Percentile(all, 0.99);
+    result.valid = !all.empty();
+    if (!result.valid) result.error = "没有成功完成的请求";
+    return result;
+}
@@ -0,0 +1,183 @@
+// ====================================================================================
+// 模块名称: ApiServer (本地 HTTP/JSON 接口服务)
+// 功能描述:
+//   在 127.0.0.1 上提供 HTTP/1.1 (keep-alive) JSON 接口，供其他内部工具在没有界面的情况下
+//   查询地区数据、增删改地区与历史记录、运行 SIR 预测。
+//   一个事件线程用 poll/WSAPoll 管理所有非阻塞连接 (接受、读取、写回)，
+//   完整的请求交给工作线程池处理。读请求直接读取 UI 线程发布的写时复制数据快照 (DataSnapshot)，
+//   快照不可变，因此并发的读请求之间没有任何锁；写请求排队交给 UI 线程在 pump() 中执行
+//   (与界面编辑一样经过 EpidemicData 的编辑接口和编辑日志)，执行后重新发布快照再回复。
+//
+//   接口:
+//     GET    /api/health
+//     GET    /api/summary
+//     GET    /api/regions?offset=0&limit=1000
+//     GET    /api/regions/{i}                       (含历史记录)
+//     POST   /api/regions                           {"name","population","confirmed","recovered","deaths"}
+//     PUT    /api/regions/{i}                       {"name"?, "population"?}
+//     DELETE /api/regions/{i}                       (最后一个地区移到 i)
+//     PUT    /api/regions/{i}/history/{day}         {"confirmed","recovered","deaths"}
+//     DELETE /api/regions/{i}/history/{day}
+//     GET    /api/forecast?region=i&beta=0.3&gamma=0.1&days=90
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] ApiServerStats
+// 描述: 服务运行统计 (UI 每帧读取)
+// ------------------------------------------------------------------------------------
+struct ApiServerStats {
+    bool running = false;
+    int port = 0;
+    unsigned workers = 0;
+    std::string error;
+    size_t openConnections = 0;
+    size_t acceptedConnections = 0;
+    size_t requests = 0;            // Responses sent
+    size_t clientErrors = 0;        // 4xx responses
+    size_t mutations = 0;           // Edits applied by pump()
+    size_t snapshotsPublished = 0;
+    double lastPublishMs = 0;       // UI-thread snapshot capture
+    double latencyP50Ms = 0;        // Request received -> response queued, server side
+    double latencyP99Ms = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] ApiLoadTestResult
+// 描述: 压测结果 (多个 keep-alive 连接并发发送只读请求: 预测 70%、地区详情 25%、汇总 5%)
+// ------------------------------------------------------------------------------------
+struct ApiLoadTestResult {
+    bool valid = false;
+    std::string error;
+    int connections = 0;
+    size_t requests = 0;
+    size_t failures = 0;            // Transport errors or non-2xx responses
+    double seconds = 0;
+    double requestsPerSecond = 0;
+    double latencyP50Ms = 0;        // Client side, send -> full response
+    double latencyP99Ms = 0;
+    double latencyMaxMs = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [类] ApiServer
+// 描述: 本地 HTTP/JSON 接口服务
+// 作用:
+//   start()/stop() 在 UI 线程调用；pump() 由 UI 主循环每帧调用 (无界面模式下由 waitForWork() 唤醒)，
+//   执行排队的写请求并在数据变化后重新发布快照。作为变更监听器，界面或其他来源的编辑也会触发重新发布。
+// ------------------------------------------------------------------------------------
+class ApiServer : public DataChangeListener {
+public:
+    static constexpr int DefaultPort = 8765;
+    static constexpr size_t MaxBodyBytes = 1 << 20;
+    static constexpr int PublishIntervalMillis = 100;  // Minimum spacing of republishes for edits made elsewhere
+
+    ApiServer();
+    ~ApiServer();
+
+    // workers = 0 uses one per hardware thread
+    bool start(EpidemicData& data, int port, unsigned workers = 0, std::string* error = nullptr);
+    void stop();
+    bool isRunning() const { return loopThread.joinable(); }
+
+    // UI thread: applies queued edits, republishes the snapshot, releases the edit responses
+    void pump();
+    // Headless main loop: returns when an edit is queued or after timeoutMillis
+    void waitForWork(int timeoutMillis);
+    ApiServerStats getStats();
+
+    // DataChangeListener: any edit makes the published snapshot stale
+    void onRegionAdded(int /*index*/, const Region& /*region*/) override { dirty = true; }
+    void onRegionDeleted(int /*index*/) override { dirty = true; }
+    void onRegionRenamed(int /*index*/, const char* /*name*/) override { dirty = true; }
+    void onPopulationChanged(int /*index*/, int /*population*/) override { dirty = true; }
+    void onCountsChanged(int /*index*/, int /*confirmed*/, int /*recovered*/, int /*deaths*/) override { dirty = true; }
+    void onHistoryUpserted(int /*index*/, const HistoricalRecord& /*record*/) override { dirty = true; }
+    void onHistoryDeleted(int /*index*/, int /*day*/) override { dirty = true; }
+    void onBulkChange() override { dirty = true; }
+
+    // Load-test client against a running server (read-only requests), on the calling thread
+    static ApiLoadTestResult RunLoadTest(int port, int connections, size_t requests);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    struct Sockets; // Listening and wake-up sockets (platform types stay in the .cpp)
+
+    struct Request {
+        uint64_t connection = 0;
+        std::string method;
+        std::string path;
+        std::string query;
+        std::string body;
+        bool keepAlive = true;
+        Clock::time_point received;
+    };
+
+    enum MutationKind { Mutation_CreateRegion, Mutation_UpdateRegion, Mutation_DeleteRegion,
+                        Mutation_UpsertHistory, Mutation_DeleteHistory };
+
+    struct Mutation {
+        Request request;
+        MutationKind kind = Mutation_CreateRegion;
+        int index = -1;
+        bool hasName = false;
+        bool hasPopulation = false;
+        std::string name;
+        int population = 0;
+        HistoricalRecord record = { 0, 0, 0, 0 };
+    };
+
+    struct Completion {
+        uint64_t connection = 0;
+        std::string response;
+        bool close = false;
+        Clock::time_point received;
+    };
+
+    void eventLoop();
+    void workerLoop();
+    void handle(Request& request);
+    void handleRead(const Request& request, const std::vector<std::string>& segments);
+    std::string applyMutation(const Mutation& mutation, int& status);
+    void complete(const Request& request, int status, const std::string& body);
+    void publish();
+
+    EpidemicData* target;
+    std::unique_ptr<Sockets> sockets;
+    int port;
+    std::atomic<bool> stopping;
+    std::atomic<bool> dirty;
+    Clock::time_point lastPublish;
+    std::shared_ptr<const DataSnapshot> published;  // Read and replaced with std::atomic_load/atomic_store
+
+    std::thread loopThread;
+    std::vector<std::thread> workers;
+    std::mutex taskMutex;
+    std::condition_variable taskReady;
+    std::deque<Request> tasks;
+
+    std::mutex mutationMutex;
+    std::condition_variable mutationReady;
+    std::vector<Mutation> mutations;
+
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+
+    std::mutex statsMutex;                          // Guards stats and the latency ring
+    ApiServerStats stats;
+    std::vector<float> latencyMs;
+    size_t latencyNext;
+};
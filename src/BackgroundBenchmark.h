@@ -0,0 +1,59 @@
+// ====================================================================================
+// 模块名称: BackgroundBenchmark (后台基准测试)
+// 功能描述:
+//   各模块的基准测试都是一个在调用线程上运行数秒的静态函数 (如 RegionScan::RunBenchmark、
+//   Journal::RunBenchmark)，本身不涉及线程。界面通过本模板把它放到一个工作线程上运行，
+//   每帧读取运行状态与最近一次的结果，界面线程不会等待。
+// ====================================================================================
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// ------------------------------------------------------------------------------------
+// [类] BackgroundBenchmark
+// 描述: 一个工作线程、最近一次的结果与运行标志
+// 作用:
+//   start(run) 在工作线程上执行 run() 并保存其返回值；运行期间再次 start() 会被忽略。
+//   Result 是各模块的结果结构体 (valid 在完成之前为 false)。
+// ------------------------------------------------------------------------------------
+template <typename Result>
+class BackgroundBenchmark {
+public:
+    BackgroundBenchmark() : running(false) {}
+    ~BackgroundBenchmark() {
+        if (worker.joinable()) worker.join();
+    }
+    BackgroundBenchmark(const BackgroundBenchmark&) = delete;
+    BackgroundBenchmark& operator=(const BackgroundBenchmark&) = delete;
+
+    template <typename Run>
+    void start(Run run) {
+        if (running) return;
+        if (worker.joinable()) worker.join();
+        running = true;
+        worker = std::thread([this, run]() mutable {
+            Result r = run();
+            std::lock_guard<std::mutex> lock(resultMutex);
+            result = std::move(r);
+            running = false;
+        });
+    }
+
+    bool isRunning() const { return running; }
+
+    // The last completed run
+    Result getResult() {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        return result;
+    }
+
+private:
+    std::thread worker;
+    std::mutex resultMutex;
+    Result result;
+    std::atomic<bool> running;
+};
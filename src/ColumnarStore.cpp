@@ -0,0 +1,332 @@
+// ====================================================================================
+// 模块名称: ColumnarStore Implementation
+// 功能描述:
+//   列式文件的顺序写入 (带缓冲)、映射后的文件头与列边界校验，以及物化到 EpidemicData。
+// ====================================================================================
+
+#include "ColumnarStore.h"
+#include "Crc32.h"
+#include "ThreadPool.h"
+#include <algorithm> // For std::min
+#include <cstdio>    // For std::FILE, std::fwrite
+#include <cstring>   // For std::memcpy, std::memcmp
+
+namespace {
+
+const char kMagic[8] = { 'E', 'P', 'I', 'C', 'O', 'L', 'S', '\0' };
+
+uint64_t AlignUp(uint64_t value) {
+    return (value + 7) & ~static_cast<uint64_t>(7);
+}
+
+// Buffered sequential writer that tracks the file position for the column offsets
+class ColumnWriter {
+public:
+    explicit ColumnWriter(std::FILE* f, uint64_t checksumFrom)
+        : file(f), position(0), checksumStart(checksumFrom), checksum(0), failed(false) {
+        buffer.reserve(1 << 20);
+    }
+
+    void write(const void* data, size_t bytes) {
+        const char* p = static_cast<const char*>(data);
+        while (bytes > 0) {
+            size_t chunk = std::min(bytes, buffer.capacity() - buffer.size());
+            buffer.insert(buffer.end(), p, p + chunk);
+            p += chunk;
+            bytes -= chunk;
+            position += chunk;
+            if (buffer.size() == buffer.capacity()) flush();
+        }
+    }
+
+    template <typename T>
+    void put(T value) {
+        if (buffer.capacity() - buffer.size() < sizeof(T)) flush();
+        const char* p = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), p, p + sizeof(T));
+        position += sizeof(T);
+    }
+
+    void pad() {
+        static const char zeros[8] = { 0 };
+        write(zeros, static_cast<size_t>(AlignUp(position) - position));
+    }
+
+    bool flush() {
+        // Checksum while the bytes are still in cache; the placeholder header is excluded
+        const uint64_t bufferStart = position - buffer.size();
+        const size_t skip = static_cast<size_t>(std::min<uint64_t>(buffer.size(),
+            checksumStart > bufferStart ? checksumStart - bufferStart : 0));
+        checksum = Crc32(buffer.data() + skip, buffer.size() - skip, checksum);
+        if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+        buffer.clear();
+        return !failed;
+    }
+
+    uint64_t tell() const { return position; }
+    uint32_t getChecksum() const { return checksum; }
+
+private:
+    std::FILE* file;
+    std::vector<char> buffer;
+    uint64_t position;
+    uint64_t checksumStart;
+    uint32_t checksum;
+    bool failed;
+};
+
+} // namespace
+
+// [算法] 列式写入 (Columnar Write)
+// 逻辑:
+//   先写一个占位文件头，再逐列遍历快照中的所有地区顺序写出，每列开头对齐到8字节并记录偏移，
+//   同时累计文件头之后全部字节的 CRC；最后回到文件头写入真实的偏移表与校验和。
+//   写入临时文件并落盘后再替换目标文件。只读取快照，因此可以在后台线程运行。
+bool ColumnarStore::Write(const char* path, const DataSnapshot& snapshot, std::string* error,
+                          uint64_t journalSequence) {
+    std::string tempPath = std::string(path) + ".tmp";
+    std::FILE* f = std::fopen(tempPath.c_str(), "wb");
+    if (!f) {
+        if (error) *error = "无法创建文件: " + tempPath;
+        return false;
+    }
+
+    const auto& rows = snapshot.rows;
+    ColumnarHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = FormatVersion;
+    header.headerSize = sizeof(ColumnarHeader);
+    header.regionCount = rows.size();
+    header.recordCount = snapshot.recordCount;
+    header.journalSequence = journalSequence;
+
+    ColumnWriter out(f, sizeof(header));
+    out.write(&header, sizeof(header));
+
+    // --- Names ---
+    header.columnOffsets[Column_NameOffsets] = out.tell();
+    uint64_t nameCursor = 0;
+    out.put<uint64_t>(0);
+    for (const auto& r : rows) {
+        nameCursor += r.nameLength;
+        out.put<uint64_t>(nameCursor);
+    }
+    header.columnOffsets[Column_NameData] = out.tell();
+    out.write(snapshot.names.data(), snapshot.names.size());
+    out.pad();
+
+    // --- Current state, one column per field ---
+    header.columnOffsets[Column_Population] = out.tell();
+    for (const auto& r : rows) out.put<int32_t>(r.population);
+    out.pad();
+    header.columnOffsets[Column_Confirmed] = out.tell();
+    for (const auto& r : rows) out.put<int32_t>(r.confirmed);
+    out.pad();
+    header.columnOffsets[Column_Recovered] = out.tell();
+    for (const auto& r : rows) out.put<int32_t>(r.recovered);
+    out.pad();
+    header.columnOffsets[Column_Deaths] = out.tell();
+    for (const auto& r : rows) out.put<int32_t>(r.deaths);
+    out.pad();
+
+    // --- Histories ---
+    header.columnOffsets[Column_HistoryOffsets] = out.tell();
+    uint64_t recordCursor = 0;
+    out.put<uint64_t>(0);
+    for (const auto& r : rows) {
+        recordCursor += r.historyCount;
+        out.put<uint64_t>(recordCursor);
+    }
+    header.columnOffsets[Column_HistoryDay] = out.tell();
+    for (const auto& r : rows) for (size_t k = 0; k < r.historyCount; ++k) out.put<int32_t>(r.history[k].day);
+    out.pad();
+    header.columnOffsets[Column_HistoryConfirmed] = out.tell();
+    for (const auto& r : rows) for (size_t k = 0; k < r.historyCount; ++k) out.put<int32_t>(r.history[k].confirmed);
+    out.pad();
+    header.columnOffsets[Column_HistoryRecovered] = out.tell();
+    for (const auto& r : rows) for (size_t k = 0; k < r.historyCount; ++k) out.put<int32_t>(r.history[k].recovered);
+    out.pad();
+    header.columnOffsets[Column_HistoryDeaths] = out.tell();
+    for (const auto& r : rows) for (size_t k = 0; k < r.historyCount; ++k) out.put<int32_t>(r.history[k].deaths);
+    out.pad();
+
+    bool ok = out.flush();
+    header.checksum = out.getChecksum();
+    ok = ok && std::fseek(f, 0, SEEK_SET) == 0;
+    ok = ok && std::fwrite(&header, sizeof(header), 1, f) == 1;
+    ok = ok && SyncFile(f); // The replaced file must be on disk before anything relies on it
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) {
+        std::remove(tempPath.c_str());
+        if (error) *error = "写入文件失败: " + tempPath;
+        return false;
+    }
+
+    // Replace in one step so a crash never leaves the target missing
+    if (!MoveFileReplacing(tempPath.c_str(), path)) {
+        if (error) *error = std::string("无法替换文件: ") + path;
+        return false;
+    }
+    return true;
+}
+
+// [算法] 映射打开 (Zero-parse Open)
+// 逻辑:
+//   只检查文件头: 魔数、版本、每一列的范围都落在文件内并且8字节对齐，
+//   以及两个偏移列首尾值与行数一致。数据本身不做任何读取或转换。
+bool ColumnarStore::open(const char* path, std::string* error) {
+    close();
+    if (!file.open(path, error)) return false;
+
+    auto fail = [&](const char* message) {
+        if (error) *error = message;
+        close();
+        return false;
+    };
+
+    const size_t size = file.getSize();
+    const unsigned char* base = file.getData();
+    if (size < sizeof(ColumnarHeader)) return fail("文件过小，不是有效的列式数据文件");
+
+    const ColumnarHeader* h = reinterpret_cast<const ColumnarHeader*>(base);
+    if (std::memcmp(h->magic, kMagic, sizeof(kMagic)) != 0) return fail("文件标识不匹配");
+    if (h->version != FormatVersion || h->headerSize != sizeof(ColumnarHeader)) return fail("不支持的文件版本");
+
+    const uint64_t R = h->regionCount;
+    const uint64_t H = h->recordCount;
+    if (R > size || H > size) return fail("文件头中的行数无效");
+
+    auto columnFits = [&](ColumnId column, uint64_t bytes) {
+        uint64_t offset = h->columnOffsets[column];
+        return offset % 8 == 0 && offset >= sizeof(ColumnarHeader) && offset <= size && bytes <= size - offset;
+    };
+    if (!columnFits(Column_NameOffsets, (R + 1) * 8) || !columnFits(Column_HistoryOffsets, (R + 1) * 8)) {
+        return fail("偏移列超出文件范围");
+    }
+
+    const uint64_t* names = reinterpret_cast<const uint64_t*>(base + h->columnOffsets[Column_NameOffsets]);
+    const uint64_t* records = reinterpret_cast<const uint64_t*>(base + h->columnOffsets[Column_HistoryOffsets]);
+    if (names[0] != 0 || records[0] != 0 || records[R] != H) return fail("偏移列与行数不一致");
+
+    bool columnsFit = columnFits(Column_NameData, names[R]);
+    for (int c = Column_Population; c <= Column_Deaths; ++c) columnsFit = columnsFit && columnFits(static_cast<ColumnId>(c), R * 4);
+    for (int c = Column_HistoryDay; c <= Column_HistoryDeaths; ++c) columnsFit = columnsFit && columnFits(static_cast<ColumnId>(c), H * 4);
+    if (!columnsFit) return fail("数据列超出文件范围");
+
+    auto column32 = [&](ColumnId column) {
+        return reinterpret_cast<const int32_t*>(base + h->columnOffsets[column]);
+    };
+    header = h;
+    nameOffsets = names;
+    nameData = reinterpret_cast<const char*>(base + h->columnOffsets[Column_NameData]);
+    population = column32(Column_Population);
+    confirmed = column32(Column_Confirmed);
+    recovered = column32(Column_Recovered);
+    deaths = column32(Column_Deaths);
+    historyOffsets = records;
+    historyDay = column32(Column_HistoryDay);
+    historyConfirmed = column32(Column_HistoryConfirmed);
+    historyRecovered = column32(Column_HistoryRecovered);
+    historyDeaths = column32(Column_HistoryDeaths);
+    return true;
+}
+
+// [算法] 并行校验 (Parallel CRC)
+// 逻辑:
+//   把数据部分切成 8 MB 的块在线程池上分别计算 CRC，再用 Crc32Combine 按顺序合并，
+//   结果与顺序计算整段完全相同。
+bool ColumnarStore::verify(std::string* error) const {
+    if (!header) {
+        if (error) *error = "文件未打开";
+        return false;
+    }
+    const unsigned char* data = file.getData() + sizeof(ColumnarHeader);
+    const size_t size = file.getSize() - sizeof(ColumnarHeader);
+    const size_t blockBytes = 8 << 20;
+    const size_t blocks = (size + blockBytes - 1) / blockBytes;
+
+    std::vector<uint32_t> crcs(blocks);
+    ThreadPool::instance().parallelFor(blocks, [&](size_t begin, size_t end, unsigned) {
+        for (size_t b = begin; b < end; ++b) {
+            size_t offset = b * blockBytes;
+            crcs[b] = Crc32(data + offset, std::min(blockBytes, size - offset));
+        }
+    });
+    uint32_t crc = 0;
+    for (size_t b = 0; b < blocks; ++b) {
+        crc = Crc32Combine(crc, crcs[b], std::min(blockBytes, size - b * blockBytes));
+    }
+    if (crc != header->checksum) {
+        if (error) *error = "校验和不匹配，文件已损坏";
+        return false;
+    }
+    return true;
+}
+
+void ColumnarStore::close() {
+    file.close();
+    header = nullptr;
+    nameOffsets = historyOffsets = nullptr;
+    nameData = nullptr;
+    population = confirmed = recovered = deaths = nullptr;
+    historyDay = historyConfirmed = historyRecovered = historyDeaths = nullptr;
+}
+
+size_t ColumnarStore::getRegionCount() const {
+    return header ? static_cast<size_t>(header->regionCount) : 0;
+}
+
+size_t ColumnarStore::getRecordCount() const {
+    return header ? static_cast<size_t>(header->recordCount) : 0;
+}
+
+// Offsets inside the file are only trusted as far as open() checked them: a corrupt
+// interior offset is clamped to the column instead of reading outside the mapping
+std::string_view ColumnarStore::getName(size_t index) const {
+    uint64_t end = std::min(nameOffsets[index + 1], nameOffsets[header->regionCount]);
+    uint64_t begin = std::min(nameOffsets[index], end);
+    return std::string_view(nameData + begin, static_cast<size_t>(end - begin));
+}
+
+HistoryColumns ColumnarStore::getHistory(size_t index) const {
+    uint64_t end = std::min(historyOffsets[index + 1], header->recordCount);
+    uint64_t begin = std::min(historyOffsets[index], end);
+    HistoryColumns view;
+    view.day = historyDay + begin;
+    view.confirmed = historyConfirmed + begin;
+    view.recovered = historyRecovered + begin;
+    view.deaths = historyDeaths + begin;
+    view.count = static_cast<size_t>(end - begin);
+    return view;
+}
+
+void ColumnarStore::materialize(EpidemicData& data) const {
+    const size_t count = getRegionCount();
+    data.beginBulkUpdate();
+    data.clearRegions();
+    data.reserveRegions(count);
+
+    char name[sizeof(Region::name)];
+    for (size_t i = 0; i < count; ++i) {
+        std::string_view n = getName(i);
+        size_t length = std::min(n.size(), sizeof(name) - 1);
+        std::memcpy(name, n.data(), length);
+        name[length] = '\0';
+        data.addRegion(name, population[i], confirmed[i], recovered[i], deaths[i]);
+    }
+
+    // The regions are new (no snapshot references them), so their histories can be filled directly
+    auto& regions = data.getRegions();
+    ThreadPool::instance().parallelFor(count, [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            HistoryColumns h = getHistory(i);
+            HistorySeries& history = regions[i].history;
+            history.resize(h.count);
+            for (size_t k = 0; k < h.count; ++k) {
+                history[k] = { h.day[k], h.confirmed[k], h.recovered[k], h.deaths[k] };
+            }
+        }
+    }, 256);
+    data.endBulkUpdate();
+}
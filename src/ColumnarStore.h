@@ -0,0 +1,127 @@
+// ====================================================================================
+// 模块名称: ColumnarStore (二进制列式数据文件)
+// 功能描述:
+//   把全部 Region 及其 HistoricalRecord 以"每个字段一列"的二进制格式持久化。
+//   打开文件时只做内存映射和文件头校验，不解析任何数据，10万地区 x 3年日数据
+//   也能在毫秒级打开；需要编辑时再显式 materialize() 到 EpidemicData。
+//
+//   文件布局 (小端序，每列按8字节对齐):
+//     [ColumnarHeader]
+//     nameOffsets     uint64 x (R+1)   名称在 nameData 中的起止位置
+//     nameData        char   x nameOffsets[R]
+//     population / confirmed / recovered / deaths      int32 x R
+//     historyOffsets  uint64 x (R+1)   地区 i 的记录位于 [historyOffsets[i], historyOffsets[i+1])
+//     day / histConfirmed / histRecovered / histDeaths int32 x H
+//   文件头之后的全部字节由 CRC-32 校验 (checksum)，载入前可用 verify() 并行校验。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [枚举] ColumnId
+// 描述: 文件中各列的编号，也是 ColumnarHeader::columnOffsets 的下标
+// ------------------------------------------------------------------------------------
+enum ColumnId {
+    Column_NameOffsets,
+    Column_NameData,
+    Column_Population,
+    Column_Confirmed,
+    Column_Recovered,
+    Column_Deaths,
+    Column_HistoryOffsets,
+    Column_HistoryDay,
+    Column_HistoryConfirmed,
+    Column_HistoryRecovered,
+    Column_HistoryDeaths,
+    Column_Count
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] ColumnarHeader
+// 描述: 文件头，固定136字节，记录行数、每一列相对文件起始处的字节偏移以及数据校验和
+// ------------------------------------------------------------------------------------
+struct ColumnarHeader {
+    char magic[8];                        // "EPICOLS\0"
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t regionCount;
+    uint64_t recordCount;
+    uint64_t columnOffsets[Column_Count];
+    uint64_t journalSequence;             // Last edit-journal LSN already contained in this file
+    uint32_t checksum;                    // CRC-32 of every byte after the header
+    uint32_t reserved;
+};
+static_assert(sizeof(ColumnarHeader) == 136, "ColumnarHeader must stay 136 bytes");
+
+// ------------------------------------------------------------------------------------
+// [结构体] HistoryColumns
+// 描述: 某个地区历史记录的零拷贝视图 (直接指向映射内存)
+// ------------------------------------------------------------------------------------
+struct HistoryColumns {
+    const int32_t* day = nullptr;
+    const int32_t* confirmed = nullptr;
+    const int32_t* recovered = nullptr;
+    const int32_t* deaths = nullptr;
+    size_t count = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [类] ColumnarStore
+// 描述: 列式数据文件的写入器与只读映射视图
+// 作用:
+//   Write() 把一份数据快照写成列式文件(先写临时文件再替换，避免写一半的文件)，
+//   可以在后台线程调用；
+//   open() 映射文件并校验文件头，之后各 get* 函数直接读取映射内存；
+//   verify() 校验数据部分的 CRC (open 本身不读数据，保持毫秒级)；
+//   materialize() 把全部数据复制进 EpidemicData，替换其中现有的地区。
+// ------------------------------------------------------------------------------------
+class ColumnarStore {
+public:
+    static const uint32_t FormatVersion = 2;
+
+    static bool Write(const char* path, const DataSnapshot& snapshot, std::string* error = nullptr,
+                      uint64_t journalSequence = 0);
+
+    bool open(const char* path, std::string* error = nullptr);
+    bool verify(std::string* error = nullptr) const;
+    void close();
+    bool isOpen() const { return header != nullptr; }
+
+    size_t getRegionCount() const;
+    size_t getRecordCount() const;
+    size_t getFileSize() const { return file.getSize(); }
+    uint64_t getJournalSequence() const { return header ? header->journalSequence : 0; }
+
+    // Per-region accessors into the mapped columns (index must be < getRegionCount())
+    std::string_view getName(size_t index) const;
+    int getPopulation(size_t index) const { return population[index]; }
+    int getConfirmed(size_t index) const { return confirmed[index]; }
+    int getRecovered(size_t index) const { return recovered[index]; }
+    int getDeaths(size_t index) const { return deaths[index]; }
+    HistoryColumns getHistory(size_t index) const;
+
+    // Copies everything into the data model, replacing its regions (histories are filled in parallel)
+    void materialize(EpidemicData& data) const;
+
+private:
+    MappedFile file;
+    const ColumnarHeader* header = nullptr;
+    const uint64_t* nameOffsets = nullptr;
+    const char* nameData = nullptr;
+    const int32_t* population = nullptr;
+    const int32_t* confirmed = nullptr;
+    const int32_t* recovered = nullptr;
+    const int32_t* deaths = nullptr;
+    const uint64_t* historyOffsets = nullptr;
+    const int32_t* historyDay = nullptr;
+    const int32_t* historyConfirmed = nullptr;
+    const int32_t* historyRecovered = nullptr;
+    const int32_t* historyDeaths = nullptr;
+};
@@ -0,0 +1,110 @@
+// ====================================================================================
+// 模块名称: Convolution Implementation
+// 功能描述:
+//   实现直接卷积、迭代式基2 FFT (预计算旋转因子) 以及两者之间的自动选择。
+// ====================================================================================
+
+#include "Convolution.h"
+#include <algorithm> // For std::fill, std::swap
+#include <cmath>     // For std::cos, std::sin
+
+namespace {
+
+size_t NextPowerOfTwo(size_t n) {
+    size_t m = 1;
+    while (m < n) m <<= 1;
+    return m;
+}
+
+const double kPi = 3.14159265358979323846;
+
+} // namespace
+
+bool Convolver::PreferFFT(size_t n, size_t k) {
+    if (n == 0 || k == 0) return false;
+    size_t m = NextPowerOfTwo(n + k - 1);
+    size_t logM = 0;
+    while ((static_cast<size_t>(1) << logM) < m) ++logM;
+    // Three transforms of ~5 flops per butterfly versus one multiply-add per direct term
+    return static_cast<double>(n) * static_cast<double>(k) > 15.0 * static_cast<double>(m) * logM;
+}
+
+void Convolver::ConvolveDirect(const double* signal, size_t n, const double* kern, size_t k, double* out) {
+    std::fill(out, out + n + k - 1, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        const double s = signal[i];
+        if (s == 0.0) continue;
+        double* o = out + i;
+        for (size_t j = 0; j < k; ++j) {
+            o[j] += s * kern[j];
+        }
+    }
+}
+
+Convolver::Convolver(const std::vector<double>& kernelValues, size_t maxSignalLength)
+    : kernel(kernelValues), fftSize(0) {
+    if (kernel.empty() || !PreferFFT(maxSignalLength, kernel.size())) return;
+
+    fftSize = NextPowerOfTwo(maxSignalLength + kernel.size() - 1);
+    twiddles.resize(fftSize / 2);
+    for (size_t i = 0; i < fftSize / 2; ++i) {
+        double angle = -2.0 * kPi * static_cast<double>(i) / static_cast<double>(fftSize);
+        twiddles[i] = std::complex<double>(std::cos(angle), std::sin(angle));
+    }
+
+    kernelSpectrum.assign(fftSize, std::complex<double>(0.0, 0.0));
+    for (size_t j = 0; j < kernel.size(); ++j) {
+        kernelSpectrum[j] = kernel[j];
+    }
+    transform(kernelSpectrum.data(), false);
+}
+
+// [算法] 迭代式基2 FFT (Cooley-Tukey)
+// 逻辑: 先做位逆序置换，再自底向上逐层做蝶形运算；逆变换使用共轭旋转因子并在最后除以 M。
+void Convolver::transform(std::complex<double>* data, bool inverse) const {
+    const size_t m = fftSize;
+    for (size_t i = 1, j = 0; i < m; ++i) {
+        size_t bit = m >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(data[i], data[j]);
+    }
+    for (size_t len = 2; len <= m; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t step = m / len;
+        for (size_t start = 0; start < m; start += len) {
+            for (size_t k = 0; k < half; ++k) {
+                std::complex<double> w = twiddles[k * step];
+                if (inverse) w = std::conj(w);
+                std::complex<double> u = data[start + k];
+                std::complex<double> v = data[start + k + half] * w;
+                data[start + k] = u + v;
+                data[start + k + half] = u - v;
+            }
+        }
+    }
+    if (inverse) {
+        const double scale = 1.0 / static_cast<double>(m);
+        for (size_t i = 0; i < m; ++i) data[i] *= scale;
+    }
+}
+
+void Convolver::convolve(const double* signal, size_t n, double* out) const {
+    const size_t k = kernel.size();
+    if (n == 0 || k == 0) return;
+    if (fftSize == 0 || n + k - 1 > fftSize) {
+        ConvolveDirect(signal, n, kernel.data(), k, out);
+        return;
+    }
+
+    // Per-thread scratch, grown once and reused across a whole batch of regions
+    thread_local std::vector<std::complex<double>> buffer;
+    if (buffer.size() < fftSize) buffer.resize(fftSize);
+
+    for (size_t i = 0; i < n; ++i) buffer[i] = std::complex<double>(signal[i], 0.0);
+    std::fill(buffer.begin() + n, buffer.begin() + fftSize, std::complex<double>(0.0, 0.0));
+    transform(buffer.data(), false);
+    for (size_t i = 0; i < fftSize; ++i) buffer[i] *= kernelSpectrum[i];
+    transform(buffer.data(), true);
+    for (size_t i = 0; i < n + k - 1; ++i) out[i] = buffer[i].real();
+}
@@ -0,0 +1,43 @@
+// ====================================================================================
+// 模块名称: Convolution (离散卷积)
+// 功能描述:
+//   为更新方程预测与报告延迟反卷积提供一维线性卷积。
+//   根据信号与卷积核的长度自动在"直接求和"与"基2 FFT"之间切换，
+//   卷积核的频谱只计算一次，可供一批地区在多个线程上共享。
+// ====================================================================================
+
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [类] Convolver
+// 描述: 固定卷积核的卷积器
+// 作用:
+//   构造时按最长信号长度决定是否使用FFT，并预先计算旋转因子和卷积核频谱。
+//   convolve() 是只读操作，临时缓冲区为线程局部变量，可在线程池中并发调用。
+// ------------------------------------------------------------------------------------
+class Convolver {
+public:
+    Convolver(const std::vector<double>& kernel, size_t maxSignalLength);
+
+    // Full linear convolution: out must hold n + kernelLength - 1 values
+    void convolve(const double* signal, size_t n, double* out) const;
+
+    size_t getKernelLength() const { return kernel.size(); }
+    bool usesFFT() const { return fftSize != 0; }
+
+    // Cost model: direct is O(n * k), FFT is O(M log M) with M = next power of two >= n + k - 1
+    static bool PreferFFT(size_t n, size_t k);
+    static void ConvolveDirect(const double* signal, size_t n, const double* kernel, size_t k, double* out);
+
+private:
+    void transform(std::complex<double>* data, bool inverse) const;
+
+    std::vector<double> kernel;
+    size_t fftSize; // 0 when the direct method is used
+    std::vector<std::complex<double>> twiddles;
+    std::vector<std::complex<double>> kernelSpectrum;
+};
@@ -0,0 +1,107 @@
+// ====================================================================================
+// 模块名称: Crc32 Implementation
+// 功能描述:
+//   slicing-by-8 查表实现。8张256项的表在首次调用时生成 (函数内静态对象，线程安全)。
+// ====================================================================================
+
+#include "Crc32.h"
+#include <cstring> // For std::memcpy
+
+namespace {
+
+struct Crc32Tables {
+    uint32_t table[8][256];
+
+    Crc32Tables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : (c >> 1);
+            table[0][i] = c;
+        }
+        // table[s][i] is the CRC of byte i followed by s zero bytes
+        for (int s = 1; s < 8; ++s) {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = table[s - 1][i];
+                table[s][i] = (c >> 8) ^ table[0][c & 0xFF];
+            }
+        }
+    }
+};
+
+const Crc32Tables& Tables() {
+    static const Crc32Tables tables;
+    return tables;
+}
+
+} // namespace
+
+// [算法] Slicing-by-8
+// 逻辑:
+//   每轮把当前 crc 异或进接下来的4个字节，再用8张表分别查8个字节的贡献并合并，
+//   相比逐字节查表减少了循环内的依赖链。尾部不足8字节时逐字节处理 (按小端读取)。
+uint32_t Crc32(const void* data, size_t size, uint32_t crc) {
+    const uint32_t (*t)[256] = Tables().table;
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+
+    while (size >= 8) {
+        uint32_t lo, hi;
+        std::memcpy(&lo, p, 4);
+        std::memcpy(&hi, p + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        p += 8;
+        size -= 8;
+    }
+    while (size--) crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xFF];
+    return ~crc;
+}
+
+namespace {
+
+uint32_t Gf2MatrixTimes(const uint32_t* matrix, uint32_t vector) {
+    uint32_t sum = 0;
+    for (; vector; vector >>= 1, ++matrix) {
+        if (vector & 1) sum ^= *matrix;
+    }
+    return sum;
+}
+
+void Gf2MatrixSquare(uint32_t* square, const uint32_t* matrix) {
+    for (int n = 0; n < 32; ++n) square[n] = Gf2MatrixTimes(matrix, matrix[n]);
+}
+
+} // namespace
+
+// [算法] CRC 合并 (GF(2) 矩阵幂)
+// 逻辑:
+//   在 crc1 后面追加 length2 个零字节等价于把 crc1 乘以"追加一个零比特"算子的 8*length2 次幂，
+//   用反复平方只需 O(log length2) 次 32x32 矩阵运算；再异或 crc2 即为整体的 CRC。
+uint32_t Crc32Combine(uint32_t crc1, uint32_t crc2, size_t length2) {
+    if (length2 == 0) return crc1;
+    uint32_t even[32];
+    uint32_t odd[32];
+
+    // Operator for one zero bit
+    odd[0] = 0xEDB88320u;
+    uint32_t row = 1;
+    for (int n = 1; n < 32; ++n) {
+        odd[n] = row;
+        row <<= 1;
+    }
+    Gf2MatrixSquare(even, odd); // Two zero bits
+    Gf2MatrixSquare(odd, even); // Four zero bits
+
+    // Apply len2 zero bytes to crc1 (the first square gives the one-byte operator)
+    do {
+        Gf2MatrixSquare(even, odd);
+        if (length2 & 1) crc1 = Gf2MatrixTimes(even, crc1);
+        length2 >>= 1;
+        if (length2 == 0) break;
+        Gf2MatrixSquare(odd, even);
+        if (length2 & 1) crc1 = Gf2MatrixTimes(odd, crc1);
+        length2 >>= 1;
+    } while (length2 != 0);
+    return crc1 ^ crc2;
+}
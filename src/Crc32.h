@@ -0,0 +1,25 @@
+// ====================================================================================
+// 模块名称: Crc32 (CRC-32 校验)
+// 功能描述:
+//   标准 CRC-32 (IEEE 802.3, 反射多项式 0xEDB88320)，与 zlib/PNG/ZIP 的结果一致。
+//   使用 slicing-by-8 查表，每次处理8个字节，用于日志记录和数据文件的完整性校验。
+// ====================================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ------------------------------------------------------------------------------------
+// [函数] Crc32
+// 描述: 计算 data[0, size) 的 CRC-32
+// 作用: 传入上一段的结果作为 crc 即可分段累计 (Crc32(b, Crc32(a)) == Crc32(a+b))
+// ------------------------------------------------------------------------------------
+uint32_t Crc32(const void* data, size_t size, uint32_t crc = 0);
+
+// ------------------------------------------------------------------------------------
+// [函数] Crc32Combine
+// 描述: 由 crc1 = Crc32(A) 与 crc2 = Crc32(B) 以及 B 的长度得到 Crc32(A+B)
+// 作用: 大文件可以分块并行计算CRC，再按顺序合并 (与 zlib 的 crc32_combine 相同)。
+// ------------------------------------------------------------------------------------
+uint32_t Crc32Combine(uint32_t crc1, uint32_t crc2, size_t length2);
@@ -0,0 +1,711 @@
+// ====================================================================================
+// 模块名称: CsvImporter Implementation
+// 功能描述:
+//   表头识别、按行切块、块内逐字段 from_chars 解析、块结果合并，
+//   以及合并到 EpidemicData 和基准测试文件的生成。
+// ====================================================================================
+
+#include "CsvImporter.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>     // For std::sort, std::stable_sort, std::min
+#include <charconv>      // For std::from_chars, std::to_chars
+#include <chrono>
+#include <climits>       // For INT_MAX
+#include <cmath>         // For std::exp
+#include <cstdio>
+#include <cstring>       // For std::memchr
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+// Column roles shared by both layouts
+enum ColumnRole {
+    Role_None,
+    Role_Name,
+    Role_Population,
+    Role_Day,
+    Role_Date,
+    Role_Confirmed,
+    Role_Recovered,
+    Role_Deaths,
+    Role_Value // Wide layout: one day of the selected field
+};
+
+struct HeaderInfo {
+    CsvLayout layout = CsvLayout::Auto;
+    std::vector<ColumnRole> roles;
+    std::vector<int> columnDay;   // Wide layout: relative day of each column (-1 when not a date)
+    int wideColumns = 0;          // Wide layout: number of date columns
+    bool daysAscending = true;
+    bool usesDates = false;       // Long layout: absolute dates, rebased to day 0 after merging
+    int fields = 0;
+};
+
+struct ChunkOutput {
+    std::vector<ImportedRegion> groups; // Consecutive rows of one region form one group
+    size_t rows = 0;
+    size_t skipped = 0;
+    int minDay = INT_MAX;
+};
+
+// [算法] 公历日期 <-> 天数 (Howard Hinnant days_from_civil)
+int DaysFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+void CivilFromDays(int z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(yoe) + era * 400 + (m <= 2);
+}
+
+// Accepts "2020-01-22" and the JHU style "1/22/20" (two-digit years are 20xx)
+bool ParseDate(std::string_view text, int& days) {
+    int parts[3] = { 0, 0, 0 };
+    const char* p = text.data();
+    const char* end = p + text.size();
+    char separator = 0;
+    for (int i = 0; i < 3; ++i) {
+        auto r = std::from_chars(p, end, parts[i]);
+        if (r.ec != std::errc() || parts[i] < 0) return false;
+        p = r.ptr;
+        if (i < 2) {
+            if (p == end || (*p != '-' && *p != '/') || (separator && *p != separator)) return false;
+            separator = *p++;
+        }
+    }
+    if (p != end) return false;
+    int year, month, day;
+    if (separator == '-') { year = parts[0]; month = parts[1]; day = parts[2]; }
+    else { month = parts[0]; day = parts[1]; year = parts[2] < 100 ? 2000 + parts[2] : parts[2]; }
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+    days = DaysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+    return true;
+}
+
+// Reads one field; quoted fields are unescaped into scratch. Returns the start of the
+// next field, or lineEnd + 1 when this was the last field of the line.
+const char* ScanField(const char* p, const char* lineEnd, std::string_view& field, std::string& scratch) {
+    if (p >= lineEnd) {
+        field = std::string_view();
+        return lineEnd + 1;
+    }
+    if (*p == '"') {
+        scratch.clear();
+        ++p;
+        while (p < lineEnd) {
+            if (*p == '"') {
+                if (p + 1 < lineEnd && p[1] == '"') { scratch.push_back('"'); p += 2; continue; }
+                ++p;
+                break;
+            }
+            scratch.push_back(*p++);
+        }
+        field = scratch;
+        while (p < lineEnd && *p != ',') ++p;
+    } else {
+        const char* start = p;
+        const char* comma = static_cast<const char*>(std::memchr(p, ',', lineEnd - p));
+        p = comma ? comma : lineEnd;
+        const char* e = p;
+        if (e > start && e[-1] == '\r') --e;
+        field = std::string_view(start, e - start);
+    }
+    return p + 1;
+}
+
+// Integer field parsed in place; a fractional part ("12.0") is truncated
+const char* ScanInt(const char* p, const char* lineEnd, int& value, bool& present) {
+    if (p < lineEnd && *p == '"') {
+        std::string_view field;
+        std::string scratch;
+        const char* next = ScanField(p, lineEnd, field, scratch);
+        present = std::from_chars(field.data(), field.data() + field.size(), value).ec == std::errc();
+        return next;
+    }
+    auto r = std::from_chars(p, lineEnd, value);
+    present = r.ec == std::errc();
+    p = r.ptr;
+    if (p < lineEnd && *p != ',') {
+        const char* comma = static_cast<const char*>(std::memchr(p, ',', lineEnd - p));
+        p = comma ? comma : lineEnd;
+    }
+    return p + 1;
+}
+
+std::string Lowercase(std::string_view text) {
+    std::string s(text);
+    for (auto& c : s) if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\r')) s.pop_back();
+    while (!s.empty() && s.front() == ' ') s.erase(s.begin());
+    return s;
+}
+
+bool IsOneOf(const std::string& s, std::initializer_list<const char*> names) {
+    for (const char* n : names) if (s == n) return true;
+    return false;
+}
+
+bool AnalyzeHeader(std::string_view line, const CsvImportOptions& options, HeaderInfo& info, std::string& error) {
+    std::vector<std::string> cells;
+    std::vector<int> cellDates;
+    std::string scratch;
+    const char* p = line.data();
+    const char* end = p + line.size();
+    while (p <= end) {
+        std::string_view field;
+        p = ScanField(p, end, field, scratch);
+        cells.push_back(Lowercase(field));
+        int d = 0;
+        cellDates.push_back(ParseDate(cells.back(), d) ? d : INT_MIN);
+    }
+
+    int dateCells = 0;
+    for (int d : cellDates) if (d != INT_MIN) ++dateCells;
+    info.layout = options.layout;
+    if (info.layout == CsvLayout::Auto) info.layout = dateCells >= 2 ? CsvLayout::Wide : CsvLayout::Long;
+
+    info.roles.assign(cells.size(), Role_None);
+    info.columnDay.assign(cells.size(), -1);
+    bool hasName = false;
+
+    if (info.layout == CsvLayout::Wide) {
+        int firstDate = INT_MAX, lastDay = -1;
+        for (int d : cellDates) if (d != INT_MIN) firstDate = std::min(firstDate, d);
+        for (size_t c = 0; c < cells.size(); ++c) {
+            if (cellDates[c] == INT_MIN) continue;
+            info.roles[c] = Role_Value;
+            info.columnDay[c] = cellDates[c] - firstDate;
+            if (info.columnDay[c] <= lastDay) info.daysAscending = false;
+            lastDay = info.columnDay[c];
+            ++info.wideColumns;
+        }
+        if (info.wideColumns == 0) { error = "宽表中没有日期列"; return false; }
+
+        // Combined_Key already joins the place names; otherwise join them in column order
+        for (size_t c = 0; c < cells.size(); ++c) {
+            if (cells[c] == "combined_key") { info.roles[c] = Role_Name; hasName = true; }
+        }
+        for (size_t c = 0; c < cells.size() && !hasName; ++c) {
+            if (IsOneOf(cells[c], { "admin2", "province/state", "province_state", "country/region", "country_region" })) {
+                info.roles[c] = Role_Name;
+            }
+        }
+        for (size_t c = 0; c < cells.size(); ++c) {
+            if (info.roles[c] == Role_Name) hasName = true;
+            if (cells[c] == "population") info.roles[c] = Role_Population;
+        }
+        if (!hasName && info.roles[0] == Role_None) { info.roles[0] = Role_Name; hasName = true; }
+        info.fields = options.wideField;
+    } else {
+        for (size_t c = 0; c < cells.size(); ++c) {
+            const std::string& s = cells[c];
+            if (!hasName && IsOneOf(s, { "region", "name", "location", "city", "country", "combined_key",
+                                         "地区", "城市", "城市名称" })) {
+                info.roles[c] = Role_Name;
+                hasName = true;
+            }
+            else if (IsOneOf(s, { "day", "天数" })) info.roles[c] = Role_Day;
+            else if (IsOneOf(s, { "date", "日期" })) { info.roles[c] = Role_Date; info.usesDates = true; }
+            else if (IsOneOf(s, { "confirmed", "cases", "累计确诊" })) { info.roles[c] = Role_Confirmed; info.fields |= CsvField_Confirmed; }
+            else if (IsOneOf(s, { "recovered", "累计治愈" })) { info.roles[c] = Role_Recovered; info.fields |= CsvField_Recovered; }
+            else if (IsOneOf(s, { "deaths", "累计死亡" })) { info.roles[c] = Role_Deaths; info.fields |= CsvField_Deaths; }
+            else if (IsOneOf(s, { "population", "总人口" })) info.roles[c] = Role_Population;
+        }
+        bool hasDay = std::find(info.roles.begin(), info.roles.end(), Role_Day) != info.roles.end() || info.usesDates;
+        if (!hasName || !hasDay || info.fields == 0) {
+            error = "无法识别表头: 长表需要地区名、day/date 以及至少一个病例数列";
+            return false;
+        }
+        if (std::find(info.roles.begin(), info.roles.end(), Role_Day) != info.roles.end()) {
+            // An explicit day column wins over a date column
+            for (auto& r : info.roles) if (r == Role_Date) r = Role_None;
+            info.usesDates = false;
+        }
+    }
+    // Trailing columns beyond the header are ignored
+    while (!info.roles.empty() && info.roles.back() == Role_None) info.roles.pop_back();
+    return true;
+}
+
+void SetField(HistoricalRecord& rec, ColumnRole role, int value) {
+    switch (role) {
+        case Role_Confirmed: rec.confirmed = value; break;
+        case Role_Recovered: rec.recovered = value; break;
+        case Role_Deaths:    rec.deaths = value; break;
+        default: break;
+    }
+}
+
+ColumnRole WideRole(int field) {
+    if (field & CsvField_Recovered) return Role_Recovered;
+    if (field & CsvField_Deaths) return Role_Deaths;
+    return Role_Confirmed;
+}
+
+void ParseWideChunk(const char* begin, const char* end, const HeaderInfo& info, ChunkOutput& out) {
+    const ColumnRole valueRole = WideRole(info.fields);
+    const size_t columns = info.roles.size();
+    std::string scratch;
+    for (const char* line = begin; line < end;) {
+        const char* nl = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        const char* lineEnd = nl ? nl : end;
+        const char* p = line;
+        line = lineEnd + 1;
+        if (lineEnd == p || (lineEnd - p == 1 && *p == '\r')) continue;
+
+        ++out.rows;
+        out.groups.emplace_back();
+        ImportedRegion& region = out.groups.back();
+        // Sized for every date column up front and trimmed to the values actually present
+        region.history.resize(info.wideColumns);
+        HistoricalRecord* next = region.history.data();
+        for (size_t c = 0; c < columns && p <= lineEnd; ++c) {
+            const ColumnRole role = info.roles[c];
+            if (role == Role_Value) {
+                int value;
+                bool present;
+                p = ScanInt(p, lineEnd, value, present);
+                if (present) {
+                    *next = { info.columnDay[c], 0, 0, 0 };
+                    SetField(*next, valueRole, value);
+                    ++next;
+                }
+            } else if (role == Role_Population) {
+                bool present;
+                p = ScanInt(p, lineEnd, region.population, present);
+            } else {
+                std::string_view field;
+                p = ScanField(p, lineEnd, field, scratch);
+                if (role == Role_Name && !field.empty()) {
+                    if (!region.name.empty()) region.name += ", ";
+                    region.name.append(field.data(), field.size());
+                }
+            }
+        }
+        region.history.resize(next - region.history.data());
+        if (region.name.empty()) {
+            out.groups.pop_back();
+            ++out.skipped;
+            continue;
+        }
+        if (!info.daysAscending) {
+            std::stable_sort(region.history.begin(), region.history.end(),
+                             [](const HistoricalRecord& a, const HistoricalRecord& b) { return a.day < b.day; });
+        }
+    }
+}
+
+void ParseLongChunk(const char* begin, const char* end, const HeaderInfo& info, ChunkOutput& out) {
+    const size_t columns = info.roles.size();
+    std::string scratch;
+    for (const char* line = begin; line < end;) {
+        const char* nl = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        const char* lineEnd = nl ? nl : end;
+        const char* p = line;
+        line = lineEnd + 1;
+        if (lineEnd == p || (lineEnd - p == 1 && *p == '\r')) continue;
+
+        ++out.rows;
+        std::string_view name;
+        std::string nameCopy; // Quoted names live in scratch, which later fields may reuse
+        HistoricalRecord rec = { 0, 0, 0, 0 };
+        int population = 0;
+        bool hasDay = false, hasPopulation = false;
+        for (size_t c = 0; c < columns && p <= lineEnd; ++c) {
+            const ColumnRole role = info.roles[c];
+            if (role == Role_Name || role == Role_Date || role == Role_None) {
+                std::string_view field;
+                p = ScanField(p, lineEnd, field, scratch);
+                if (role == Role_Name) {
+                    if (!field.empty() && field.data() == scratch.data()) { nameCopy = scratch; field = nameCopy; }
+                    name = field;
+                } else if (role == Role_Date) {
+                    hasDay = ParseDate(field, rec.day);
+                }
+            } else {
+                int value;
+                bool present;
+                p = ScanInt(p, lineEnd, value, present);
+                if (!present) continue;
+                if (role == Role_Day) { rec.day = value; hasDay = true; }
+                else if (role == Role_Population) { population = value; hasPopulation = true; }
+                else SetField(rec, role, value);
+            }
+        }
+        if (name.empty() || !hasDay) {
+            ++out.skipped;
+            continue;
+        }
+        if (out.groups.empty() || out.groups.back().name != name) {
+            out.groups.emplace_back();
+            out.groups.back().name.assign(name.data(), name.size());
+        }
+        ImportedRegion& region = out.groups.back();
+        if (hasPopulation) region.population = population;
+        region.history.push_back(rec);
+        out.minDay = std::min(out.minDay, rec.day);
+    }
+}
+
+bool ByDay(const HistoricalRecord& a, const HistoricalRecord& b) { return a.day < b.day; }
+
+// Sorts by day and keeps the last record of each day (later rows override earlier ones)
+void NormalizeHistory(std::vector<HistoricalRecord>& history) {
+    if (!std::is_sorted(history.begin(), history.end(), ByDay)) {
+        std::stable_sort(history.begin(), history.end(), ByDay);
+    }
+    size_t out = 0;
+    for (size_t i = 0; i < history.size(); ++i) {
+        if (out > 0 && history[out - 1].day == history[i].day) history[out - 1] = history[i];
+        else history[out++] = history[i];
+    }
+    history.resize(out);
+}
+
+// Merges incoming records into target by day, overwriting only the fields in the mask
+void MergeHistory(HistorySeries& target, const std::vector<HistoricalRecord>& incoming, int fields) {
+    std::vector<HistoricalRecord> merged;
+    merged.reserve(target.size() + incoming.size());
+    size_t i = 0, j = 0;
+    while (i < target.size() || j < incoming.size()) {
+        if (j == incoming.size() || (i < target.size() && target[i].day < incoming[j].day)) {
+            merged.push_back(target[i++]);
+            continue;
+        }
+        // A day new to the target carries the other (cumulative) fields forward
+        HistoricalRecord rec = merged.empty() ? HistoricalRecord{ 0, 0, 0, 0 } : merged.back();
+        rec.day = incoming[j].day;
+        if (i < target.size() && target[i].day == incoming[j].day) rec = target[i++];
+        if (fields & CsvField_Confirmed) rec.confirmed = incoming[j].confirmed;
+        if (fields & CsvField_Recovered) rec.recovered = incoming[j].recovered;
+        if (fields & CsvField_Deaths) rec.deaths = incoming[j].deaths;
+        merged.push_back(rec);
+        ++j;
+    }
+    target.assign(merged);
+}
+
+} // namespace
+
+CsvImporter::CsvImporter()
+    : running(false), generating(false), cancelRequested(false), bytesDone(0), bytesTotal(0) {}
+
+CsvImporter::~CsvImporter() {
+    cancel();
+    if (worker.joinable()) worker.join();
+}
+
+CsvImportResult CsvImporter::Import(const char* path, const CsvImportOptions& options,
+                                    std::atomic<size_t>* bytesDoneOut, const std::atomic<bool>* cancelFlag) {
+    auto startTime = std::chrono::steady_clock::now();
+    MappedFile file;
+    CsvImportResult result;
+    if (!file.open(path, &result.error)) return result;
+    result = Parse(reinterpret_cast<const char*>(file.getData()), file.getSize(), options, bytesDoneOut, cancelFlag);
+    result.parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    result.megabytesPerSecond = result.parseSeconds > 0 ? result.bytes / 1e6 / result.parseSeconds : 0.0;
+    return result;
+}
+
+// [算法] 分块并行解析 (Chunked Parallel Parse)
+// 核心逻辑:
+//   1. 串行解析表头，确定布局以及每一列的角色。
+//   2. 以 chunkBytes 为步长切分正文，每个切点向后移到下一个换行符之后，保证块内都是整行。
+//   3. 线程池上每块独立解析: 宽表每行得到一个地区，长表把连续的同名行归为一组。
+//   4. 串行合并: 宽表直接拼接；长表按名称哈希合并各组，再按天排序去重，
+//      使用 date 列时把最早的日期平移为第0天。
+CsvImportResult CsvImporter::Parse(const char* data, size_t size, const CsvImportOptions& options,
+                                   std::atomic<size_t>* bytesDoneOut, const std::atomic<bool>* cancelFlag) {
+    auto startTime = std::chrono::steady_clock::now();
+    CsvImportResult result;
+    result.bytes = size;
+
+    const char* end = data + size;
+    const char* p = data;
+    if (size >= 3 && std::memcmp(p, "\xEF\xBB\xBF", 3) == 0) p += 3; // UTF-8 BOM
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    const char* headerEnd = nl ? nl : end;
+    HeaderInfo info;
+    if (p == headerEnd || !AnalyzeHeader(std::string_view(p, headerEnd - p), options, info, result.error)) {
+        if (result.error.empty()) result.error = "文件为空";
+        return result;
+    }
+    result.layout = info.layout;
+    result.fields = info.fields;
+    const char* body = nl ? nl + 1 : end;
+
+    // --- Split the body into line-aligned chunks ---
+    const size_t chunkBytes = std::max<size_t>(options.chunkBytes, 4096);
+    std::vector<const char*> bounds;
+    bounds.push_back(body);
+    for (const char* cut = body; end - cut > static_cast<ptrdiff_t>(chunkBytes);) {
+        cut += chunkBytes;
+        const char* next = static_cast<const char*>(std::memchr(cut, '\n', end - cut));
+        if (!next) break;
+        cut = next + 1;
+        bounds.push_back(cut);
+    }
+    if (bounds.back() != end) bounds.push_back(end);
+
+    // --- Parse chunks in parallel ---
+    const size_t chunkCount = bounds.size() - 1;
+    std::vector<ChunkOutput> chunks(chunkCount);
+    ThreadPool::instance().parallelFor(chunkCount, [&](size_t first, size_t last, unsigned) {
+        for (size_t c = first; c < last; ++c) {
+            if (cancelFlag && cancelFlag->load(std::memory_order_relaxed)) return;
+            if (info.layout == CsvLayout::Wide) ParseWideChunk(bounds[c], bounds[c + 1], info, chunks[c]);
+            else ParseLongChunk(bounds[c], bounds[c + 1], info, chunks[c]);
+            if (bytesDoneOut) bytesDoneOut->fetch_add(bounds[c + 1] - bounds[c], std::memory_order_relaxed);
+        }
+    }, 1);
+    if (cancelFlag && cancelFlag->load()) {
+        result.error = "已取消";
+        return result;
+    }
+
+    // --- Merge chunk outputs ---
+    if (info.layout == CsvLayout::Wide) {
+        size_t total = 0;
+        for (const auto& c : chunks) total += c.groups.size();
+        result.regions.reserve(total);
+        for (auto& c : chunks) {
+            for (auto& g : c.groups) result.regions.push_back(std::move(g));
+        }
+    } else {
+        std::unordered_map<std::string, size_t> indexByName;
+        for (auto& c : chunks) {
+            for (auto& g : c.groups) {
+                auto inserted = indexByName.emplace(g.name, result.regions.size());
+                if (inserted.second) {
+                    result.regions.push_back(std::move(g));
+                    continue;
+                }
+                ImportedRegion& region = result.regions[inserted.first->second];
+                if (g.population > 0) region.population = g.population;
+                region.history.insert(region.history.end(), g.history.begin(), g.history.end());
+            }
+        }
+        int minDay = INT_MAX;
+        for (const auto& c : chunks) minDay = std::min(minDay, c.minDay);
+        int shift = 0;
+        if (info.usesDates) {
+            // A fixed origin keeps day numbers stable across files (or appended parts of one file)
+            shift = options.dateOrigin != INT_MIN ? options.dateOrigin : (minDay != INT_MAX ? minDay : 0);
+            result.dateOrigin = shift;
+        }
+        ThreadPool::instance().parallelFor(result.regions.size(), [&](size_t first, size_t last, unsigned) {
+            for (size_t i = first; i < last; ++i) {
+                auto& history = result.regions[i].history;
+                if (shift != 0) for (auto& rec : history) rec.day -= shift;
+                NormalizeHistory(history);
+            }
+        }, 64);
+    }
+
+    for (const auto& c : chunks) {
+        result.rows += c.rows;
+        result.skippedRows += c.skipped;
+    }
+    for (const auto& r : result.regions) result.records += r.history.size();
+    result.valid = true;
+    result.parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    result.megabytesPerSecond = result.parseSeconds > 0 ? size / 1e6 / result.parseSeconds : 0.0;
+    return result;
+}
+
+void CsvImporter::CopyRegionName(const std::string& name, char* out, size_t capacity) {
+    size_t length = std::min(name.size(), capacity - 1);
+    if (length < name.size()) {
+        while (length > 0 && (static_cast<unsigned char>(name[length]) & 0xC0) == 0x80) --length;
+    }
+    std::memcpy(out, name.data(), length);
+    out[length] = '\0';
+}
+
+void CsvImporter::Apply(CsvImportResult& result, EpidemicData& data, bool replaceExisting) {
+    data.beginBulkUpdate();
+    if (replaceExisting) data.clearRegions();
+
+    std::unordered_map<std::string, size_t> existing;
+    auto& regions = data.getRegions();
+    existing.reserve(regions.size());
+    for (size_t i = 0; i < regions.size(); ++i) existing.emplace(regions[i].name, i);
+    data.reserveRegions(regions.size() + result.regions.size());
+
+    char name[sizeof(Region::name)];
+    for (auto& incoming : result.regions) {
+        CopyRegionName(incoming.name, name, sizeof(name));
+        auto it = existing.find(name);
+        if (it == existing.end()) {
+            HistoricalRecord last = incoming.history.empty() ? HistoricalRecord{ 0, 0, 0, 0 } : incoming.history.back();
+            data.addRegion(name, incoming.population, last.confirmed, last.recovered, last.deaths);
+            data.getRegions().back().history.assign(incoming.history);   // Copied into the region arena
+            existing.emplace(name, data.getRegions().size() - 1);
+            continue;
+        }
+        // Same name: merge the provided fields day by day and refresh the current state
+        const int index = static_cast<int>(it->second);
+        Region& region = data.getRegions()[index];
+        MergeHistory(data.getMutableHistory(index), incoming.history, result.fields);
+        if (incoming.population > 0) data.setRegionPopulation(index, incoming.population);
+        if (!region.history.empty()) {
+            const auto& last = region.history.back();
+            data.setRegionCounts(index, last.confirmed, last.recovered, last.deaths);
+        }
+        const int removed = region.getRecoveredCases() + region.getDeaths();
+        region.simulation.reset(region.getPopulation(), region.getConfirmedCases() - removed, removed);
+    }
+    result.regions.clear();
+    data.endBulkUpdate();
+}
+
+bool CsvImporter::WriteBenchmarkFile(const char* path, CsvLayout layout, size_t targetBytes, std::string* error) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (!f) {
+        if (error) *error = std::string("无法创建文件: ") + path;
+        return false;
+    }
+    const int days = 1095;
+    const int firstDay = DaysFromCivil(2020, 1, 22);
+    std::vector<char> buffer;
+    buffer.reserve(1 << 22);
+    size_t written = 0;
+    bool ok = true;
+    char number[16];
+    auto putText = [&](const char* s, size_t n) { buffer.insert(buffer.end(), s, s + n); };
+    auto putInt = [&](int v) {
+        auto r = std::to_chars(number, number + sizeof(number), v);
+        putText(number, r.ptr - number);
+    };
+    auto putDate = [&](int d, bool iso) {
+        int y; unsigned m, dd;
+        CivilFromDays(firstDay + d, y, m, dd);
+        if (iso) {
+            putInt(y); buffer.push_back('-');
+            if (m < 10) buffer.push_back('0');
+            putInt(static_cast<int>(m)); buffer.push_back('-');
+            if (dd < 10) buffer.push_back('0');
+            putInt(static_cast<int>(dd));
+        } else {
+            putInt(static_cast<int>(m)); buffer.push_back('/');
+            putInt(static_cast<int>(dd)); buffer.push_back('/');
+            putInt(y % 100);
+        }
+    };
+    auto flush = [&]() {
+        if (!buffer.empty() && std::fwrite(buffer.data(), 1, buffer.size(), f) != buffer.size()) ok = false;
+        written += buffer.size();
+        buffer.clear();
+    };
+
+    if (layout == CsvLayout::Long) putText("region,date,confirmed,recovered,deaths\n", 39);
+    else {
+        putText("Province/State,Country/Region,Lat,Long", 38);
+        for (int d = 0; d < days; ++d) { buffer.push_back(','); putDate(d, false); }
+        buffer.push_back('\n');
+    }
+
+    // Logistic cumulative curves with a per-region size and timing
+    unsigned seed = 12345;
+    for (int region = 0; ok && written + buffer.size() < targetBytes; ++region) {
+        seed = seed * 1664525u + 1013904223u;
+        const double size = 1000.0 + (seed >> 8) % 200000;
+        const double midpoint = 100.0 + (seed >> 4) % 800;
+        char name[48];
+        int nameLength = std::snprintf(name, sizeof(name), "Region %d", region);
+        if (layout == CsvLayout::Long) {
+            for (int d = 0; d < days; ++d) {
+                int confirmed = static_cast<int>(size / (1.0 + std::exp((midpoint - d) / 30.0)));
+                putText(name, nameLength); buffer.push_back(',');
+                putDate(d, true); buffer.push_back(',');
+                putInt(confirmed); buffer.push_back(',');
+                putInt(confirmed * 9 / 10); buffer.push_back(',');
+                putInt(confirmed / 50); buffer.push_back('\n');
+            }
+        } else {
+            putText(",", 1); putText(name, nameLength); putText(",0.0,0.0", 8);
+            for (int d = 0; d < days; ++d) {
+                buffer.push_back(',');
+                putInt(static_cast<int>(size / (1.0 + std::exp((midpoint - d) / 30.0))));
+            }
+            buffer.push_back('\n');
+        }
+        if (buffer.size() > (3u << 20)) flush();
+    }
+    flush();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok && error) *error = std::string("写入文件失败: ") + path;
+    return ok;
+}
+
+void CsvImporter::launch(const std::string& path, const CsvImportOptions& options, CsvLayout benchmarkLayout, size_t benchmarkBytes) {
+    if (running.load()) return;
+    if (worker.joinable()) worker.join();
+
+    cancelRequested = false;
+    bytesDone = 0;
+    bytesTotal = 0;
+    generating = benchmarkBytes > 0;
+    running = true;
+    worker = std::thread([this, path, options, benchmarkLayout, benchmarkBytes]() {
+        CsvImportResult r;
+        double generateSeconds = 0.0;
+        bool ready = true;
+        if (benchmarkBytes > 0) {
+            auto t0 = std::chrono::steady_clock::now();
+            ready = WriteBenchmarkFile(path.c_str(), benchmarkLayout, benchmarkBytes, &r.error);
+            generateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            generating = false;
+        }
+        if (ready && !cancelRequested.load()) {
+            MappedFile probe;
+            if (probe.open(path.c_str())) bytesTotal = probe.getSize();
+            probe.close();
+            r = Import(path.c_str(), options, &bytesDone, &cancelRequested);
+        }
+        r.generateSeconds = generateSeconds;
+        {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            result = std::move(r);
+        }
+        running = false;
+    });
+}
+
+void CsvImporter::start(const std::string& path, const CsvImportOptions& options) {
+    launch(path, options, CsvLayout::Auto, 0);
+}
+
+void CsvImporter::startBenchmark(const std::string& path, CsvLayout layout, size_t targetBytes, const CsvImportOptions& options) {
+    launch(path, options, layout, targetBytes);
+}
+
+void CsvImporter::cancel() { cancelRequested = true; }
+bool CsvImporter::isRunning() const { return running.load(); }
+bool CsvImporter::isGenerating() const { return generating.load(); }
+
+double CsvImporter::getProgress() const {
+    size_t total = bytesTotal.load();
+    return total > 0 ? static_cast<double>(bytesDone.load()) / total : 0.0;
+}
+
+CsvImportResult CsvImporter::takeResult() {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    CsvImportResult r = std::move(result);
+    result = CsvImportResult();
+    return r;
+}
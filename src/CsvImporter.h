@@ -0,0 +1,119 @@
+// ====================================================================================
+// 模块名称: CsvImporter (大规模CSV时间序列导入)
+// 功能描述:
+//   导入两种常见的病例时间序列CSV:
+//     宽表 (JHU CSSE 格式): 每行一个地区，每天一列，如
+//         Province/State,Country/Region,Lat,Long,1/22/20,1/23/20,...
+//     长表: 每行一个"地区-日期"，如 region,date,confirmed,recovered,deaths[,population]
+//   文件被内存映射后按换行切分为若干块，在线程池上用 std::from_chars 并行解析，
+//   最后一次性批量构建各地区的历史记录，而不是逐行调用 addRegion。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <atomic>
+#include <climits> // For INT_MIN
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [枚举] CsvLayout / CsvField
+// 描述: 文件布局 (Auto 根据表头自动判断) 以及文件提供了哪些字段 (位掩码)
+// ------------------------------------------------------------------------------------
+enum class CsvLayout { Auto, Wide, Long };
+
+enum CsvField {
+    CsvField_Confirmed = 1,
+    CsvField_Recovered = 2,
+    CsvField_Deaths = 4
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] CsvImportOptions
+// 描述: 导入设置
+// ------------------------------------------------------------------------------------
+struct CsvImportOptions {
+    CsvLayout layout = CsvLayout::Auto;
+    int wideField = CsvField_Confirmed;  // JHU publishes confirmed/recovered/deaths as separate wide files
+    size_t chunkBytes = 8 << 20;         // Bytes per parallel parse chunk
+    int dateOrigin = INT_MIN;            // Long layout with dates: absolute day mapped to day 0 (INT_MIN = earliest in file)
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] ImportedRegion / CsvImportResult
+// 描述: 解析结果。历史记录按天排序，天数从文件中最早的日期记为第0天。
+// ------------------------------------------------------------------------------------
+struct ImportedRegion {
+    std::string name;
+    int population = 0;
+    std::vector<HistoricalRecord> history;
+};
+
+struct CsvImportResult {
+    bool valid = false;
+    std::string error;
+    CsvLayout layout = CsvLayout::Auto;
+    int fields = 0;                 // CsvField mask of the columns the file provided
+    int dateOrigin = INT_MIN;       // Absolute day that became day 0 (long layout with a date column)
+    std::vector<ImportedRegion> regions;
+    size_t rows = 0;
+    size_t skippedRows = 0;         // Rows without a usable name or day
+    size_t records = 0;
+    size_t bytes = 0;
+    double parseSeconds = 0;        // Map + parallel parse + merge
+    double megabytesPerSecond = 0;
+    double generateSeconds = 0;     // Benchmark runs only: time spent writing the test file
+};
+
+// ------------------------------------------------------------------------------------
+// [类] CsvImporter
+// 描述: CSV导入器
+// 作用:
+//   Import() 同步解析整个文件 (可在任意线程调用)；
+//   Apply() 把结果合并进 EpidemicData: 同名地区按天合并所提供的字段，新地区批量追加；
+//   start()/startBenchmark() 在后台线程运行，UI 通过 getProgress()/takeResult() 轮询。
+// ------------------------------------------------------------------------------------
+class CsvImporter {
+public:
+    CsvImporter();
+    ~CsvImporter();
+
+    static CsvImportResult Import(const char* path, const CsvImportOptions& options,
+                                  std::atomic<size_t>* bytesDone = nullptr,
+                                  const std::atomic<bool>* cancelFlag = nullptr);
+    static CsvImportResult Parse(const char* data, size_t size, const CsvImportOptions& options,
+                                 std::atomic<size_t>* bytesDone = nullptr,
+                                 const std::atomic<bool>* cancelFlag = nullptr);
+
+    // replaceExisting drops all current regions first; otherwise regions are merged by name
+    static void Apply(CsvImportResult& result, EpidemicData& data, bool replaceExisting);
+    // Region::name holds 127 bytes; cuts at a UTF-8 character boundary
+    static void CopyRegionName(const std::string& name, char* out, size_t capacity);
+
+    // Synthetic file of roughly targetBytes (1095 days per region) for throughput measurements
+    static bool WriteBenchmarkFile(const char* path, CsvLayout layout, size_t targetBytes, std::string* error = nullptr);
+
+    // Background execution
+    void start(const std::string& path, const CsvImportOptions& options);
+    void startBenchmark(const std::string& path, CsvLayout layout, size_t targetBytes, const CsvImportOptions& options);
+    void cancel();
+    bool isRunning() const;
+    bool isGenerating() const;
+    double getProgress() const;   // Fraction of the file parsed so far
+    CsvImportResult takeResult(); // Moves the finished result out (histories can be large)
+
+private:
+    void launch(const std::string& path, const CsvImportOptions& options, CsvLayout benchmarkLayout, size_t benchmarkBytes);
+
+    std::thread worker;
+    std::mutex resultMutex;
+    CsvImportResult result;
+    std::atomic<bool> running;
+    std::atomic<bool> generating;
+    std::atomic<bool> cancelRequested;
+    std::atomic<size_t> bytesDone;
+    std::atomic<size_t> bytesTotal;
+};
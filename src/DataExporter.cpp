@@ -0,0 +1,328 @@
+// ====================================================================================
+// 模块名称: DataExporter Implementation
+// 功能描述:
+//   平铺快照的采集，以及基于 std::to_chars 的缓冲式 CSV 写出。
+// ====================================================================================
+
+#include "DataExporter.h"
+#include <algorithm> // For std::min
+#include <charconv>  // For std::to_chars
+#include <chrono>
+#include <cmath>     // For std::fabs, std::llround
+#include <cstdio>    // For std::FILE, std::fwrite
+#include <cstring>   // For std::memcpy, strnlen
+#include <memory>    // For std::unique_ptr
+
+namespace {
+
+// Formats into a large in-memory buffer and flushes it to the file in big writes
+class CsvWriter {
+public:
+    CsvWriter(std::FILE* f, size_t capacity) : file(f), failed(false), written(0), lines(0) {
+        buffer.resize(capacity);
+        cursor = buffer.data();
+        limit = buffer.data() + capacity - 512; // Room for one full line
+    }
+
+    void text(const char* s, size_t n) {
+        if (cursor + n > limit) flush();
+        if (n > static_cast<size_t>(limit - cursor)) { // Longer than the whole buffer
+            write(s, n);
+            return;
+        }
+        std::memcpy(cursor, s, n);
+        cursor += n;
+    }
+    void text(const char* s) { text(s, std::strlen(s)); }
+
+    // CSV quoting only when the name needs it
+    void name(const char* s) {
+        size_t n = strnlen(s, 128);
+        bool quote = false;
+        for (size_t i = 0; i < n && !quote; ++i) quote = s[i] == ',' || s[i] == '"' || s[i] == '\n';
+        if (!quote) { text(s, n); return; }
+        put('"');
+        for (size_t i = 0; i < n; ++i) {
+            if (s[i] == '"') put('"');
+            put(s[i]);
+        }
+        put('"');
+    }
+
+    void put(char c) {
+        if (cursor >= limit) flush();
+        *cursor++ = c;
+    }
+    void comma() { put(','); }
+    void endLine() { put('\n'); ++lines; }
+
+    void integer(long long v) {
+        if (cursor + 24 > limit) flush();
+        cursor = std::to_chars(cursor, limit, v).ptr;
+    }
+    // One decimal place; integer arithmetic is several times faster than floating to_chars
+    void tenths(double v) {
+        if (!(std::fabs(v) < 1e15)) {
+            if (cursor + 64 > limit) flush();
+            // The slack past limit (512 bytes) fits any fixed-format double
+            auto r = std::to_chars(cursor, buffer.data() + buffer.size(), v, std::chars_format::fixed, 1);
+            if (r.ec == std::errc()) cursor = r.ptr;
+            return;
+        }
+        long long t = std::llround(v * 10.0);
+        if (t < 0) { put('-'); t = -t; }
+        integer(t / 10);
+        put('.');
+        put(static_cast<char>('0' + t % 10));
+    }
+
+    bool flush() {
+        write(buffer.data(), cursor - buffer.data());
+        cursor = buffer.data();
+        return !failed;
+    }
+
+    size_t getWritten() const { return written; }
+    size_t getLines() const { return lines; }
+
+private:
+    void write(const char* data, size_t n) {
+        if (n > 0 && std::fwrite(data, 1, n, file) != n) failed = true;
+        written += n;
+    }
+
+    std::FILE* file;
+    std::vector<char> buffer;
+    char* cursor;
+    char* limit;
+    bool failed;
+    size_t written;
+    size_t lines;
+};
+
+enum Table { Table_Summary, Table_History, Table_Trajectory, Table_Count };
+
+const char* kTableSuffix[Table_Count] = { "_summary.csv", "_history.csv", "_trajectory.csv" };
+const char* kTableHeader[Table_Count] = {
+    "城市名称,总人口,累计确诊,累计治愈,累计死亡,活跃病例,风险等级\n",
+    "城市名称,天数,累计确诊,累计治愈,累计死亡\n",
+    "城市名称,天数,易感者S,感染者I,移出者R\n"
+};
+
+void WriteSlice(Table table, const ExportSlice& s, CsvWriter& out) {
+    for (size_t i = 0; i < s.rows.size(); ++i) {
+        const ExportSlice::Row& row = s.rows[i];
+        if (table == Table_Summary) {
+            out.name(row.name); out.comma();
+            out.integer(row.population); out.comma();
+            out.integer(row.confirmed); out.comma();
+            out.integer(row.recovered); out.comma();
+            out.integer(row.deaths); out.comma();
+            out.integer(static_cast<long long>(row.confirmed) - row.recovered - row.deaths); out.comma();
+            out.text(EpidemicData::getRiskLevelString(row.risk));
+            out.endLine();
+        } else if (table == Table_History) {
+            for (uint32_t k = s.historyOffsets[i]; k < s.historyOffsets[i + 1]; ++k) {
+                const HistoricalRecord& h = s.history[k];
+                out.name(row.name); out.comma();
+                out.integer(h.day); out.comma();
+                out.integer(h.confirmed); out.comma();
+                out.integer(h.recovered); out.comma();
+                out.integer(h.deaths);
+                out.endLine();
+            }
+        } else {
+            for (uint32_t k = s.trajectoryOffsets[i]; k < s.trajectoryOffsets[i + 1]; ++k) {
+                const SIRDataPoint& p = s.trajectories[k];
+                out.name(row.name); out.comma();
+                out.integer(p.day); out.comma();
+                out.tenths(p.susceptible); out.comma();
+                out.tenths(p.infected); out.comma();
+                out.tenths(p.recovered);
+                out.endLine();
+            }
+        }
+    }
+}
+
+// Slices waiting for the writer; pump() stops copying while the queue is this deep
+const size_t kMaxQueuedSlices = 8;
+
+} // namespace
+
+DataExporter::DataExporter()
+    : captureFinished(true), regionTotal(0), regionsCaptured(0),
+      lastSliceRows(0), lastSliceRecords(0), lastSlicePoints(0),
+      running(false), cancelRequested(false), regionsWritten(0) {}
+
+DataExporter::~DataExporter() {
+    cancel();
+    if (worker.joinable()) worker.join();
+}
+
+void DataExporter::CaptureRegion(const Region& r, const ExportOptions& opts, ExportSlice& slice) {
+    if (slice.historyOffsets.empty()) slice.historyOffsets.push_back(0);
+    if (slice.trajectoryOffsets.empty()) slice.trajectoryOffsets.push_back(0);
+    slice.rows.emplace_back();
+    ExportSlice::Row& row = slice.rows.back();
+    std::memcpy(row.name, r.name, sizeof(row.name));
+    row.name[sizeof(row.name) - 1] = '\0';
+    row.population = r.getPopulation();
+    row.confirmed = r.getConfirmedCases();
+    row.recovered = r.getRecoveredCases();
+    row.deaths = r.getDeaths();
+    row.risk = EpidemicData::calculateRiskLevel(r);
+    if (opts.history) {
+        slice.history.insert(slice.history.end(), r.history.begin(), r.history.end());
+    }
+    if (opts.trajectories) {
+        const auto& points = r.simulation.getHistory();
+        slice.trajectories.insert(slice.trajectories.end(), points.begin(), points.end());
+    }
+    slice.historyOffsets.push_back(static_cast<uint32_t>(slice.history.size()));
+    slice.trajectoryOffsets.push_back(static_cast<uint32_t>(slice.trajectories.size()));
+}
+
+void DataExporter::start(EpidemicData& data, const ExportOptions& exportOptions) {
+    if (running.load()) return;
+    if (worker.joinable()) worker.join();
+
+    options = exportOptions;
+    const size_t regionCount = data.getRegions().size();
+    handles.resize(regionCount);
+    for (size_t i = 0; i < regionCount; ++i) handles[i] = data.getHandle(static_cast<int>(i));
+    regionTotal = regionCount;
+    regionsCaptured = 0;
+    lastSliceRows = lastSliceRecords = lastSlicePoints = 0;
+    queue.clear();
+    captureFinished = (regionCount == 0);
+    cancelRequested = false;
+    regionsWritten = 0;
+    running = true;
+    worker = std::thread(&DataExporter::writerLoop, this);
+}
+
+// [算法] 分帧拷贝 (Time-budgeted Capture)
+// 逻辑:
+//   以16个地区为一批拷贝，每批之后检查耗时，超过预算即停止，剩余部分留到下一帧。
+//   地区按开始时记下的句柄解析，其间删除的地区解析失败而被跳过，其余地区不受下标移动影响。
+void DataExporter::pump(EpidemicData& data, double budgetMs) {
+    if (!running.load() || regionsCaptured >= regionTotal) return;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (captureFinished || queue.size() >= kMaxQueuedSlices) return;
+    }
+
+    const std::vector<Region>& regions = data.getRegions();
+    auto startTime = std::chrono::steady_clock::now();
+    // Sized like the previous slice so the vectors rarely reallocate mid-frame
+    ExportSlice slice;
+    slice.rows.reserve(lastSliceRows);
+    slice.history.reserve(lastSliceRecords);
+    slice.trajectories.reserve(lastSlicePoints);
+    slice.historyOffsets.reserve(lastSliceRows + 1);
+    slice.trajectoryOffsets.reserve(lastSliceRows + 1);
+    const size_t begin = regionsCaptured;
+    while (regionsCaptured < regionTotal) {
+        const size_t end = std::min(regionTotal, regionsCaptured + 16);
+        for (; regionsCaptured < end; ++regionsCaptured) {
+            const int index = data.resolve(handles[regionsCaptured]);
+            if (index >= 0) CaptureRegion(regions[index], options, slice);
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        if (elapsed >= budgetMs) break;
+    }
+
+    lastSliceRows = slice.rows.size();
+    lastSliceRecords = slice.history.size();
+    lastSlicePoints = slice.trajectories.size();
+
+    slice.covered = regionsCaptured - begin;
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (slice.covered > 0) queue.push_back(std::move(slice));
+    if (regionsCaptured >= regionTotal) captureFinished = true;
+    queueCondition.notify_one();
+}
+
+void DataExporter::writerLoop() {
+    auto startTime = std::chrono::steady_clock::now();
+    ExportResult r;
+
+    const bool enabled[Table_Count] = { options.summary, options.history, options.trajectories };
+    std::string paths[Table_Count];
+    std::FILE* files[Table_Count] = { nullptr, nullptr, nullptr };
+    std::unique_ptr<CsvWriter> writers[Table_Count];
+    bool ok = true;
+    for (int t = 0; t < Table_Count && ok; ++t) {
+        if (!enabled[t]) continue;
+        paths[t] = options.pathPrefix + kTableSuffix[t];
+        files[t] = std::fopen(paths[t].c_str(), "wb");
+        if (!files[t]) {
+            r.error = "无法创建文件: " + paths[t];
+            ok = false;
+            break;
+        }
+        writers[t].reset(new CsvWriter(files[t], 4 << 20));
+        writers[t]->text("\xEF\xBB\xBF"); // UTF-8 BOM for Excel
+        writers[t]->text(kTableHeader[t]);
+        r.files.push_back(paths[t]);
+    }
+
+    while (ok) {
+        ExportSlice slice;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCondition.wait(lock, [this]() { return !queue.empty() || captureFinished || cancelRequested.load(); });
+            if (cancelRequested.load()) { r.error = "已取消"; ok = false; break; }
+            if (queue.empty()) break; // Capture finished and everything is written
+            slice = std::move(queue.front());
+            queue.pop_front();
+        }
+        for (int t = 0; t < Table_Count; ++t) {
+            if (writers[t]) WriteSlice(static_cast<Table>(t), slice, *writers[t]);
+        }
+        regionsWritten.fetch_add(slice.covered);
+    }
+
+    for (int t = 0; t < Table_Count; ++t) {
+        if (!writers[t]) continue;
+        bool written = writers[t]->flush();
+        written = (std::fclose(files[t]) == 0) && written;
+        r.bytes += writers[t]->getWritten();
+        r.lines += writers[t]->getLines();
+        if (!written && ok) {
+            r.error = "写入文件失败: " + paths[t];
+            ok = false;
+        }
+    }
+    r.valid = ok;
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    r.megabytesPerSecond = r.seconds > 0 ? r.bytes / 1e6 / r.seconds : 0.0;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        result = std::move(r);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.clear();
+        captureFinished = true;
+    }
+    running = false;
+}
+
+void DataExporter::cancel() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    cancelRequested = true;
+    queueCondition.notify_one();
+}
+
+bool DataExporter::isRunning() const { return running.load(); }
+
+double DataExporter::getProgress() const {
+    return regionTotal > 0 ? static_cast<double>(regionsWritten.load()) / regionTotal : 0.0;
+}
+
+ExportResult DataExporter::getResult() {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    return result;
+}
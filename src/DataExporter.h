@@ -0,0 +1,113 @@
+// ====================================================================================
+// 模块名称: DataExporter (异步数据导出)
+// 功能描述:
+//   把城市汇总表、完整历史记录 (Region::history) 以及 SIR 模拟轨迹导出为 CSV。
+//   UI线程每帧只在很小的时间预算内把一批地区平铺拷贝为 ExportSlice (不做任何格式化)，
+//   后台写出线程用 std::to_chars 把切片格式化到大缓冲区再整块写入文件，
+//   因此即使十万个地区连同全部历史一起导出，单帧耗时也不会明显增加。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] ExportOptions
+// 描述: 导出哪些表以及输出文件名前缀 (每张表一个文件: 前缀 + _summary/_history/_trajectory.csv)
+// ------------------------------------------------------------------------------------
+struct ExportOptions {
+    bool summary = true;
+    bool history = false;
+    bool trajectories = false;
+    std::string pathPrefix = "epidemic_data";
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] ExportSlice
+// 描述: 一批地区的平铺拷贝，写出线程只读它而不触碰 EpidemicData
+// ------------------------------------------------------------------------------------
+struct ExportSlice {
+    struct Row {
+        char name[128];
+        int population;
+        int confirmed;
+        int recovered;
+        int deaths;
+        RiskLevel risk;
+    };
+    std::vector<Row> rows;
+    std::vector<uint32_t> historyOffsets;     // Records of row i: [historyOffsets[i], historyOffsets[i+1])
+    std::vector<HistoricalRecord> history;
+    std::vector<uint32_t> trajectoryOffsets;
+    std::vector<SIRDataPoint> trajectories;
+    size_t covered = 0;                       // Export positions this slice accounts for (deleted regions have no row)
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] ExportResult
+// ------------------------------------------------------------------------------------
+struct ExportResult {
+    bool valid = false;
+    std::string error;
+    std::vector<std::string> files;
+    size_t bytes = 0;
+    size_t lines = 0;
+    double seconds = 0;             // Wall time from start() until the last file was closed
+    double megabytesPerSecond = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [类] DataExporter
+// 描述: 后台CSV导出器
+// 作用:
+//   start() 打开输出文件并启动写出线程；之后UI线程每帧调用 pump()，在时间预算内
+//   按顺序拷贝下一批地区交给写出线程 (队列有上限，写出跟不上时 pump 暂停拷贝)。
+//   start() 记下当时每个地区的句柄，pump() 按句柄取地区: 导出期间的增删不会使地区错位或漏掉，
+//   开始之后删除的地区不再写出，新增的地区不在本次导出之内。每个地区在被拷贝的那一帧整体取值。
+// ------------------------------------------------------------------------------------
+class DataExporter {
+public:
+    DataExporter();
+    ~DataExporter();
+
+    void start(EpidemicData& data, const ExportOptions& options);
+    void pump(EpidemicData& data, double budgetMs = 2.0);
+    void cancel();
+    bool isRunning() const;
+    double getProgress() const;
+    ExportResult getResult();
+
+    // Appends one region to a slice
+    static void CaptureRegion(const Region& region, const ExportOptions& options, ExportSlice& slice);
+
+private:
+    void writerLoop();
+
+    std::thread worker;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<ExportSlice> queue;
+    bool captureFinished;
+
+    ExportOptions options;
+    std::vector<RegionHandle> handles; // The regions in table order when the export started
+    size_t regionTotal;
+    size_t regionsCaptured;          // UI thread only; positions in handles
+    size_t lastSliceRows;            // Previous slice sizes, used to reserve the next one
+    size_t lastSliceRecords;
+    size_t lastSlicePoints;
+
+    std::mutex resultMutex;
+    ExportResult result;
+    std::atomic<bool> running;
+    std::atomic<bool> cancelRequested;
+    std::atomic<size_t> regionsWritten;
+};
@@ -7,16 +7,24 @@
 
 #include "DataModel.h"
 #include "imgui.h" // For ImVec4
-#include <cstring>  // For strncpy
-#include <algorithm> // For std::max
+#include <cstring>  // For strncpy, strnlen, strrchr, std::memcpy
+#include <type_traits> // For std::is_nothrow_move_constructible
+#include <atomic>    // For std::atomic_thread_fence
+#include <algorithm> // For std::max, std::min, std::lower_bound
+#include <climits>   // For INT_MAX
+#include <cassert>   // For the debug totals check
+#include "MemoryArena.h" // For the region arena
 
 // --- SIRModel Class Implementation ---
 
 SIRModel::SIRModel() : beta(0.2), gamma(0.1), population(0) {
-    history.reserve(200); // Pre-allocate some memory
+    // No up-front reservation: every region owns a model, most of which never run; run() reserves instead
 }
 
-const std::vector<SIRDataPoint>& SIRModel::getHistory() const {
+SIRModel::SIRModel(std::pmr::memory_resource* resource) : history(resource), beta(0.2), gamma(0.1), population(0) {
+}
+
+const SIRTrajectory& SIRModel::getHistory() const {
     return history;
 }
 
@@ -66,6 +74,7 @@ void SIRModel::run_single_step() {
 void SIRModel::run(int days) {
     // The reset function already clears history and adds day 0.
     // This loop will add day 1 through `days`.
+    if (days > 0) history.reserve(history.size() + days);
     for (int d = 0; d < days; ++d) {
         run_single_step();
     }
@@ -84,12 +93,113 @@ void SIRModel::reset(int initialPopulation, int initialInfected, int initialReco
 }
 
 
+// --- HistorySeries Class Implementation ---
+
+// [算法] 按天定位
+// 逻辑:
+//   记录按天严格递增，所以第 i 条的 day >= 首日 + i，目标天的下标不会超过 (day - 首日)。
+//   天数连续 (最常见) 时 records[day - 首日] 就是目标，O(1)；否则只在 [0, day - 首日] 内二分。
+size_t HistorySeries::lowerBound(int day) const {
+    if (records.empty() || day <= records.front().day) return 0;
+    if (day > records.back().day) return records.size();
+    const size_t offset = static_cast<size_t>(static_cast<int64_t>(day) - records.front().day);
+    if (offset < records.size() && records[offset].day == day) return offset;
+    const size_t limit = std::min(offset + 1, records.size());
+    return std::lower_bound(records.begin(), records.begin() + limit, day,
+        [](const HistoricalRecord& rec, int d) { return rec.day < d; }) - records.begin();
+}
+
+const HistoricalRecord* HistorySeries::find(int day) const {
+    const size_t i = lowerBound(day);
+    return i < records.size() && records[i].day == day ? &records[i] : nullptr;
+}
+
+bool HistorySeries::upsert(const HistoricalRecord& record) {
+    if (records.empty() || record.day > records.back().day) {
+        records.push_back(record);
+        return true;
+    }
+    const size_t i = lowerBound(record.day);
+    if (records[i].day == record.day) {
+        records[i] = record;
+        return false;
+    }
+    records.insert(records.begin() + i, record);
+    return true;
+}
+
+bool HistorySeries::erase(int day) {
+    if (records.empty()) return false;
+    if (records.back().day == day) {
+        records.pop_back();
+        return true;
+    }
+    const size_t i = lowerBound(day);
+    if (i == records.size() || records[i].day != day) return false;
+    records.erase(records.begin() + i);
+    return true;
+}
+
+// [算法] 批量合并 (Upsert Sorted)
+// 逻辑:
+//   先在一次合并扫描中统计新增的天数并覆盖已有的天，再把数组扩大新增数，
+//   从两端往前做原地归并: 每条已有记录最多移动一次，总代价 O(n + k)，
+//   而逐条插入最坏是 O(n * k)。全部在末尾之后时退化为一次追加。
+size_t HistorySeries::upsertSorted(const HistoricalRecord* incoming, size_t count) {
+    if (count == 0) return 0;
+    if (records.empty() || incoming[0].day > records.back().day) {
+        records.insert(records.end(), incoming, incoming + count);
+        return count;
+    }
+    size_t added = 0;
+    size_t i = lowerBound(incoming[0].day);
+    for (size_t k = 0; k < count; ++k) {
+        while (i < records.size() && records[i].day < incoming[k].day) ++i;
+        if (i < records.size() && records[i].day == incoming[k].day) records[i] = incoming[k];
+        else ++added;
+    }
+    if (added == 0) return 0;
+
+    size_t old = records.size();
+    records.resize(old + added);
+    size_t out = records.size();
+    for (size_t k = count; k-- > 0;) {
+        const HistoricalRecord& rec = incoming[k];
+        while (old > 0 && records[old - 1].day > rec.day) records[--out] = records[--old];
+        if (old > 0 && records[old - 1].day == rec.day) {
+            records[--out] = records[--old]; // Already overwritten above
+        } else {
+            records[--out] = rec;
+        }
+        if (out == old) break; // Everything below is already in place
+    }
+    return added;
+}
+
+HistorySeries::Range HistorySeries::range(int firstDay, int lastDay) const {
+    const HistoricalRecord* base = records.data();
+    if (lastDay < firstDay) return { base, base };
+    const size_t first = lowerBound(firstDay);
+    const size_t last = lastDay == INT_MAX ? records.size() : lowerBound(lastDay + 1);
+    return { base + first, base + std::max(first, last) };
+}
+
 // --- Region Struct Implementation ---
 
-Region::Region() : population(0), confirmedCases(0), recoveredCases(0), deaths(0) {
+Region::Region() : historyEpoch(0), population(0), confirmedCases(0), recoveredCases(0), deaths(0) {
     name[0] = '\0'; // Ensure the name is an empty string by default
 }
 
+Region::Region(std::pmr::memory_resource* resource)
+    : history(resource), historyEpoch(0), simulation(resource), population(0), confirmedCases(0), recoveredCases(0), deaths(0) {
+    name[0] = '\0';
+}
+
+Region::Region(int population, int confirmed, int recovered, int deaths)
+    : historyEpoch(0), population(population), confirmedCases(confirmed), recoveredCases(recovered), deaths(deaths) {
+    name[0] = '\0';
+}
+
 // [算法] 估算传染率 (Calculate Average Beta)
 // 逻辑:
 //   遍历历史数据，利用SIR微分方程反推每一天的Beta值。
@@ -165,20 +275,42 @@ double Region::calculateAverageGamma() const {
     return (count > 0) ? (sumGamma / count) : 0.1;
 }
 
+// [算法] 预测起点 (Forecast Origin)
+// 逻辑:
+//   如果有历史数据，从历史最后一天的下一天开始预测；否则从当前状态(Day 0)开始。
+//   感染者至少为1，否则模型不会发生任何传播。
+void Region::getForecastOrigin(int& startDay, int& infected, int& removed) const {
+    if (!history.empty()) {
+        const auto& lastHistory = history.back();
+        startDay = lastHistory.day + 1;
+        infected = lastHistory.confirmed - lastHistory.recovered - lastHistory.deaths;
+        removed = lastHistory.recovered + lastHistory.deaths;
+    } else {
+        startDay = 0;
+        infected = confirmedCases - recoveredCases - deaths;
+        removed = recoveredCases + deaths;
+    }
+    if (infected <= 0) infected = 1;
+}
+
 
 // --- EpidemicData Class Implementation ---
 
-EpidemicData::EpidemicData() {
+// Snapshots point into history buffers: reallocating `regions` must move them, never copy and free
+static_assert(std::is_nothrow_move_constructible<Region>::value, "Region must stay nothrow-movable");
+
+EpidemicData::EpidemicData() : arena(MemoryArena::CreateRegionArena()), bulkDepth(0), snapshotEpoch(0) {
     // The vector is already initialized by its own default constructor
 }
 
 void EpidemicData::addRegion(const char* name, int population, int confirmed, int recovered, int deaths) {
-    regions.emplace_back(); // Create a new default-constructed Region at the end
+    regions.emplace_back(arena.get()); // New Region at the end, its buffers drawn from the region arena
     Region& newRegion = regions.back();
 
     strncpy(newRegion.name, name, sizeof(newRegion.name) - 1);
     newRegion.name[sizeof(newRegion.name) - 1] = '\0';
 
+    newRegion.historyEpoch = snapshotEpoch;
     newRegion.population = population;
     newRegion.confirmedCases = confirmed;
     newRegion.recoveredCases = recovered;
@@ -186,12 +318,119 @@ void EpidemicData::addRegion(const char* name, int population, int confirmed, in
 
     // Also initialize its simulation model
     newRegion.simulation.reset(population, confirmed - recovered - deaths, recovered + deaths);
+    columns.push_back(newRegion);
+    regionSlots.push_back(allocateSlot(static_cast<uint32_t>(regions.size() - 1)));
+    if (rollingUp()) tree.addRegion(newRegion);
+
+    if (notifying()) {
+        for (auto* l : listeners) l->onRegionAdded(static_cast<int>(regions.size()) - 1, newRegion);
+    }
 }
 
+// [算法] 保序删除
+// 逻辑:
+//   地区表保持原有顺序 (界面、HTTP API 与共享内存源按下标引用的地区不变)，其后的地区各前移一位。
+//   代价只是几次连续的搬移: 地区与各列整体前移，槽位、风险链表与分组成员中大于 index 的下标减一；
+//   不重新计算任何汇总或风险等级。移动不改变历史缓冲区的地址，快照不受影响。
 void EpidemicData::deleteRegion(int index) {
+    if (index < 0 || index >= regions.size()) return;
+    // The tree subtracts the region's history, which retiring to a live snapshot empties: remove it first
+    if (rollingUp()) tree.removeRegion(index, regions[index]);
+    retireHistory(regions[index], false);
+    releaseSlot(regionSlots[index]);
+    regions.erase(regions.begin() + index);
+    regionSlots.erase(regionSlots.begin() + index);
+    for (size_t i = index; i < regionSlots.size(); ++i) slots[regionSlots[i]].index = static_cast<uint32_t>(i);
+    columns.erase(index);
+    if (notifying()) {
+        for (auto* l : listeners) l->onRegionDeleted(index);
+    }
+}
+
+void EpidemicData::clearRegions() {
+    for (auto& region : regions) retireHistory(region, false);
+    for (uint32_t slot : regionSlots) releaseSlot(slot);
+    regions.clear();
+    regionSlots.clear();
+    columns.clear();
+    tree.clear();
+    if (notifying()) {
+        for (auto* l : listeners) l->onBulkChange();
+    }
+}
+
+// [算法] 整体换入后台载入的地区
+// 逻辑:
+//   先像 clearRegions 一样把现有历史移交给存活的快照、作废全部句柄；再交换地区表、热数据列与汇总树
+//   (loaded 在自己的批量更新结束时已建好)，并换用 loaded 的内存池 (新地区的缓冲区都在其中；
+//   旧内存池由引用它的快照继续持有)。换入的缓冲区不被本对象的任何快照引用，historyEpoch 取当前值。
+void EpidemicData::adoptRegions(EpidemicData& loaded) {
+    for (auto& region : regions) retireHistory(region, false);
+    for (uint32_t slot : regionSlots) releaseSlot(slot);
+    regions.clear();
+    regionSlots.clear();
+    columns.clear();
+    tree.clear();
+
+    std::swap(arena, loaded.arena);
+    regions.swap(loaded.regions);
+    std::swap(columns, loaded.columns);
+    std::swap(tree, loaded.tree);
+    loaded.slots.clear();
+    loaded.freeSlots.clear();
+    loaded.regionSlots.clear();
+
+    regionSlots.reserve(regions.size());
+    for (size_t i = 0; i < regions.size(); ++i) {
+        regions[i].historyEpoch = snapshotEpoch;
+        regionSlots.push_back(allocateSlot(static_cast<uint32_t>(i)));
+    }
+    // Inside an outer bulk update the tree is rebuilt (and listeners told) at its end anyway
+    if (notifying()) {
+        for (auto* l : listeners) l->onBulkChange();
+    }
+}
+
+void EpidemicData::reserveRegions(size_t count) {
+    regions.reserve(count);
+    columns.reserve(count);
+    regionSlots.reserve(count);
+}
+
+// --- Region handles (slot map) ---
+
+uint32_t EpidemicData::allocateSlot(uint32_t index) {
+    if (!freeSlots.empty()) {
+        const uint32_t slot = freeSlots.back();
+        freeSlots.pop_back();
+        slots[slot].index = index;
+        return slot;
+    }
+    slots.push_back({ index, 0 });
+    return static_cast<uint32_t>(slots.size() - 1);
+}
+
+void EpidemicData::releaseSlot(uint32_t slot) {
+    slots[slot].generation++;
+    freeSlots.push_back(slot);
+}
+
+RegionHandle EpidemicData::getHandle(int index) const {
+    RegionHandle handle;
     if (index >= 0 && index < regions.size()) {
-        regions.erase(regions.begin() + index);
+        handle.slot = regionSlots[index];
+        handle.generation = slots[handle.slot].generation;
     }
+    return handle;
+}
+
+int EpidemicData::resolve(RegionHandle handle) const {
+    if (handle.slot >= slots.size() || slots[handle.slot].generation != handle.generation) return -1;
+    return static_cast<int>(slots[handle.slot].index);
+}
+
+Region* EpidemicData::getRegion(RegionHandle handle) {
+    return getRegion(resolve(handle));
 }
 
 Region* EpidemicData::getRegion(int index) {
@@ -205,6 +444,641 @@ std::vector<Region>& EpidemicData::getRegions() {
     return regions;
 }
 
+void EpidemicData::renameRegion(int index, const char* name) {
+    Region* region = getRegion(index);
+    if (!region) return;
+    strncpy(region->name, name, sizeof(region->name) - 1);
+    region->name[sizeof(region->name) - 1] = '\0';
+    if (rollingUp()) tree.renameRegion(index, *region);
+    if (notifying()) {
+        for (auto* l : listeners) l->onRegionRenamed(index, region->name);
+    }
+}
+
+void EpidemicData::setRegionPopulation(int index, int population) {
+    Region* region = getRegion(index);
+    if (!region) return;
+    if (rollingUp()) {
+        RollupCounts delta;
+        delta.population = static_cast<long long>(population) - region->population;
+        tree.addCounts(index, delta);
+    }
+    region->population = population;
+    columns.set(index, *region);
+    if (notifying()) {
+        for (auto* l : listeners) l->onPopulationChanged(index, population);
+    }
+}
+
+void EpidemicData::setRegionCounts(int index, int confirmed, int recovered, int deaths) {
+    Region* region = getRegion(index);
+    if (!region) return;
+    if (rollingUp()) {
+        RollupCounts delta;
+        delta.confirmed = static_cast<long long>(confirmed) - region->confirmedCases;
+        delta.recovered = static_cast<long long>(recovered) - region->recoveredCases;
+        delta.deaths = static_cast<long long>(deaths) - region->deaths;
+        tree.addCounts(index, delta);
+    }
+    region->confirmedCases = confirmed;
+    region->recoveredCases = recovered;
+    region->deaths = deaths;
+    columns.set(index, *region);
+    if (notifying()) {
+        for (auto* l : listeners) l->onCountsChanged(index, confirmed, recovered, deaths);
+    }
+}
+
+// Update current state (and its hot columns and rollups) from the last history record
+void EpidemicData::refreshCurrentState(int index) {
+    Region& region = regions[index];
+    if (!region.history.empty()) {
+        const auto& lastDay = region.history.back();
+        if (rollingUp()) {
+            RollupCounts delta;
+            delta.confirmed = static_cast<long long>(lastDay.confirmed) - region.confirmedCases;
+            delta.recovered = static_cast<long long>(lastDay.recovered) - region.recoveredCases;
+            delta.deaths = static_cast<long long>(lastDay.deaths) - region.deaths;
+            tree.addCounts(index, delta);
+        }
+        region.confirmedCases = lastDay.confirmed;
+        region.recoveredCases = lastDay.recovered;
+        region.deaths = lastDay.deaths;
+        columns.set(index, region);
+    }
+}
+
+void EpidemicData::upsertHistoryRecord(int index, const HistoricalRecord& record) {
+    Region* region = getRegion(index);
+    if (!region) return;
+    if (rollingUp()) tree.beginHistoryEdit(region->history, &record, 1);
+    getMutableHistory(index).upsert(record);
+    if (rollingUp()) tree.endHistoryEdit(index, region->history);
+    refreshCurrentState(index);
+    if (notifying()) {
+        for (auto* l : listeners) l->onHistoryUpserted(index, record);
+    }
+}
+
+void EpidemicData::upsertHistoryRecords(int index, const HistoricalRecord* records, size_t count) {
+    Region* region = getRegion(index);
+    if (!region || count == 0) return;
+    if (rollingUp()) tree.beginHistoryEdit(region->history, records, count);
+    getMutableHistory(index).upsertSorted(records, count);
+    if (rollingUp()) tree.endHistoryEdit(index, region->history);
+    refreshCurrentState(index);
+    if (notifying()) {
+        for (size_t i = 0; i < count; ++i) {
+            for (auto* l : listeners) l->onHistoryUpserted(index, records[i]);
+        }
+    }
+}
+
+void EpidemicData::deleteHistoryRecord(int index, int day) {
+    Region* region = getRegion(index);
+    if (!region || !region->history.find(day)) return;
+    if (rollingUp()) tree.beginHistoryEdit(region->history, day);
+    getMutableHistory(index).erase(day);
+    if (rollingUp()) tree.endHistoryEdit(index, region->history);
+    refreshCurrentState(index);
+    if (notifying()) {
+        for (auto* l : listeners) l->onHistoryDeleted(index, day);
+    }
+}
+
+HistorySeries& EpidemicData::getMutableHistory(int index) {
+    Region& region = regions[index];
+    retireHistory(region, true);
+    return region.history;
+}
+
+// [算法] 写时复制 (Copy-on-Write)
+// 逻辑:
+//   每次截取快照 epoch 加一。某地区当前的历史缓冲区在 historyEpoch 时开始使用，
+//   因此 epoch 大于 historyEpoch 的存活快照都引用着它。修改前把缓冲区整体移入这些快照的
+//   retired 列表 (移动 HistorySeries 不会改变其数据地址)，地区改用一份副本；之后的修改就不再复制。
+//   没有存活快照时只是一次空列表检查。
+void EpidemicData::retireHistory(Region& region, bool keepCopy) {
+    if (snapshots.empty()) return;
+    std::shared_ptr<HistorySeries> retired;
+    for (size_t i = 0; i < snapshots.size();) {
+        std::shared_ptr<DataSnapshot> snapshot = snapshots[i].lock();
+        if (!snapshot) {
+            // Pairs with the reader's final reference release: its reads happen before our writes
+            std::atomic_thread_fence(std::memory_order_acquire);
+            snapshots[i] = std::move(snapshots.back());
+            snapshots.pop_back();
+            continue;
+        }
+        if (snapshot->epoch > region.historyEpoch) {
+            if (!retired) {
+                retired = std::make_shared<HistorySeries>(std::move(region.history));
+                if (keepCopy) region.history = *retired;
+                else region.history.clear();
+            }
+            snapshot->retired.push_back(retired);
+        }
+        ++i;
+    }
+    region.historyEpoch = snapshotEpoch;
+}
+
+std::shared_ptr<DataSnapshot> EpidemicData::captureSnapshot() {
+    auto snapshot = std::make_shared<DataSnapshot>();
+    snapshot->epoch = ++snapshotEpoch;
+    snapshot->arena = arena;
+    snapshot->rows.resize(regions.size());
+    size_t nameBytes = 0;
+    for (const auto& r : regions) nameBytes += strnlen(r.name, sizeof(r.name));
+    snapshot->names.resize(nameBytes);
+
+    char* names = &snapshot->names[0];
+    uint32_t offset = 0;
+    for (size_t i = 0; i < regions.size(); ++i) {
+        const Region& r = regions[i];
+        DataSnapshot::Row& row = snapshot->rows[i];
+        row.nameOffset = offset;
+        row.nameLength = static_cast<uint32_t>(strnlen(r.name, sizeof(r.name)));
+        std::memcpy(names + offset, r.name, row.nameLength);
+        offset += row.nameLength;
+        row.population = r.population;
+        row.confirmed = r.confirmedCases;
+        row.recovered = r.recoveredCases;
+        row.deaths = r.deaths;
+        row.history = r.history.data();
+        row.historyCount = r.history.size();
+        snapshot->recordCount += row.historyCount;
+    }
+
+    // Drop expired captures so the list stays short
+    snapshots.erase(std::remove_if(snapshots.begin(), snapshots.end(),
+        [](const std::weak_ptr<DataSnapshot>& s) { return s.expired(); }), snapshots.end());
+    std::atomic_thread_fence(std::memory_order_acquire);
+    snapshots.push_back(snapshot);
+    return snapshot;
+}
+
+void EpidemicData::addChangeListener(DataChangeListener* listener) {
+    if (std::find(listeners.begin(), listeners.end(), listener) == listeners.end()) listeners.push_back(listener);
+}
+
+void EpidemicData::removeChangeListener(DataChangeListener* listener) {
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
+}
+
+void EpidemicData::beginBulkUpdate() {
+    ++bulkDepth;
+}
+
+void EpidemicData::endBulkUpdate() {
+    if (bulkDepth > 0 && --bulkDepth == 0) {
+        // The columns followed every call; the rollups were paused and bulk loaders may have
+        // pushed histories straight through getMutableHistory(), so they are rebuilt once here
+        tree.rebuild(regions);
+        for (auto* l : listeners) l->onBulkChange();
+    }
+}
+
+RegionTotals EpidemicData::getTotals() const {
+#ifndef NDEBUG
+    assert(columns.getTotals() == recountTotals());
+#endif
+    return columns.getTotals();
+}
+
+RegionTotals EpidemicData::recountTotals() const {
+    RegionTotals totals;
+    totals.regions = regions.size();
+    for (const Region& r : regions) {
+        totals.population += r.population;
+        totals.confirmed += r.confirmedCases;
+        totals.recovered += r.recoveredCases;
+        totals.deaths += r.deaths;
+    }
+    return totals;
+}
+
+// --- RegionColumns Struct Implementation ---
+
+void RegionColumns::push_back(const Region& region) {
+    population.push_back(region.getPopulation());
+    confirmed.push_back(region.getConfirmedCases());
+    recovered.push_back(region.getRecoveredCases());
+    deaths.push_back(region.getDeaths());
+    const RiskLevel level = EpidemicData::calculateRiskLevel(region);
+    risk.push_back(level);
+    prev.push_back(-1);
+    next.push_back(-1);
+    link(size() - 1, level);
+    addToTotals(size() - 1, +1);
+}
+
+void RegionColumns::set(size_t index, const Region& region) {
+    if (population[index] == region.getPopulation() && confirmed[index] == region.getConfirmedCases() &&
+        recovered[index] == region.getRecoveredCases() && deaths[index] == region.getDeaths()) {
+        return;
+    }
+    addToTotals(index, -1);
+    population[index] = region.getPopulation();
+    confirmed[index] = region.getConfirmedCases();
+    recovered[index] = region.getRecoveredCases();
+    deaths[index] = region.getDeaths();
+    addToTotals(index, +1);
+    const RiskLevel level = EpidemicData::calculateRiskLevel(region);
+    if (level != risk[index]) {
+        unlink(index);
+        risk[index] = level;
+        link(index, level);
+    }
+}
+
+void RegionColumns::erase(size_t index) {
+    addToTotals(index, -1);
+    unlink(index);
+    population.erase(population.begin() + index);
+    confirmed.erase(confirmed.begin() + index);
+    recovered.erase(recovered.begin() + index);
+    deaths.erase(deaths.begin() + index);
+    risk.erase(risk.begin() + index);
+    prev.erase(prev.begin() + index);
+    next.erase(next.begin() + index);
+    // Every later row moved down by one, and so does every link to it
+    const int32_t removed = static_cast<int32_t>(index);
+    for (int32_t& i : prev) i -= i > removed;
+    for (int32_t& i : next) i -= i > removed;
+    for (int32_t& head : bucketHead) head -= head > removed;
+}
+
+void RegionColumns::clear() {
+    population.clear();
+    confirmed.clear();
+    recovered.clear();
+    deaths.clear();
+    risk.clear();
+    relinkAll();
+    totals = RegionTotals();
+}
+
+void RegionColumns::reserve(size_t count) {
+    population.reserve(count);
+    confirmed.reserve(count);
+    recovered.reserve(count);
+    deaths.reserve(count);
+    risk.reserve(count);
+    prev.reserve(count);
+    next.reserve(count);
+}
+
+void RegionColumns::resize(size_t count) {
+    // New rows are all zero, which classifies as low risk and adds nothing but their count
+    for (size_t i = count; i < size(); ++i) addToTotals(i, -1);
+    if (count > size()) totals.regions += count - size();
+    population.resize(count);
+    confirmed.resize(count);
+    recovered.resize(count);
+    deaths.resize(count);
+    risk.resize(count, RiskLevel::Low);
+    relinkAll();
+}
+
+void RegionColumns::collectRisk(RiskLevel level, std::vector<uint32_t>& out) const {
+    out.reserve(out.size() + riskCount(level));
+    for (int32_t i = riskFirst(level); i != -1; i = next[i]) out.push_back(static_cast<uint32_t>(i));
+}
+
+void RegionColumns::addToTotals(size_t index, int sign) {
+    if (sign > 0) totals.regions++;
+    else totals.regions--;
+    totals.population += sign * static_cast<long long>(population[index]);
+    totals.confirmed += sign * static_cast<long long>(confirmed[index]);
+    totals.recovered += sign * static_cast<long long>(recovered[index]);
+    totals.deaths += sign * static_cast<long long>(deaths[index]);
+}
+
+void RegionColumns::link(size_t index, RiskLevel level) {
+    // New members go to the front of their bucket
+    int32_t& head = bucketHead[static_cast<int>(level)];
+    prev[index] = -1;
+    next[index] = head;
+    if (head != -1) prev[head] = static_cast<int32_t>(index);
+    head = static_cast<int32_t>(index);
+    bucketSize[static_cast<int>(level)]++;
+    riskVersion++;
+}
+
+void RegionColumns::unlink(size_t index) {
+    const int bucket = static_cast<int>(risk[index]);
+    if (prev[index] != -1) {
+        next[prev[index]] = next[index];
+    } else {
+        bucketHead[bucket] = next[index];
+    }
+    if (next[index] != -1) prev[next[index]] = prev[index];
+    bucketSize[bucket]--;
+    riskVersion++;
+}
+
+void RegionColumns::relinkAll() {
+    prev.assign(size(), -1);
+    next.assign(size(), -1);
+    for (int b = 0; b < 3; ++b) {
+        bucketHead[b] = -1;
+        bucketSize[b] = 0;
+    }
+    // Linked back to front so each bucket lists its rows in ascending order
+    for (size_t i = size(); i-- > 0;) link(i, risk[i]);
+}
+
+// --- RegionTree Class Implementation ---
+
+// Change of a history's carried-forward counts on day: the record of that day minus the one before it
+static RollupDelta HistoryChangeAt(const HistorySeries& history, int day) {
+    RollupDelta change;
+    const size_t i = history.lowerBound(day);
+    if (i < history.size() && history[i].day == day) {
+        change.confirmed = history[i].confirmed;
+        change.recovered = history[i].recovered;
+        change.deaths = history[i].deaths;
+        if (i > 0) {
+            change.confirmed -= history[i - 1].confirmed;
+            change.recovered -= history[i - 1].recovered;
+            change.deaths -= history[i - 1].deaths;
+        }
+    }
+    return change;
+}
+
+RegionTree::RegionTree() {
+    clear();
+}
+
+std::string RegionTree::ParentPath(const char* name) {
+    const char* separator = strrchr(name, Separator);
+    return separator ? std::string(name, separator - name) : std::string();
+}
+
+const char* RegionTree::LeafName(const char* path) {
+    const char* separator = strrchr(path, Separator);
+    return separator ? separator + 1 : path;
+}
+
+int RegionTree::findGroup(const std::string& path) const {
+    auto it = byPath.find(path);
+    return it != byPath.end() ? it->second : -1;
+}
+
+void RegionTree::getHistory(int group, std::vector<RollupDay>& out) const {
+    out.clear();
+    if (!isLive(group)) return;
+    const Group& g = groups[group];
+    out.reserve(g.changes.size());
+    RollupDay running = { 0, 0, 0, 0 };
+    for (size_t i = 0; i < g.changes.size(); ++i) {
+        running.day = g.firstDay + static_cast<int>(i);
+        running.confirmed += g.changes[i].confirmed;
+        running.recovered += g.changes[i].recovered;
+        running.deaths += g.changes[i].deaths;
+        out.push_back(running);
+    }
+}
+
+void RegionTree::clear() {
+    groups.clear();
+    freeGroups.clear();
+    byPath.clear();
+    regionGroup.clear();
+    memberPos.clear();
+    groups.emplace_back();
+    groups[Root].live = true;
+    byPath[std::string()] = Root;
+}
+
+// [算法] 自底向上重建 (Bottom-up Rebuild)
+// 逻辑:
+//   每个地区只计入它直接所在的分组 (O(记录数))，然后按深度从深到浅把每个分组的汇总并入父分组，
+//   总成本 O(记录数 + 分组数 × 天数)，而不是逐个地区把记录加到所有祖先上的 O(记录数 × 深度)。
+void RegionTree::rebuild(const std::vector<Region>& regions) {
+    clear();
+    regionGroup.reserve(regions.size());
+    memberPos.reserve(regions.size());
+    std::string path;
+    int group = Root;
+    for (size_t i = 0; i < regions.size(); ++i) {
+        // Loaders usually list a group's regions together: reuse the last lookup
+        std::string parent = ParentPath(regions[i].name);
+        if (i == 0 || parent != path) {
+            path.swap(parent);
+            group = ensureGroup(path);
+        }
+        regionGroup.push_back(group);
+        memberPos.push_back(0);
+        attach(i, group);
+        addContribution(group, regions[i], +1, false);
+    }
+
+    std::vector<int32_t> order(groups.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int32_t>(i);
+    std::sort(order.begin(), order.end(), [this](int32_t a, int32_t b) { return groups[a].depth > groups[b].depth; });
+    for (int32_t id : order) {
+        if (id == Root) continue;
+        const Group& child = groups[id];
+        Group& parent = groups[child.parent];
+        parent.regions += child.regions;
+        parent.totals.population += child.totals.population;
+        parent.totals.confirmed += child.totals.confirmed;
+        parent.totals.recovered += child.totals.recovered;
+        parent.totals.deaths += child.totals.deaths;
+        for (size_t d = 0; d < child.changes.size(); ++d) {
+            if (!child.changes[d].isZero()) AddChangeAt(parent, child.firstDay + static_cast<int>(d), child.changes[d]);
+        }
+    }
+}
+
+void RegionTree::addRegion(const Region& region) {
+    const size_t index = regionGroup.size();
+    const int group = ensureGroup(ParentPath(region.name));
+    regionGroup.push_back(group);
+    memberPos.push_back(0);
+    attach(index, group);
+    addContribution(group, region, +1, true);
+}
+
+void RegionTree::removeRegion(size_t index, const Region& region) {
+    const int group = regionGroup[index];
+    addContribution(group, region, -1, true);
+    detach(index);
+    regionGroup.erase(regionGroup.begin() + index);
+    memberPos.erase(memberPos.begin() + index);
+    // Mirror the data model: the later regions move down by one in their groups' member lists too
+    for (Group& g : groups) {
+        for (uint32_t& member : g.members) member -= member > index;
+    }
+    releaseIfEmpty(group);
+}
+
+void RegionTree::renameRegion(size_t index, const Region& region) {
+    const int from = regionGroup[index];
+    std::string path = ParentPath(region.name);
+    if (groups[from].path == path) return;
+    addContribution(from, region, -1, true);
+    detach(index);
+    const int to = ensureGroup(path);
+    attach(index, to);
+    addContribution(to, region, +1, true);
+    releaseIfEmpty(from);
+}
+
+void RegionTree::addCounts(size_t index, const RollupCounts& delta) {
+    for (int g = regionGroup[index]; g != -1; g = groups[g].parent) {
+        RollupCounts& totals = groups[g].totals;
+        totals.population += delta.population;
+        totals.confirmed += delta.confirmed;
+        totals.recovered += delta.recovered;
+        totals.deaths += delta.deaths;
+    }
+}
+
+// [算法] 历史编辑的增量汇总
+// 逻辑:
+//   地区的延续值只在记录日变化，变化量 = 当天记录 - 前一条记录。新增/修改/删除 day 这条记录，
+//   只会改变 day 当天和它之后第一条记录那天的变化量 (其间延续值整体平移，差分不变)。
+//   编辑前后各取一次这些天的变化量，把差值加到所在分组及其全部祖先: O((编辑天数) × 深度)。
+void RegionTree::beginHistoryEdit(const HistorySeries& history, const HistoricalRecord* records, size_t count) {
+    editDays.clear();
+    for (size_t i = 0; i < count; ++i) {
+        editDays.push_back(records[i].day);
+        const size_t next = history.lowerBound(records[i].day + 1);
+        if (next < history.size()) editDays.push_back(history[next].day);
+    }
+    sampleEditDays(history);
+}
+
+void RegionTree::beginHistoryEdit(const HistorySeries& history, int day) {
+    editDays.clear();
+    editDays.push_back(day);
+    const size_t next = history.lowerBound(day + 1);
+    if (next < history.size()) editDays.push_back(history[next].day);
+    sampleEditDays(history);
+}
+
+void RegionTree::sampleEditDays(const HistorySeries& history) {
+    std::sort(editDays.begin(), editDays.end());
+    editDays.erase(std::unique(editDays.begin(), editDays.end()), editDays.end());
+    editBefore.resize(editDays.size());
+    for (size_t i = 0; i < editDays.size(); ++i) editBefore[i] = HistoryChangeAt(history, editDays[i]);
+}
+
+void RegionTree::endHistoryEdit(size_t index, const HistorySeries& history) {
+    const int group = regionGroup[index];
+    for (size_t i = 0; i < editDays.size(); ++i) {
+        const RollupDelta after = HistoryChangeAt(history, editDays[i]);
+        RollupDelta delta;
+        delta.confirmed = after.confirmed - editBefore[i].confirmed;
+        delta.recovered = after.recovered - editBefore[i].recovered;
+        delta.deaths = after.deaths - editBefore[i].deaths;
+        if (!delta.isZero()) addChange(group, editDays[i], delta);
+    }
+    editDays.clear();
+}
+
+int RegionTree::ensureGroup(const std::string& path) {
+    auto it = byPath.find(path);
+    if (it != byPath.end()) return it->second;
+
+    const int parent = ensureGroup(ParentPath(path.c_str()));
+    int id;
+    if (!freeGroups.empty()) {
+        id = freeGroups.back();
+        freeGroups.pop_back();
+        groups[id] = Group();
+    } else {
+        id = static_cast<int>(groups.size());
+        groups.emplace_back();
+    }
+    Group& group = groups[id];
+    group.path = path;
+    group.parent = parent;
+    group.depth = groups[parent].depth + 1;
+    group.live = true;
+    group.slotInParent = static_cast<uint32_t>(groups[parent].children.size());
+    groups[parent].children.push_back(id);
+    byPath[path] = id;
+    return id;
+}
+
+// Releases id and every ancestor left without regions (never the root)
+void RegionTree::releaseIfEmpty(int id) {
+    while (id != Root && groups[id].regions == 0) {
+        Group& group = groups[id];
+        const int parent = group.parent;
+        std::vector<int32_t>& siblings = groups[parent].children;
+        const int32_t moved = siblings.back();
+        siblings[group.slotInParent] = moved;
+        groups[moved].slotInParent = group.slotInParent;
+        siblings.pop_back();
+        byPath.erase(group.path);
+        group = Group();
+        freeGroups.push_back(id);
+        id = parent;
+    }
+}
+
+void RegionTree::attach(size_t index, int group) {
+    std::vector<uint32_t>& members = groups[group].members;
+    regionGroup[index] = group;
+    memberPos[index] = static_cast<uint32_t>(members.size());
+    members.push_back(static_cast<uint32_t>(index));
+}
+
+void RegionTree::detach(size_t index) {
+    std::vector<uint32_t>& members = groups[regionGroup[index]].members;
+    const uint32_t moved = members.back();
+    members[memberPos[index]] = moved;
+    memberPos[moved] = memberPos[index];
+    members.pop_back();
+}
+
+void RegionTree::addContribution(int group, const Region& region, int sign, bool ancestors) {
+    for (int g = group; g != -1; g = ancestors ? groups[g].parent : -1) {
+        Group& target = groups[g];
+        if (sign > 0) target.regions++;
+        else target.regions--;
+        target.totals.population += sign * static_cast<long long>(region.getPopulation());
+        target.totals.confirmed += sign * static_cast<long long>(region.getConfirmedCases());
+        target.totals.recovered += sign * static_cast<long long>(region.getRecoveredCases());
+        target.totals.deaths += sign * static_cast<long long>(region.getDeaths());
+        const HistoricalRecord* previous = nullptr;
+        for (const HistoricalRecord& record : region.history) {
+            RollupDelta change;
+            change.confirmed = sign * static_cast<long long>(record.confirmed - (previous ? previous->confirmed : 0));
+            change.recovered = sign * static_cast<long long>(record.recovered - (previous ? previous->recovered : 0));
+            change.deaths = sign * static_cast<long long>(record.deaths - (previous ? previous->deaths : 0));
+            if (!change.isZero()) AddChangeAt(target, record.day, change);
+            previous = &record;
+        }
+    }
+}
+
+void RegionTree::addChange(int group, int day, const RollupDelta& delta) {
+    for (int g = group; g != -1; g = groups[g].parent) AddChangeAt(groups[g], day, delta);
+}
+
+void RegionTree::AddChangeAt(Group& group, int day, const RollupDelta& delta) {
+    std::vector<RollupDelta>& changes = group.changes;
+    if (changes.empty()) {
+        group.firstDay = day;
+    } else if (day < group.firstDay) {
+        // Grow at the front (rare: records are normally added in day order)
+        changes.insert(changes.begin(), static_cast<size_t>(group.firstDay - day), RollupDelta());
+        group.firstDay = day;
+    }
+    const size_t offset = static_cast<size_t>(day - group.firstDay);
+    if (offset >= changes.size()) changes.resize(offset + 1);
+    changes[offset].confirmed += delta.confirmed;
+    changes[offset].recovered += delta.recovered;
+    changes[offset].deaths += delta.deaths;
+}
+
 // --- Static Utility Functions ---
 
 const char* EpidemicData::getRiskLevelString(RiskLevel level) {
@@ -226,11 +1100,15 @@ ImVec4 EpidemicData::getRiskLevelColor(RiskLevel level) {
 }
 
 RiskLevel EpidemicData::calculateRiskLevel(const Region& region) {
-    int activeCases = region.confirmedCases - region.recoveredCases - region.deaths;
+    return calculateRiskLevel(region.population, region.confirmedCases, region.recoveredCases, region.deaths);
+}
+
+RiskLevel EpidemicData::calculateRiskLevel(int population, int confirmed, int recovered, int deaths) {
+    int activeCases = confirmed - recovered - deaths;
     // Basic logic: risk is based on active cases per 100k people
-    if (region.population == 0) return RiskLevel::Low;
+    if (population == 0) return RiskLevel::Low;
     
-    double activePer100k = (static_cast<double>(activeCases) / region.population) * 100000.0;
+    double activePer100k = (static_cast<double>(activeCases) / population) * 100000.0;
 
     if (activePer100k > 50) return RiskLevel::High;
     if (activePer100k > 10) return RiskLevel::Medium;
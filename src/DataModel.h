@@ -7,6 +7,11 @@
 
 #pragma once
 
+#include <cstdint>
+#include <unordered_map>
+#include <memory>
+#include <memory_resource>
+#include <utility>
 #include <vector>
 #include <string>
 
@@ -25,6 +30,9 @@ struct SIRDataPoint {
     double recovered = 0;
 };
 
+// Trajectory buffer; a region's model draws it from the data model's region arena
+typedef std::pmr::vector<SIRDataPoint> SIRTrajectory;
+
 // ------------------------------------------------------------------------------------
 // [类] SIRModel
 // 描述: 传染病动力学模拟核心类 (Susceptible-Infected-Removed)
@@ -35,9 +43,10 @@ struct SIRDataPoint {
 class SIRModel {
 public:
     SIRModel();
+    explicit SIRModel(std::pmr::memory_resource* resource);
 
     // Getters
-    const std::vector<SIRDataPoint>& getHistory() const;
+    const SIRTrajectory& getHistory() const;
     const SIRDataPoint& getCurrentData() const;
     double getBeta() const;
     double getGamma() const;
@@ -53,7 +62,7 @@ public:
     void reset(int initialPopulation, int initialInfected, int initialRecovered, int startDay = 0);
 
 private:
-    std::vector<SIRDataPoint> history;
+    SIRTrajectory history;
     SIRDataPoint currentData;
     double beta;  // Transmission rate
     double gamma; // Recovery rate
@@ -79,6 +88,68 @@ struct HistoricalRecord {
     int deaths;
 };
 
+// ------------------------------------------------------------------------------------
+// [类] HistorySeries
+// 描述: 按天排序、每天至多一条的历史记录序列
+// 作用:
+//   记录连续存放 (data()/size() 可以直接交给快照、导出与编辑日志)，同时提供按天的操作:
+//     find/lowerBound  天数连续时按 (day - 首日) 直接定位，有缺口时在 [0, day - 首日] 内二分，O(log n)
+//     upsert/erase     修改已有天或在末尾追加/删除为 O(1)；中间插入/删除是一次 memmove
+//     upsertSorted     批量合并一段按天排序的记录，一次从后往前的原地归并 O(n + k)
+//     range            [firstDay, lastDay] 内的记录 (指针区间)
+//   begin()/end() 的可写版本只给按整体排序或整体替换的批量加载使用，调用方负责保持按天有序。
+//   记录缓冲区来自构造时给定的内存资源 (地区的历史来自 EpidemicData 的地区内存池)。
+// ------------------------------------------------------------------------------------
+class HistorySeries {
+public:
+    HistorySeries() = default;
+    explicit HistorySeries(std::pmr::memory_resource* resource) : records(resource) {}
+
+    struct Range {
+        const HistoricalRecord* first;
+        const HistoricalRecord* last;
+        const HistoricalRecord* begin() const { return first; }
+        const HistoricalRecord* end() const { return last; }
+        size_t size() const { return static_cast<size_t>(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    // Sequence access
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+    const HistoricalRecord* data() const { return records.data(); }
+    const HistoricalRecord* begin() const { return records.data(); }
+    const HistoricalRecord* end() const { return records.data() + records.size(); }
+    HistoricalRecord* begin() { return records.data(); }
+    HistoricalRecord* end() { return records.data() + records.size(); }
+    const HistoricalRecord& operator[](size_t i) const { return records[i]; }
+    HistoricalRecord& operator[](size_t i) { return records[i]; }
+    const HistoricalRecord& front() const { return records.front(); }
+    const HistoricalRecord& back() const { return records.back(); }
+
+    // Bulk loading (the caller keeps the records sorted by day)
+    void reserve(size_t count) { records.reserve(count); }
+    void resize(size_t count) { records.resize(count); }
+    void clear() { records.clear(); }
+    void push_back(const HistoricalRecord& record) { records.push_back(record); }
+    void assign(const HistoricalRecord* first, const HistoricalRecord* last) { records.assign(first, last); }
+    void assign(const std::vector<HistoricalRecord>& sorted) { records.assign(sorted.begin(), sorted.end()); }
+    std::pmr::memory_resource* getResource() const { return records.get_allocator().resource(); }
+    void append(const HistoricalRecord* first, const HistoricalRecord* last) { records.insert(records.end(), first, last); }
+
+    // Day-indexed access
+    size_t lowerBound(int day) const;               // Index of the first record with record.day >= day
+    const HistoricalRecord* find(int day) const;    // nullptr when there is no record for that day
+    bool upsert(const HistoricalRecord& record);    // Returns true if a new day was inserted
+    bool erase(int day);                            // Returns true if a record was removed
+    // incoming must be sorted by day without duplicates; returns the number of newly inserted days
+    size_t upsertSorted(const HistoricalRecord* incoming, size_t count);
+    Range range(int firstDay, int lastDay) const;
+
+private:
+    std::pmr::vector<HistoricalRecord> records;
+};
+
 // ------------------------------------------------------------------------------------
 // [结构体] Region
 // 描述: 地区/城市实体
@@ -88,25 +159,285 @@ struct HistoricalRecord {
 // ------------------------------------------------------------------------------------
 struct Region {
     char name[128];
-    int population;
-    
-    // Manually entered data (current state)
-    int confirmedCases;
-    int recoveredCases;
-    int deaths;
 
-    // Historical data for prediction calibration
-    std::vector<HistoricalRecord> history;
+    // Historical data for prediction calibration.
+    // A background snapshot may be reading this buffer: modify it through EpidemicData
+    // (edit calls or getMutableHistory), which copies it first when needed.
+    HistorySeries history;
+    uint64_t historyEpoch; // Snapshot epoch at which the current history buffer became live
 
     // Simulation model for this region
     SIRModel simulation;
 
-    // Default constructor
+    // Default constructor (heap storage); EpidemicData passes its region arena
     Region();
+    explicit Region(std::pmr::memory_resource* resource);
+    // Standalone region outside any EpidemicData (benchmarks, calibration inputs)
+    Region(int population, int confirmed, int recovered, int deaths);
+
+    // Current state, read-only: EpidemicData's edit calls are the only writers, so the hot
+    // columns and the rollups it keeps beside the regions never disagree with them
+    int getPopulation() const { return population; }
+    int getConfirmedCases() const { return confirmedCases; }
+    int getRecoveredCases() const { return recoveredCases; }
+    int getDeaths() const { return deaths; }
 
     // Calibration methods
     double calculateAverageBeta() const;
     double calculateAverageGamma() const;
+
+    // Forecast origin: the day after the last history record, or day 0 from the current state
+    void getForecastOrigin(int& startDay, int& infected, int& removed) const;
+
+private:
+    friend class EpidemicData;
+
+    int population;
+
+    // Manually entered data (current state)
+    int confirmedCases;
+    int recoveredCases;
+    int deaths;
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] RegionHandle
+// 描述: 地区的稳定句柄 (槽位 + 代数)
+// 作用:
+//   地区在 getRegions() 中的下标会随删除变化 (其后的地区前移一位)，指针会随扩容失效；
+//   句柄在地区存在期间始终指向同一个地区。地区删除后槽位的代数加一，旧句柄解析为 -1，
+//   不会悄悄指向另一个地区。
+// ------------------------------------------------------------------------------------
+struct RegionHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool isNull() const { return slot == UINT32_MAX; }
+    bool operator==(const RegionHandle& o) const { return slot == o.slot && generation == o.generation; }
+    bool operator!=(const RegionHandle& o) const { return !(*this == o); }
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] RegionTotals
+// 描述: 全部地区的汇总 (总览页)，由 RegionColumns 随每次修改增量维护
+// ------------------------------------------------------------------------------------
+struct RegionTotals {
+    size_t regions = 0;
+    long long population = 0;
+    long long confirmed = 0;
+    long long recovered = 0;
+    long long deaths = 0;
+
+    long long active() const { return confirmed - recovered - deaths; }
+    bool operator==(const RegionTotals& o) const {
+        return regions == o.regions && population == o.population && confirmed == o.confirmed &&
+               recovered == o.recovered && deaths == o.deaths;
+    }
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] RegionColumns
+// 描述: 地区表的热数据列 (结构数组)
+// 作用:
+//   Region 是体积较大的行对象 (128 字节名称、历史记录、SIR 模型)，而总览统计、风险筛选等每帧扫描
+//   只用到人口与三个累计数。EpidemicData 把这四个字段另外按列连续存放 (下标与 getRegions() 一致)，
+//   扫描时每条缓存行都是有用数据；名称、历史与模型等冷数据仍留在 Region 中。
+//   每个地区的风险等级也缓存在这里，只在其人口或累计数变化时重新计算；同一等级的地区由
+//   侵入式双向链表 (按下标链接) 串起来，按等级筛选只遍历该等级的地区，各等级的地区数随时可读。
+//   全部地区的人口与累计数之和同样随每行的增删改加减，总览页直接读取，不再每帧扫描。
+// ------------------------------------------------------------------------------------
+struct RegionColumns {
+    std::vector<int32_t> population;
+    std::vector<int32_t> confirmed;
+    std::vector<int32_t> recovered;
+    std::vector<int32_t> deaths;
+    std::vector<RiskLevel> risk;                    // Cached EpidemicData::calculateRiskLevel of each row
+
+    size_t size() const { return population.size(); }
+    void push_back(const Region& region);
+    void set(size_t index, const Region& region);   // Re-classifies only if a count differs
+    void erase(size_t index);                       // Later rows move down by one
+    void clear();
+    void reserve(size_t count);
+    void resize(size_t count);
+
+    // Risk buckets
+    size_t riskCount(RiskLevel level) const { return bucketSize[static_cast<int>(level)]; }
+    int32_t riskFirst(RiskLevel level) const { return bucketHead[static_cast<int>(level)]; }
+    int32_t riskNext(size_t index) const { return next[index]; }  // -1 at the end of the bucket
+    void collectRisk(RiskLevel level, std::vector<uint32_t>& out) const; // Appends the bucket, in bucket order
+    uint64_t getRiskVersion() const { return riskVersion; }          // Changes whenever a bucket's members change
+
+    // Sums over all rows, adjusted by every row change
+    const RegionTotals& getTotals() const { return totals; }
+
+private:
+    void addToTotals(size_t index, int sign);
+    void link(size_t index, RiskLevel level);
+    void unlink(size_t index);
+    void relinkAll();
+
+    std::vector<int32_t> prev;
+    std::vector<int32_t> next;
+    int32_t bucketHead[3] = { -1, -1, -1 };
+    size_t bucketSize[3] = { 0, 0, 0 };
+    uint64_t riskVersion = 0;
+    RegionTotals totals;
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] RollupCounts / RollupDelta / RollupDay
+// 描述: 分组汇总 (64 位，十万个地区相加不会溢出)
+// ------------------------------------------------------------------------------------
+struct RollupCounts {
+    long long population = 0;
+    long long confirmed = 0;
+    long long recovered = 0;
+    long long deaths = 0;
+};
+
+struct RollupDelta {
+    long long confirmed = 0;
+    long long recovered = 0;
+    long long deaths = 0;
+
+    bool isZero() const { return confirmed == 0 && recovered == 0 && deaths == 0; }
+};
+
+struct RollupDay {
+    int day;
+    long long confirmed;
+    long long recovered;
+    long long deaths;
+};
+
+// ------------------------------------------------------------------------------------
+// [类] RegionTree
+// 描述: 地区层级 (国家 → 省 → 市 → 区县) 与各级分组的汇总
+// 作用:
+//   层级取自地区名称中的路径: "湖北省/武汉市/江岸区" 属于分组 "湖北省/武汉市"，它又属于 "湖北省"，
+//   根分组包含全部地区。改名即移动到另一个分组；层级随名称一起保存在快照与编辑日志中。
+//   每个分组保存其下全部地区的人口与当前累计数之和，以及逐日累计数之和 (各地区的记录向后延续到
+//   下一条记录后相加)。逐日汇总按变化量存储，汇总序列是变化量的前缀和: 一条记录的增删改只改变
+//   该地区延续值在两个日期上的变化量，所以只需更新其 O(深度) 个祖先分组，不必重新相加。
+//   EpidemicData 在每个编辑接口中同步维护 (批量操作期间暂停，结束时整体重建)。
+// ------------------------------------------------------------------------------------
+class RegionTree {
+public:
+    static const char Separator = '/';
+    static const int Root = 0;
+
+    struct Group {
+        std::string path;                       // "湖北省/武汉市"; empty for the root
+        int32_t parent = -1;
+        int depth = 0;
+        bool live = false;                      // Released groups wait in the free list
+        std::vector<int32_t> children;          // Child groups
+        std::vector<uint32_t> members;          // Regions directly in this group (region indices)
+        size_t regions = 0;                     // Regions anywhere below
+        RollupCounts totals;
+        int firstDay = 0;                       // Day of changes[0]
+        std::vector<RollupDelta> changes;       // Per day: summed change of the regions' carried-forward counts
+        uint32_t slotInParent = 0;              // Position in the parent's children
+    };
+
+    RegionTree();
+
+    // Queries
+    const Group& getGroup(int id) const { return groups[id]; }
+    bool isLive(int id) const { return id >= 0 && static_cast<size_t>(id) < groups.size() && groups[id].live; }
+    size_t getGroupCount() const { return groups.size() - freeGroups.size(); }
+    int findGroup(const std::string& path) const;           // -1 if no region is under that path
+    int getRegionGroup(size_t region) const { return regionGroup[region]; }
+    // Day-by-day sums of the group's regions, one entry per day from the first to the last change
+    void getHistory(int group, std::vector<RollupDay>& out) const;
+    static std::string ParentPath(const char* name);         // Group of a region with this name
+    static const char* LeafName(const char* path);           // Last path component
+
+    // Maintenance (EpidemicData)
+    void clear();
+    void rebuild(const std::vector<Region>& regions);
+    void addRegion(const Region& region);                    // Appended as the last region
+    void removeRegion(size_t index, const Region& region);   // The later regions then move down by one
+    void renameRegion(size_t index, const Region& region);   // region already carries its new name
+    void addCounts(size_t index, const RollupCounts& delta);
+    // A history edit is sampled around the edited days before and after; the difference goes to the ancestors
+    void beginHistoryEdit(const HistorySeries& history, const HistoricalRecord* records, size_t count);
+    void beginHistoryEdit(const HistorySeries& history, int day);
+    void endHistoryEdit(size_t index, const HistorySeries& history);
+
+private:
+    int ensureGroup(const std::string& path);
+    void releaseIfEmpty(int id);
+    void attach(size_t index, int group);
+    void detach(size_t index);
+    // sign = +1 / -1: the region's counts and history changes, into group and (if ancestors) all above it
+    void addContribution(int group, const Region& region, int sign, bool ancestors);
+    void addChange(int group, int day, const RollupDelta& delta);
+    static void AddChangeAt(Group& group, int day, const RollupDelta& delta);
+    void sampleEditDays(const HistorySeries& history);
+
+    std::vector<Group> groups;
+    std::vector<int32_t> freeGroups;
+    std::unordered_map<std::string, int32_t> byPath;
+    std::vector<int32_t> regionGroup;                        // Parallel to the regions
+    std::vector<uint32_t> memberPos;                         // Position in the group's members
+    std::vector<int> editDays;                               // Edit in progress
+    std::vector<RollupDelta> editBefore;
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] DataSnapshot
+// 描述: 数据模型在某一时刻的只读快照 (写时复制)
+// 作用:
+//   EpidemicData::captureSnapshot() 只复制每个地区的名称和当前计数，历史记录不复制，
+//   而是直接引用各地区现有的历史缓冲区。快照存活期间，UI 对某个地区历史的第一次修改
+//   会把旧缓冲区整体移交给快照 (retired) 并在副本上修改，因此后台线程读到的始终是截取时的内容。
+//   快照可以交给任意线程读取，但必须在 UI 线程之外也保持 shared_ptr 存活直到读完。
+// ------------------------------------------------------------------------------------
+struct DataSnapshot {
+    struct Row {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        int population;
+        int confirmed;
+        int recovered;
+        int deaths;
+        const HistoricalRecord* history;
+        size_t historyCount;
+    };
+
+    uint64_t epoch = 0;
+    std::vector<Row> rows;
+    std::string names;                      // Packed names, rows index into it
+    size_t recordCount = 0;
+    // The arena the retired buffers below return to when the last reader lets go (declared first: outlives them)
+    std::shared_ptr<std::pmr::memory_resource> arena;
+    // Buffers handed over by edits made after the capture (kept alive, never read directly)
+    std::vector<std::shared_ptr<HistorySeries>> retired;
+
+    const char* getName(const Row& row) const { return names.data() + row.nameOffset; }
+};
+
+// ------------------------------------------------------------------------------------
+// [接口] DataChangeListener
+// 描述: 数据变更监听器
+// 作用:
+//   EpidemicData 的每个修改接口在修改完成后通知已注册的监听器 (如编辑日志)。
+//   批量操作 (导入、载入数据文件) 期间不逐条通知，结束时只发出一次 onBulkChange。
+// ------------------------------------------------------------------------------------
+class DataChangeListener {
+public:
+    virtual ~DataChangeListener() {}
+    virtual void onRegionAdded(int /*index*/, const Region& /*region*/) {}
+    // The region at index is gone and every later region moved down by one
+    virtual void onRegionDeleted(int /*index*/) {}
+    virtual void onRegionRenamed(int /*index*/, const char* /*name*/) {}
+    virtual void onPopulationChanged(int /*index*/, int /*population*/) {}
+    virtual void onCountsChanged(int /*index*/, int /*confirmed*/, int /*recovered*/, int /*deaths*/) {}
+    virtual void onHistoryUpserted(int /*index*/, const HistoricalRecord& /*record*/) {}
+    virtual void onHistoryDeleted(int /*index*/, int /*day*/) {}
+    virtual void onBulkChange() {}
 };
 
 // ------------------------------------------------------------------------------------
@@ -122,15 +453,86 @@ public:
 
     // Region management
     void addRegion(const char* name, int population, int confirmed, int recovered, int deaths);
+    // Keeps the order: the later regions move down by one (see onRegionDeleted)
     void deleteRegion(int index);
+    void clearRegions();
+    void reserveRegions(size_t count); // Bulk loaders call this before a run of addRegion()
+    // Replaces every region with those of a model filled off the UI thread (outside any bulk update of
+    // its own; loaded is left empty).
+    // Only containers are exchanged and handles issued: O(regions), no history is copied.
+    // Listeners see one onBulkChange, as for a bulk load.
+    void adoptRegions(EpidemicData& loaded);
     Region* getRegion(int index);
     std::vector<Region>& getRegions();
 
+    // Stable handles: survive other regions being added or deleted; stale once their region is deleted
+    RegionHandle getHandle(int index) const;
+    int resolve(RegionHandle handle) const;          // Current index, -1 if stale or null
+    Region* getRegion(RegionHandle handle);
+    // Hot columns of the regions' current counts, kept in step by every edit call (the counts are
+    // only writable through them, see Region)
+    const RegionColumns& getColumns() const { return columns; }
+    // Region hierarchy from the name paths with its rollups, kept in step by every edit call and
+    // rebuilt once by endBulkUpdate()
+    const RegionTree& getTree() const { return tree; }
+    // O(1) copy of the maintained sums; debug builds check them against a recount of the regions
+    RegionTotals getTotals() const;
+    RegionTotals recountTotals() const;
+
+    // Edits (notify listeners); history edits also refresh the current state from the last record
+    void renameRegion(int index, const char* name);
+    void setRegionPopulation(int index, int population);
+    // Current state set directly (undo restoring the counts a history edit replaced)
+    void setRegionCounts(int index, int confirmed, int recovered, int deaths);
+    void upsertHistoryRecord(int index, const HistoricalRecord& record);
+    // Merges a run of records sorted by day in one pass; listeners still see one upsert per record
+    void upsertHistoryRecords(int index, const HistoricalRecord* records, size_t count);
+    void deleteHistoryRecord(int index, int day);
+
+    // Copy-on-write access: copies the history first if a live snapshot still references it
+    HistorySeries& getMutableHistory(int index);
+
+    // O(regions) capture for background serialization; histories are shared, not copied
+    std::shared_ptr<DataSnapshot> captureSnapshot();
+
+    // Change notification
+    void addChangeListener(DataChangeListener* listener);
+    void removeChangeListener(DataChangeListener* listener);
+    // Between begin/end no per-edit notifications are sent; end sends one onBulkChange
+    void beginBulkUpdate();
+    void endBulkUpdate();
+
     // Utility
     static const char* getRiskLevelString(RiskLevel level);
     static ImVec4 getRiskLevelColor(RiskLevel level);
     static RiskLevel calculateRiskLevel(const Region& region);
+    static RiskLevel calculateRiskLevel(int population, int confirmed, int recovered, int deaths);
 
 private:
+    bool notifying() const { return bulkDepth == 0 && !listeners.empty(); }
+    bool rollingUp() const { return bulkDepth == 0; }
+    // Hands a history buffer that live snapshots still reference over to them; keepCopy leaves a copy in place
+    void retireHistory(Region& region, bool keepCopy);
+    void refreshCurrentState(int index);
+
+    // Histories and trajectories of the regions (declared first: outlives them; snapshots share it)
+    std::shared_ptr<std::pmr::memory_resource> arena;
     std::vector<Region> regions;
+    RegionColumns columns;                              // Hot copy of the counts in regions, written with them
+    RegionTree tree;                                    // Paused during bulk updates
+
+    // Slot map behind RegionHandle
+    struct Slot {
+        uint32_t index;                                 // Into regions while live
+        uint32_t generation;                            // Bumped when the slot's region is deleted
+    };
+    uint32_t allocateSlot(uint32_t index);
+    void releaseSlot(uint32_t slot);
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<uint32_t> regionSlots;                  // Slot of each region, parallel to regions
+    std::vector<DataChangeListener*> listeners;
+    int bulkDepth;
+    uint64_t snapshotEpoch;                             // Incremented by every capture
+    std::vector<std::weak_ptr<DataSnapshot>> snapshots; // Captures that may still be read
 };
@@ -0,0 +1,243 @@
+// ====================================================================================
+// 模块名称: InterventionOptimizer Implementation
+// 功能描述:
+//   实现分段 beta(t) 的模拟、带惩罚的目标函数以及 sep-CMA-ES 的均值/步长/对角协方差更新。
+// ====================================================================================
+
+#include "InterventionOptimizer.h"
+#include "ThreadPool.h"
+#include <algorithm> // For std::sort, std::min, std::max
+#include <chrono>
+#include <cmath>     // For std::sqrt, std::log, std::exp
+#include <numeric>   // For std::iota
+#include <random>
+
+namespace {
+
+int SegmentCount(const InterventionConfig& config) {
+    return std::max(1, (config.days + config.segmentDays - 1) / config.segmentDays);
+}
+
+double ClampReduction(double x, double maxReduction) {
+    return std::min(std::max(x, 0.0), maxReduction);
+}
+
+// [算法] 目标函数 (Objective)
+// 逻辑:
+//   代价 = Σ r_k^2 * 段长；峰值超过容量时按超出比例施加大惩罚，使不可行方案总是劣于可行方案；
+//   候选点越过 [0, maxReduction] 边界时再加上到边界距离的平方惩罚，引导搜索回到可行域。
+double Objective(const InterventionConfig& config, const double* x, double* clamped, SIRModel& model,
+                 double* peakOut) {
+    const int segments = SegmentCount(config);
+    double cost = 0.0;
+    double boundary = 0.0;
+    for (int k = 0; k < segments; ++k) {
+        clamped[k] = ClampReduction(x[k], config.maxReduction);
+        boundary += (x[k] - clamped[k]) * (x[k] - clamped[k]);
+        int length = std::min(config.segmentDays, config.days - k * config.segmentDays);
+        cost += clamped[k] * clamped[k] * length;
+    }
+    double peak = InterventionOptimizer::Simulate(config, clamped, model);
+    if (peakOut) *peakOut = peak;
+
+    double penalty = 0.0;
+    if (peak > config.capacity) {
+        penalty = 1000.0 + 100.0 * config.days * (peak - config.capacity) / config.capacity;
+    }
+    return cost + penalty + 10.0 * boundary;
+}
+
+} // namespace
+
+InterventionOptimizer::InterventionOptimizer() : running(false), cancelRequested(false), generation(0) {}
+
+InterventionOptimizer::~InterventionOptimizer() {
+    cancel();
+    if (worker.joinable()) worker.join();
+}
+
+double InterventionOptimizer::Simulate(const InterventionConfig& config, const double* reductions, SIRModel& model) {
+    const int segments = SegmentCount(config);
+    model.setGamma(config.gamma);
+    model.reset(config.population, config.initialInfected, config.initialRemoved, config.startDay);
+
+    double peak = model.getCurrentData().infected;
+    for (int k = 0; k < segments; ++k) {
+        int length = std::min(config.segmentDays, config.days - k * config.segmentDays);
+        model.setBeta(config.baseBeta * (1.0 - reductions[k]));
+        // Each step continues from the current state, so segments chain naturally
+        for (int d = 0; d < length; ++d) {
+            model.run_single_step();
+            peak = std::max(peak, model.getCurrentData().infected);
+        }
+    }
+    return peak;
+}
+
+// [算法] sep-CMA-ES (Ros & Hansen, 2008)
+// 核心逻辑:
+//   1. 采样: x_i = m + sigma * sqrt(C) ⊙ z_i, z_i ~ N(0, I)，C 为对角协方差。
+//   2. 并行评估全部 λ 个候选，按目标值排序，取前 μ 个加权重组得到新均值。
+//   3. 累积路径 p_sigma 控制步长 sigma (CSA)，p_c 与秩-μ 更新共同调整对角协方差。
+//   对角协方差使每代更新为 O(λn)，适合 365 天 / 14 天一段这类几十维的问题。
+InterventionPlan InterventionOptimizer::run(const InterventionConfig& config, std::atomic<int>* generationOut,
+                                            const std::atomic<bool>* cancelFlag) {
+    InterventionPlan plan;
+    if (config.population <= 0 || config.days <= 0 || config.segmentDays <= 0) return plan;
+
+    auto startTime = std::chrono::steady_clock::now();
+    ThreadPool& pool = ThreadPool::instance();
+    const unsigned workerCount = pool.getWorkerCount();
+    const int n = SegmentCount(config);
+
+    // Strategy parameters
+    int lambda = config.populationSize > 0 ? config.populationSize
+                                           : 4 + static_cast<int>(3.0 * std::log(static_cast<double>(n)));
+    lambda = std::max(lambda, static_cast<int>(2 * workerCount)); // Keep every core busy
+    const int mu = lambda / 2;
+    std::vector<double> weights(mu);
+    double weightSum = 0.0;
+    for (int i = 0; i < mu; ++i) {
+        weights[i] = std::log(mu + 0.5) - std::log(i + 1.0);
+        weightSum += weights[i];
+    }
+    double weightSqSum = 0.0;
+    for (auto& w : weights) {
+        w /= weightSum;
+        weightSqSum += w * w;
+    }
+    const double muEff = 1.0 / weightSqSum;
+    const double cSigma = (muEff + 2.0) / (n + muEff + 5.0);
+    const double dSigma = 1.0 + 2.0 * std::max(0.0, std::sqrt((muEff - 1.0) / (n + 1.0)) - 1.0) + cSigma;
+    const double cc = 4.0 / (n + 4.0);
+    const double c1 = 2.0 / ((n + 1.3) * (n + 1.3) + muEff) * (n + 2.0) / 3.0;
+    const double cMu = std::min(1.0 - c1, 2.0 * (muEff - 2.0 + 1.0 / muEff) / ((n + 2.0) * (n + 2.0) + muEff) * (n + 2.0) / 3.0);
+    const double chiN = std::sqrt(static_cast<double>(n)) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+    // Buffers allocated once and reused by every generation
+    std::vector<double> mean(n, 0.3), diagC(n, 1.0), pSigma(n, 0.0), pc(n, 0.0), yw(n);
+    std::vector<double> z(static_cast<size_t>(lambda) * n), x(static_cast<size_t>(lambda) * n);
+    std::vector<double> clamped(static_cast<size_t>(lambda) * n);
+    std::vector<double> fitness(lambda);
+    std::vector<int> order(lambda);
+    std::vector<double> bestX(n, 0.0);
+    std::vector<SIRModel> models(workerCount);
+    for (auto& model : models) {
+        Simulate(config, bestX.data(), model); // Warm-up: grow each model's history to full length
+    }
+    double bestFitness = Objective(config, bestX.data(), clamped.data(), models[0], &plan.uncontrolledPeak);
+    double sigma = 0.2;
+
+    std::mt19937_64 rng(config.seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    long long evaluations = 1;
+    int gen = 0;
+
+    for (; gen < config.maxGenerations; ++gen) {
+        if (cancelFlag && cancelFlag->load()) break;
+        if (generationOut) generationOut->store(gen);
+
+        for (int i = 0; i < lambda; ++i) {
+            for (int j = 0; j < n; ++j) {
+                double zij = normal(rng);
+                z[i * n + j] = zij;
+                x[i * n + j] = mean[j] + sigma * std::sqrt(diagC[j]) * zij;
+            }
+        }
+
+        pool.parallelFor(lambda, [&](size_t begin, size_t end, unsigned w) {
+            for (size_t i = begin; i < end; ++i) {
+                fitness[i] = Objective(config, &x[i * n], &clamped[i * n], models[w], nullptr);
+            }
+        });
+        evaluations += lambda;
+
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return fitness[a] < fitness[b]; });
+        if (fitness[order[0]] < bestFitness) {
+            bestFitness = fitness[order[0]];
+            for (int j = 0; j < n; ++j) bestX[j] = clamped[order[0] * n + j];
+        }
+
+        // Recombination: weighted mean of the best mu candidates
+        for (int j = 0; j < n; ++j) {
+            double newMean = 0.0;
+            for (int i = 0; i < mu; ++i) newMean += weights[i] * x[order[i] * n + j];
+            yw[j] = (newMean - mean[j]) / sigma;
+            mean[j] = newMean;
+        }
+
+        // Step-size path and covariance path
+        double pSigmaNorm2 = 0.0;
+        for (int j = 0; j < n; ++j) {
+            pSigma[j] = (1.0 - cSigma) * pSigma[j] + std::sqrt(cSigma * (2.0 - cSigma) * muEff) * yw[j] / std::sqrt(diagC[j]);
+            pSigmaNorm2 += pSigma[j] * pSigma[j];
+        }
+        const double pSigmaNorm = std::sqrt(pSigmaNorm2);
+        const bool hSigma = pSigmaNorm / std::sqrt(1.0 - std::pow(1.0 - cSigma, 2.0 * (gen + 1))) < (1.4 + 2.0 / (n + 1.0)) * chiN;
+
+        double maxStd = 0.0;
+        for (int j = 0; j < n; ++j) {
+            pc[j] = (1.0 - cc) * pc[j] + (hSigma ? std::sqrt(cc * (2.0 - cc) * muEff) * yw[j] : 0.0);
+            double rankMu = 0.0;
+            for (int i = 0; i < mu; ++i) {
+                double y = z[order[i] * n + j] * std::sqrt(diagC[j]);
+                rankMu += weights[i] * y * y;
+            }
+            diagC[j] = (1.0 - c1 - cMu) * diagC[j]
+                     + c1 * (pc[j] * pc[j] + (hSigma ? 0.0 : cc * (2.0 - cc) * diagC[j]))
+                     + cMu * rankMu;
+            maxStd = std::max(maxStd, std::sqrt(diagC[j]));
+        }
+        sigma *= std::exp((cSigma / dSigma) * (pSigmaNorm / chiN - 1.0));
+
+        if (sigma * maxStd < 1e-4) {
+            ++gen;
+            break;
+        }
+    }
+
+    // Final course of the best plan
+    SIRModel& model = models[0];
+    plan.reductions = bestX;
+    plan.peakInfected = Simulate(config, bestX.data(), model);
+    plan.trajectory.assign(model.getHistory().begin(), model.getHistory().end());
+    plan.feasible = plan.peakInfected <= config.capacity;
+    plan.cost = 0.0;
+    for (int k = 0; k < n; ++k) {
+        int length = std::min(config.segmentDays, config.days - k * config.segmentDays);
+        plan.cost += bestX[k] * bestX[k] * length;
+    }
+    plan.generations = gen;
+    plan.evaluations = evaluations;
+    plan.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    plan.evaluationsPerSecond = (plan.elapsedSeconds > 0.0) ? evaluations / plan.elapsedSeconds : 0.0;
+    plan.valid = true;
+    return plan;
+}
+
+void InterventionOptimizer::start(const InterventionConfig& config) {
+    if (running.load()) return;
+    if (worker.joinable()) worker.join();
+
+    cancelRequested = false;
+    generation = 0;
+    running = true;
+    worker = std::thread([this, config]() {
+        InterventionPlan p = run(config, &generation, &cancelRequested);
+        {
+            std::lock_guard<std::mutex> lock(resultMutex);
+            result = std::move(p);
+        }
+        running = false;
+    });
+}
+
+void InterventionOptimizer::cancel() { cancelRequested = true; }
+bool InterventionOptimizer::isRunning() const { return running.load(); }
+int InterventionOptimizer::getGeneration() const { return generation.load(); }
+
+InterventionPlan InterventionOptimizer::getResult() {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    return result;
+}
@@ -0,0 +1,84 @@
+// ====================================================================================
+// 模块名称: InterventionOptimizer (干预方案优化器)
+// 功能描述:
+//   在分段常数的传染率 beta(t) 上搜索"代价最小"的防控方案，使活跃病例峰值不超过容量上限。
+//   使用可分离协方差的 CMA-ES (sep-CMA-ES)；每一代的候选方案在线程池上并行评估，
+//   每个工作线程复用自己的 SIRModel，迭代过程中不再分配内存。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] InterventionConfig / InterventionPlan
+// 描述: 优化问题定义与最优方案
+// 作用:
+//   第 k 段的传染率为 baseBeta * (1 - reduction[k])。
+//   代价 = Σ reduction[k]^2 * 段长(天)，即越强的措施代价增长越快；峰值超出容量时施加惩罚。
+// ------------------------------------------------------------------------------------
+struct InterventionConfig {
+    int population = 0;
+    int initialInfected = 1;
+    int initialRemoved = 0;
+    int startDay = 0;
+    double baseBeta = 0.3;
+    double gamma = 0.1;
+    int days = 365;
+    int segmentDays = 14;
+    double capacity = 10000;     // Maximum allowed active infections
+    double maxReduction = 0.9;   // Upper bound for any segment's beta reduction
+    int populationSize = 0;      // Candidates per generation, 0 = automatic
+    int maxGenerations = 2000;
+    unsigned long long seed = 2024;
+};
+
+struct InterventionPlan {
+    bool valid = false;
+    bool feasible = false;
+    std::vector<double> reductions;       // One value per segment
+    std::vector<SIRDataPoint> trajectory; // Simulated course under the plan
+    double cost = 0;
+    double peakInfected = 0;
+    double uncontrolledPeak = 0;
+    int generations = 0;
+    long long evaluations = 0;
+    double elapsedSeconds = 0;
+    double evaluationsPerSecond = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [类] InterventionOptimizer
+// 描述: 基于 sep-CMA-ES 的干预方案搜索
+// 作用: run() 同步优化；start() 在后台线程优化，UI 轮询 getGeneration()/isRunning()。
+// ------------------------------------------------------------------------------------
+class InterventionOptimizer {
+public:
+    InterventionOptimizer();
+    ~InterventionOptimizer();
+
+    static InterventionPlan run(const InterventionConfig& config,
+                                std::atomic<int>* generationOut = nullptr,
+                                const std::atomic<bool>* cancelFlag = nullptr);
+
+    // Runs the piecewise-constant beta schedule and returns the peak active infections
+    static double Simulate(const InterventionConfig& config, const double* reductions, SIRModel& model);
+
+    void start(const InterventionConfig& config);
+    void cancel();
+    bool isRunning() const;
+    int getGeneration() const;
+    InterventionPlan getResult();
+
+private:
+    std::thread worker;
+    std::mutex resultMutex;
+    InterventionPlan result;
+    std::atomic<bool> running;
+    std::atomic<bool> cancelRequested;
+    std::atomic<int> generation;
+};
@@ -0,0 +1,633 @@
+// ====================================================================================
+// 模块名称: Journal Implementation
+// 功能描述:
+//   记录编码/解码、组提交写出线程、后台压缩 (快照 + 切换日志) 以及启动时的快照加载与日志重放。
+// ====================================================================================
+
+#include "Journal.h"
+#include "ColumnarStore.h"
+#include "Crc32.h"
+#include "MappedFile.h"
+#include <algorithm>  // For std::nth_element, std::max, std::min
+#include <cstring>    // For std::memcpy, std::memcmp, strnlen
+#include <filesystem> // For std::filesystem::resize_file, temp_directory_path
+#include <random>
+
+namespace {
+
+struct JournalFileHeader {
+    char magic[8];                        // "EPIJRNL\0"
+    uint32_t version;
+    uint32_t reserved;
+};
+static_assert(sizeof(JournalFileHeader) == 16, "JournalFileHeader must stay 16 bytes");
+
+const char kMagic[8] = { 'E', 'P', 'I', 'J', 'R', 'N', 'L', '\0' };
+const size_t kRecordPrefix = 8;           // u32 length + u32 crc
+const size_t kRecordHead = 9;             // u8 type + u64 lsn (covered by length and crc)
+const size_t kLatencyRing = 4096;
+
+bool WriteFileHeader(std::FILE* f) {
+    JournalFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = Journal::FormatVersion;
+    return std::fwrite(&header, sizeof(header), 1, f) == 1;
+}
+
+// Fixed-capacity payload encoder (the largest record is a 127-byte name plus a few ints)
+class PayloadWriter {
+public:
+    PayloadWriter() : size(0) {}
+    void i32(int32_t v) { std::memcpy(buffer + size, &v, 4); size += 4; }
+    void name(const char* s) {
+        uint16_t n = static_cast<uint16_t>(strnlen(s, 127));
+        std::memcpy(buffer + size, &n, 2);
+        std::memcpy(buffer + size + 2, s, n);
+        size += 2 + n;
+    }
+    const unsigned char* data() const { return buffer; }
+    size_t length() const { return size; }
+
+private:
+    unsigned char buffer[192];
+    size_t size;
+};
+
+// Bounds-checked payload decoder; any overrun marks the record as malformed
+class PayloadReader {
+public:
+    PayloadReader(const unsigned char* p, size_t n) : cursor(p), end(p + n), ok(true) {}
+    int32_t i32() {
+        int32_t v = 0;
+        if (end - cursor < 4) { ok = false; return 0; }
+        std::memcpy(&v, cursor, 4);
+        cursor += 4;
+        return v;
+    }
+    void name(char* out, size_t capacity) {
+        uint16_t n = 0;
+        if (end - cursor < 2) { ok = false; out[0] = '\0'; return; }
+        std::memcpy(&n, cursor, 2);
+        cursor += 2;
+        if (n >= capacity || end - cursor < n) { ok = false; out[0] = '\0'; return; }
+        std::memcpy(out, cursor, n);
+        out[n] = '\0';
+        cursor += n;
+    }
+    bool finished() const { return ok && cursor == end; }
+
+private:
+    const unsigned char* cursor;
+    const unsigned char* end;
+    bool ok;
+};
+
+bool ApplyRecord(uint8_t type, const unsigned char* payload, size_t bytes, EpidemicData& data) {
+    PayloadReader in(payload, bytes);
+    char name[128];
+    switch (type) {
+    case JournalRecord_AddRegion: {
+        in.name(name, sizeof(name));
+        int population = in.i32(), confirmed = in.i32(), recovered = in.i32(), deaths = in.i32();
+        if (!in.finished()) return false;
+        data.addRegion(name, population, confirmed, recovered, deaths);
+        return true;
+    }
+    case JournalRecord_DeleteRegion: {
+        int index = in.i32();
+        if (!in.finished()) return false;
+        data.deleteRegion(index);
+        return true;
+    }
+    case JournalRecord_RenameRegion: {
+        int index = in.i32();
+        in.name(name, sizeof(name));
+        if (!in.finished()) return false;
+        data.renameRegion(index, name);
+        return true;
+    }
+    case JournalRecord_SetPopulation: {
+        int index = in.i32(), population = in.i32();
+        if (!in.finished()) return false;
+        data.setRegionPopulation(index, population);
+        return true;
+    }
+    case JournalRecord_SetCounts: {
+        int index = in.i32(), confirmed = in.i32(), recovered = in.i32(), deaths = in.i32();
+        if (!in.finished()) return false;
+        data.setRegionCounts(index, confirmed, recovered, deaths);
+        return true;
+    }
+    case JournalRecord_UpsertHistory: {
+        int index = in.i32();
+        HistoricalRecord record;
+        record.day = in.i32();
+        record.confirmed = in.i32();
+        record.recovered = in.i32();
+        record.deaths = in.i32();
+        if (!in.finished()) return false;
+        data.upsertHistoryRecord(index, record);
+        return true;
+    }
+    case JournalRecord_DeleteHistory: {
+        int index = in.i32(), day = in.i32();
+        if (!in.finished()) return false;
+        data.deleteHistoryRecord(index, day);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+double Percentile(std::vector<float>& values, double q) {
+    if (values.empty()) return 0;
+    size_t k = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+bool SameData(EpidemicData& a, EpidemicData& b) {
+    const auto& x = a.getRegions();
+    const auto& y = b.getRegions();
+    if (x.size() != y.size()) return false;
+    for (size_t i = 0; i < x.size(); ++i) {
+        if (std::strcmp(x[i].name, y[i].name) != 0 || x[i].getPopulation() != y[i].getPopulation() ||
+            x[i].getConfirmedCases() != y[i].getConfirmedCases() || x[i].getRecoveredCases() != y[i].getRecoveredCases() ||
+            x[i].getDeaths() != y[i].getDeaths() || x[i].history.size() != y[i].history.size()) {
+            return false;
+        }
+        for (size_t k = 0; k < x[i].history.size(); ++k) {
+            const HistoricalRecord& p = x[i].history[k];
+            const HistoricalRecord& q = y[i].history[k];
+            if (p.day != q.day || p.confirmed != q.confirmed || p.recovered != q.recovered || p.deaths != q.deaths) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+Journal::Journal()
+    : target(nullptr), nextLsn(1), compactRequested(false), compactLsn(0), carrying(false),
+      rollRequested(false), stopRequested(false),
+      file(nullptr), appendSecondsTotal(0), latencyNext(0) {}
+
+Journal::~Journal() {
+    stop();
+}
+
+// [算法] 启动恢复 (Snapshot + Redo)
+// 逻辑:
+//   1. 映射列式快照，校验 CRC 后物化；快照头中的 journalSequence 是它已包含的最后一条日志的 LSN。
+//   2. 映射日志，逐条校验长度与 CRC，只重放 LSN 大于快照 LSN 的记录 (更早的记录在压缩时
+//      已并入快照，只是日志还没来得及清空)。
+//   3. 第一条不完整或校验失败的记录视为崩溃时写了一半的尾部: 停止重放并把日志截断到此处，
+//      之后的追加才不会接在坏数据后面。
+//   没有快照时日志中的地区下标没有参照对象，因此不重放，由 start() 重新建立快照。
+JournalRecovery Journal::Recover(const char* snapshotPath, const char* journalPath, EpidemicData& data) {
+    JournalRecovery result;
+    std::error_code ec;
+    auto t0 = Clock::now();
+    {
+        ColumnarStore store;
+        std::string error;
+        if (store.open(snapshotPath, &error) && store.verify(&error)) {
+            store.materialize(data);
+            result.recovered = true;
+            result.regions = store.getRegionCount();
+            result.snapshotLsn = store.getJournalSequence();
+        } else if (std::filesystem::exists(snapshotPath, ec)) {
+            // Keep the damaged file for inspection instead of letting the next snapshot overwrite it
+            store.close();
+            std::string aside = std::string(snapshotPath) + ".corrupt";
+            MoveFileReplacing(snapshotPath, aside.c_str());
+            result.error = "快照无法读取 (" + error + ")，已改名为 " + aside;
+        }
+    }
+    result.snapshotSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    result.lastLsn = result.snapshotLsn;
+    if (!result.recovered) return result;
+
+    size_t fileSize = 0;
+    size_t validBytes = 0;
+    auto t1 = Clock::now();
+    {
+        MappedFile journal;
+        if (!journal.open(journalPath)) return result;
+        const unsigned char* base = journal.getData();
+        fileSize = journal.getSize();
+
+        const JournalFileHeader* header = reinterpret_cast<const JournalFileHeader*>(base);
+        if (fileSize >= sizeof(JournalFileHeader) && std::memcmp(header->magic, kMagic, sizeof(kMagic)) == 0 &&
+            header->version == FormatVersion) {
+            const unsigned char* p = base + sizeof(JournalFileHeader);
+            const unsigned char* end = base + fileSize;
+            while (static_cast<size_t>(end - p) >= kRecordPrefix + kRecordHead) {
+                uint32_t length, crc;
+                std::memcpy(&length, p, 4);
+                std::memcpy(&crc, p + 4, 4);
+                if (length < kRecordHead || length > static_cast<size_t>(end - p) - kRecordPrefix) break;
+                const unsigned char* body = p + kRecordPrefix;
+                if (Crc32(body, length) != crc) break;
+
+                uint64_t lsn;
+                std::memcpy(&lsn, body + 1, 8);
+                if (lsn > result.snapshotLsn) {
+                    if (!ApplyRecord(body[0], body + kRecordHead, length - kRecordHead, data)) break;
+                    result.lastLsn = std::max(result.lastLsn, lsn);
+                    ++result.replayedRecords;
+                }
+                p = body + length;
+            }
+            validBytes = static_cast<size_t>(p - base);
+        }
+    }
+    result.replaySeconds = std::chrono::duration<double>(Clock::now() - t1).count();
+    if (result.replaySeconds > 0) result.recordsPerSecond = result.replayedRecords / result.replaySeconds;
+    result.regions = data.getRegions().size();
+
+    if (validBytes < fileSize) {
+        std::filesystem::resize_file(journalPath, validBytes, ec);
+        result.truncatedBytes = fileSize - validBytes;
+        result.error = ec ? "日志尾部已损坏且无法截断: " + ec.message()
+                          : "日志尾部不完整 (可能是上次异常退出)，已丢弃 " + std::to_string(result.truncatedBytes) + " 字节";
+    }
+    return result;
+}
+
+bool Journal::start(EpidemicData& data, const char* snapshot, const char* journal,
+                    const JournalRecovery& recovery, std::string* error) {
+    stop();
+    snapshotPath = snapshot;
+    journalPath = journal;
+
+    file = std::fopen(journal, "ab");
+    if (!file) {
+        if (error) *error = std::string("无法打开编辑日志: ") + journal;
+        return false;
+    }
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    if (size <= 0) {
+        if (!WriteFileHeader(file) || !SyncFile(file)) {
+            std::fclose(file);
+            file = nullptr;
+            if (error) *error = std::string("无法写入编辑日志: ") + journal;
+            return false;
+        }
+        size = sizeof(JournalFileHeader);
+    }
+
+    nextLsn = recovery.lastLsn + 1;
+    stats = JournalStats();
+    stats.open = true;
+    stats.appendedLsn = stats.durableLsn = recovery.lastLsn;
+    stats.snapshotLsn = recovery.snapshotLsn;
+    stats.journalBytes = static_cast<size_t>(size);
+    appendSecondsTotal = 0;
+    latencyMs.clear();
+    latencyNext = 0;
+    pending.clear();
+    pendingEdits.clear();
+    carrying = false;
+    carry.clear();
+    rollRequested = false;
+    stopRequested = false;
+
+    target = &data;
+    data.addChangeListener(this);
+    writer = std::thread(&Journal::writerLoop, this);
+
+    // Fold the replayed records into a fresh snapshot (or create the first one)
+    if (!recovery.recovered || recovery.replayedRecords > 0) compact();
+    return true;
+}
+
+void Journal::stop() {
+    if (!target) return;
+    target->removeChangeListener(this);
+    if (carrying) {
+        compactor.wait();
+        finishCompaction();
+    }
+    target = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    wake.notify_one();
+    if (writer.joinable()) writer.join();
+    if (file) std::fclose(file);
+    file = nullptr;
+    std::lock_guard<std::mutex> lock(mutex);
+    stats.open = false;
+}
+
+void Journal::maintain() {
+    if (!target) return;
+    if (carrying) {
+        if (!compactor.isRunning()) finishCompaction();
+        return;
+    }
+    size_t bytes;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bytes = stats.journalBytes + pending.size();
+    }
+    if (compactRequested || bytes >= CompactBytes) compact();
+}
+
+// [算法] 压缩 (Checkpoint)
+// 逻辑:
+//   1. UI线程上当前数据已经包含 LSN <= nextLsn-1 的全部编辑，截取写时复制快照并在后台
+//      写成列式文件，文件头记下这个 LSN。截取只复制各地区的计数，几乎不占用帧时间。
+//   2. 写出期间的新编辑照常追加并落盘到旧日志，同时另存一份到 carry。
+//   3. 快照落盘后，写出线程把 carry 写成新日志的临时文件，落盘后原子替换旧日志。
+//   任何一步之间崩溃都可以恢复: 旧快照 + 旧日志，或新快照 + 旧日志 (重放时跳过不大于
+//   快照 LSN 的记录)，或新快照 + 新日志。
+void Journal::compact() {
+    if (!target) return;
+    if (carrying) {
+        compactRequested = true; // Run again once the current one finishes
+        return;
+    }
+    compactRequested = false;
+    compactLsn = nextLsn - 1;
+    compactor.start(*target, snapshotPath, compactLsn);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    carrying = true;
+    carry.clear();
+    stats.compacting = true;
+}
+
+void Journal::finishCompaction() {
+    SnapshotSaveResult saved = compactor.getResult();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        carrying = false;
+        stats.compacting = false;
+        stats.lastCompactPauseMs = saved.pauseMs;
+        stats.lastCompactSeconds = saved.writeSeconds;
+        if (!saved.valid) {
+            stats.error = saved.error;
+            carry.clear();
+            return;
+        }
+        // Everything since the capture, already written to the old journal or not, goes to the new one
+        pending.swap(carry);
+        carry.clear();
+        rollRequested = true;
+        stats.snapshotLsn = compactLsn;
+        stats.durableLsn = std::max(stats.durableLsn, compactLsn);
+        stats.compactions++;
+    }
+    wake.notify_one();
+}
+
+void Journal::append(JournalRecordType type, const unsigned char* payload, size_t bytes) {
+    auto t0 = Clock::now();
+    const uint64_t lsn = nextLsn++;
+    unsigned char head[kRecordPrefix + kRecordHead];
+    uint32_t length = static_cast<uint32_t>(kRecordHead + bytes);
+    head[kRecordPrefix] = type;
+    std::memcpy(head + kRecordPrefix + 1, &lsn, 8);
+    uint32_t crc = Crc32(head + kRecordPrefix, kRecordHead);
+    crc = Crc32(payload, bytes, crc);
+    std::memcpy(head, &length, 4);
+    std::memcpy(head + 4, &crc, 4);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.insert(pending.end(), head, head + sizeof(head));
+        pending.insert(pending.end(), payload, payload + bytes);
+        if (carrying) {
+            carry.insert(carry.end(), head, head + sizeof(head));
+            carry.insert(carry.end(), payload, payload + bytes);
+        }
+        pendingEdits.push_back({ lsn, t0 });
+        stats.appendedLsn = lsn;
+        stats.edits++;
+        appendSecondsTotal += std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    wake.notify_one();
+}
+
+// [算法] 组提交 (Group Commit)
+// 逻辑:
+//   写出线程一次取走全部待写记录，写入并 fsync；在这次 fsync 期间到达的编辑
+//   继续积累在 pending 中，下一轮一起落盘。编辑越密集每批越大，fsync 次数不随编辑数增长，
+//   而UI线程的一次编辑只是一次内存追加，从不等待磁盘。
+void Journal::writerLoop() {
+    std::vector<unsigned char> batch;
+    std::vector<PendingEdit> edits;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopRequested || rollRequested || !pending.empty(); });
+        const bool roll = rollRequested;
+        const bool stopping = stopRequested;
+        rollRequested = false;
+        batch.swap(pending);
+        edits.swap(pendingEdits);
+        if (!roll && batch.empty() && stopping) break;
+        lock.unlock();
+
+        bool ok = true;
+        if (roll) {
+            // Build the new journal beside the old one and swap it in only once it is on disk
+            const std::string tempPath = journalPath + ".tmp";
+            std::FILE* next = std::fopen(tempPath.c_str(), "wb");
+            ok = next && WriteFileHeader(next);
+            ok = ok && (batch.empty() || std::fwrite(batch.data(), 1, batch.size(), next) == batch.size());
+            ok = ok && SyncFile(next);
+            if (next) std::fclose(next);
+            if (ok) {
+                if (file) std::fclose(file);
+                ok = MoveFileReplacing(tempPath.c_str(), journalPath.c_str());
+                file = std::fopen(journalPath.c_str(), "ab");
+                ok = ok && file;
+            }
+        } else {
+            ok = batch.empty() || std::fwrite(batch.data(), 1, batch.size(), file) == batch.size();
+            ok = ok && SyncFile(file);
+        }
+        auto now = Clock::now();
+
+        lock.lock();
+        if (ok) {
+            if (roll) stats.journalBytes = sizeof(JournalFileHeader);
+            stats.journalBytes += batch.size();
+            if (!edits.empty()) {
+                stats.durableLsn = std::max(stats.durableLsn, edits.back().lsn);
+                stats.batches++;
+                if (latencyMs.size() < kLatencyRing) latencyMs.resize(kLatencyRing);
+                for (const PendingEdit& e : edits) {
+                    latencyMs[latencyNext % kLatencyRing] = std::chrono::duration<float, std::milli>(now - e.appended).count();
+                    ++latencyNext;
+                }
+            }
+        } else {
+            stats.error = "写入编辑日志失败: " + journalPath;
+        }
+        batch.clear();
+        edits.clear();
+    }
+}
+
+JournalStats Journal::getStats() {
+    std::vector<float> samples;
+    JournalStats copy;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        copy = stats;
+        if (stats.edits > 0) copy.appendMicros = appendSecondsTotal / stats.edits * 1e6;
+        samples.assign(latencyMs.begin(), latencyMs.begin() + std::min(latencyNext, latencyMs.size()));
+    }
+    copy.commitP50Ms = Percentile(samples, 0.50);
+    copy.commitP99Ms = Percentile(samples, 0.99);
+    return copy;
+}
+
+// --- DataChangeListener ---
+
+void Journal::onRegionAdded(int /*index*/, const Region& region) {
+    PayloadWriter out;
+    out.name(region.name);
+    out.i32(region.getPopulation());
+    out.i32(region.getConfirmedCases());
+    out.i32(region.getRecoveredCases());
+    out.i32(region.getDeaths());
+    append(JournalRecord_AddRegion, out.data(), out.length());
+}
+
+void Journal::onRegionDeleted(int index) {
+    PayloadWriter out;
+    out.i32(index);
+    append(JournalRecord_DeleteRegion, out.data(), out.length());
+}
+
+void Journal::onRegionRenamed(int index, const char* name) {
+    PayloadWriter out;
+    out.i32(index);
+    out.name(name);
+    append(JournalRecord_RenameRegion, out.data(), out.length());
+}
+
+void Journal::onPopulationChanged(int index, int population) {
+    PayloadWriter out;
+    out.i32(index);
+    out.i32(population);
+    append(JournalRecord_SetPopulation, out.data(), out.length());
+}
+
+void Journal::onCountsChanged(int index, int confirmed, int recovered, int deaths) {
+    PayloadWriter out;
+    out.i32(index);
+    out.i32(confirmed);
+    out.i32(recovered);
+    out.i32(deaths);
+    append(JournalRecord_SetCounts, out.data(), out.length());
+}
+
+void Journal::onHistoryUpserted(int index, const HistoricalRecord& record) {
+    PayloadWriter out;
+    out.i32(index);
+    out.i32(record.day);
+    out.i32(record.confirmed);
+    out.i32(record.recovered);
+    out.i32(record.deaths);
+    append(JournalRecord_UpsertHistory, out.data(), out.length());
+}
+
+void Journal::onHistoryDeleted(int index, int day) {
+    PayloadWriter out;
+    out.i32(index);
+    out.i32(day);
+    append(JournalRecord_DeleteHistory, out.data(), out.length());
+}
+
+void Journal::onBulkChange() {
+    // Imports replace or merge whole regions: cheaper to snapshot than to log every record
+    compactRequested = true;
+}
+
+// --- Benchmark ---
+
+// [算法] 日志基准测试
+// 逻辑:
+//   在临时目录建立一个256个地区的数据集与日志，以最快速度连续调用编辑接口
+//   (以历史记录增改为主，混合删除、改人口、改名、增删地区)，测量UI线程侧每次编辑的开销
+//   和记录从追加到落盘的延迟；然后在一个空的数据集上完整恢复，测量重放速度并逐项核对结果。
+JournalBenchmarkResult Journal::RunBenchmark(size_t edits) {
+    namespace fs = std::filesystem;
+    JournalBenchmarkResult result;
+    std::error_code ec;
+    fs::path directory = fs::temp_directory_path(ec);
+    if (ec) directory = ".";
+    const std::string snapshot = (directory / "epidemic_journal_bench.cols").string();
+    const std::string journalFile = (directory / "epidemic_journal_bench.wal").string();
+    fs::remove(snapshot, ec);
+    fs::remove(journalFile, ec);
+
+    EpidemicData data;
+    for (int i = 0; i < 256; ++i) {
+        data.addRegion(("基准地区 " + std::to_string(i)).c_str(), 1000000 + i * 1000, 0, 0, 0);
+    }
+
+    {
+        Journal journal;
+        if (!journal.start(data, snapshot.c_str(), journalFile.c_str(), JournalRecovery(), &result.error)) return result;
+
+        std::mt19937 rng(20240601u);
+        auto t0 = Clock::now();
+        for (size_t e = 0; e < edits; ++e) {
+            const int count = static_cast<int>(data.getRegions().size());
+            const int index = static_cast<int>(rng() % count);
+            const unsigned op = rng() % 100;
+            if (op < 70) {
+                int confirmed = static_cast<int>(rng() % 100000);
+                data.upsertHistoryRecord(index, { static_cast<int>(rng() % 365), confirmed, confirmed / 2, confirmed / 50 });
+            } else if (op < 80) {
+                data.deleteHistoryRecord(index, static_cast<int>(rng() % 365));
+            } else if (op < 90) {
+                data.setRegionPopulation(index, 500000 + static_cast<int>(rng() % 20000000));
+            } else if (op < 95) {
+                data.renameRegion(index, ("改名地区 " + std::to_string(e)).c_str());
+            } else if (op < 98 || count <= 16) {
+                data.addRegion(("新增地区 " + std::to_string(e)).c_str(), 800000, 0, 0, 0);
+            } else {
+                data.deleteRegion(index);
+            }
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+        journal.stop(); // Waits for the final batch to reach the disk
+
+        JournalStats stats = journal.getStats();
+        if (!stats.error.empty()) {
+            result.error = stats.error;
+            return result;
+        }
+        result.edits = stats.edits;
+        result.editsPerSecond = seconds > 0 ? edits / seconds : 0;
+        result.appendMicros = stats.appendMicros;
+        result.commitP50Ms = stats.commitP50Ms;
+        result.commitP99Ms = stats.commitP99Ms;
+        result.batches = stats.batches;
+        result.editsPerBatch = stats.batches ? static_cast<double>(stats.edits) / stats.batches : 0;
+        result.journalBytes = stats.journalBytes;
+    }
+
+    EpidemicData restored;
+    JournalRecovery recovery = Recover(snapshot.c_str(), journalFile.c_str(), restored);
+    result.replayedRecords = recovery.replayedRecords;
+    result.replaySeconds = recovery.replaySeconds;
+    result.recordsPerSecond = recovery.recordsPerSecond;
+    result.verified = recovery.recovered && recovery.truncatedBytes == 0 && SameData(data, restored);
+
+    fs::remove(snapshot, ec);
+    fs::remove(journalFile, ec);
+    result.valid = true;
+    return result;
+}
@@ -0,0 +1,175 @@
+// ====================================================================================
+// 模块名称: Journal (编辑日志 / 崩溃恢复)
+// 功能描述:
+//   追加写入的预写日志 (Write-Ahead Log)。作为 EpidemicData 的变更监听器，把
+//   添加/删除地区、改名、改人口、历史记录增改/删除编码成紧凑的二进制记录追加到日志文件。
+//   后台线程以组提交 (group commit) 方式写盘: 一次 fsync 落盘期间到达的所有编辑
+//   合并进下一次 fsync。启动时先映射最近一次的列式快照 (ColumnarStore)，再重放快照之后的日志；
+//   日志过大或发生批量变更 (导入/载入) 时在后台写一份新快照，然后换成只含快照之后记录的新日志 (压缩)。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include "SnapshotSaver.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [枚举] JournalRecordType
+// 描述: 日志记录类型。记录格式 (小端):
+//   u32 长度 | u32 CRC-32 | u8 类型 | u64 LSN | 负载
+//   长度与CRC覆盖 "类型 + LSN + 负载"。地区以其在 EpidemicData 中的下标引用。
+// ------------------------------------------------------------------------------------
+enum JournalRecordType : uint8_t {
+    JournalRecord_AddRegion = 1,    // u16 nameLength, name, i32 population, confirmed, recovered, deaths
+    JournalRecord_DeleteRegion,     // i32 index
+    JournalRecord_RenameRegion,     // i32 index, u16 nameLength, name
+    JournalRecord_SetPopulation,    // i32 index, i32 population
+    JournalRecord_UpsertHistory,    // i32 index, i32 day, confirmed, recovered, deaths
+    JournalRecord_DeleteHistory,    // i32 index, i32 day
+    JournalRecord_SetCounts         // i32 index, confirmed, recovered, deaths
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] JournalRecovery
+// 描述: 启动恢复的结果
+// ------------------------------------------------------------------------------------
+struct JournalRecovery {
+    bool recovered = false;         // A snapshot was loaded (the data model now holds the saved state)
+    std::string error;              // Non-fatal problems (unreadable snapshot, damaged journal tail)
+    size_t regions = 0;
+    uint64_t snapshotLsn = 0;
+    uint64_t lastLsn = 0;           // Highest LSN contained in snapshot + replayed journal
+    size_t replayedRecords = 0;
+    size_t truncatedBytes = 0;      // Torn or corrupt tail removed from the journal
+    double snapshotSeconds = 0;
+    double replaySeconds = 0;
+    double recordsPerSecond = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] JournalStats
+// 描述: 运行时统计 (UI 每帧读取)
+// ------------------------------------------------------------------------------------
+struct JournalStats {
+    bool open = false;
+    std::string error;
+    uint64_t appendedLsn = 0;
+    uint64_t durableLsn = 0;
+    uint64_t snapshotLsn = 0;
+    size_t edits = 0;               // Records appended this session
+    size_t batches = 0;             // fsyncs issued by the writer
+    size_t journalBytes = 0;
+    double appendMicros = 0;        // Mean UI-thread cost of encoding one edit
+    double commitP50Ms = 0;         // Edit appended -> on disk, over the most recent edits
+    double commitP99Ms = 0;
+    size_t compactions = 0;
+    bool compacting = false;
+    double lastCompactPauseMs = 0;  // UI-thread snapshot capture
+    double lastCompactSeconds = 0;  // Background snapshot write
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] JournalBenchmarkResult
+// 描述: 基准测试: 在临时文件上连续编辑后再完整恢复一遍
+// ------------------------------------------------------------------------------------
+struct JournalBenchmarkResult {
+    bool valid = false;
+    std::string error;
+    size_t edits = 0;
+    double editsPerSecond = 0;      // Edit API call + journal append, UI-thread side
+    double appendMicros = 0;
+    double commitP50Ms = 0;
+    double commitP99Ms = 0;
+    size_t batches = 0;
+    double editsPerBatch = 0;
+    size_t journalBytes = 0;
+    size_t replayedRecords = 0;
+    double replaySeconds = 0;
+    double recordsPerSecond = 0;
+    bool verified = false;          // Recovered data matches the edited data exactly
+};
+
+// ------------------------------------------------------------------------------------
+// [类] Journal
+// 描述: 编辑日志
+// 作用:
+//   Recover() 在 start() 之前调用，把快照 + 日志恢复进 EpidemicData；
+//   start() 注册为监听器并打开日志，此后的每次编辑都被记录；
+//   maintain() 每帧在UI线程调用，按需开始压缩并在快照写完后切换日志；
+//   stop() 等待进行中的压缩与所有记录落盘后关闭。
+// ------------------------------------------------------------------------------------
+class Journal : public DataChangeListener {
+public:
+    static const uint32_t FormatVersion = 1;
+    static const size_t CompactBytes = 16 << 20;   // Journal size that triggers compaction
+
+    Journal();
+    ~Journal();
+
+    static JournalRecovery Recover(const char* snapshotPath, const char* journalPath, EpidemicData& data);
+
+    bool start(EpidemicData& data, const char* snapshotPath, const char* journalPath,
+               const JournalRecovery& recovery, std::string* error = nullptr);
+    void maintain();
+    void compact();
+    void stop();
+    bool isOpen() const { return target != nullptr; }
+    JournalStats getStats();
+
+    // DataChangeListener
+    void onRegionAdded(int index, const Region& region) override;
+    void onRegionDeleted(int index) override;
+    void onRegionRenamed(int index, const char* name) override;
+    void onPopulationChanged(int index, int population) override;
+    void onCountsChanged(int index, int confirmed, int recovered, int deaths) override;
+    void onHistoryUpserted(int index, const HistoricalRecord& record) override;
+    void onHistoryDeleted(int index, int day) override;
+    void onBulkChange() override;
+
+    // Benchmark on scratch files (independent of the journal being used), on the calling thread
+    static JournalBenchmarkResult RunBenchmark(size_t edits);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct PendingEdit {
+        uint64_t lsn;
+        Clock::time_point appended;
+    };
+
+    void append(JournalRecordType type, const unsigned char* payload, size_t bytes);
+    void finishCompaction();
+    void writerLoop();
+
+    EpidemicData* target;
+    std::string snapshotPath;
+    std::string journalPath;
+    uint64_t nextLsn;                // UI thread only
+    bool compactRequested;
+    SnapshotSaver compactor;
+    uint64_t compactLsn;
+
+    std::thread writer;
+    std::mutex mutex;                // Guards everything below up to the latency ring
+    std::condition_variable wake;
+    std::vector<unsigned char> pending;
+    std::vector<PendingEdit> pendingEdits;
+    bool carrying;                   // Compaction in progress: also keep records for the next journal
+    std::vector<unsigned char> carry;
+    bool rollRequested;              // Snapshot written: switch to a journal holding only `pending`
+    bool stopRequested;
+    std::FILE* file;                 // Writer thread only while running
+    JournalStats stats;
+    double appendSecondsTotal;
+    std::vector<float> latencyMs;    // Ring of the most recent commit latencies
+    size_t latencyNext;
+};
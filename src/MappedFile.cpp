@@ -0,0 +1,142 @@
+// ====================================================================================
+// 模块名称: MappedFile Implementation
+// 功能描述:
+//   平台相关的映射/解除映射实现。空文件视为打开成功但长度为0。
+// ====================================================================================
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h> // For _commit, _fileno
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Non-null marker for successfully opened empty files (nothing to map)
+const unsigned char kEmptyFile[1] = { 0 };
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : data(nullptr), size(0), fileHandle(nullptr), mappingHandle(nullptr) {}
+
+bool MappedFile::open(const char* path, std::string* error) {
+    close();
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        if (error) *error = std::string("无法打开文件: ") + path;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        if (error) *error = "无法获取文件大小";
+        return false;
+    }
+    if (fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        data = kEmptyFile;
+        size = 0;
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        CloseHandle(file);
+        if (error) *error = "CreateFileMapping 失败";
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        if (error) *error = "MapViewOfFile 失败";
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data && data != kEmptyFile) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+    data = nullptr;
+    size = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile() : data(nullptr), size(0), fd(-1) {}
+
+bool MappedFile::open(const char* path, std::string* error) {
+    close();
+    int file = ::open(path, O_RDONLY);
+    if (file < 0) {
+        if (error) *error = std::string("无法打开文件: ") + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(file, &st) != 0) {
+        ::close(file);
+        if (error) *error = "无法获取文件大小";
+        return false;
+    }
+    if (st.st_size == 0) {
+        ::close(file);
+        data = kEmptyFile;
+        size = 0;
+        return true;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED) {
+        ::close(file);
+        if (error) *error = "mmap 失败";
+        return false;
+    }
+    fd = file;
+    data = static_cast<const unsigned char*>(view);
+    size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data && data != kEmptyFile) munmap(const_cast<unsigned char*>(data), size);
+    if (fd >= 0) ::close(fd);
+    data = nullptr;
+    size = 0;
+    fd = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool SyncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool MoveFileReplacing(const char* from, const char* to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(from, to) == 0;
+#endif
+}
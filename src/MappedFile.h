@@ -0,0 +1,57 @@
+// ====================================================================================
+// 模块名称: MappedFile (只读内存映射文件)
+// 功能描述:
+//   把整个文件只读映射进地址空间，读取时不做任何拷贝或解析。
+//   Windows 下使用 CreateFileMapping/MapViewOfFile，其他平台使用 POSIX mmap。
+// ====================================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+// ------------------------------------------------------------------------------------
+// [类] MappedFile
+// 描述: RAII 封装的只读文件映射
+// 作用: open() 成功后 getData()/getSize() 指向整个文件内容，析构或 close() 时解除映射。
+// ------------------------------------------------------------------------------------
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path, std::string* error = nullptr);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    const unsigned char* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+private:
+    const unsigned char* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+};
+
+// ------------------------------------------------------------------------------------
+// [函数] SyncFile
+// 描述: 把 stdio 缓冲以及操作系统缓存中的内容真正写到磁盘 (fflush + fsync/_commit)
+// 作用: 返回 true 后即使进程崩溃或断电，已写入的内容也不会丢失。
+// ------------------------------------------------------------------------------------
+bool SyncFile(std::FILE* file);
+
+// ------------------------------------------------------------------------------------
+// [函数] MoveFileReplacing
+// 描述: 把 from 重命名为 to，to 已存在时一步替换 (Windows 下 rename 不会覆盖已有文件)
+// 作用: 与"先写临时文件并 SyncFile"配合，崩溃后目标文件要么是旧内容要么是新内容。
+// ------------------------------------------------------------------------------------
+bool MoveFileReplacing(const char* from, const char* to);
@@ -0,0 +1,235 @@
+// ====================================================================================
+// 模块名称: MemoryArena Implementation
+// 功能描述:
+//   地区内存池与帧内存池、页错误计数，以及两种分配方式的对比基准测试 (分配计数见 AllocationCounter.cpp)。
+// ====================================================================================
+
+#include "MemoryArena.h"
+#include "DataModel.h"
+#include <algorithm>  // For std::max, std::min
+#include <chrono>
+#include <random>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>    // For GetProcessMemoryInfo
+#else
+#include <sys/resource.h>
+#endif
+
+// --- Counters ---
+
+uint64_t MemoryArena::PageFaultCount() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PageFaultCount;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<uint64_t>(usage.ru_minflt) + static_cast<uint64_t>(usage.ru_majflt);
+#endif
+}
+
+// [算法] 地区内存池
+// 逻辑:
+//   同步的分级池: 每种尺寸的块从成批申请的大块内存中切出，释放后进入该尺寸的空闲链表。
+//   历史记录在编辑中会扩容、写时复制会整体替换，释放的旧缓冲区因此能被下一次同尺寸的申请直接复用；
+//   超过最大分级 (64 KB，约 4000 条记录) 的缓冲区直接向堆申请。快照线程释放退役的缓冲区，故需加锁版本。
+std::shared_ptr<std::pmr::memory_resource> MemoryArena::CreateRegionArena() {
+    std::pmr::pool_options options;
+    options.max_blocks_per_chunk = 0;                 // Implementation default, chunks grow geometrically
+    options.largest_required_pool_block = 64 * 1024;
+    return std::make_shared<std::pmr::synchronized_pool_resource>(options);
+}
+
+// --- FrameArena ---
+
+FrameArena::FrameArena(size_t initialBytes)
+    : buffer(nullptr), capacity(initialBytes), used(0), requested(0), lastFrameBytes(0), grows(0), enabled(true) {
+    buffer = static_cast<char*>(::operator new(capacity));
+}
+
+FrameArena::~FrameArena() {
+    for (void* block : overflow) ::operator delete(block);
+    ::operator delete(buffer);
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    requested += bytes;
+    const uintptr_t base = reinterpret_cast<uintptr_t>(buffer);
+    const uintptr_t aligned = (base + used + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    if (aligned + bytes <= base + capacity) {
+        used = aligned + bytes - base;
+        return reinterpret_cast<void*>(aligned);
+    }
+    // Past the buffer: a heap block until the next reset, which then grows the buffer
+    void* block = ::operator new(bytes + alignment);
+    overflow.push_back(block);
+    const uintptr_t start = reinterpret_cast<uintptr_t>(block);
+    return reinterpret_cast<void*>((start + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+}
+
+void FrameArena::reset() {
+    lastFrameBytes = requested;
+    if (!overflow.empty()) {
+        for (void* block : overflow) ::operator delete(block);
+        overflow.clear();
+        // One buffer large enough for the busiest frame so far (plus alignment slack)
+        ::operator delete(buffer);
+        capacity = std::max(capacity * 2, requested + requested / 4);
+        buffer = static_cast<char*>(::operator new(capacity));
+        ++grows;
+    }
+    used = 0;
+    requested = 0;
+}
+
+// --- FrameMemoryCounter ---
+
+FrameMemoryCounter::FrameMemoryCounter() : next(0), frames(0) {
+    restart();
+}
+
+void FrameMemoryCounter::restart() {
+    lastAllocations = MemoryArena::AllocationCount();
+    lastFaults = MemoryArena::PageFaultCount();
+    next = 0;
+    frames = 0;
+}
+
+void FrameMemoryCounter::sample() {
+    const uint64_t a = MemoryArena::AllocationCount();
+    const uint64_t f = MemoryArena::PageFaultCount();
+    allocations[next] = static_cast<uint32_t>(a - lastAllocations);
+    faults[next] = static_cast<uint32_t>(f - lastFaults);
+    lastAllocations = a;
+    lastFaults = f;
+    next = (next + 1) % Window;
+    frames = std::min(frames + 1, Window);
+}
+
+double FrameMemoryCounter::getAllocationsPerFrame() const {
+    if (frames == 0) return 0;
+    uint64_t sum = 0;
+    for (int i = 0; i < frames; ++i) sum += allocations[i];
+    return static_cast<double>(sum) / frames;
+}
+
+double FrameMemoryCounter::getPageFaultsPerFrame() const {
+    if (frames == 0) return 0;
+    uint64_t sum = 0;
+    for (int i = 0; i < frames; ++i) sum += faults[i];
+    return static_cast<double>(sum) / frames;
+}
+
+// --- Benchmark ---
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Regions as a load builds them: records appended one by one, then each model run for a forecast
+void LoadRegions(std::vector<Region>& rows, size_t count, std::pmr::memory_resource* arena) {
+    std::mt19937 rng(41);
+    std::uniform_int_distribution<int> lengthDist(20, 120);
+    rows.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (arena) rows.emplace_back(arena);
+        else rows.emplace_back();
+        Region& region = rows.back();
+        const int population = 1000000;
+        const int length = lengthDist(rng);
+        int confirmed = 0;
+        for (int day = 0; day < length; ++day) {
+            confirmed += static_cast<int>(rng() % 50);
+            region.history.push_back({ day, confirmed, confirmed / 2, confirmed / 40 });
+        }
+        region.simulation.reset(population, confirmed / 3, confirmed / 2, length);
+        region.simulation.run(90);
+    }
+}
+
+// One dashboard-style frame: labels and three value arrays for every region, grown one element at a time
+double BuildChartArrays(const std::vector<Region>& rows, std::pmr::memory_resource* resource) {
+    std::pmr::vector<const char*> names(resource);
+    std::pmr::vector<double> confirmed(resource), recovered(resource), active(resource);
+    for (const Region& r : rows) {
+        names.push_back(r.name);
+        const HistoricalRecord& last = r.history.back();
+        confirmed.push_back(last.confirmed);
+        recovered.push_back(last.recovered);
+        active.push_back(last.confirmed - last.recovered - last.deaths);
+    }
+    return confirmed.back() + recovered.back() + active.back() + static_cast<double>(names.size());
+}
+
+} // namespace
+
+// [算法] 堆与内存池的对比
+// 逻辑:
+//   同一份合成数据 (逐条追加历史、每个地区运行一次 90 天的模型) 分别用普通堆与地区内存池建立，
+//   比较期间的分配次数、页错误次数与用时，并逐条比较两者的内容；
+//   再把一帧的图表临时数组 (前 1000 个地区) 分别用普通堆和帧内存池各建立 200 帧，比较每帧的分配次数。
+MemoryArenaBenchmarkResult MemoryArena::RunBenchmark(size_t regions) {
+    MemoryArenaBenchmarkResult result;
+    result.regions = regions;
+
+    std::vector<Region> heapRows, arenaRows;
+    uint64_t a0 = MemoryArena::AllocationCount(), f0 = MemoryArena::PageFaultCount();
+    auto t0 = Clock::now();
+    LoadRegions(heapRows, regions, nullptr);
+    result.heapMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    result.heapAllocations = MemoryArena::AllocationCount() - a0;
+    result.heapFaults = MemoryArena::PageFaultCount() - f0;
+
+    std::shared_ptr<std::pmr::memory_resource> arena = MemoryArena::CreateRegionArena();
+    a0 = MemoryArena::AllocationCount();
+    f0 = MemoryArena::PageFaultCount();
+    t0 = Clock::now();
+    LoadRegions(arenaRows, regions, arena.get());
+    result.arenaMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    result.arenaAllocations = MemoryArena::AllocationCount() - a0;
+    result.arenaFaults = MemoryArena::PageFaultCount() - f0;
+
+    bool verified = heapRows.size() == arenaRows.size();
+    for (size_t i = 0; verified && i < heapRows.size(); ++i) {
+        const Region& h = heapRows[i];
+        const Region& a = arenaRows[i];
+        verified = h.history.size() == a.history.size() && h.simulation.getHistory().size() == a.simulation.getHistory().size();
+        for (size_t k = 0; verified && k < h.history.size(); ++k) {
+            verified = h.history[k].day == a.history[k].day && h.history[k].confirmed == a.history[k].confirmed &&
+                       h.history[k].recovered == a.history[k].recovered && h.history[k].deaths == a.history[k].deaths;
+        }
+        for (size_t k = 0; verified && k < h.simulation.getHistory().size(); ++k) {
+            verified = h.simulation.getHistory()[k].infected == a.simulation.getHistory()[k].infected;
+        }
+    }
+
+    // Per-frame scratch
+    const std::vector<Region> shown(heapRows.begin(), heapRows.begin() + std::min<size_t>(1000, heapRows.size()));
+    const int frames = 200;
+    double sink = 0;
+    a0 = MemoryArena::AllocationCount();
+    t0 = Clock::now();
+    for (int f = 0; f < frames; ++f) sink += BuildChartArrays(shown, std::pmr::new_delete_resource());
+    result.frameHeapUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / frames;
+    result.frameHeapAllocations = static_cast<double>(MemoryArena::AllocationCount() - a0) / frames;
+
+    FrameArena frameArena(16 * 1024);   // Small on purpose: the first frames grow it
+    a0 = MemoryArena::AllocationCount();
+    t0 = Clock::now();
+    for (int f = 0; f < frames; ++f) {
+        frameArena.reset();
+        sink -= BuildChartArrays(shown, frameArena.resource());
+    }
+    result.frameArenaUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / frames;
+    result.frameArenaAllocations = static_cast<double>(MemoryArena::AllocationCount() - a0) / frames;
+
+    // The regions go before their arena
+    arenaRows.clear();
+    arenaRows.shrink_to_fit();
+    result.verified = verified && sink == 0;
+    result.valid = true;
+    return result;
+}
@@ -0,0 +1,116 @@
+// ====================================================================================
+// 模块名称: MemoryArena (内存池与分配计数)
+// 功能描述:
+//   两种多态分配器 (std::pmr) 内存资源，以及衡量它们效果的分配/页错误计数:
+//     地区内存池  每个 EpidemicData 一个: 地区的历史记录与 SIR 轨迹从大块内存中按尺寸分级切分，
+//                 释放的块回到空闲链表供下次复用，而不是每个缓冲区各自向堆申请
+//     帧内存池    每帧的临时数组 (图表数据等) 在一块连续缓冲区上顺序分配、从不单独释放，
+//                 ImGui::NewFrame 之后整体重置；某帧用量超出缓冲区时，下一帧起缓冲区扩大到该用量
+//   计数: 进程内 operator new 与 ImGui 分配的次数，以及操作系统报告的页错误次数。
+// ====================================================================================
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] MemoryArenaBenchmarkResult
+// 描述: 堆与内存池两种方式下的分配次数、页错误次数与用时 (计数包含同一时间段内其他线程的分配)
+// ------------------------------------------------------------------------------------
+struct MemoryArenaBenchmarkResult {
+    bool valid = false;
+    size_t regions = 0;
+    // Loading regions with histories and running each model
+    uint64_t heapAllocations = 0;
+    uint64_t arenaAllocations = 0;
+    uint64_t heapFaults = 0;
+    uint64_t arenaFaults = 0;
+    double heapMs = 0;
+    double arenaMs = 0;
+    // Per simulated frame: chart scratch arrays for every region
+    double frameHeapAllocations = 0;
+    double frameArenaAllocations = 0;
+    double frameHeapUs = 0;
+    double frameArenaUs = 0;
+    bool verified = false;              // Both ways hold identical histories and trajectories
+};
+
+namespace MemoryArena {
+
+// Thread-safe pool for region storage: snapshots may drop retired histories on background threads
+std::shared_ptr<std::pmr::memory_resource> CreateRegionArena();
+
+// Process-wide counters
+uint64_t AllocationCount();             // operator new (all threads) and ImGui allocations since start
+uint64_t PageFaultCount();              // Page faults of the process as reported by the OS (soft and hard)
+void CountImGuiAllocations();           // Routes ImGui's allocator through the counter; call before ImGui::CreateContext
+
+// Heap against arena on the calling thread
+MemoryArenaBenchmarkResult RunBenchmark(size_t regions);
+
+} // namespace MemoryArena
+
+// ------------------------------------------------------------------------------------
+// [类] FrameArena
+// 描述: 每帧重置的单调 (只分配不释放) 内存资源
+// 作用:
+//   UI 线程在一帧之内用 resource() 构造临时容器 (std::pmr::vector 等)，这些容器必须在帧末之前销毁；
+//   reset() 在 ImGui::NewFrame 之后调用。停用时 resource() 返回普通堆，便于对比。
+// ------------------------------------------------------------------------------------
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t initialBytes = 256 * 1024);
+    ~FrameArena();
+
+    std::pmr::memory_resource* resource() { return enabled ? this : std::pmr::new_delete_resource(); }
+    void reset();
+
+    void setEnabled(bool enable) { enabled = enable; }
+    bool isEnabled() const { return enabled; }
+    size_t getCapacity() const { return capacity; }
+    size_t getLastFrameBytes() const { return lastFrameBytes; }  // Bytes handed out during the previous frame
+    size_t getGrowCount() const { return grows; }                // Frames that outgrew the buffer
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    char* buffer;
+    size_t capacity;
+    size_t used;
+    size_t requested;                   // Including what went to overflow blocks
+    std::vector<void*> overflow;        // Heap blocks for requests past the buffer, freed at reset
+    size_t lastFrameBytes;
+    size_t grows;
+    bool enabled;
+};
+
+// ------------------------------------------------------------------------------------
+// [类] FrameMemoryCounter
+// 描述: 最近若干帧的平均分配次数与页错误次数 (每帧调用一次 sample)
+// ------------------------------------------------------------------------------------
+class FrameMemoryCounter {
+public:
+    static constexpr int Window = 120;
+
+    FrameMemoryCounter();
+    void sample();
+    void restart();                     // Forget the window (after switching a mode being compared)
+
+    double getAllocationsPerFrame() const;
+    double getPageFaultsPerFrame() const;
+    int getFrames() const { return frames; }
+
+private:
+    uint64_t lastAllocations;
+    uint64_t lastFaults;
+    uint32_t allocations[Window];
+    uint32_t faults[Window];
+    int next;
+    int frames;                         // Valid entries, up to Window
+};
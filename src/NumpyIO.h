@@ -0,0 +1,200 @@
+// ====================================================================================
+// 模块名称: NumpyIO (NumPy .npy / .npz 读写)
+// 功能描述:
+//   分析人员用 Python 做后处理，这里按 NumPy 的格式直接读写:
+//     .npy  = 64 字节对齐的文本头 (dtype、形状) + 原始小端数据
+//     .npz  = 不压缩 (stored) 的 ZIP，每个成员是一个 .npy (与 np.savez 相同)
+//   写入时数据部分就是内存中连续缓冲区的原样拷贝 (可以由多段缓冲区首尾相接组成，
+//   例如各地区的历史记录)，不做任何格式化；.npz 的 CRC 在线程池上分块并行计算。
+//   读取时内存映射整个文件，只解析文本头与 ZIP 目录，数组数据直接指向映射内存。
+//
+//   导出内容:
+//     SIR 轨迹      .npy  结构化 dtype (day, susceptible, infected, recovered)，与 SIRDataPoint 内存布局一致
+//     历史记录      .npz  names, population, confirmed, recovered, deaths, offsets, history (H x 4 int32)
+//     后验集合      .npz  values (成员 x 天 x 3: S, I, R), beta, gamma, weight, days
+// ====================================================================================
+
+#pragma once
+
+#include "ABCCalibrator.h"
+#include "DataModel.h"
+#include "MappedFile.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] NpyArray
+// 描述: 待写出的一个数组: dtype、形状以及按 C 顺序首尾相接的数据段 (不拷贝，只引用)
+// ------------------------------------------------------------------------------------
+struct NpyArray {
+    std::string name;                                   // Member name inside a .npz (".npy" is appended)
+    std::string descr;                                  // NumPy dtype: "<f8", "|S16", or a record list "[(...)]"
+    std::vector<uint64_t> shape;
+    std::vector<std::pair<const void*, size_t>> parts;  // Buffers written back to back
+
+    size_t bytes() const;
+
+    template <typename T>
+    static NpyArray Of(const std::string& name, const T* data, std::vector<uint64_t> shape);
+    static NpyArray Trajectory(const std::string& name, const SIRDataPoint* points, size_t count);
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] NpyView
+// 描述: 映射文件中一个数组的零拷贝视图
+// ------------------------------------------------------------------------------------
+struct NpyView {
+    std::string name;
+    std::string descr;
+    bool fortranOrder = false;
+    std::vector<uint64_t> shape;
+    const unsigned char* data = nullptr;
+    size_t bytes = 0;
+
+    size_t elements() const;
+    // Typed pointer into the mapping; nullptr unless the dtype matches T exactly and the data is aligned
+    template <typename T>
+    const T* as() const;
+};
+
+// dtype strings of the element types the helpers accept
+template <typename T> struct NpyDtype;
+template <> struct NpyDtype<int32_t> { static const char* descr() { return "<i4"; } };
+template <> struct NpyDtype<int64_t> { static const char* descr() { return "<i8"; } };
+template <> struct NpyDtype<float>   { static const char* descr() { return "<f4"; } };
+template <> struct NpyDtype<double>  { static const char* descr() { return "<f8"; } };
+
+template <typename T>
+NpyArray NpyArray::Of(const std::string& name, const T* data, std::vector<uint64_t> shape) {
+    NpyArray a;
+    a.name = name;
+    a.descr = NpyDtype<T>::descr();
+    a.shape = std::move(shape);
+    size_t count = 1;
+    for (uint64_t n : a.shape) count *= static_cast<size_t>(n);
+    a.parts.push_back({ data, count * sizeof(T) });
+    return a;
+}
+
+template <typename T>
+const T* NpyView::as() const {
+    if (descr != NpyDtype<T>::descr() || fortranOrder) return nullptr;
+    if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0) return nullptr;
+    return reinterpret_cast<const T*>(data);
+}
+
+// ------------------------------------------------------------------------------------
+// [类] NpyFile
+// 描述: 只读映射的 .npy 或 .npz 文件 (按文件内容识别)
+// 作用:
+//   open() 只解析头部与 ZIP 目录；getArrays()/find() 返回指向映射内存的视图，
+//   在 close() 或析构前有效。.npz 只支持不压缩的成员 (np.savez；np.savez_compressed 不支持)。
+//   本模块写出的成员数据 64 字节对齐，直接指向映射；其他工具写出的未对齐成员会拷贝一份对齐的副本。
+// ------------------------------------------------------------------------------------
+class NpyFile {
+public:
+    bool open(const std::string& path, std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    size_t getFileSize() const { return file.getSize(); }
+
+    const std::vector<NpyView>& getArrays() const { return arrays; }
+    const NpyView* find(const std::string& name) const;
+
+private:
+    MappedFile file;
+    std::vector<NpyView> arrays;
+    std::vector<std::vector<uint64_t>> alignedCopies;  // Members whose data is not 8-byte aligned in the file
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] SIREnsemble
+// 描述: 一组参数各自的 SIR 轨迹 (成员 x (days+1) x 3，C 顺序，第三维依次为 S, I, R)
+// ------------------------------------------------------------------------------------
+struct SIREnsemble {
+    int startDay = 0;
+    int days = 0;
+    std::vector<double> beta;
+    std::vector<double> gamma;
+    std::vector<double> weight;
+    std::vector<double> values;
+
+    size_t members() const { return beta.size(); }
+    size_t steps() const { return static_cast<size_t>(days) + 1; }
+
+    // One trajectory per ABC particle from the region's forecast origin (parallel on the thread pool)
+    static SIREnsemble FromPosterior(const Region& region, const std::vector<ABCParticle>& particles, int days);
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] NumpyIoResult / NumpyBenchmarkResult
+// ------------------------------------------------------------------------------------
+struct NumpyIoResult {
+    bool valid = false;
+    std::string error;
+    std::string path;
+    size_t bytes = 0;
+    double seconds = 0;
+    double megabytesPerSecond = 0;
+};
+
+struct NumpyBenchmarkResult {
+    bool valid = false;
+    std::string error;
+    size_t members = 0;
+    int days = 0;
+    double megabytes = 0;               // Ensemble values only
+    double writeMBps = 0;               // .npz with CRC
+    double rawWriteMBps = 0;            // Plain fwrite of the same buffer (I/O baseline)
+    double readMBps = 0;                // Map + touch every value
+    double rawReadMBps = 0;             // Plain fread into a vector (I/O baseline)
+    bool verified = false;              // Mapped values identical to the source
+};
+
+// ------------------------------------------------------------------------------------
+// [类] NumpyIO
+// 描述: .npy/.npz 写入与各类数据的导入导出
+// 作用:
+//   Write* 与 Save* 只读取传入的数据，可以在后台线程调用；LoadHistory 修改 EpidemicData，只在 UI 线程调用。
+//   startHistoryExport()/startEnsembleExport() 在后台线程执行，UI 轮询 isRunning()。
+// ------------------------------------------------------------------------------------
+class NumpyIO {
+public:
+    static bool WriteNpy(const std::string& path, const NpyArray& array, std::string* error = nullptr);
+    static bool WriteNpz(const std::string& path, const std::vector<NpyArray>& arrays, std::string* error = nullptr);
+
+    static bool SaveTrajectory(const std::string& path, const SIRDataPoint* points, size_t count, std::string* error = nullptr);
+    static bool LoadTrajectory(const std::string& path, std::vector<SIRDataPoint>& points, std::string* error = nullptr);
+    static bool SaveHistory(const std::string& path, const DataSnapshot& snapshot, std::string* error = nullptr);
+    // Replaces the regions of data with the file's (histories are copied in parallel)
+    static bool LoadHistory(const std::string& path, EpidemicData& data, std::string* error = nullptr);
+    static bool SaveEnsemble(const std::string& path, const SIREnsemble& ensemble, std::string* error = nullptr);
+    // Zero-copy: the view's pointers stay valid while file is open
+    static bool OpenEnsemble(const std::string& path, NpyFile& file, const double*& values,
+                             size_t& members, size_t& steps, std::string* error = nullptr);
+
+    // Ensemble round trip against raw fwrite/fread, on the calling thread
+    static NumpyBenchmarkResult RunBenchmark(size_t members, int days);
+
+    NumpyIO();
+    ~NumpyIO();
+    void startHistoryExport(std::shared_ptr<const DataSnapshot> snapshot, const std::string& path);
+    void startEnsembleExport(SIREnsemble ensemble, const std::string& path);
+    bool isRunning() const { return running; }
+    NumpyIoResult getResult();
+
+private:
+    template <typename Job>
+    void startJob(Job job);
+
+    std::thread worker;
+    std::mutex resultMutex;
+    NumpyIoResult result;
+    std::atomic<bool> running;
+};
@@ -0,0 +1,1464 @@
+// ====================================================================================
+// 模块名称: Pinyin Implementation
+// 功能描述:
+//   汉字 (U+4E00 - U+9FA5) 到拼音的查表。kReadings 由 ICU 的 Han-Latin 转写生成 (去掉声调，ü 写作 v)，
+//   每个汉字一个常用读音；地名中常见的多音字另在 kAlternates 中列出其他读音。
+// ====================================================================================
+
+#include "Pinyin.h"
+#include <algorithm> // For std::lower_bound
+
+namespace {
+
+const uint32_t kFirstHan = 0x4E00;
+const uint32_t kLastHan = 0x9FA5;
+
+// Index 0 means "no reading"
+const char* const kSyllables[] = {
+    "",
+    "a", "ai", "an", "ang", "ao", "ba", "bai", "ban", "bang", "bao", "bei", "ben", "beng", "bi",
+    "bian", "biao", "bie", "bin", "bing", "bo", "bu", "ca", "cai", "can", "cang", "cao", "ce",
+    "cen", "ceng", "cha", "chai", "chan", "chang", "chao", "che", "chen", "cheng", "chi", "chong",
+    "chou", "chu", "chua", "chuai", "chuan", "chuang", "chui", "chun", "chuo", "ci", "cong", "cou",
+    "cu", "cuan", "cui", "cun", "cuo", "da", "dai", "dan", "dang", "dao", "de", "den", "deng", "di",
+    "dian", "diao", "die", "ding", "diu", "dong", "dou", "du", "duan", "dui", "dun", "duo", "e",
+    "ei", "en", "eng", "er", "fa", "fan", "fang", "fei", "fen", "feng", "fiao", "fo", "fou", "fu",
+    "ga", "gai", "gan", "gang", "gao", "ge", "gei", "gen", "geng", "gong", "gou", "gu", "gua",
+    "guai", "guan", "guang", "gui", "gun", "guo", "ha", "hai", "han", "hang", "hao", "he", "hei",
+    "hen", "heng", "hm", "hong", "hou", "hu", "hua", "huai", "huan", "huang", "hui", "hun", "huo",
+    "ji", "jia", "jian", "jiang", "jiao", "jie", "jin", "jing", "jiong", "jiu", "ju", "juan", "jue",
+    "jun", "ka", "kai", "kan", "kang", "kao", "ke", "kei", "ken", "keng", "kong", "kou", "ku",
+    "kua", "kuai", "kuan", "kuang", "kui", "kun", "kuo", "la", "lai", "lan", "lang", "lao", "le",
+    "lei", "leng", "li", "lia", "lian", "liang", "liao", "lie", "lin", "ling", "liu", "lo", "long",
+    "lou", "lu", "luan", "lun", "luo", "lv", "lve", "m", "ma", "mai", "man", "mang", "mao", "me",
+    "mei", "men", "meng", "mi", "mian", "miao", "mie", "min", "ming", "miu", "mo", "mou", "mu", "n",
+    "na", "nai", "nan", "nang", "nao", "ne", "nei", "nen", "neng", "ni", "nian", "niang", "niao",
+    "nie", "nin", "ning", "niu", "nong", "nou", "nu", "nuan", "nun", "nuo", "nv", "nve", "o", "ou",
+    "pa", "pai", "pan", "pang", "pao", "pei", "pen", "peng", "pi", "pian", "piao", "pie", "pin",
+    "ping", "po", "pou", "pu", "qi", "qia", "qian", "qiang", "qiao", "qie", "qin", "qing", "qiong",
+    "qiu", "qu", "quan", "que", "qun", "ran", "rang", "rao", "re", "ren", "reng", "ri", "rong",
+    "rou", "ru", "rua", "ruan", "rui", "run", "ruo", "sa", "sai", "san", "sang", "sao", "se", "sen",
+    "seng", "sha", "shai", "shan", "shang", "shao", "she", "shei", "shen", "sheng", "shi", "shou",
+    "shu", "shua", "shuai", "shuan", "shuang", "shui", "shun", "shuo", "si", "song", "sou", "su",
+    "suan", "sui", "sun", "suo", "ta", "tai", "tan", "tang", "tao", "te", "teng", "ti", "tian",
+    "tiao", "tie", "ting", "tong", "tou", "tu", "tuan", "tui", "tun", "tuo", "wa", "wai", "wan",
+    "wang", "wei", "wen", "weng", "wo", "wu", "xi", "xia", "xian", "xiang", "xiao", "xie", "xin",
+    "xing", "xiong", "xiu", "xu", "xuan", "xue", "xun", "ya", "yan", "yang", "yao", "ye", "yi",
+    "yin", "ying", "yo", "yong", "you", "yu", "yuan", "yue", "yun", "za", "zai", "zan", "zang",
+    "zao", "ze", "zei", "zen", "zeng", "zha", "zhai", "zhan", "zhang", "zhao", "zhe", "zhen",
+    "zheng", "zhi", "zhong", "zhou", "zhu", "zhua", "zhuai", "zhuan", "zhuang", "zhui", "zhun",
+    "zhuo", "zi", "zong", "zou", "zu", "zuan", "zui", "zun", "zuo",
+};
+
+// Syllable of each character from kFirstHan to kLastHan
+const uint16_t kReadings[] = {
+    /* 4E00 */ 367, 69, 150, 256, 296, 349, 114, 341, 389, 287, 296, 349, 132, 21, 373, 202,
+    /* 4E10 */ 94, 40, 40, 400, 261, 247, 302, 302, 265, 19, 366, 50, 71, 312, 37, 70,
+    /* 4E20 */ 265, 176, 70, 372, 176, 363, 19, 288, 110, 141, 98, 362, 259, 395, 132, 137,
+    /* 4E30 */ 88, 107, 44, 32, 179, 404, 397, 6, 341, 59, 343, 397, 139, 173, 142, 250,
+    /* 4E40 */ 92, 367, 367, 213, 347, 141, 141, 338, 197, 367, 367, 394, 347, 386, 124, 83,
+    /* 4E50 */ 170, 368, 252, 242, 260, 124, 106, 37, 37, 367, 368, 362, 204, 141, 256, 366,
+    /* 4E60 */ 348, 351, 94, 141, 349, 124, 304, 72, 302, 132, 215, 133, 142, 302, 196, 124,
+    /* 4E70 */ 193, 186, 405, 279, 360, 363, 92, 293, 212, 95, 319, 373, 54, 391, 258, 394,
+    /* 4E80 */ 109, 95, 186, 179, 367, 144, 170, 192, 373, 393, 302, 302, 82, 41, 373, 162,
+    /* 4E90 */ 373, 376, 124, 256, 347, 139, 312, 317, 100, 100, 362, 353, 362, 256, 362, 132,
+    /* 4EA0 */ 333, 342, 149, 57, 136, 113, 367, 32, 120, 210, 366, 351, 139, 331, 176, 351,
+    /* 4EB0 */ 139, 366, 262, 20, 372, 353, 59, 175, 77, 199, 274, 274, 132, 132, 342, 367,
+    /* 4EC0 */ 300, 274, 170, 69, 382, 138, 255, 40, 6, 389, 138, 137, 19, 275, 50, 90,
+    /* 4ED0 */ 287, 187, 19, 25, 405, 302, 320, 389, 92, 350, 350, 338, 122, 332, 274, 258,
+    /* 4EE0 */ 95, 98, 20, 58, 180, 367, 34, 33, 285, 33, 367, 210, 199, 274, 84, 34,
+    /* 4EF0 */ 364, 258, 395, 247, 346, 347, 134, 133, 365, 88, 25, 274, 342, 87, 65, 85,
+    /* 4F00 */ 395, 256, 244, 373, 67, 76, 347, 367, 354, 149, 367, 132, 2, 347, 132, 92,
+    /* 4F10 */ 83, 357, 138, 247, 59, 92, 323, 395, 372, 131, 129, 373, 54, 376, 287, 343,
+    /* 4F20 */ 44, 35, 362, 350, 296, 33, 187, 25, 361, 354, 343, 397, 382, 350, 231, 20,
+    /* 4F30 */ 104, 221, 221, 353, 8, 358, 180, 396, 300, 266, 49, 13, 302, 133, 247, 367,
+    /* 4F40 */ 312, 367, 393, 66, 114, 193, 59, 397, 21, 266, 14, 390, 49, 343, 65, 397,
+    /* 4F50 */ 412, 372, 364, 327, 388, 117, 14, 338, 298, 373, 367, 92, 412, 103, 227, 332,
+    /* 4F60 */ 221, 350, 266, 371, 339, 258, 302, 146, 10, 244, 129, 117, 169, 351, 98, 364,
+    /* 4F70 */ 7, 83, 206, 133, 82, 19, 132, 119, 131, 109, 267, 329, 136, 49, 367, 302,
+    /* 4F80 */ 355, 300, 338, 148, 394, 94, 166, 367, 38, 158, 108, 173, 368, 302, 201, 397,
+    /* 4F90 */ 358, 372, 3, 185, 209, 82, 187, 71, 30, 38, 361, 102, 396, 367, 279, 55,
+    /* 4FA0 */ 349, 312, 58, 189, 320, 136, 392, 27, 260, 159, 31, 227, 229, 138, 347, 123,
+    /* 4FB0 */ 140, 37, 392, 412, 40, 262, 189, 142, 304, 331, 300, 336, 20, 214, 352, 15,
+    /* 4FC0 */ 336, 373, 348, 52, 78, 265, 358, 108, 157, 347, 145, 367, 92, 176, 408, 260,
+    /* 4FD0 */ 173, 371, 130, 139, 258, 287, 244, 315, 92, 348, 173, 92, 252, 10, 373, 256,
+    /* 4FE0 */ 349, 354, 357, 373, 65, 35, 40, 394, 363, 174, 173, 166, 312, 134, 357, 92,
+    /* 4FF0 */ 131, 142, 352, 240, 134, 16, 41, 86, 88, 362, 3, 11, 373, 354, 14, 124,
+    /* 5000 */ 33, 394, 19, 141, 365, 54, 174, 341, 166, 25, 406, 98, 107, 11, 328, 304,
+    /* 5010 */ 304, 199, 61, 322, 144, 46, 355, 246, 323, 123, 367, 256, 327, 95, 139, 137,
+    /* 5020 */ 317, 33, 137, 85, 394, 155, 143, 406, 142, 258, 221, 187, 404, 346, 188, 313,
+    /* 5030 */ 172, 130, 71, 405, 12, 347, 142, 213, 23, 134, 387, 366, 394, 293, 263, 227,
+    /* 5040 */ 369, 37, 258, 363, 281, 395, 47, 133, 132, 343, 373, 19, 284, 327, 343, 248,
+    /* 5050 */ 363, 88, 323, 346, 78, 353, 35, 301, 148, 65, 412, 30, 331, 11, 353, 128,
+    /* 5060 */ 365, 388, 40, 363, 372, 134, 358, 386, 49, 92, 14, 394, 406, 202, 132, 367,
+    /* 5070 */ 353, 361, 23, 74, 27, 392, 238, 333, 333, 11, 377, 184, 137, 343, 87, 33,
+    /* 5080 */ 109, 314, 394, 315, 349, 92, 374, 277, 173, 231, 376, 135, 192, 9, 66, 323,
+    /* 5090 */ 116, 137, 348, 295, 258, 144, 25, 41, 287, 11, 352, 371, 365, 322, 319, 364,
+    /* 50A0 */ 83, 19, 133, 58, 378, 323, 104, 18, 41, 234, 24, 171, 54, 371, 381, 406,
+    /* 50B0 */ 13, 313, 5, 44, 373, 387, 408, 296, 45, 139, 38, 293, 114, 389, 263, 363,
+    /* 50C0 */ 65, 353, 184, 11, 249, 138, 175, 185, 194, 258, 350, 322, 369, 71, 400, 351,
+    /* 50D0 */ 295, 260, 140, 336, 411, 255, 348, 169, 33, 108, 177, 256, 37, 32, 343, 132,
+    /* 50E0 */ 20, 129, 44, 330, 59, 136, 141, 292, 87, 350, 142, 78, 136, 134, 332, 179,
+    /* 50F0 */ 20, 104, 350, 315, 350, 135, 205, 366, 138, 133, 260, 247, 88, 396, 2, 286,
+    /* 5100 */ 367, 145, 229, 32, 367, 60, 139, 359, 159, 134, 41, 59, 136, 293, 378, 24,
+    /* 5110 */ 18, 3, 279, 321, 40, 31, 167, 221, 138, 258, 200, 347, 227, 264, 221, 33,
+    /* 5120 */ 178, 171, 189, 161, 10, 373, 16, 379, 394, 312, 372, 116, 263, 36, 173, 326,
+    /* 5130 */ 343, 183, 41, 32, 271, 304, 129, 173, 188, 379, 234, 323, 363, 171, 215, 82,
+    /* 5140 */ 347, 376, 379, 374, 356, 39, 390, 356, 350, 108, 75, 151, 75, 202, 334, 33,
+    /* 5150 */ 82, 75, 82, 138, 334, 312, 363, 363, 302, 0, 60, 258, 72, 87, 196, 300,
+    /* 5160 */ 72, 0, 139, 173, 128, 279, 342, 218, 267, 176, 373, 6, 102, 181, 348, 114,
+    /* 5170 */ 167, 102, 328, 107, 355, 19, 256, 142, 66, 405, 87, 364, 134, 303, 132, 367,
+    /* 5180 */ 132, 32, 140, 196, 270, 218, 374, 196, 96, 270, 27, 140, 27, 378, 105, 140,
+    /* 5190 */ 196, 396, 196, 103, 358, 202, 201, 277, 368, 353, 148, 145, 229, 367, 201, 302,
+    /* 51A0 */ 107, 200, 395, 142, 374, 206, 156, 179, 92, 353, 201, 19, 71, 321, 96, 88,
+    /* 51B0 */ 19, 124, 39, 144, 124, 161, 366, 172, 241, 92, 205, 71, 350, 178, 257, 134,
+    /* 51C0 */ 139, 314, 198, 334, 256, 104, 403, 313, 139, 176, 263, 67, 180, 71, 95, 134,
+    /* 51D0 */ 368, 51, 2, 173, 45, 206, 403, 54, 312, 77, 138, 179, 179, 227, 348, 73,
+    /* 51E0 */ 132, 84, 84, 84, 88, 142, 41, 393, 88, 210, 394, 92, 88, 252, 88, 147,
+    /* 51F0 */ 128, 147, 95, 64, 252, 258, 356, 159, 334, 5, 41, 132, 60, 114, 114, 381,
+    /* 5200 */ 61, 67, 61, 274, 274, 45, 87, 261, 367, 132, 148, 258, 55, 41, 344, 132,
+    /* 5210 */ 59, 355, 125, 341, 144, 173, 375, 178, 181, 382, 96, 45, 92, 41, 266, 67,
+    /* 5220 */ 295, 205, 180, 395, 241, 17, 137, 137, 243, 173, 295, 17, 32, 139, 105, 101,
+    /* 5230 */ 61, 45, 162, 157, 77, 82, 394, 305, 267, 293, 49, 151, 137, 109, 49, 109,
+    /* 5240 */ 147, 77, 132, 327, 139, 184, 188, 382, 374, 56, 360, 152, 165, 258, 293, 45,
+    /* 5250 */ 105, 134, 56, 173, 327, 86, 254, 32, 256, 45, 405, 96, 341, 20, 132, 77,
+    /* 5260 */ 263, 295, 73, 134, 132, 20, 363, 142, 131, 301, 134, 77, 74, 347, 105, 92,
+    /* 5270 */ 301, 134, 98, 57, 147, 45, 44, 32, 335, 185, 173, 246, 295, 249, 156, 136,
+    /* 5280 */ 105, 260, 144, 125, 386, 404, 175, 142, 247, 181, 109, 136, 109, 134, 134, 323,
+    /* 5290 */ 131, 132, 134, 367, 134, 394, 32, 134, 208, 173, 397, 173, 362, 267, 8, 102,
+    /* 52A0 */ 133, 347, 193, 178, 138, 154, 353, 394, 71, 397, 231, 137, 266, 297, 367, 397,
+    /* 52B0 */ 208, 173, 138, 169, 169, 143, 156, 364, 339, 352, 209, 161, 137, 178, 117, 302,
+    /* 52C0 */ 151, 138, 97, 20, 205, 38, 168, 371, 371, 202, 151, 361, 143, 263, 185, 21,
+    /* 52D0 */ 200, 38, 171, 147, 202, 71, 358, 358, 148, 347, 367, 361, 345, 301, 169, 210,
+    /* 52E0 */ 185, 249, 302, 132, 262, 135, 34, 267, 351, 367, 144, 84, 143, 332, 142, 59,
+    /* 52F0 */ 353, 193, 361, 361, 189, 173, 35, 271, 267, 10, 297, 376, 141, 10, 103, 347,
+    /* 5300 */ 376, 344, 356, 94, 94, 10, 50, 367, 356, 246, 142, 324, 98, 255, 78, 243,
+    /* 5310 */ 92, 102, 57, 141, 102, 14, 125, 11, 216, 302, 85, 141, 367, 377, 135, 149,
+    /* 5320 */ 135, 161, 124, 349, 266, 84, 109, 261, 380, 161, 86, 124, 373, 109, 162, 129,
+    /* 5330 */ 59, 109, 175, 175, 316, 73, 141, 144, 348, 247, 266, 367, 151, 363, 15, 221,
+    /* 5340 */ 266, 302, 361, 258, 222, 285, 408, 301, 347, 129, 8, 302, 348, 341, 125, 353,
+    /* 5350 */ 341, 11, 408, 404, 353, 59, 193, 214, 59, 132, 20, 306, 20, 161, 15, 21,
+    /* 5360 */ 388, 146, 185, 372, 185, 348, 105, 346, 353, 137, 137, 343, 4, 264, 394, 196,
+    /* 5370 */ 368, 343, 297, 132, 268, 186, 38, 143, 353, 358, 138, 268, 347, 132, 78, 263,
+    /* 5380 */ 348, 287, 33, 343, 78, 331, 173, 391, 114, 173, 362, 362, 363, 298, 65, 386,
+    /* 5390 */ 242, 362, 261, 362, 394, 27, 242, 327, 173, 298, 123, 331, 410, 56, 86, 374,
+    /* 53A0 */ 27, 374, 351, 363, 173, 144, 293, 66, 41, 141, 138, 5, 109, 363, 312, 173,
+    /* 53B0 */ 33, 167, 173, 363, 363, 374, 312, 102, 179, 278, 266, 266, 82, 171, 73, 350,
+    /* 53C0 */ 400, 287, 24, 24, 24, 24, 2, 58, 372, 30, 132, 372, 308, 84, 303, 106,
+    /* 53D0 */ 6, 83, 284, 302, 304, 404, 266, 303, 15, 358, 349, 241, 314, 132, 343, 314,
+    /* 53E0 */ 68, 282, 50, 156, 104, 142, 180, 105, 61, 156, 394, 136, 390, 6, 69, 151,
+    /* 53F0 */ 321, 38, 302, 372, 265, 253, 366, 116, 312, 322, 38, 170, 67, 132, 177, 122,
+    /* 5400 */ 204, 358, 195, 38, 98, 359, 365, 405, 117, 132, 67, 55, 332, 206, 123, 173,
+    /* 5410 */ 334, 351, 386, 349, 366, 189, 362, 192, 238, 131, 367, 145, 40, 179, 337, 368,
+    /* 5420 */ 86, 14, 262, 262, 137, 21, 91, 6, 76, 87, 78, 114, 331, 154, 310, 256,
+    /* 5430 */ 122, 394, 368, 347, 347, 34, 212, 360, 348, 46, 72, 344, 123, 122, 347, 97,
+    /* 5440 */ 362, 145, 189, 78, 98, 198, 58, 256, 37, 347, 97, 92, 136, 122, 38, 301,
+    /* 5450 */ 212, 337, 92, 367, 58, 238, 173, 11, 374, 111, 344, 259, 347, 78, 302, 143,
+    /* 5460 */ 245, 344, 217, 191, 180, 270, 372, 65, 396, 302, 396, 330, 348, 367, 256, 252,
+    /* 5470 */ 405, 104, 49, 343, 358, 117, 216, 93, 244, 367, 352, 300, 124, 206, 57, 266,
+    /* 5480 */ 142, 114, 377, 338, 77, 254, 243, 17, 92, 364, 117, 377, 117, 113, 141, 371,
+    /* 5490 */ 92, 57, 396, 339, 146, 104, 146, 412, 21, 183, 71, 227, 320, 312, 350, 131,
+    /* 54A0 */ 256, 82, 78, 108, 386, 348, 367, 178, 405, 204, 201, 394, 365, 132, 396, 98,
+    /* 54B0 */ 304, 379, 352, 113, 129, 158, 126, 324, 350, 78, 359, 357, 111, 363, 169, 367,
+    /* 54C0 */ 2, 251, 300, 332, 122, 356, 77, 339, 112, 378, 372, 68, 240, 351, 2, 100,
+    /* 54D0 */ 161, 362, 57, 352, 14, 129, 222, 125, 355, 159, 77, 87, 132, 229, 209, 370,
+    /* 54E0 */ 116, 374, 183, 254, 195, 98, 237, 38, 297, 173, 212, 408, 117, 157, 352, 350,
+    /* 54F0 */ 169, 20, 391, 386, 176, 6, 204, 178, 317, 92, 21, 114, 120, 101, 311, 98,
+    /* 5500 */ 372, 363, 104, 104, 11, 114, 319, 47, 367, 2, 133, 334, 350, 341, 173, 348,
+    /* 5510 */ 323, 412, 265, 35, 347, 381, 362, 72, 256, 65, 262, 192, 208, 102, 72, 266,
+    /* 5520 */ 169, 176, 319, 381, 127, 168, 293, 132, 408, 346, 88, 138, 124, 256, 303, 343,
+    /* 5530 */ 305, 33, 82, 173, 259, 3, 382, 370, 222, 373, 328, 166, 293, 348, 338, 124,
+    /* 5540 */ 2, 390, 230, 153, 404, 404, 296, 65, 120, 179, 1, 23, 351, 337, 347, 344,
+    /* 5550 */ 54, 293, 104, 256, 256, 324, 59, 59, 366, 405, 14, 54, 43, 117, 362, 256,
+    /* 5560 */ 391, 86, 176, 350, 247, 293, 165, 382, 369, 105, 239, 391, 290, 400, 225, 111,
+    /* 5570 */ 188, 363, 65, 267, 32, 20, 69, 168, 352, 142, 323, 38, 327, 3, 141, 59,
+    /* 5580 */ 146, 371, 343, 214, 295, 373, 391, 165, 137, 123, 114, 68, 396, 31, 340, 234,
+    /* 5590 */ 373, 368, 377, 365, 237, 202, 124, 376, 44, 129, 127, 127, 348, 117, 132, 162,
+    /* 55A0 */ 395, 343, 293, 358, 128, 77, 225, 359, 176, 373, 288, 38, 260, 363, 59, 245,
+    /* 55B0 */ 24, 173, 370, 386, 343, 203, 369, 245, 21, 162, 348, 373, 137, 184, 157, 381,
+    /* 55C0 */ 124, 327, 365, 117, 1, 357, 259, 290, 371, 315, 122, 353, 2, 319, 192, 30,
+    /* 55D0 */ 113, 151, 57, 288, 36, 279, 314, 339, 132, 242, 347, 258, 302, 98, 405, 137,
+    /* 55E0 */ 169, 345, 339, 312, 38, 116, 319, 0, 113, 319, 262, 225, 117, 394, 286, 211,
+    /* 55F0 */ 98, 212, 68, 2, 259, 332, 14, 5, 5, 175, 410, 391, 208, 314, 314, 322,
+    /* 5600 */ 65, 256, 136, 39, 136, 147, 322, 295, 26, 133, 2, 352, 249, 184, 93, 104,
+    /* 5610 */ 352, 124, 129, 111, 238, 350, 382, 33, 358, 253, 62, 192, 192, 124, 171, 73,
+    /* 5620 */ 93, 323, 366, 13, 369, 286, 136, 201, 352, 125, 193, 270, 43, 246, 169, 352,
+    /* 5630 */ 132, 397, 34, 162, 410, 352, 312, 116, 92, 177, 260, 348, 41, 32, 59, 118,
+    /* 5640 */ 361, 78, 411, 84, 38, 129, 379, 45, 52, 59, 373, 337, 29, 136, 366, 348,
+    /* 5650 */ 256, 116, 175, 358, 64, 129, 368, 255, 144, 262, 361, 225, 185, 312, 363, 369,
+    /* 5660 */ 57, 388, 237, 396, 138, 229, 129, 353, 256, 78, 381, 367, 302, 136, 374, 2,
+    /* 5670 */ 371, 144, 159, 373, 245, 61, 93, 121, 76, 60, 354, 286, 247, 247, 368, 410,
+    /* 5680 */ 227, 65, 167, 320, 131, 279, 116, 349, 366, 77, 247, 40, 132, 138, 116, 327,
+    /* 5690 */ 33, 361, 197, 22, 327, 185, 129, 20, 372, 225, 368, 124, 197, 122, 391, 173,
+    /* 56A0 */ 181, 113, 215, 352, 208, 363, 173, 185, 183, 208, 59, 36, 251, 247, 351, 131,
+    /* 56B0 */ 208, 348, 77, 157, 363, 32, 369, 271, 66, 165, 320, 352, 144, 48, 127, 131,
+    /* 56C0 */ 400, 225, 352, 22, 173, 32, 31, 173, 367, 188, 215, 377, 315, 348, 384, 134,
+    /* 56D0 */ 377, 397, 167, 225, 215, 167, 182, 343, 129, 368, 265, 312, 226, 134, 129, 354,
+    /* 56E0 */ 368, 214, 335, 335, 76, 149, 374, 140, 248, 376, 50, 124, 129, 374, 78, 111,
+    /* 56F0 */ 163, 50, 332, 334, 343, 187, 111, 269, 276, 180, 104, 111, 321, 111, 334, 372,
+    /* 5700 */ 111, 368, 130, 255, 373, 114, 374, 187, 267, 373, 263, 111, 44, 343, 374, 267,
+    /* 5710 */ 157, 255, 374, 374, 362, 334, 334, 334, 335, 190, 129, 367, 127, 186, 186, 334,
+    /* 5720 */ 362, 334, 331, 301, 255, 185, 159, 362, 378, 343, 98, 373, 347, 109, 247, 367,
+    /* 5730 */ 62, 258, 258, 392, 404, 60, 257, 349, 295, 161, 33, 256, 225, 208, 132, 133,
+    /* 5740 */ 394, 394, 8, 361, 367, 262, 198, 145, 277, 337, 85, 12, 12, 322, 148, 126,
+    /* 5750 */ 412, 154, 14, 139, 65, 139, 132, 159, 65, 139, 134, 322, 173, 6, 347, 87,
+    /* 5760 */ 402, 253, 8, 323, 163, 266, 322, 394, 338, 95, 252, 66, 105, 221, 321, 247,
+    /* 5770 */ 140, 364, 90, 5, 185, 265, 210, 151, 103, 360, 6, 38, 35, 180, 397, 92,
+    /* 5780 */ 124, 394, 46, 165, 183, 183, 185, 5, 58, 243, 205, 355, 71, 132, 117, 189,
+    /* 5790 */ 49, 38, 171, 94, 368, 123, 75, 390, 92, 108, 365, 77, 77, 109, 30, 364,
+    /* 57A0 */ 368, 83, 103, 374, 68, 353, 153, 296, 303, 78, 19, 66, 122, 362, 158, 57,
+    /* 57B0 */ 146, 60, 147, 115, 216, 3, 355, 350, 374, 9, 92, 6, 367, 368, 114, 358,
+    /* 57C0 */ 46, 262, 101, 2, 13, 85, 268, 371, 145, 133, 65, 193, 168, 143, 37, 295,
+    /* 57D0 */ 138, 391, 178, 178, 21, 37, 125, 21, 302, 361, 111, 140, 366, 222, 65, 373,
+    /* 57E0 */ 21, 362, 267, 317, 247, 263, 341, 142, 187, 393, 155, 39, 71, 58, 322, 3,
+    /* 57F0 */ 23, 41, 13, 148, 394, 77, 367, 394, 367, 244, 132, 403, 256, 289, 142, 221,
+    /* 5800 */ 157, 151, 323, 163, 221, 134, 75, 138, 96, 373, 78, 246, 104, 334, 172, 85,
+    /* 5810 */ 362, 258, 163, 3, 300, 77, 216, 334, 37, 368, 130, 14, 175, 111, 68, 400,
+    /* 5820 */ 123, 10, 10, 373, 65, 196, 137, 281, 366, 101, 148, 406, 373, 128, 78, 365,
+    /* 5830 */ 363, 10, 49, 198, 33, 73, 338, 368, 88, 395, 137, 138, 120, 96, 47, 134,
+    /* 5840 */ 252, 171, 351, 128, 172, 74, 341, 359, 132, 132, 159, 369, 320, 37, 371, 147,
+    /* 5850 */ 315, 315, 302, 201, 320, 345, 37, 334, 323, 268, 395, 173, 395, 9, 286, 380,
+    /* 5860 */ 75, 328, 347, 393, 361, 98, 392, 2, 102, 363, 148, 328, 374, 344, 353, 181,
+    /* 5870 */ 113, 168, 33, 246, 13, 36, 185, 185, 238, 258, 198, 208, 400, 308, 304, 184,
+    /* 5880 */ 38, 194, 16, 139, 27, 304, 394, 389, 148, 371, 66, 36, 394, 348, 111, 259,
+    /* 5890 */ 138, 65, 296, 210, 54, 363, 320, 385, 258, 259, 176, 343, 402, 260, 385, 358,
+    /* 58A0 */ 295, 295, 6, 255, 159, 71, 84, 268, 208, 76, 76, 411, 65, 301, 77, 77,
+    /* 58B0 */ 322, 64, 210, 87, 128, 322, 57, 366, 397, 134, 5, 259, 132, 260, 153, 367,
+    /* 58C0 */ 247, 14, 66, 135, 366, 371, 360, 322, 167, 142, 126, 60, 271, 258, 361, 350,
+    /* 58D0 */ 348, 117, 2, 362, 61, 116, 281, 138, 171, 161, 185, 363, 322, 343, 126, 183,
+    /* 58E0 */ 183, 282, 173, 179, 271, 32, 361, 363, 171, 6, 341, 302, 274, 287, 401, 401,
+    /* 58F0 */ 301, 367, 193, 151, 397, 401, 124, 124, 163, 367, 124, 358, 163, 303, 195, 411,
+    /* 5900 */ 303, 367, 394, 104, 41, 135, 88, 11, 387, 15, 317, 269, 180, 92, 56, 349,
+    /* 5910 */ 356, 353, 216, 349, 162, 348, 340, 374, 196, 315, 77, 77, 366, 263, 340, 103,
+    /* 5920 */ 103, 256, 200, 200, 368, 131, 36, 57, 382, 328, 321, 92, 106, 365, 364, 115,
+    /* 5930 */ 97, 302, 324, 321, 333, 363, 14, 367, 158, 133, 77, 125, 161, 376, 133, 6,
+    /* 5940 */ 80, 175, 127, 65, 363, 243, 143, 256, 213, 88, 353, 87, 66, 267, 162, 407,
+    /* 5950 */ 127, 256, 147, 386, 12, 367, 135, 324, 380, 12, 348, 128, 86, 67, 361, 13,
+    /* 5960 */ 66, 5, 298, 345, 112, 5, 347, 5, 135, 175, 77, 376, 135, 302, 87, 131,
+    /* 5970 */ 14, 186, 77, 235, 231, 69, 213, 258, 134, 320, 141, 232, 30, 116, 350, 84,
+    /* 5980 */ 132, 311, 279, 86, 342, 122, 401, 92, 192, 59, 274, 92, 139, 363, 113, 344,
+    /* 5990 */ 395, 239, 73, 132, 154, 395, 365, 138, 376, 203, 91, 38, 375, 401, 228, 363,
+    /* 59A0 */ 212, 354, 87, 14, 373, 338, 88, 341, 85, 347, 373, 109, 73, 6, 221, 396,
+    /* 59B0 */ 404, 390, 57, 213, 374, 333, 350, 394, 78, 198, 208, 256, 14, 300, 261, 78,
+    /* 59C0 */ 117, 358, 83, 393, 205, 8, 210, 92, 180, 405, 405, 302, 270, 295, 364, 194,
+    /* 59D0 */ 137, 104, 312, 355, 343, 405, 142, 295, 251, 274, 365, 71, 135, 304, 132, 94,
+    /* 59E0 */ 351, 125, 143, 136, 103, 169, 134, 134, 367, 222, 394, 132, 132, 350, 120, 108,
+    /* 59F0 */ 145, 158, 363, 206, 178, 244, 78, 372, 363, 30, 300, 368, 302, 109, 267, 405,
+    /* 5A00 */ 313, 343, 122, 339, 184, 362, 272, 136, 186, 252, 350, 297, 173, 37, 353, 195,
+    /* 5A10 */ 92, 319, 198, 343, 151, 48, 48, 331, 223, 355, 214, 373, 212, 254, 218, 143,
+    /* 5A20 */ 300, 394, 114, 65, 401, 78, 251, 336, 350, 202, 347, 363, 347, 2, 363, 373,
+    /* 5A30 */ 312, 373, 339, 173, 350, 142, 266, 402, 256, 350, 404, 71, 33, 185, 2, 78,
+    /* 5A40 */ 78, 184, 202, 50, 254, 142, 253, 23, 180, 341, 16, 352, 304, 256, 129, 84,
+    /* 5A50 */ 346, 282, 322, 86, 86, 137, 328, 221, 267, 139, 130, 139, 258, 66, 355, 124,
+    /* 5A60 */ 341, 166, 14, 368, 40, 216, 92, 139, 187, 3, 167, 163, 368, 362, 142, 173,
+    /* 5A70 */ 66, 350, 125, 125, 369, 32, 300, 331, 60, 365, 347, 214, 48, 133, 333, 358,
+    /* 5A80 */ 373, 343, 65, 278, 198, 59, 281, 262, 129, 346, 258, 47, 203, 92, 137, 74,
+    /* 5A90 */ 367, 395, 198, 128, 202, 3, 369, 359, 137, 343, 198, 374, 393, 265, 302, 353,
+    /* 5AA0 */ 338, 175, 196, 270, 312, 248, 343, 339, 52, 124, 5, 137, 10, 358, 333, 109,
+    /* 5AB0 */ 41, 365, 247, 348, 374, 369, 277, 279, 38, 181, 198, 241, 5, 192, 103, 162,
+    /* 5AC0 */ 262, 133, 289, 392, 374, 137, 277, 206, 369, 132, 315, 224, 350, 324, 242, 168,
+    /* 5AD0 */ 216, 10, 2, 247, 251, 367, 249, 373, 171, 359, 194, 367, 389, 149, 371, 221,
+    /* 5AE0 */ 173, 65, 109, 363, 138, 400, 33, 382, 114, 219, 169, 208, 391, 124, 124, 5,
+    /* 5AF0 */ 219, 259, 192, 250, 104, 347, 260, 338, 388, 203, 350, 350, 208, 177, 175, 125,
+    /* 5B00 */ 109, 64, 394, 358, 367, 125, 348, 162, 272, 348, 363, 32, 136, 198, 84, 84,
+    /* 5B10 */ 350, 367, 129, 136, 92, 302, 14, 295, 317, 259, 175, 127, 354, 224, 71, 367,
+    /* 5B20 */ 24, 2, 223, 227, 192, 329, 40, 138, 49, 373, 251, 277, 279, 213, 363, 321,
+    /* 5B30 */ 369, 258, 224, 375, 369, 202, 14, 192, 300, 355, 221, 73, 181, 374, 167, 363,
+    /* 5B40 */ 308, 180, 136, 223, 167, 258, 369, 308, 129, 267, 201, 173, 186, 363, 397, 167,
+    /* 5B50 */ 405, 137, 144, 144, 155, 376, 192, 405, 55, 318, 92, 11, 405, 352, 354, 200,
+    /* 5B60 */ 312, 321, 10, 132, 104, 231, 360, 372, 400, 113, 186, 318, 216, 204, 50, 258,
+    /* 5B70 */ 304, 24, 362, 405, 221, 92, 405, 173, 360, 20, 279, 213, 225, 225, 369, 186,
+    /* 5B80 */ 202, 227, 277, 320, 109, 387, 264, 373, 303, 3, 334, 313, 341, 278, 365, 122,
+    /* 5B90 */ 367, 139, 403, 201, 397, 60, 122, 406, 107, 396, 69, 341, 367, 10, 302, 302,
+    /* 5BA0 */ 39, 300, 151, 359, 302, 372, 127, 367, 329, 302, 350, 102, 37, 269, 102, 352,
+    /* 5BB0 */ 378, 386, 10, 113, 363, 352, 133, 300, 36, 277, 128, 201, 156, 160, 18, 315,
+    /* 5BC0 */ 23, 379, 132, 374, 132, 368, 201, 156, 263, 117, 392, 134, 92, 227, 19, 127,
+    /* 5BD0 */ 198, 262, 114, 373, 302, 227, 138, 227, 394, 373, 10, 160, 227, 262, 208, 30,
+    /* 5BE0 */ 142, 105, 262, 124, 347, 177, 302, 227, 387, 300, 343, 353, 160, 129, 177, 145,
+    /* 5BF0 */ 127, 367, 367, 10, 262, 39, 10, 88, 55, 75, 312, 361, 61, 189, 75, 303,
+    /* 5C00 */ 253, 88, 400, 92, 298, 151, 135, 135, 400, 343, 411, 361, 304, 75, 61, 352,
+    /* 5C10 */ 137, 297, 82, 82, 82, 93, 134, 304, 36, 296, 296, 208, 93, 33, 177, 350,
+    /* 5C20 */ 350, 163, 372, 342, 372, 177, 177, 365, 195, 342, 342, 342, 93, 365, 77, 162,
+    /* 5C30 */ 395, 141, 95, 104, 95, 336, 95, 95, 302, 368, 38, 150, 221, 138, 343, 224,
+    /* 5C40 */ 142, 247, 29, 348, 14, 142, 137, 328, 266, 327, 137, 347, 67, 302, 302, 252,
+    /* 5C50 */ 132, 353, 392, 353, 221, 388, 348, 343, 194, 78, 184, 252, 327, 86, 304, 353,
+    /* 5C60 */ 334, 189, 189, 348, 29, 189, 142, 353, 142, 144, 177, 144, 304, 348, 35, 337,
+    /* 5C70 */ 221, 295, 339, 350, 173, 78, 129, 129, 183, 367, 256, 274, 347, 114, 300, 373,
+    /* 5C80 */ 41, 317, 256, 274, 375, 8, 365, 4, 362, 347, 137, 78, 132, 258, 87, 341,
+    /* 5C90 */ 256, 28, 258, 256, 30, 137, 266, 96, 350, 5, 167, 61, 6, 412, 412, 364,
+    /* 5CA0 */ 142, 96, 151, 103, 360, 253, 173, 329, 266, 363, 92, 357, 133, 180, 338, 247,
+    /* 5CB0 */ 5, 58, 161, 375, 266, 124, 253, 205, 3, 329, 180, 38, 252, 71, 114, 162,
+    /* 5CC0 */ 357, 196, 332, 360, 367, 15, 117, 6, 188, 78, 92, 361, 68, 185, 80, 82,
+    /* 5CD0 */ 94, 267, 71, 367, 210, 302, 3, 343, 127, 394, 201, 173, 132, 332, 343, 372,
+    /* 5CE0 */ 257, 349, 173, 365, 136, 393, 186, 136, 78, 78, 373, 353, 21, 260, 269, 88,
+    /* 5CF0 */ 88, 216, 173, 372, 350, 277, 61, 300, 37, 334, 101, 145, 97, 349, 368, 373,
+    /* 5D00 */ 168, 148, 169, 166, 350, 268, 155, 39, 39, 320, 179, 125, 142, 166, 256, 205,
+    /* 5D10 */ 163, 163, 408, 104, 54, 362, 362, 96, 187, 187, 172, 144, 77, 393, 111, 368,
+    /* 5D20 */ 71, 114, 393, 343, 352, 247, 363, 313, 137, 13, 408, 157, 71, 388, 104, 368,
+    /* 5D30 */ 405, 382, 128, 373, 340, 364, 88, 265, 364, 327, 367, 394, 302, 378, 365, 78,
+    /* 5D40 */ 397, 148, 189, 363, 198, 114, 132, 132, 127, 331, 301, 198, 258, 347, 373, 406,
+    /* 5D50 */ 167, 151, 363, 363, 343, 406, 30, 317, 277, 151, 262, 373, 256, 184, 334, 75,
+    /* 5D60 */ 348, 345, 25, 60, 277, 137, 147, 181, 347, 313, 260, 405, 343, 13, 66, 56,
+    /* 5D70 */ 258, 371, 225, 56, 132, 302, 284, 313, 406, 135, 177, 149, 32, 68, 28, 69,
+    /* 5D80 */ 334, 184, 389, 388, 388, 5, 26, 266, 259, 54, 410, 61, 61, 348, 373, 244,
+    /* 5D90 */ 183, 351, 29, 20, 262, 136, 363, 169, 388, 179, 177, 177, 138, 64, 77, 411,
+    /* 5DA0 */ 136, 109, 365, 136, 365, 144, 388, 367, 360, 216, 366, 366, 367, 225, 350, 132,
+    /* 5DB0 */ 353, 151, 348, 65, 5, 410, 343, 367, 277, 61, 180, 137, 373, 375, 368, 279,
+    /* 5DC0 */ 137, 173, 109, 183, 183, 66, 277, 348, 142, 32, 369, 162, 363, 343, 216, 267,
+    /* 5DD0 */ 34, 53, 186, 66, 66, 225, 363, 363, 363, 162, 363, 44, 159, 44, 396, 128,
+    /* 5DE0 */ 139, 361, 34, 34, 178, 102, 412, 260, 142, 102, 142, 347, 255, 255, 30, 265,
+    /* 5DF0 */ 265, 132, 367, 312, 6, 394, 390, 351, 367, 138, 361, 143, 6, 361, 138, 92,
+    /* 5E00 */ 377, 14, 302, 21, 69, 306, 84, 225, 302, 87, 239, 394, 348, 124, 59, 343,
+    /* 5E10 */ 389, 323, 58, 208, 244, 239, 330, 20, 175, 394, 396, 20, 394, 65, 208, 367,
+    /* 5E20 */ 367, 252, 257, 143, 279, 306, 58, 393, 309, 260, 392, 302, 269, 348, 9, 58,
+    /* 5E30 */ 109, 40, 252, 389, 287, 341, 58, 343, 33, 293, 256, 382, 111, 196, 73, 123,
+    /* 5E40 */ 393, 358, 201, 343, 346, 92, 367, 9, 252, 68, 102, 241, 128, 324, 201, 133,
+    /* 5E50 */ 326, 129, 395, 295, 194, 210, 16, 111, 382, 210, 9, 389, 139, 32, 92, 394,
+    /* 5E60 */ 124, 84, 45, 14, 14, 389, 201, 260, 32, 87, 200, 9, 40, 204, 41, 137,
+    /* 5E70 */ 350, 167, 95, 252, 222, 134, 19, 19, 355, 95, 365, 127, 372, 372, 132, 108,
+    /* 5E80 */ 247, 331, 382, 108, 401, 208, 263, 14, 262, 76, 45, 109, 362, 7, 137, 358,
+    /* 5E90 */ 185, 347, 401, 157, 369, 65, 243, 66, 362, 203, 101, 49, 92, 332, 242, 86,
+    /* 5EA0 */ 351, 367, 394, 329, 394, 357, 73, 412, 352, 334, 109, 157, 195, 331, 372, 21,
+    /* 5EB0 */ 19, 37, 166, 14, 132, 3, 304, 149, 371, 338, 313, 304, 263, 373, 373, 203,
+    /* 5EC0 */ 314, 27, 351, 86, 141, 78, 109, 181, 293, 175, 168, 314, 394, 21, 263, 141,
+    /* 5ED0 */ 141, 138, 5, 164, 184, 368, 177, 58, 185, 367, 41, 32, 334, 312, 354, 203,
+    /* 5EE0 */ 33, 347, 86, 108, 157, 159, 14, 259, 353, 179, 179, 177, 185, 132, 369, 350,
+    /* 5EF0 */ 331, 371, 173, 331, 368, 361, 363, 331, 65, 240, 134, 129, 213, 129, 102, 222,
+    /* 5F00 */ 147, 15, 367, 256, 229, 87, 142, 363, 367, 380, 14, 367, 367, 82, 287, 302,
+    /* 5F10 */ 82, 302, 302, 102, 67, 368, 124, 92, 122, 347, 336, 38, 135, 6, 300, 65,
+    /* 5F20 */ 389, 144, 324, 92, 65, 201, 350, 124, 34, 231, 139, 392, 367, 201, 267, 341,
+    /* 5F30 */ 297, 284, 359, 139, 67, 389, 135, 259, 246, 59, 259, 14, 14, 298, 59, 134,
+    /* 5F40 */ 103, 98, 83, 14, 156, 134, 17, 352, 59, 111, 135, 122, 201, 111, 341, 144,
+    /* 5F50 */ 132, 132, 109, 60, 185, 185, 335, 129, 394, 129, 129, 367, 367, 367, 367, 375,
+    /* 5F60 */ 375, 295, 355, 344, 332, 363, 363, 373, 38, 23, 16, 67, 18, 246, 371, 249,
+    /* 5F70 */ 389, 369, 38, 38, 404, 338, 132, 85, 395, 367, 342, 35, 14, 65, 180, 92,
+    /* 5F80 */ 342, 393, 52, 342, 139, 58, 348, 361, 119, 364, 126, 189, 123, 342, 37, 394,
+    /* 5F90 */ 358, 139, 334, 50, 394, 166, 50, 62, 240, 348, 71, 132, 33, 394, 50, 396,
+    /* 5FA0 */ 166, 373, 353, 137, 134, 302, 133, 15, 128, 92, 361, 343, 242, 365, 343, 348,
+    /* 5FB0 */ 393, 249, 327, 62, 393, 394, 17, 62, 39, 35, 136, 129, 136, 129, 198, 183,
+    /* 5FC0 */ 351, 10, 266, 354, 354, 14, 367, 170, 274, 61, 69, 94, 132, 274, 274, 32,
+    /* 5FD0 */ 322, 325, 325, 95, 256, 302, 55, 394, 342, 195, 348, 84, 369, 328, 205, 344,
+    /* 5FE0 */ 395, 39, 347, 132, 347, 348, 133, 372, 341, 50, 313, 159, 373, 15, 394, 256,
+    /* 5FF0 */ 54, 36, 321, 337, 258, 222, 130, 356, 228, 161, 350, 354, 149, 124, 147, 87,
+    /* 6000 */ 126, 321, 313, 347, 238, 33, 45, 142, 367, 10, 34, 205, 244, 412, 384, 364,
+    /* 6010 */ 142, 8, 231, 216, 393, 239, 21, 330, 124, 124, 142, 57, 175, 312, 40, 65,
+    /* 6020 */ 58, 367, 334, 372, 92, 132, 246, 355, 374, 221, 106, 92, 348, 14, 372, 261,
+    /* 6030 */ 359, 50, 19, 128, 358, 41, 14, 304, 348, 322, 371, 406, 75, 208, 394, 367,
+    /* 6040 */ 302, 219, 361, 302, 348, 169, 120, 161, 209, 394, 353, 175, 329, 128, 68, 116,
+    /* 6050 */ 155, 109, 120, 348, 136, 304, 312, 124, 265, 364, 129, 129, 38, 133, 367, 356,
+    /* 6060 */ 106, 179, 129, 405, 358, 38, 296, 235, 119, 80, 151, 71, 328, 102, 267, 348,
+    /* 6070 */ 257, 375, 246, 153, 62, 129, 78, 352, 332, 363, 147, 27, 216, 376, 195, 371,
+    /* 6080 */ 371, 374, 247, 163, 260, 375, 373, 334, 137, 348, 391, 179, 327, 114, 116, 261,
+    /* 6090 */ 327, 21, 367, 258, 129, 348, 11, 194, 367, 120, 313, 267, 37, 162, 347, 347,
+    /* 60A0 */ 372, 173, 176, 127, 50, 367, 375, 173, 226, 216, 78, 268, 359, 258, 347, 205,
+    /* 60B0 */ 50, 86, 11, 62, 54, 33, 199, 173, 132, 107, 107, 355, 61, 256, 155, 328,
+    /* 60C0 */ 187, 348, 148, 110, 221, 263, 40, 76, 111, 388, 139, 341, 374, 138, 132, 167,
+    /* 60D0 */ 373, 131, 117, 267, 322, 327, 327, 225, 342, 48, 124, 130, 348, 33, 354, 343,
+    /* 60E0 */ 129, 78, 319, 406, 134, 371, 66, 142, 24, 37, 62, 11, 261, 24, 59, 107,
+    /* 60F0 */ 77, 216, 376, 351, 402, 68, 128, 47, 264, 273, 355, 27, 15, 205, 406, 327,
+    /* 6100 */ 260, 40, 11, 359, 343, 98, 258, 343, 373, 373, 14, 359, 127, 205, 14, 367,
+    /* 6110 */ 202, 371, 147, 60, 368, 78, 36, 196, 257, 151, 373, 2, 261, 363, 234, 95,
+    /* 6120 */ 376, 406, 286, 172, 87, 369, 162, 162, 268, 102, 376, 315, 315, 256, 365, 313,
+    /* 6130 */ 128, 132, 104, 142, 45, 221, 353, 147, 393, 371, 26, 361, 300, 20, 147, 374,
+    /* 6140 */ 348, 130, 371, 364, 173, 289, 324, 368, 49, 358, 258, 321, 128, 376, 300, 206,
+    /* 6150 */ 102, 298, 50, 249, 210, 210, 111, 38, 24, 24, 24, 54, 205, 325, 389, 332,
+    /* 6160 */ 5, 308, 194, 107, 268, 381, 141, 129, 147, 175, 238, 313, 262, 368, 189, 296,
+    /* 6170 */ 343, 335, 194, 258, 298, 371, 263, 149, 65, 394, 184, 143, 256, 256, 373, 252,
+    /* 6180 */ 177, 50, 372, 39, 394, 332, 37, 256, 266, 246, 11, 17, 264, 136, 385, 38,
+    /* 6190 */ 175, 252, 162, 129, 260, 37, 368, 368, 348, 348, 59, 322, 77, 75, 75, 315,
+    /* 61A0 */ 144, 27, 352, 84, 87, 169, 169, 39, 114, 256, 350, 205, 139, 177, 347, 24,
+    /* 61B0 */ 144, 52, 350, 322, 301, 247, 367, 41, 350, 216, 59, 322, 139, 313, 114, 136,
+    /* 61C0 */ 343, 359, 71, 262, 262, 142, 26, 153, 353, 369, 5, 196, 367, 179, 290, 145,
+    /* 61D0 */ 126, 199, 167, 2, 179, 363, 164, 349, 38, 373, 368, 58, 200, 2, 200, 75,
+    /* 61E0 */ 256, 208, 167, 199, 40, 394, 234, 234, 363, 364, 20, 394, 161, 161, 372, 92,
+    /* 61F0 */ 181, 204, 37, 129, 32, 200, 167, 126, 359, 271, 32, 132, 142, 127, 298, 367,
+    /* 6200 */ 175, 214, 201, 323, 144, 96, 96, 401, 98, 375, 347, 134, 358, 304, 277, 348,
+    /* 6210 */ 37, 346, 137, 98, 134, 259, 131, 259, 388, 71, 256, 133, 68, 383, 133, 132,
+    /* 6220 */ 394, 148, 132, 162, 94, 64, 388, 259, 98, 134, 137, 373, 134, 363, 185, 124,
+    /* 6230 */ 388, 348, 348, 48, 58, 266, 124, 124, 124, 78, 302, 327, 196, 124, 173, 85,
+    /* 6240 */ 319, 15, 66, 140, 296, 367, 367, 295, 124, 86, 363, 303, 303, 23, 386, 265,
+    /* 6250 */ 170, 255, 6, 57, 275, 84, 279, 378, 338, 389, 67, 149, 373, 157, 95, 300,
+    /* 6260 */ 30, 338, 104, 156, 347, 63, 258, 394, 274, 164, 199, 289, 364, 228, 8, 35,
+    /* 6270 */ 272, 348, 258, 8, 133, 373, 92, 5, 348, 247, 394, 394, 78, 63, 390, 37,
+    /* 6280 */ 132, 363, 161, 15, 34, 142, 344, 124, 375, 144, 6, 262, 59, 393, 376, 341,
+    /* 6290 */ 217, 367, 304, 398, 254, 333, 72, 149, 391, 254, 92, 243, 6, 5, 382, 335,
+    /* 62A0 */ 156, 187, 259, 376, 124, 10, 19, 394, 246, 214, 21, 247, 321, 365, 392, 386,
+    /* 62B0 */ 364, 10, 117, 221, 366, 65, 38, 247, 133, 208, 198, 36, 362, 40, 266, 205,
+    /* 62C0 */ 41, 133, 92, 386, 397, 59, 31, 210, 222, 165, 92, 243, 8, 240, 179, 212,
+    /* 62D0 */ 106, 258, 142, 320, 6, 338, 338, 5, 142, 404, 241, 390, 7, 7, 65, 221,
+    /* 62E0 */ 142, 164, 183, 134, 257, 371, 167, 227, 20, 382, 258, 119, 164, 302, 137, 393,
+    /* 62F0 */ 226, 102, 102, 267, 307, 55, 377, 150, 367, 353, 27, 129, 251, 399, 302, 212,
+    /* 6300 */ 7, 38, 105, 394, 164, 77, 77, 394, 261, 3, 229, 392, 98, 136, 158, 71,
+    /* 6310 */ 212, 329, 178, 386, 189, 68, 339, 144, 178, 142, 394, 186, 362, 346, 320, 353,
+    /* 6320 */ 216, 60, 136, 393, 132, 129, 350, 373, 2, 338, 234, 56, 20, 101, 327, 392,
+    /* 6330 */ 37, 285, 285, 154, 198, 229, 142, 246, 134, 367, 331, 295, 280, 341, 353, 30,
+    /* 6340 */ 88, 136, 347, 145, 141, 332, 163, 131, 334, 404, 254, 189, 6, 114, 297, 225,
+    /* 6350 */ 143, 382, 304, 366, 144, 21, 341, 21, 411, 366, 387, 189, 314, 338, 169, 318,
+    /* 6360 */ 9, 134, 127, 61, 343, 341, 262, 246, 298, 178, 205, 199, 92, 7, 142, 61,
+    /* 6370 */ 346, 2, 143, 375, 406, 36, 46, 137, 334, 12, 212, 222, 284, 412, 346, 256,
+    /* 6380 */ 350, 37, 66, 289, 187, 263, 96, 77, 303, 67, 254, 65, 389, 130, 132, 324,
+    /* 6390 */ 257, 256, 240, 304, 258, 180, 366, 362, 144, 393, 176, 105, 367, 131, 295, 393,
+    /* 63A0 */ 190, 23, 322, 35, 19, 137, 327, 155, 336, 363, 56, 396, 142, 328, 258, 153,
+    /* 63B0 */ 7, 239, 137, 185, 106, 206, 137, 394, 59, 200, 24, 289, 107, 246, 374, 234,
+    /* 63C0 */ 134, 393, 141, 134, 373, 363, 162, 214, 122, 278, 247, 343, 286, 407, 359, 203,
+    /* 63D0 */ 327, 225, 30, 302, 406, 392, 367, 361, 371, 15, 364, 127, 363, 379, 3, 358,
+    /* 63E0 */ 362, 346, 151, 43, 132, 327, 165, 165, 36, 147, 141, 141, 334, 137, 129, 100,
+    /* 63F0 */ 39, 352, 68, 353, 374, 258, 366, 30, 386, 11, 365, 343, 13, 167, 344, 262,
+    /* 6400 */ 32, 98, 184, 406, 100, 136, 103, 262, 277, 268, 40, 43, 388, 318, 318, 20,
+    /* 6410 */ 41, 277, 9, 56, 289, 151, 365, 61, 394, 231, 165, 134, 314, 265, 97, 350,
+    /* 6420 */ 311, 288, 138, 204, 78, 46, 234, 295, 320, 386, 323, 241, 8, 57, 173, 324,
+    /* 6430 */ 124, 394, 339, 125, 258, 344, 259, 328, 392, 78, 353, 234, 267, 30, 386, 98,
+    /* 6440 */ 347, 80, 298, 149, 298, 304, 7, 365, 18, 314, 322, 285, 32, 319, 141, 39,
+    /* 6450 */ 45, 106, 19, 88, 306, 65, 256, 314, 387, 175, 37, 38, 107, 185, 188, 184,
+    /* 6460 */ 406, 94, 124, 386, 45, 323, 125, 54, 213, 208, 135, 109, 369, 394, 5, 394,
+    /* 6470 */ 225, 194, 32, 156, 41, 298, 335, 136, 208, 208, 391, 24, 154, 16, 135, 365,
+    /* 6480 */ 103, 258, 177, 132, 369, 144, 250, 250, 169, 76, 350, 281, 109, 379, 367, 350,
+    /* 6490 */ 37, 37, 285, 216, 122, 312, 114, 108, 57, 411, 222, 179, 393, 129, 401, 136,
+    /* 64A0 */ 132, 26, 59, 59, 35, 20, 35, 144, 92, 177, 12, 92, 260, 20, 56, 404,
+    /* 64B0 */ 400, 343, 255, 262, 76, 222, 125, 353, 185, 136, 53, 320, 114, 260, 346, 134,
+    /* 64C0 */ 95, 371, 171, 215, 185, 295, 404, 382, 255, 48, 132, 60, 290, 26, 263, 263,
+    /* 64D0 */ 127, 137, 262, 159, 59, 353, 146, 247, 7, 5, 142, 366, 78, 200, 314, 201,
+    /* 64E0 */ 132, 321, 404, 61, 355, 167, 22, 142, 366, 279, 366, 366, 221, 346, 137, 18,
+    /* 64F0 */ 227, 98, 394, 394, 164, 208, 134, 353, 178, 322, 7, 314, 185, 190, 272, 327,
+    /* 6500 */ 241, 364, 171, 22, 304, 379, 222, 350, 145, 131, 173, 165, 127, 369, 185, 183,
+    /* 6510 */ 258, 258, 379, 258, 167, 350, 369, 198, 271, 32, 345, 53, 353, 298, 188, 145,
+    /* 6520 */ 201, 38, 379, 186, 322, 409, 173, 66, 339, 60, 136, 144, 167, 173, 215, 394,
+    /* 6530 */ 109, 109, 256, 361, 255, 255, 303, 150, 372, 94, 367, 102, 95, 8, 85, 393,
+    /* 6540 */ 253, 66, 156, 205, 347, 104, 117, 27, 352, 201, 41, 98, 65, 358, 136, 205,
+    /* 6550 */ 36, 141, 300, 77, 373, 38, 5, 7, 358, 136, 77, 175, 225, 14, 33, 66,
+    /* 6560 */ 77, 367, 95, 287, 151, 363, 76, 132, 333, 352, 77, 136, 139, 364, 349, 205,
+    /* 6570 */ 304, 2, 260, 2, 393, 65, 392, 92, 304, 177, 266, 356, 367, 136, 295, 136,
+    /* 6580 */ 404, 367, 175, 14, 173, 352, 352, 344, 360, 256, 256, 387, 18, 144, 387, 168,
+    /* 6590 */ 86, 8, 8, 167, 373, 167, 343, 72, 301, 177, 133, 124, 353, 133, 373, 392,
+    /* 65A0 */ 136, 346, 329, 72, 138, 38, 368, 92, 259, 388, 266, 404, 388, 74, 56, 312,
+    /* 65B0 */ 354, 404, 404, 262, 179, 404, 41, 74, 397, 85, 32, 115, 373, 302, 244, 372,
+    /* 65C0 */ 198, 242, 256, 388, 196, 189, 244, 247, 181, 92, 85, 359, 139, 139, 221, 408,
+    /* 65D0 */ 390, 367, 181, 297, 134, 373, 367, 256, 394, 84, 249, 84, 388, 159, 317, 373,
+    /* 65E0 */ 347, 132, 132, 132, 131, 276, 59, 141, 394, 381, 353, 329, 361, 358, 93, 165,
+    /* 65F0 */ 95, 114, 321, 65, 358, 32, 302, 161, 364, 302, 342, 205, 205, 337, 47, 347,
+    /* 6600 */ 376, 11, 4, 382, 8, 137, 163, 301, 124, 85, 116, 109, 33, 359, 206, 130,
+    /* 6610 */ 87, 262, 124, 367, 348, 354, 363, 382, 85, 322, 300, 142, 364, 379, 19, 355,
+    /* 6620 */ 369, 359, 253, 392, 180, 47, 116, 198, 412, 208, 15, 358, 130, 390, 406, 302,
+    /* 6630 */ 302, 373, 86, 68, 196, 221, 33, 344, 71, 2, 19, 4, 396, 183, 350, 161,
+    /* 6640 */ 329, 34, 302, 128, 128, 359, 162, 358, 136, 138, 394, 138, 296, 332, 122, 363,
+    /* 6650 */ 94, 351, 294, 352, 366, 376, 129, 114, 114, 145, 341, 350, 163, 396, 348, 37,
+    /* 6660 */ 301, 21, 391, 391, 347, 341, 129, 116, 36, 341, 328, 404, 410, 396, 255, 139,
+    /* 6670 */ 348, 295, 221, 348, 263, 256, 139, 109, 393, 367, 394, 3, 341, 179, 176, 33,
+    /* 6680 */ 342, 352, 379, 86, 359, 101, 367, 349, 376, 129, 358, 205, 162, 366, 369, 304,
+    /* 6690 */ 343, 304, 263, 196, 214, 134, 232, 3, 364, 47, 365, 319, 255, 206, 136, 147,
+    /* 66A0 */ 97, 345, 33, 256, 116, 363, 173, 2, 132, 132, 199, 379, 353, 116, 210, 208,
+    /* 66B0 */ 50, 221, 389, 129, 10, 114, 359, 44, 177, 350, 322, 139, 250, 179, 337, 348,
+    /* 66C0 */ 367, 132, 128, 58, 366, 366, 173, 322, 332, 352, 86, 300, 390, 116, 367, 351,
+    /* 66D0 */ 355, 300, 136, 10, 139, 363, 2, 366, 279, 304, 200, 361, 365, 255, 173, 36,
+    /* 66E0 */ 161, 68, 177, 363, 131, 185, 348, 277, 183, 215, 188, 186, 294, 323, 363, 397,
+    /* 66F0 */ 375, 375, 266, 366, 101, 366, 124, 117, 304, 26, 26, 301, 194, 29, 29, 327,
+    /* 6700 */ 410, 24, 358, 129, 368, 261, 87, 247, 375, 372, 281, 246, 87, 92, 180, 86,
+    /* 6710 */ 266, 327, 235, 329, 311, 392, 168, 168, 410, 206, 128, 342, 337, 34, 132, 256,
+    /* 6720 */ 369, 406, 342, 332, 168, 169, 200, 183, 210, 64, 343, 208, 12, 386, 304, 304,
+    /* 6730 */ 210, 397, 274, 6, 255, 77, 77, 61, 173, 109, 132, 141, 14, 357, 37, 49,
+    /* 6740 */ 293, 279, 377, 267, 258, 373, 95, 347, 30, 295, 361, 84, 347, 405, 173, 355,
+    /* 6750 */ 23, 55, 274, 16, 338, 65, 389, 195, 38, 367, 94, 102, 73, 173, 256, 304,
+    /* 6760 */ 96, 329, 135, 202, 341, 166, 141, 195, 364, 192, 203, 312, 374, 115, 86, 11,
+    /* 6770 */ 137, 71, 97, 365, 350, 41, 47, 239, 304, 125, 354, 40, 397, 40, 313, 8,
+    /* 6780 */ 313, 132, 346, 138, 103, 132, 196, 247, 14, 342, 4, 85, 87, 367, 92, 214,
+    /* 6790 */ 348, 124, 362, 72, 354, 392, 365, 179, 282, 78, 198, 390, 111, 394, 50, 376,
+    /* 67A0 */ 410, 301, 304, 381, 65, 173, 185, 134, 37, 313, 259, 88, 388, 352, 350, 157,
+    /* 67B0 */ 252, 321, 348, 394, 106, 352, 133, 133, 103, 10, 208, 367, 366, 366, 302, 225,
+    /* 67C0 */ 14, 77, 367, 180, 19, 221, 165, 117, 8, 84, 395, 58, 49, 364, 92, 7,
+    /* 67D0 */ 209, 95, 256, 270, 278, 196, 297, 313, 391, 349, 372, 300, 109, 338, 386, 214,
+    /* 67E0 */ 227, 371, 65, 394, 386, 30, 59, 104, 21, 141, 5, 92, 134, 6, 77, 151,
+    /* 67F0 */ 213, 397, 14, 181, 31, 295, 312, 41, 244, 302, 106, 386, 365, 37, 141, 302,
+    /* 6800 */ 394, 181, 198, 173, 277, 386, 381, 16, 388, 394, 183, 71, 185, 301, 173, 167,
+    /* 6810 */ 371, 304, 361, 307, 256, 392, 256, 173, 367, 351, 392, 173, 290, 105, 148, 12,
+    /* 6820 */ 274, 352, 7, 274, 19, 405, 40, 367, 49, 358, 397, 134, 410, 82, 82, 372,
+    /* 6830 */ 83, 102, 150, 169, 388, 178, 368, 364, 117, 100, 367, 302, 98, 378, 186, 92,
+    /* 6840 */ 137, 120, 109, 324, 108, 343, 161, 279, 3, 3, 143, 367, 404, 157, 394, 264,
+    /* 6850 */ 332, 288, 288, 127, 142, 141, 360, 77, 402, 373, 379, 0, 369, 137, 181, 388,
+    /* 6860 */ 362, 272, 392, 60, 256, 260, 125, 109, 135, 401, 361, 319, 293, 392, 11, 331,
+    /* 6870 */ 164, 139, 253, 12, 92, 282, 332, 144, 348, 168, 181, 88, 256, 344, 145, 95,
+    /* 6880 */ 315, 176, 265, 331, 372, 198, 9, 183, 246, 401, 65, 359, 334, 381, 5, 104,
+    /* 6890 */ 14, 65, 114, 405, 394, 274, 11, 101, 134, 127, 341, 234, 133, 329, 132, 352,
+    /* 68A0 */ 189, 130, 297, 28, 87, 313, 200, 347, 173, 173, 72, 262, 369, 319, 142, 327,
+    /* 68B0 */ 353, 163, 404, 304, 32, 84, 343, 139, 173, 18, 349, 90, 324, 394, 166, 175,
+    /* 68C0 */ 134, 404, 180, 173, 256, 19, 187, 50, 258, 202, 256, 256, 23, 110, 32, 62,
+    /* 68D0 */ 86, 240, 9, 9, 130, 406, 37, 381, 132, 173, 246, 373, 373, 104, 145, 71,
+    /* 68E0 */ 323, 96, 342, 65, 56, 84, 37, 388, 256, 374, 363, 373, 267, 367, 291, 274,
+    /* 68F0 */ 46, 172, 256, 404, 92, 151, 166, 407, 407, 390, 107, 87, 87, 300, 263, 221,
+    /* 6900 */ 341, 111, 185, 116, 137, 367, 40, 142, 142, 37, 412, 176, 259, 394, 46, 362,
+    /* 6910 */ 142, 11, 136, 404, 405, 18, 246, 69, 41, 33, 199, 125, 134, 109, 348, 73,
+    /* 6920 */ 258, 61, 109, 66, 188, 394, 267, 206, 92, 101, 246, 295, 367, 338, 291, 77,
+    /* 6930 */ 366, 92, 343, 343, 74, 133, 406, 134, 367, 300, 348, 363, 363, 44, 134, 47,
+    /* 6940 */ 373, 117, 386, 346, 248, 14, 365, 131, 358, 284, 364, 165, 363, 12, 129, 162,
+    /* 6950 */ 137, 162, 312, 88, 353, 338, 394, 134, 210, 196, 41, 124, 124, 175, 172, 331,
+    /* 6960 */ 214, 373, 372, 198, 313, 359, 359, 364, 392, 248, 366, 132, 137, 366, 41, 76,
+    /* 6970 */ 373, 407, 343, 198, 327, 132, 137, 147, 265, 369, 278, 128, 184, 170, 267, 351,
+    /* 6980 */ 251, 302, 94, 322, 167, 344, 373, 36, 189, 142, 300, 41, 14, 353, 133, 367,
+    /* 6990 */ 388, 92, 234, 201, 168, 277, 104, 134, 142, 320, 365, 392, 9, 293, 374, 405,
+    /* 69A0 */ 206, 315, 133, 365, 137, 128, 95, 86, 386, 258, 192, 318, 374, 353, 277, 302,
+    /* 69B0 */ 394, 54, 344, 331, 181, 277, 323, 268, 387, 312, 301, 320, 151, 348, 104, 256,
+    /* 69C0 */ 97, 97, 318, 241, 324, 98, 47, 66, 230, 132, 311, 103, 46, 259, 30, 258,
+    /* 69D0 */ 126, 198, 358, 96, 97, 404, 338, 260, 364, 66, 133, 148, 410, 61, 183, 18,
+    /* 69E0 */ 397, 288, 348, 132, 175, 129, 371, 258, 111, 94, 94, 335, 125, 256, 291, 54,
+    /* 69F0 */ 246, 372, 124, 135, 124, 127, 109, 225, 367, 97, 149, 109, 109, 26, 194, 138,
+    /* 6A00 */ 65, 401, 170, 168, 36, 50, 173, 357, 263, 308, 84, 332, 107, 382, 315, 171,
+    /* 6A10 */ 185, 176, 201, 184, 34, 315, 151, 41, 323, 16, 185, 141, 391, 386, 304, 389,
+    /* 6A20 */ 194, 208, 224, 364, 329, 246, 397, 293, 348, 267, 120, 134, 50, 132, 363, 259,
+    /* 6A30 */ 360, 369, 82, 361, 394, 260, 410, 50, 255, 304, 125, 162, 392, 411, 375, 295,
+    /* 6A40 */ 348, 47, 66, 83, 95, 208, 347, 260, 272, 179, 181, 260, 350, 283, 84, 388,
+    /* 6A50 */ 338, 169, 376, 310, 76, 37, 323, 200, 142, 37, 315, 144, 144, 66, 129, 132,
+    /* 6A60 */ 234, 351, 338, 227, 282, 397, 332, 385, 87, 264, 270, 120, 258, 104, 181, 169,
+    /* 6A70 */ 97, 41, 348, 301, 405, 287, 132, 72, 139, 185, 134, 41, 374, 320, 304, 135,
+    /* 6A80 */ 322, 179, 229, 368, 348, 129, 295, 410, 359, 37, 95, 142, 410, 367, 262, 255,
+    /* 6A90 */ 363, 171, 88, 129, 60, 132, 317, 20, 252, 37, 41, 398, 109, 132, 137, 133,
+    /* 6AA0 */ 263, 387, 134, 259, 61, 367, 16, 313, 298, 179, 173, 30, 200, 368, 324, 321,
+    /* 6AB0 */ 202, 256, 335, 18, 131, 132, 258, 221, 227, 367, 97, 148, 368, 230, 263, 363,
+    /* 6AC0 */ 256, 201, 390, 109, 47, 132, 162, 253, 64, 41, 98, 202, 372, 394, 128, 258,
+    /* 6AD0 */ 171, 171, 285, 185, 173, 53, 189, 204, 129, 238, 189, 394, 97, 73, 374, 173,
+    /* 6AE0 */ 86, 404, 314, 175, 135, 41, 263, 397, 185, 363, 173, 397, 36, 137, 78, 315,
+    /* 6AF0 */ 126, 225, 373, 183, 166, 136, 350, 109, 142, 352, 180, 369, 134, 368, 372, 369,
+    /* 6B00 */ 351, 229, 20, 32, 167, 142, 308, 298, 343, 50, 267, 266, 25, 141, 373, 188,
+    /* 6B10 */ 173, 53, 186, 60, 144, 363, 167, 167, 397, 171, 173, 6, 215, 373, 180, 108,
+    /* 6B20 */ 258, 49, 127, 354, 373, 367, 258, 238, 358, 34, 41, 256, 147, 367, 144, 348,
+    /* 6B30 */ 358, 117, 373, 162, 168, 160, 311, 348, 2, 367, 256, 42, 38, 262, 160, 148,
+    /* 6B40 */ 160, 148, 44, 293, 105, 368, 354, 353, 373, 258, 352, 366, 98, 347, 322, 138,
+    /* 6B50 */ 238, 124, 327, 127, 358, 245, 348, 352, 42, 298, 295, 114, 41, 367, 78, 373,
+    /* 6B60 */ 48, 127, 394, 393, 49, 21, 347, 256, 21, 21, 340, 142, 258, 38, 290, 38,
+    /* 6B70 */ 290, 395, 317, 317, 173, 382, 373, 173, 109, 58, 78, 312, 134, 391, 208, 208,
+    /* 6B80 */ 365, 208, 52, 364, 328, 301, 58, 296, 358, 361, 304, 24, 144, 249, 257, 265,
+    /* 6B90 */ 315, 263, 376, 175, 367, 91, 394, 366, 24, 130, 59, 132, 68, 392, 376, 344,
+    /* 6BA0 */ 40, 18, 327, 138, 296, 368, 67, 141, 129, 53, 367, 59, 73, 135, 175, 18,
+    /* 6BB0 */ 73, 134, 134, 304, 238, 74, 397, 368, 263, 367, 293, 260, 151, 352, 361, 66,
+    /* 6BC0 */ 129, 129, 104, 260, 132, 367, 238, 129, 74, 367, 352, 347, 107, 210, 198, 198,
+    /* 6BD0 */ 2, 137, 73, 373, 14, 14, 14, 247, 247, 14, 32, 196, 116, 23, 247, 178,
+    /* 6BE0 */ 133, 388, 286, 210, 338, 361, 82, 277, 350, 142, 210, 116, 265, 72, 293, 322,
+    /* 6BF0 */ 244, 142, 77, 54, 14, 287, 287, 196, 286, 304, 304, 338, 117, 134, 320, 287,
+    /* 6C00 */ 189, 210, 196, 332, 277, 33, 255, 185, 388, 289, 388, 200, 185, 266, 68, 302,
+    /* 6C10 */ 65, 205, 144, 195, 256, 250, 213, 256, 61, 350, 44, 87, 364, 218, 18, 92,
+    /* 6C20 */ 300, 71, 263, 256, 368, 348, 113, 364, 3, 362, 151, 263, 362, 71, 59, 189,
+    /* 6C30 */ 263, 364, 376, 376, 309, 309, 393, 19, 371, 60, 309, 170, 221, 337, 84, 109,
+    /* 6C40 */ 331, 394, 265, 18, 382, 202, 53, 129, 67, 114, 30, 404, 44, 341, 84, 57,
+    /* 6C50 */ 348, 338, 195, 265, 256, 295, 251, 114, 258, 347, 347, 361, 312, 279, 102, 135,
+    /* 6C60 */ 38, 347, 334, 141, 323, 394, 394, 258, 201, 104, 342, 139, 139, 282, 145, 122,
+    /* 6C70 */ 321, 267, 132, 15, 15, 95, 344, 395, 85, 356, 144, 124, 228, 256, 87, 358,
+    /* 6C80 */ 358, 262, 367, 346, 376, 374, 115, 363, 300, 36, 59, 372, 76, 124, 131, 256,
+    /* 6C90 */ 210, 235, 198, 57, 202, 201, 39, 242, 14, 293, 394, 244, 241, 402, 377, 103,
+    /* 6CA0 */ 181, 198, 382, 88, 238, 173, 187, 25, 88, 343, 124, 208, 198, 304, 142, 377,
+    /* 6CB0 */ 338, 338, 338, 117, 173, 201, 367, 83, 86, 372, 328, 394, 390, 104, 388, 363,
+    /* 6CC0 */ 312, 161, 140, 142, 353, 265, 367, 133, 395, 267, 253, 129, 201, 12, 382, 397,
+    /* 6CD0 */ 170, 372, 104, 122, 95, 83, 196, 312, 124, 252, 49, 84, 394, 315, 227, 37,
+    /* 6CE0 */ 180, 243, 20, 256, 312, 221, 142, 285, 397, 301, 171, 359, 144, 92, 241, 205,
+    /* 6CF0 */ 321, 364, 132, 371, 107, 13, 360, 183, 185, 59, 188, 353, 253, 382, 139, 368,
+    /* 6D00 */ 241, 137, 366, 129, 129, 378, 37, 368, 343, 123, 134, 364, 178, 312, 132, 82,
+    /* 6D10 */ 355, 92, 285, 290, 394, 368, 347, 348, 150, 397, 135, 188, 188, 3, 71, 327,
+    /* 6D20 */ 209, 171, 367, 201, 267, 138, 253, 343, 352, 353, 122, 358, 315, 161, 324, 261,
+    /* 6D30 */ 142, 82, 396, 279, 252, 361, 356, 394, 108, 127, 206, 131, 339, 257, 240, 347,
+    /* 6D40 */ 266, 181, 367, 133, 139, 258, 135, 136, 392, 302, 404, 27, 83, 129, 132, 181,
+    /* 6D50 */ 32, 130, 124, 229, 361, 138, 178, 265, 343, 391, 145, 114, 9, 195, 404, 372,
+    /* 6D60 */ 348, 20, 72, 127, 122, 367, 255, 369, 167, 116, 168, 114, 173, 101, 92, 347,
+    /* 6D70 */ 175, 47, 88, 367, 373, 332, 169, 113, 138, 133, 39, 140, 198, 317, 37, 244,
+    /* 6D80 */ 350, 300, 334, 163, 252, 225, 114, 139, 352, 298, 222, 334, 371, 352, 350, 331,
+    /* 6D90 */ 78, 315, 337, 143, 28, 327, 173, 309, 312, 171, 309, 324, 73, 169, 166, 175,
+    /* 6DA0 */ 343, 346, 376, 127, 65, 120, 283, 134, 389, 290, 92, 107, 355, 303, 307, 362,
+    /* 6DB0 */ 48, 389, 366, 155, 346, 114, 338, 71, 117, 346, 142, 298, 176, 130, 320, 404,
+    /* 6DC0 */ 66, 261, 62, 143, 405, 348, 352, 256, 104, 111, 363, 179, 323, 396, 246, 116,
+    /* 6DD0 */ 33, 304, 256, 85, 394, 185, 216, 142, 324, 50, 171, 391, 252, 86, 313, 328,
+    /* 6DE0 */ 247, 59, 373, 221, 373, 185, 95, 201, 139, 180, 187, 368, 54, 266, 126, 373,
+    /* 6DF0 */ 222, 300, 16, 47, 124, 374, 166, 130, 263, 363, 258, 328, 203, 394, 368, 20,
+    /* 6E00 */ 12, 374, 344, 284, 86, 263, 374, 151, 132, 298, 374, 290, 185, 405, 73, 367,
+    /* 6E10 */ 134, 202, 240, 348, 373, 374, 300, 300, 278, 127, 397, 134, 232, 373, 265, 331,
+    /* 6E20 */ 266, 73, 84, 386, 20, 346, 346, 65, 343, 344, 279, 353, 27, 343, 117, 96,
+    /* 6E30 */ 363, 122, 359, 201, 151, 196, 369, 363, 372, 122, 203, 301, 198, 378, 130, 213,
+    /* 6E40 */ 109, 38, 78, 240, 198, 175, 256, 256, 198, 328, 51, 343, 24, 335, 202, 129,
+    /* 6E50 */ 208, 358, 132, 245, 134, 134, 124, 88, 351, 367, 368, 388, 302, 137, 37, 128,
+    /* 6E60 */ 322, 373, 14, 205, 302, 334, 301, 371, 142, 71, 335, 136, 136, 265, 363, 323,
+    /* 6E70 */ 183, 131, 374, 214, 8, 372, 267, 401, 176, 32, 350, 47, 225, 405, 341, 302,
+    /* 6E80 */ 194, 369, 165, 162, 88, 134, 358, 184, 343, 94, 20, 369, 253, 138, 363, 323,
+    /* 6E90 */ 374, 319, 374, 175, 365, 200, 403, 37, 151, 321, 320, 339, 181, 103, 289, 206,
+    /* 6EA0 */ 386, 302, 367, 187, 192, 255, 343, 173, 378, 347, 348, 344, 259, 382, 302, 315,
+    /* 6EB0 */ 2, 262, 314, 376, 357, 368, 277, 130, 315, 319, 221, 320, 302, 279, 2, 241,
+    /* 6EC0 */ 41, 41, 242, 345, 25, 204, 98, 66, 116, 128, 348, 405, 65, 394, 355, 92,
+    /* 6ED0 */ 137, 125, 98, 405, 324, 326, 317, 14, 136, 129, 110, 368, 97, 183, 394, 363,
+    /* 6EE0 */ 298, 194, 369, 47, 189, 167, 186, 365, 18, 322, 373, 357, 124, 14, 16, 394,
+    /* 6EF0 */ 135, 156, 300, 296, 65, 201, 5, 185, 124, 124, 372, 32, 84, 371, 110, 194,
+    /* 6F00 */ 263, 373, 249, 132, 362, 34, 256, 348, 132, 185, 184, 183, 138, 111, 50, 184,
+    /* 6F10 */ 394, 94, 259, 173, 363, 26, 136, 50, 47, 335, 238, 326, 366, 348, 201, 323,
+    /* 6F20 */ 208, 296, 114, 175, 167, 339, 38, 95, 88, 359, 367, 194, 405, 195, 149, 188,
+    /* 6F30 */ 246, 304, 389, 389, 401, 358, 127, 131, 134, 363, 308, 177, 54, 327, 364, 135,
+    /* 6F40 */ 50, 369, 122, 357, 304, 107, 369, 352, 406, 163, 358, 175, 394, 343, 247, 373,
+    /* 6F50 */ 136, 253, 60, 129, 137, 347, 239, 132, 241, 343, 315, 258, 258, 348, 185, 348,
+    /* 6F60 */ 361, 76, 128, 205, 283, 315, 169, 392, 50, 367, 391, 341, 295, 322, 34, 361,
+    /* 6F70 */ 162, 366, 297, 334, 397, 285, 118, 14, 295, 32, 32, 304, 332, 255, 179, 343,
+    /* 6F80 */ 290, 290, 37, 140, 37, 125, 136, 169, 35, 95, 55, 122, 312, 304, 246, 114,
+    /* 6F90 */ 376, 181, 122, 92, 116, 117, 350, 134, 295, 348, 373, 185, 167, 227, 373, 179,
+    /* 6FA0 */ 202, 381, 60, 127, 382, 353, 373, 173, 302, 360, 180, 341, 405, 371, 129, 24,
+    /* 6FB0 */ 175, 66, 366, 5, 127, 392, 32, 194, 59, 59, 367, 317, 247, 142, 320, 262,
+    /* 6FC0 */ 132, 404, 175, 229, 111, 138, 87, 290, 132, 317, 129, 41, 320, 313, 69, 290,
+    /* 6FD0 */ 397, 166, 18, 175, 201, 302, 304, 201, 227, 369, 369, 200, 138, 256, 14, 132,
+    /* 6FE0 */ 116, 279, 54, 346, 324, 368, 368, 75, 49, 131, 263, 167, 145, 2, 255, 404,
+    /* 6FF0 */ 343, 18, 104, 258, 369, 18, 164, 86, 25, 197, 134, 343, 188, 379, 189, 173,
+    /* 7000 */ 372, 364, 185, 312, 394, 369, 73, 342, 129, 353, 241, 300, 16, 32, 208, 181,
+    /* 7010 */ 134, 255, 290, 37, 104, 18, 131, 350, 185, 262, 114, 369, 277, 173, 139, 352,
+    /* 7020 */ 369, 317, 343, 353, 126, 360, 397, 183, 166, 75, 84, 124, 166, 304, 180, 369,
+    /* 7030 */ 201, 132, 175, 134, 369, 87, 179, 367, 134, 375, 32, 58, 271, 134, 167, 84,
+    /* 7040 */ 308, 374, 404, 88, 298, 171, 167, 50, 266, 371, 258, 83, 107, 144, 363, 116,
+    /* 7050 */ 369, 285, 379, 186, 363, 173, 201, 295, 322, 60, 136, 32, 369, 116, 6, 397,
+    /* 7060 */ 167, 167, 215, 341, 186, 361, 350, 363, 95, 363, 373, 131, 16, 204, 108, 64,
+    /* 7070 */ 129, 352, 352, 129, 122, 180, 381, 400, 141, 386, 353, 38, 404, 378, 378, 24,
+    /* 7080 */ 364, 256, 395, 87, 228, 140, 344, 255, 367, 185, 46, 247, 147, 241, 363, 147,
+    /* 7090 */ 242, 210, 34, 177, 109, 149, 76, 108, 354, 394, 108, 108, 343, 259, 15, 57,
+    /* 70A0 */ 349, 393, 397, 151, 390, 92, 6, 353, 353, 180, 404, 359, 142, 322, 243, 140,
+    /* 70B0 */ 243, 321, 321, 19, 364, 332, 295, 397, 386, 66, 343, 302, 175, 38, 128, 396,
+    /* 70C0 */ 124, 311, 167, 331, 136, 358, 120, 267, 178, 127, 364, 357, 357, 350, 368, 347,
+    /* 70D0 */ 396, 365, 302, 343, 332, 204, 378, 147, 122, 169, 349, 397, 359, 393, 253, 363,
+    /* 70E0 */ 129, 108, 35, 129, 150, 142, 84, 297, 366, 129, 0, 323, 138, 273, 178, 348,
+    /* 70F0 */ 92, 140, 353, 255, 331, 404, 331, 341, 113, 246, 168, 363, 358, 88, 38, 277,
+    /* 7100 */ 124, 348, 304, 117, 361, 157, 143, 352, 348, 363, 114, 401, 145, 65, 353, 132,
+    /* 7110 */ 347, 363, 189, 114, 363, 127, 199, 142, 61, 11, 87, 179, 163, 130, 337, 348,
+    /* 7120 */ 54, 347, 122, 34, 92, 346, 136, 50, 88, 252, 264, 284, 348, 264, 354, 34,
+    /* 7130 */ 363, 363, 367, 144, 373, 96, 270, 247, 356, 96, 301, 33, 297, 356, 222, 101,
+    /* 7140 */ 343, 36, 117, 162, 395, 74, 349, 129, 88, 175, 359, 355, 128, 136, 134, 14,
+    /* 7150 */ 369, 397, 343, 335, 295, 348, 232, 232, 32, 363, 140, 140, 373, 198, 293, 343,
+    /* 7160 */ 386, 138, 264, 278, 198, 127, 358, 390, 343, 84, 265, 317, 364, 178, 397, 137,
+    /* 7170 */ 381, 105, 10, 124, 376, 214, 302, 176, 15, 103, 336, 323, 34, 295, 80, 20,
+    /* 7180 */ 128, 353, 348, 347, 348, 376, 117, 117, 348, 376, 356, 213, 295, 264, 365, 361,
+    /* 7190 */ 201, 175, 369, 347, 277, 102, 363, 259, 181, 348, 14, 16, 50, 185, 134, 304,
+    /* 71A0 */ 367, 184, 246, 317, 367, 326, 144, 406, 376, 124, 367, 394, 5, 343, 181, 114,
+    /* 71B0 */ 238, 273, 140, 194, 163, 296, 53, 385, 134, 348, 348, 348, 367, 352, 38, 128,
+    /* 71C0 */ 32, 366, 322, 270, 363, 361, 260, 145, 64, 76, 300, 136, 87, 312, 177, 373,
+    /* 71D0 */ 179, 332, 297, 87, 84, 363, 361, 167, 198, 323, 367, 140, 199, 139, 136, 369,
+    /* 71E0 */ 373, 367, 360, 167, 321, 381, 24, 317, 348, 268, 406, 175, 129, 397, 353, 180,
+    /* 71F0 */ 343, 367, 353, 390, 129, 57, 229, 167, 279, 350, 117, 361, 138, 40, 61, 365,
+    /* 7200 */ 117, 167, 16, 277, 173, 208, 10, 284, 189, 165, 5, 361, 161, 311, 177, 173,
+    /* 7210 */ 185, 144, 177, 363, 348, 353, 183, 366, 24, 271, 375, 167, 50, 144, 39, 107,
+    /* 7220 */ 142, 35, 201, 323, 167, 397, 167, 180, 53, 373, 390, 390, 239, 393, 243, 37,
+    /* 7230 */ 374, 2, 343, 114, 144, 144, 92, 366, 6, 68, 366, 365, 408, 308, 82, 241,
+    /* 7240 */ 45, 151, 380, 68, 259, 371, 259, 248, 8, 241, 34, 134, 240, 73, 45, 373,
+    /* 7250 */ 386, 15, 68, 9, 20, 45, 372, 372, 73, 362, 37, 228, 228, 251, 141, 209,
+    /* 7260 */ 320, 210, 169, 274, 195, 85, 196, 210, 96, 347, 363, 98, 11, 312, 134, 104,
+    /* 7270 */ 372, 98, 301, 210, 65, 258, 267, 267, 405, 325, 348, 195, 154, 258, 347, 104,
+    /* 7280 */ 348, 173, 173, 254, 132, 96, 394, 12, 267, 47, 73, 142, 133, 134, 88, 248,
+    /* 7290 */ 151, 142, 150, 41, 348, 11, 188, 137, 192, 287, 343, 196, 76, 332, 260, 135,
+    /* 72A0 */ 348, 173, 73, 178, 240, 249, 20, 348, 40, 343, 162, 40, 267, 267, 6, 84,
+    /* 72B0 */ 265, 132, 31, 404, 3, 98, 401, 108, 192, 372, 149, 20, 123, 362, 368, 127,
+    /* 72C0 */ 401, 376, 161, 228, 65, 161, 395, 210, 11, 247, 142, 367, 301, 243, 349, 338,
+    /* 72D0 */ 124, 180, 86, 247, 221, 365, 372, 103, 360, 142, 59, 20, 157, 350, 227, 127,
+    /* 72E0 */ 119, 136, 117, 390, 132, 361, 295, 320, 277, 303, 332, 169, 73, 349, 302, 159,
+    /* 72F0 */ 393, 373, 318, 373, 14, 195, 348, 143, 173, 349, 368, 316, 168, 11, 394, 363,
+    /* 7300 */ 293, 173, 114, 350, 139, 240, 86, 352, 7, 256, 221, 16, 368, 166, 178, 134,
+    /* 7310 */ 259, 163, 363, 111, 406, 201, 33, 367, 394, 393, 362, 200, 23, 52, 298, 178,
+    /* 7320 */ 66, 188, 124, 406, 109, 343, 88, 346, 374, 355, 397, 196, 343, 44, 350, 335,
+    /* 7330 */ 362, 216, 353, 133, 123, 15, 372, 372, 198, 30, 365, 318, 20, 206, 125, 374,
+    /* 7340 */ 314, 192, 374, 58, 373, 302, 116, 259, 367, 392, 25, 116, 194, 139, 135, 208,
+    /* 7350 */ 389, 32, 5, 5, 116, 54, 12, 144, 14, 14, 128, 255, 179, 358, 332, 365,
+    /* 7360 */ 177, 311, 352, 303, 76, 136, 98, 143, 73, 129, 159, 350, 353, 320, 350, 361,
+    /* 7370 */ 227, 15, 131, 230, 200, 178, 216, 108, 303, 185, 320, 350, 201, 271, 127, 216,
+    /* 7380 */ 188, 350, 256, 144, 359, 203, 405, 189, 185, 373, 315, 342, 265, 93, 69, 170,
+    /* 7390 */ 6, 132, 122, 65, 44, 95, 141, 373, 256, 373, 33, 192, 122, 347, 92, 344,
+    /* 73A0 */ 137, 362, 18, 15, 9, 375, 144, 199, 144, 341, 134, 198, 59, 251, 343, 127,
+    /* 73B0 */ 350, 259, 180, 58, 367, 3, 252, 66, 92, 359, 348, 20, 49, 103, 133, 297,
+    /* 73C0 */ 253, 49, 151, 270, 301, 300, 367, 408, 133, 205, 295, 181, 14, 392, 392, 144,
+    /* 73D0 */ 83, 183, 138, 136, 134, 173, 108, 350, 396, 102, 363, 357, 364, 358, 188, 315,
+    /* 73E0 */ 397, 262, 368, 361, 10, 82, 351, 365, 349, 115, 109, 39, 358, 8, 244, 169,
+    /* 73F0 */ 60, 369, 129, 344, 78, 37, 65, 347, 347, 37, 145, 198, 11, 331, 350, 41,
+    /* 7400 */ 114, 359, 363, 265, 359, 168, 173, 357, 92, 181, 362, 348, 180, 173, 138, 175,
+    /* 7410 */ 319, 319, 88, 341, 66, 251, 388, 290, 205, 373, 142, 36, 166, 205, 301, 343,
+    /* 7420 */ 328, 41, 412, 13, 37, 124, 256, 78, 163, 33, 256, 13, 341, 185, 50, 107,
+    /* 7430 */ 363, 67, 11, 179, 262, 247, 239, 268, 404, 262, 83, 138, 264, 73, 137, 130,
+    /* 7440 */ 373, 196, 198, 47, 359, 327, 355, 58, 278, 205, 134, 343, 281, 127, 353, 44,
+    /* 7450 */ 134, 400, 33, 175, 267, 349, 74, 374, 362, 216, 124, 369, 373, 128, 282, 290,
+    /* 7460 */ 181, 302, 277, 319, 365, 344, 347, 392, 138, 369, 192, 324, 181, 323, 173, 168,
+    /* 7470 */ 109, 392, 259, 56, 144, 390, 365, 2, 18, 304, 33, 163, 400, 50, 138, 367,
+    /* 7480 */ 54, 50, 256, 173, 139, 319, 265, 359, 5, 175, 199, 389, 368, 366, 369, 343,
+    /* 7490 */ 185, 347, 64, 357, 385, 361, 266, 60, 179, 177, 264, 315, 128, 109, 255, 139,
+    /* 74A0 */ 84, 138, 181, 132, 129, 139, 2, 14, 24, 266, 381, 60, 136, 110, 322, 129,
+    /* 74B0 */ 127, 290, 317, 328, 41, 373, 138, 185, 18, 304, 344, 410, 167, 348, 405, 359,
+    /* 74C0 */ 281, 346, 94, 171, 73, 173, 394, 278, 173, 379, 264, 327, 109, 317, 165, 183,
+    /* 74D0 */ 185, 173, 379, 167, 369, 201, 351, 264, 107, 61, 379, 127, 105, 20, 68, 20,
+    /* 74E0 */ 124, 394, 249, 8, 271, 173, 339, 0, 351, 258, 8, 245, 85, 59, 345, 238,
+    /* 74F0 */ 0, 0, 339, 124, 180, 367, 252, 49, 7, 143, 33, 38, 0, 60, 200, 21,
+    /* 7500 */ 402, 252, 15, 396, 392, 0, 49, 369, 256, 350, 184, 65, 238, 200, 400, 13,
+    /* 7510 */ 179, 385, 347, 247, 59, 345, 369, 363, 95, 58, 300, 328, 328, 114, 33, 301,
+    /* 7520 */ 263, 300, 32, 32, 282, 301, 315, 300, 371, 306, 185, 92, 371, 13, 88, 227,
+    /* 7530 */ 328, 372, 133, 300, 386, 66, 92, 214, 66, 252, 331, 125, 331, 392, 378, 200,
+    /* 7540 */ 14, 14, 181, 361, 181, 33, 210, 376, 84, 92, 101, 328, 137, 137, 267, 343,
+    /* 7550 */ 92, 328, 210, 77, 241, 135, 339, 57, 214, 181, 12, 392, 41, 210, 210, 27,
+    /* 7560 */ 328, 94, 14, 57, 394, 190, 256, 190, 241, 367, 84, 125, 298, 373, 210, 145,
+    /* 7570 */ 367, 181, 298, 68, 40, 125, 60, 402, 132, 341, 135, 37, 33, 337, 171, 132,
+    /* 7580 */ 30, 181, 68, 335, 179, 135, 135, 40, 247, 68, 68, 247, 137, 59, 304, 304,
+    /* 7590 */ 394, 367, 217, 213, 69, 14, 137, 177, 96, 98, 141, 396, 349, 295, 358, 236,
+    /* 75A0 */ 173, 364, 36, 372, 6, 137, 144, 256, 349, 54, 14, 367, 173, 406, 45, 88,
+    /* 75B0 */ 397, 243, 247, 95, 151, 49, 360, 394, 59, 392, 83, 394, 326, 142, 132, 86,
+    /* 75C0 */ 142, 295, 133, 359, 386, 19, 225, 393, 371, 139, 267, 326, 332, 367, 137, 343,
+    /* 75D0 */ 129, 322, 364, 38, 394, 119, 362, 198, 72, 139, 352, 332, 334, 195, 247, 352,
+    /* 75E0 */ 316, 92, 173, 394, 56, 77, 347, 293, 169, 303, 127, 350, 367, 13, 389, 107,
+    /* 75F0 */ 322, 86, 192, 179, 38, 132, 328, 3, 38, 14, 14, 205, 104, 75, 78, 343,
+    /* 7600 */ 373, 54, 362, 397, 52, 59, 300, 395, 38, 373, 123, 88, 165, 364, 36, 334,
+    /* 7610 */ 373, 111, 344, 127, 157, 133, 368, 367, 184, 289, 144, 38, 348, 107, 367, 344,
+    /* 7620 */ 132, 45, 8, 129, 181, 31, 303, 236, 66, 57, 17, 322, 389, 16, 300, 52,
+    /* 7630 */ 188, 367, 406, 40, 389, 387, 314, 290, 268, 67, 184, 184, 208, 262, 368, 369,
+    /* 7640 */ 128, 92, 177, 183, 260, 181, 169, 350, 86, 59, 368, 117, 2, 8, 350, 107,
+    /* 7650 */ 109, 229, 373, 343, 367, 371, 247, 171, 173, 304, 59, 179, 66, 179, 166, 17,
+    /* 7660 */ 132, 38, 364, 359, 137, 393, 197, 173, 131, 166, 132, 66, 359, 369, 368, 266,
+    /* 7670 */ 371, 322, 66, 188, 186, 186, 20, 20, 109, 6, 83, 64, 83, 7, 7, 261,
+    /* 7680 */ 132, 381, 381, 196, 62, 239, 137, 128, 109, 49, 180, 97, 208, 132, 136, 246,
+    /* 7690 */ 97, 2, 78, 116, 114, 14, 341, 40, 258, 348, 2, 352, 116, 128, 116, 382,
+    /* 76A0 */ 54, 116, 352, 366, 253, 116, 136, 2, 355, 128, 173, 249, 117, 136, 247, 95,
+    /* 76B0 */ 243, 396, 145, 265, 55, 268, 386, 104, 145, 145, 396, 386, 104, 390, 73, 205,
+    /* 76C0 */ 256, 369, 373, 11, 390, 395, 245, 117, 369, 117, 367, 20, 341, 117, 4, 388,
+    /* 76D0 */ 363, 134, 117, 373, 162, 84, 94, 61, 241, 92, 265, 301, 61, 185, 388, 200,
+    /* 76E0 */ 173, 138, 358, 134, 241, 107, 3, 185, 358, 396, 60, 3, 104, 173, 210, 69,
+    /* 76F0 */ 95, 358, 195, 342, 394, 256, 374, 328, 351, 76, 354, 348, 241, 88, 76, 205,
+    /* 7700 */ 206, 301, 302, 376, 202, 241, 85, 203, 59, 198, 196, 148, 350, 156, 302, 364,
+    /* 7710 */ 393, 365, 300, 131, 57, 392, 161, 142, 300, 367, 301, 198, 208, 397, 392, 392,
+    /* 7720 */ 202, 302, 374, 68, 221, 405, 405, 34, 386, 359, 19, 201, 183, 317, 332, 201,
+    /* 7730 */ 68, 65, 217, 206, 359, 38, 161, 143, 209, 392, 329, 364, 363, 208, 395, 208,
+    /* 7740 */ 391, 393, 198, 319, 297, 114, 127, 65, 37, 56, 143, 78, 194, 350, 348, 163,
+    /* 7750 */ 166, 134, 295, 328, 110, 341, 172, 302, 264, 178, 362, 139, 393, 173, 166, 317,
+    /* 7760 */ 143, 309, 317, 73, 14, 247, 210, 130, 221, 185, 367, 137, 23, 396, 373, 130,
+    /* 7770 */ 192, 349, 355, 129, 110, 378, 47, 134, 198, 73, 123, 359, 328, 162, 97, 282,
+    /* 7780 */ 196, 358, 83, 346, 203, 40, 162, 201, 345, 156, 60, 36, 151, 314, 349, 264,
+    /* 7790 */ 208, 206, 194, 309, 382, 389, 367, 67, 156, 208, 310, 50, 184, 38, 194, 249,
+    /* 77A0 */ 37, 109, 200, 341, 283, 250, 348, 260, 255, 397, 64, 300, 310, 177, 35, 350,
+    /* 77B0 */ 148, 366, 358, 332, 209, 179, 109, 134, 366, 2, 129, 388, 134, 104, 390, 266,
+    /* 77C0 */ 198, 40, 289, 227, 361, 365, 131, 200, 202, 251, 202, 171, 161, 144, 359, 202,
+    /* 77D0 */ 131, 185, 200, 183, 107, 194, 348, 41, 323, 148, 397, 196, 138, 138, 373, 311,
+    /* 77E0 */ 382, 144, 302, 367, 300, 394, 123, 300, 369, 142, 396, 136, 56, 74, 2, 136,
+    /* 77F0 */ 385, 375, 6, 302, 69, 256, 132, 405, 95, 347, 391, 157, 96, 348, 84, 161,
+    /* 7800 */ 60, 192, 293, 59, 144, 173, 92, 205, 78, 131, 149, 394, 256, 148, 137, 18,
+    /* 7810 */ 78, 362, 247, 391, 363, 317, 400, 35, 76, 339, 363, 138, 88, 83, 208, 386,
+    /* 7820 */ 142, 373, 151, 338, 338, 65, 387, 392, 78, 92, 210, 397, 165, 15, 231, 252,
+    /* 7830 */ 246, 180, 243, 170, 253, 20, 253, 300, 377, 2, 173, 183, 332, 371, 173, 161,
+    /* 7840 */ 41, 154, 267, 397, 161, 109, 78, 216, 257, 185, 343, 2, 98, 350, 355, 363,
+    /* 7850 */ 71, 246, 348, 169, 122, 311, 349, 260, 263, 343, 260, 367, 154, 352, 268, 32,
+    /* 7860 */ 168, 122, 373, 352, 349, 195, 188, 371, 35, 35, 346, 181, 369, 195, 268, 363,
+    /* 7870 */ 293, 163, 373, 38, 125, 185, 36, 134, 236, 313, 404, 154, 246, 363, 402, 155,
+    /* 7880 */ 37, 256, 406, 263, 179, 145, 20, 69, 205, 67, 134, 117, 185, 2, 317, 268,
+    /* 7890 */ 172, 11, 368, 75, 347, 256, 187, 341, 66, 216, 11, 256, 36, 281, 363, 68,
+    /* 78A0 */ 69, 73, 338, 137, 369, 15, 151, 14, 343, 311, 392, 74, 349, 60, 327, 216,
+    /* 78B0 */ 246, 134, 65, 322, 30, 328, 256, 76, 88, 359, 268, 268, 192, 102, 222, 315,
+    /* 78C0 */ 78, 49, 181, 312, 323, 9, 125, 247, 343, 288, 171, 56, 328, 349, 348, 175,
+    /* 78D0 */ 241, 343, 376, 75, 391, 151, 165, 400, 365, 110, 400, 32, 256, 5, 246, 181,
+    /* 78E0 */ 185, 148, 45, 36, 368, 171, 16, 256, 208, 256, 54, 406, 263, 48, 187, 132,
+    /* 78F0 */ 295, 169, 266, 385, 64, 134, 348, 179, 69, 322, 128, 241, 377, 260, 65, 173,
+    /* 7900 */ 134, 136, 348, 389, 260, 76, 134, 373, 402, 117, 151, 382, 171, 137, 41, 366,
+    /* 7910 */ 268, 60, 367, 135, 247, 247, 373, 251, 78, 2, 151, 134, 373, 281, 200, 243,
+    /* 7920 */ 49, 20, 364, 192, 22, 350, 161, 171, 171, 394, 173, 173, 84, 268, 243, 369,
+    /* 7930 */ 173, 183, 183, 208, 20, 308, 107, 167, 22, 363, 302, 302, 173, 275, 298, 375,
+    /* 7940 */ 312, 256, 320, 192, 353, 365, 350, 256, 256, 394, 13, 75, 395, 274, 367, 302,
+    /* 7950 */ 372, 394, 329, 92, 92, 201, 408, 394, 316, 198, 412, 266, 124, 397, 300, 317,
+    /* 7960 */ 49, 31, 201, 189, 373, 351, 347, 329, 249, 397, 109, 349, 394, 132, 97, 392,
+    /* 7970 */ 97, 309, 138, 300, 94, 163, 65, 61, 131, 324, 256, 104, 107, 410, 180, 185,
+    /* 7980 */ 19, 138, 61, 394, 185, 32, 14, 391, 129, 372, 348, 368, 405, 131, 392, 92,
+    /* 7990 */ 374, 347, 350, 364, 394, 367, 198, 312, 65, 11, 404, 392, 371, 132, 97, 323,
+    /* 79A0 */ 312, 192, 320, 92, 359, 256, 373, 348, 132, 312, 32, 59, 109, 317, 173, 229,
+    /* 79B0 */ 201, 61, 173, 271, 375, 327, 379, 171, 278, 373, 373, 173, 353, 262, 117, 334,
+    /* 79C0 */ 357, 312, 274, 334, 405, 30, 95, 367, 350, 19, 222, 265, 265, 395, 87, 116,
+    /* 79D0 */ 376, 151, 203, 394, 139, 14, 394, 373, 201, 157, 8, 247, 221, 173, 372, 408,
+    /* 79E0 */ 247, 20, 180, 208, 37, 222, 262, 364, 412, 394, 394, 304, 142, 405, 131, 132,
+    /* 79F0 */ 37, 332, 394, 131, 117, 368, 405, 394, 137, 274, 73, 367, 397, 129, 229, 92,
+    /* 7A00 */ 348, 97, 168, 92, 361, 309, 189, 163, 95, 139, 327, 37, 334, 297, 309, 362,
+    /* 7A10 */ 187, 185, 104, 412, 274, 403, 9, 7, 132, 394, 394, 163, 172, 246, 151, 19,
+    /* 7A20 */ 40, 410, 373, 315, 190, 351, 367, 348, 15, 132, 92, 247, 234, 137, 395, 406,
+    /* 7A30 */ 358, 37, 61, 344, 350, 405, 373, 132, 358, 392, 394, 61, 133, 132, 97, 97,
+    /* 7A40 */ 104, 277, 317, 277, 132, 149, 210, 24, 198, 394, 132, 185, 315, 132, 369, 344,
+    /* 7A50 */ 265, 290, 117, 367, 128, 261, 132, 317, 352, 255, 136, 404, 395, 410, 189, 317,
+    /* 7A60 */ 229, 290, 129, 271, 234, 373, 251, 132, 336, 344, 37, 131, 161, 189, 16, 290,
+    /* 7A70 */ 271, 404, 173, 53, 360, 339, 141, 264, 348, 264, 155, 373, 300, 139, 365, 44,
+    /* 7A80 */ 403, 334, 169, 261, 387, 365, 15, 10, 365, 19, 339, 397, 136, 260, 67, 347,
+    /* 7A90 */ 109, 365, 394, 45, 365, 329, 136, 45, 140, 352, 37, 156, 53, 346, 59, 157,
+    /* 7AA0 */ 151, 404, 358, 315, 107, 162, 72, 404, 361, 346, 339, 362, 373, 142, 264, 365,
+    /* 7AB0 */ 365, 329, 34, 373, 328, 67, 142, 177, 348, 347, 162, 45, 390, 160, 160, 183,
+    /* 7AC0 */ 37, 54, 177, 381, 53, 260, 264, 72, 381, 183, 261, 173, 41, 302, 92, 258,
+    /* 7AD0 */ 41, 122, 256, 116, 301, 87, 304, 203, 266, 388, 397, 180, 183, 19, 139, 139,
+    /* 7AE0 */ 389, 7, 312, 145, 122, 332, 313, 139, 67, 367, 304, 139, 266, 137, 252, 74,
+    /* 7AF0 */ 173, 400, 29, 64, 55, 340, 139, 148, 139, 397, 397, 170, 246, 373, 38, 95,
+    /* 7B00 */ 195, 397, 341, 73, 132, 136, 6, 316, 132, 262, 390, 318, 362, 402, 374, 124,
+    /* 7B10 */ 115, 352, 28, 14, 14, 134, 367, 71, 295, 301, 57, 65, 397, 212, 38, 104,
+    /* 7B20 */ 173, 261, 205, 10, 329, 312, 92, 27, 12, 83, 57, 405, 65, 180, 382, 231,
+    /* 7B30 */ 92, 103, 84, 133, 95, 84, 302, 196, 253, 327, 134, 264, 183, 205, 15, 188,
+    /* 7B40 */ 109, 266, 38, 368, 365, 350, 14, 264, 164, 64, 352, 138, 267, 318, 279, 83,
+    /* 7B50 */ 161, 397, 332, 132, 57, 115, 27, 395, 156, 166, 14, 294, 60, 393, 27, 92,
+    /* 7B60 */ 376, 334, 239, 173, 168, 142, 107, 134, 114, 332, 349, 394, 37, 316, 302, 397,
+    /* 7B70 */ 412, 352, 297, 331, 27, 363, 97, 159, 95, 40, 161, 96, 376, 238, 258, 352,
+    /* 7B80 */ 134, 254, 166, 407, 14, 14, 14, 98, 321, 106, 373, 134, 61, 104, 38, 393,
+    /* 7B90 */ 263, 293, 396, 185, 20, 132, 179, 316, 145, 92, 386, 104, 155, 258, 258, 145,
+    /* 7BA0 */ 46, 107, 374, 27, 408, 20, 382, 261, 338, 188, 59, 352, 284, 134, 359, 15,
+    /* 7BB0 */ 318, 351, 350, 252, 392, 355, 124, 367, 397, 375, 47, 189, 347, 71, 311, 132,
+    /* 7BC0 */ 137, 128, 355, 198, 84, 44, 400, 248, 88, 397, 128, 261, 123, 265, 203, 258,
+    /* 7BD0 */ 104, 162, 302, 184, 376, 117, 323, 375, 40, 97, 86, 284, 393, 103, 225, 258,
+    /* 7BE0 */ 352, 53, 183, 246, 73, 173, 14, 404, 41, 294, 38, 397, 259, 183, 167, 134,
+    /* 7BF0 */ 21, 173, 129, 14, 65, 50, 363, 246, 24, 400, 247, 249, 72, 373, 204, 335,
+    /* 7C00 */ 382, 294, 109, 367, 124, 32, 156, 52, 252, 381, 132, 109, 315, 184, 27, 185,
+    /* 7C10 */ 222, 319, 53, 67, 319, 170, 74, 176, 352, 20, 201, 294, 60, 177, 59, 66,
+    /* 7C20 */ 92, 134, 205, 162, 58, 136, 64, 128, 318, 169, 379, 352, 185, 302, 379, 256,
+    /* 7C30 */ 240, 256, 240, 95, 142, 185, 185, 363, 20, 60, 286, 398, 103, 258, 175, 21,
+    /* 7C40 */ 396, 166, 302, 167, 162, 373, 375, 116, 392, 321, 327, 225, 40, 132, 367, 256,
+    /* 7C50 */ 326, 400, 396, 84, 314, 396, 258, 404, 326, 185, 185, 134, 338, 369, 373, 166,
+    /* 7C60 */ 183, 261, 175, 167, 258, 375, 395, 266, 175, 15, 74, 409, 173, 312, 188, 369,
+    /* 7C70 */ 375, 404, 373, 201, 65, 84, 300, 391, 300, 235, 117, 171, 350, 405, 221, 55,
+    /* 7C80 */ 389, 258, 387, 14, 8, 347, 293, 149, 278, 87, 14, 54, 368, 391, 201, 321,
+    /* 7C90 */ 124, 6, 173, 95, 142, 253, 208, 52, 388, 396, 38, 315, 329, 173, 348, 315,
+    /* 7CA0 */ 122, 332, 405, 27, 375, 396, 179, 401, 7, 169, 87, 82, 266, 117, 176, 350,
+    /* 7CB0 */ 92, 176, 24, 139, 173, 375, 185, 142, 256, 54, 7, 389, 179, 406, 139, 111,
+    /* 7CC0 */ 125, 287, 287, 323, 15, 278, 202, 123, 358, 406, 124, 134, 379, 49, 173, 353,
+    /* 7CD0 */ 92, 234, 11, 104, 357, 97, 323, 265, 133, 26, 401, 323, 201, 287, 87, 381,
+    /* 7CE0 */ 149, 135, 208, 287, 287, 234, 348, 176, 135, 159, 20, 127, 304, 406, 350, 234,
+    /* 7CF0 */ 335, 225, 173, 412, 65, 225, 329, 167, 201, 312, 141, 348, 102, 393, 141, 372,
+    /* 7D00 */ 132, 30, 396, 361, 375, 122, 373, 117, 341, 274, 344, 344, 265, 212, 405, 333,
+    /* 7D10 */ 228, 91, 132, 304, 47, 247, 392, 293, 122, 394, 132, 87, 376, 274, 59, 138,
+    /* 7D20 */ 315, 85, 319, 54, 141, 377, 6, 138, 92, 394, 256, 405, 40, 122, 377, 171,
+    /* 7D30 */ 348, 92, 353, 300, 20, 397, 266, 180, 397, 297, 95, 364, 92, 338, 392, 58,
+    /* 7D40 */ 41, 302, 395, 350, 408, 140, 8, 266, 208, 304, 410, 161, 139, 274, 115, 353,
+    /* 7D50 */ 137, 397, 40, 105, 7, 144, 161, 124, 49, 127, 101, 324, 137, 157, 136, 267,
+    /* 7D60 */ 94, 188, 359, 13, 350, 92, 99, 71, 277, 329, 368, 171, 353, 143, 358, 94,
+    /* 7D70 */ 68, 332, 312, 135, 351, 129, 144, 394, 134, 143, 38, 202, 392, 189, 37, 265,
+    /* 7D80 */ 304, 9, 332, 352, 127, 262, 101, 357, 327, 333, 353, 122, 348, 92, 331, 317,
+    /* 7D90 */ 75, 163, 92, 139, 124, 394, 363, 140, 88, 132, 358, 274, 406, 36, 77, 173,
+    /* 7DA0 */ 189, 176, 40, 267, 297, 256, 256, 403, 256, 341, 258, 350, 303, 343, 256, 324,
+    /* 7DB0 */ 341, 96, 342, 13, 402, 23, 111, 54, 187, 181, 256, 388, 14, 48, 180, 202,
+    /* 7DC0 */ 256, 261, 328, 406, 110, 407, 348, 405, 355, 176, 138, 86, 282, 205, 373, 406,
+    /* 7DD0 */ 84, 189, 358, 369, 296, 256, 358, 351, 134, 151, 350, 281, 202, 132, 74, 39,
+    /* 7DE0 */ 65, 205, 203, 374, 353, 10, 312, 265, 15, 127, 101, 50, 202, 343, 92, 343,
+    /* 7DF0 */ 333, 103, 203, 353, 175, 406, 15, 376, 368, 327, 105, 394, 376, 37, 32, 58,
+    /* 7E00 */ 349, 374, 406, 358, 301, 343, 101, 359, 369, 138, 367, 402, 221, 9, 104, 241,
+    /* 7E10 */ 396, 134, 49, 267, 308, 376, 349, 54, 348, 277, 324, 92, 376, 36, 97, 279,
+    /* 7E20 */ 124, 378, 326, 350, 315, 392, 406, 324, 128, 23, 14, 88, 52, 173, 319, 363,
+    /* 7E30 */ 348, 406, 171, 143, 258, 194, 394, 189, 210, 249, 175, 201, 359, 406, 132, 295,
+    /* 7E40 */ 317, 84, 189, 13, 367, 289, 209, 365, 259, 130, 350, 132, 293, 357, 270, 359,
+    /* 7E50 */ 317, 260, 385, 412, 394, 295, 287, 179, 373, 84, 177, 48, 411, 134, 272, 32,
+    /* 7E60 */ 282, 357, 129, 125, 409, 348, 259, 376, 57, 301, 129, 348, 290, 134, 135, 127,
+    /* 7E70 */ 381, 50, 353, 136, 14, 59, 367, 229, 317, 367, 294, 358, 132, 18, 258, 167,
+    /* 7E80 */ 255, 361, 409, 256, 246, 365, 208, 171, 353, 409, 161, 372, 358, 171, 350, 32,
+    /* 7E90 */ 136, 185, 32, 369, 23, 271, 350, 410, 409, 188, 173, 61, 167, 171, 175, 312,
+    /* 7EA0 */ 141, 373, 122, 396, 350, 98, 375, 132, 341, 161, 132, 274, 343, 376, 122, 47,
+    /* 7EB0 */ 247, 293, 96, 212, 274, 406, 187, 87, 394, 344, 85, 397, 392, 228, 304, 350,
+    /* 7EC0 */ 95, 353, 92, 175, 408, 300, 348, 394, 395, 396, 8, 92, 41, 297, 367, 139,
+    /* 7ED0 */ 58, 9, 277, 137, 157, 272, 68, 115, 129, 99, 359, 135, 188, 144, 136, 332,
+    /* 7EE0 */ 101, 352, 143, 357, 348, 317, 324, 132, 327, 132, 358, 180, 369, 358, 256, 86,
+    /* 7EF0 */ 48, 296, 110, 301, 343, 202, 303, 13, 40, 324, 181, 267, 406, 388, 341, 189,
+    /* 7F00 */ 402, 405, 151, 351, 134, 202, 167, 327, 203, 132, 376, 129, 312, 77, 74, 15,
+    /* 7F10 */ 350, 103, 402, 127, 65, 189, 15, 205, 374, 138, 92, 279, 392, 88, 54, 97,
+    /* 7F20 */ 32, 173, 367, 134, 18, 249, 194, 171, 369, 319, 209, 289, 353, 177, 295, 385,
+    /* 7F30 */ 135, 258, 260, 127, 136, 409, 91, 353, 96, 91, 268, 91, 256, 20, 252, 351,
+    /* 7F40 */ 390, 96, 369, 369, 263, 349, 107, 411, 322, 37, 256, 345, 369, 171, 322, 185,
+    /* 7F50 */ 107, 342, 342, 96, 342, 114, 188, 188, 92, 300, 83, 104, 397, 142, 196, 104,
+    /* 7F60 */ 205, 96, 6, 105, 327, 143, 92, 300, 363, 390, 410, 105, 404, 373, 394, 3,
+    /* 7F70 */ 83, 167, 304, 312, 247, 192, 181, 6, 83, 173, 34, 343, 14, 132, 385, 39,
+    /* 7F80 */ 181, 132, 143, 201, 390, 188, 247, 132, 132, 186, 364, 201, 259, 57, 198, 364,
+    /* 7F90 */ 372, 372, 87, 6, 97, 364, 104, 259, 380, 97, 180, 367, 397, 65, 357, 259,
+    /* 7FA0 */ 367, 350, 277, 269, 269, 259, 127, 319, 350, 367, 364, 259, 258, 373, 101, 137,
+    /* 7FB0 */ 323, 374, 348, 84, 295, 87, 295, 175, 171, 101, 230, 259, 32, 373, 102, 367,
+    /* 7FC0 */ 39, 345, 87, 122, 38, 38, 54, 92, 349, 12, 367, 165, 367, 247, 180, 181,
+    /* 7FD0 */ 394, 266, 348, 353, 351, 348, 348, 151, 260, 129, 129, 352, 293, 122, 135, 65,
+    /* 7FE0 */ 54, 86, 61, 293, 38, 397, 134, 359, 38, 248, 406, 341, 129, 123, 117, 117,
+    /* 7FF0 */ 114, 5, 249, 367, 175, 123, 5, 179, 245, 260, 5, 84, 367, 129, 359, 61,
+    /* 8000 */ 365, 169, 169, 150, 196, 391, 256, 103, 103, 103, 68, 68, 82, 305, 281, 213,
+    /* 8010 */ 213, 74, 171, 331, 405, 101, 34, 116, 376, 6, 247, 367, 312, 266, 133, 142,
+    /* 8020 */ 131, 41, 169, 187, 132, 323, 238, 184, 230, 135, 242, 386, 184, 132, 169, 131,
+    /* 8030 */ 372, 208, 126, 82, 367, 69, 366, 57, 313, 262, 376, 38, 59, 59, 122, 101,
+    /* 8040 */ 394, 241, 225, 59, 392, 35, 180, 393, 372, 339, 177, 183, 394, 227, 329, 82,
+    /* 8050 */ 362, 330, 105, 358, 175, 116, 301, 178, 251, 139, 142, 14, 65, 111, 344, 358,
+    /* 8060 */ 252, 50, 69, 221, 331, 142, 50, 162, 175, 162, 50, 175, 345, 162, 175, 175,
+    /* 8070 */ 50, 5, 301, 313, 331, 162, 225, 394, 59, 227, 261, 221, 331, 331, 183, 373,
+    /* 8080 */ 373, 390, 312, 315, 367, 315, 312, 390, 390, 278, 367, 170, 132, 265, 153, 26,
+    /* 8090 */ 98, 20, 127, 128, 38, 274, 352, 279, 396, 374, 73, 96, 277, 95, 30, 346,
+    /* 80A0 */ 33, 104, 394, 114, 92, 86, 87, 244, 242, 134, 85, 403, 372, 212, 4, 153,
+    /* 80B0 */ 270, 102, 373, 344, 365, 256, 247, 258, 348, 348, 86, 153, 139, 321, 300, 395,
+    /* 80C0 */ 389, 353, 300, 343, 396, 68, 59, 86, 6, 20, 266, 328, 11, 105, 321, 405,
+    /* 80D0 */ 86, 394, 221, 252, 405, 92, 242, 392, 350, 412, 244, 133, 301, 394, 10, 210,
+    /* 80E0 */ 266, 124, 151, 38, 368, 358, 364, 183, 71, 146, 185, 139, 231, 363, 242, 158,
+    /* 80F0 */ 367, 108, 113, 98, 71, 38, 136, 356, 356, 82, 3, 120, 248, 220, 405, 109,
+    /* 8100 */ 37, 329, 394, 54, 198, 353, 54, 353, 193, 193, 132, 353, 226, 159, 285, 380,
+    /* 8110 */ 256, 216, 201, 229, 186, 341, 20, 344, 341, 357, 136, 139, 372, 120, 56, 178,
+    /* 8120 */ 295, 331, 198, 47, 300, 258, 62, 143, 52, 357, 354, 338, 243, 37, 218, 255,
+    /* 8130 */ 72, 338, 224, 216, 247, 104, 188, 173, 175, 389, 54, 137, 176, 309, 247, 16,
+    /* 8140 */ 187, 248, 171, 162, 46, 59, 328, 218, 139, 213, 165, 366, 363, 274, 300, 48,
+    /* 8150 */ 92, 92, 142, 86, 259, 341, 71, 247, 111, 406, 69, 346, 198, 221, 400, 38,
+    /* 8160 */ 51, 188, 238, 65, 3, 355, 216, 304, 307, 214, 376, 395, 278, 78, 286, 334,
+    /* 8170 */ 365, 134, 343, 136, 373, 133, 74, 14, 33, 92, 350, 221, 202, 339, 326, 336,
+    /* 8180 */ 9, 258, 189, 339, 303, 323, 315, 402, 98, 367, 20, 177, 132, 247, 353, 97,
+    /* 8190 */ 189, 18, 238, 33, 185, 111, 242, 43, 16, 135, 92, 323, 208, 348, 400, 189,
+    /* 81A0 */ 136, 369, 189, 394, 360, 55, 179, 332, 246, 221, 43, 177, 54, 109, 352, 326,
+    /* 81B0 */ 84, 394, 136, 295, 124, 54, 283, 351, 317, 87, 369, 295, 398, 59, 159, 229,
+    /* 81C0 */ 337, 175, 14, 371, 144, 41, 367, 143, 165, 175, 289, 337, 104, 256, 54, 18,
+    /* 81D0 */ 361, 216, 346, 380, 350, 16, 355, 160, 165, 363, 185, 131, 377, 188, 266, 380,
+    /* 81E0 */ 186, 221, 377, 36, 258, 346, 108, 380, 179, 108, 405, 136, 225, 40, 132, 97,
+    /* 81F0 */ 40, 202, 225, 394, 394, 98, 134, 68, 394, 357, 321, 392, 141, 350, 373, 30,
+    /* 8200 */ 365, 373, 39, 348, 348, 141, 373, 373, 355, 142, 141, 354, 298, 298, 298, 141,
+    /* 8210 */ 302, 322, 304, 302, 328, 322, 255, 255, 107, 125, 328, 44, 310, 349, 347, 396,
+    /* 8220 */ 61, 44, 295, 367, 84, 239, 321, 84, 8, 44, 115, 85, 8, 14, 185, 395,
+    /* 8230 */ 134, 25, 180, 397, 382, 77, 20, 350, 98, 44, 349, 185, 264, 242, 348, 158,
+    /* 8240 */ 92, 381, 88, 173, 297, 373, 168, 331, 373, 343, 20, 200, 222, 142, 128, 303,
+    /* 8250 */ 151, 15, 210, 68, 61, 9, 30, 367, 314, 25, 26, 184, 58, 360, 365, 39,
+    /* 8260 */ 64, 60, 259, 185, 367, 132, 134, 131, 200, 256, 185, 185, 32, 308, 100, 176,
+    /* 8270 */ 134, 134, 290, 363, 92, 252, 363, 363, 26, 26, 367, 170, 331, 136, 2, 213,
+    /* 8280 */ 329, 136, 137, 246, 341, 367, 31, 202, 201, 95, 258, 373, 373, 297, 264, 73,
+    /* 8290 */ 124, 256, 195, 405, 129, 317, 394, 351, 247, 92, 337, 343, 347, 394, 256, 295,
+    /* 82A0 */ 344, 258, 274, 92, 156, 137, 185, 358, 132, 262, 256, 363, 87, 6, 282, 354,
+    /* 82B0 */ 132, 125, 125, 85, 347, 144, 103, 394, 376, 262, 5, 41, 196, 362, 86, 275,
+    /* 82C0 */ 115, 50, 368, 372, 15, 367, 261, 343, 173, 247, 78, 350, 33, 25, 397, 315,
+    /* 82D0 */ 327, 374, 270, 180, 321, 297, 65, 203, 263, 173, 371, 151, 210, 11, 10, 103,
+    /* 82E0 */ 205, 367, 367, 142, 250, 284, 157, 227, 221, 20, 19, 295, 357, 365, 350, 12,
+    /* 82F0 */ 122, 369, 386, 71, 142, 68, 225, 95, 124, 252, 198, 92, 301, 104, 14, 343,
+    /* 8300 */ 92, 404, 196, 84, 133, 196, 196, 6, 49, 208, 405, 394, 38, 132, 139, 183,
+    /* 8310 */ 50, 224, 374, 360, 369, 264, 98, 206, 173, 277, 368, 100, 258, 31, 36, 373,
+    /* 8320 */ 116, 405, 178, 347, 132, 109, 49, 134, 49, 103, 108, 195, 30, 136, 136, 92,
+    /* 8330 */ 373, 397, 405, 135, 129, 368, 30, 83, 277, 279, 39, 195, 332, 395, 258, 397,
+    /* 8340 */ 361, 127, 92, 267, 94, 57, 139, 355, 44, 26, 139, 82, 3, 260, 38, 274,
+    /* 8350 */ 134, 327, 128, 252, 173, 138, 169, 304, 401, 57, 133, 272, 14, 27, 260, 129,
+    /* 8360 */ 132, 60, 405, 277, 130, 355, 188, 369, 361, 138, 318, 368, 193, 122, 396, 365,
+    /* 8370 */ 73, 343, 173, 72, 92, 274, 368, 117, 14, 21, 376, 65, 334, 317, 317, 37,
+    /* 8380 */ 36, 347, 17, 348, 101, 173, 255, 397, 208, 173, 401, 412, 338, 265, 293, 319,
+    /* 8390 */ 36, 246, 142, 198, 200, 355, 139, 35, 300, 145, 363, 331, 372, 56, 107, 114,
+    /* 83A0 */ 372, 56, 133, 342, 315, 228, 297, 350, 168, 92, 78, 208, 344, 137, 214, 210,
+    /* 83B0 */ 148, 166, 175, 302, 346, 334, 350, 131, 372, 369, 369, 102, 47, 195, 195, 49,
+    /* 83C0 */ 341, 139, 65, 266, 71, 134, 407, 104, 165, 185, 142, 343, 145, 225, 163, 117,
+    /* 83D0 */ 255, 378, 97, 111, 92, 187, 33, 40, 313, 46, 388, 199, 23, 6, 173, 334,
+    /* 83E0 */ 20, 114, 10, 262, 143, 348, 262, 65, 137, 255, 60, 138, 260, 321, 101, 125,
+    /* 83F0 */ 104, 180, 86, 262, 3, 342, 13, 396, 363, 142, 134, 179, 322, 304, 328, 61,
+    /* 8400 */ 124, 256, 117, 54, 324, 47, 14, 33, 127, 86, 166, 256, 200, 252, 343, 59,
+    /* 8410 */ 293, 127, 363, 367, 329, 256, 341, 27, 213, 392, 338, 141, 330, 188, 14, 367,
+    /* 8420 */ 241, 20, 243, 69, 369, 369, 369, 352, 285, 265, 151, 351, 341, 373, 373, 92,
+    /* 8430 */ 175, 359, 359, 214, 27, 346, 47, 352, 373, 15, 196, 3, 78, 188, 369, 164,
+    /* 8440 */ 164, 135, 202, 412, 412, 408, 10, 278, 348, 366, 3, 266, 134, 92, 189, 139,
+    /* 8450 */ 245, 88, 122, 122, 123, 363, 334, 391, 405, 351, 274, 98, 257, 263, 201, 128,
+    /* 8460 */ 300, 255, 94, 71, 396, 134, 343, 20, 343, 239, 132, 124, 380, 133, 74, 365,
+    /* 8470 */ 317, 50, 267, 343, 392, 162, 331, 130, 348, 302, 256, 167, 406, 365, 374, 198,
+    /* 8480 */ 376, 304, 65, 400, 107, 270, 360, 32, 147, 162, 125, 135, 184, 343, 240, 372,
+    /* 8490 */ 314, 368, 302, 47, 302, 376, 392, 168, 279, 200, 173, 268, 316, 374, 173, 142,
+    /* 84A0 */ 348, 9, 41, 358, 334, 181, 131, 66, 258, 408, 253, 56, 374, 41, 373, 159,
+    /* 84B0 */ 241, 255, 255, 212, 311, 348, 87, 376, 393, 134, 132, 284, 25, 80, 201, 116,
+    /* 84C0 */ 318, 392, 206, 314, 358, 181, 348, 104, 168, 277, 345, 94, 56, 302, 323, 188,
+    /* 84D0 */ 279, 319, 359, 11, 365, 109, 14, 406, 110, 412, 329, 27, 244, 167, 59, 132,
+    /* 84E0 */ 173, 300, 168, 373, 180, 369, 208, 67, 329, 196, 332, 41, 246, 3, 175, 50,
+    /* 84F0 */ 348, 252, 265, 138, 47, 137, 343, 336, 26, 373, 367, 405, 177, 14, 185, 358,
+    /* 8500 */ 21, 389, 171, 259, 194, 363, 180, 132, 16, 110, 114, 65, 315, 185, 298, 296,
+    /* 8510 */ 65, 204, 361, 194, 20, 65, 56, 391, 300, 359, 343, 124, 5, 201, 184, 52,
+    /* 8520 */ 395, 23, 253, 135, 201, 50, 224, 129, 143, 368, 134, 222, 304, 368, 111, 36,
+    /* 8530 */ 124, 293, 156, 258, 192, 380, 382, 259, 72, 175, 179, 156, 2, 14, 173, 343,
+    /* 8540 */ 132, 258, 301, 84, 200, 238, 32, 66, 361, 136, 282, 282, 171, 373, 260, 41,
+    /* 8550 */ 125, 134, 193, 376, 10, 372, 266, 185, 272, 129, 78, 327, 86, 144, 410, 83,
+    /* 8560 */ 279, 87, 162, 310, 282, 362, 358, 92, 144, 60, 347, 71, 312, 352, 348, 183,
+    /* 8570 */ 344, 297, 256, 134, 376, 318, 180, 373, 349, 345, 132, 122, 312, 229, 171, 359,
+    /* 8580 */ 376, 373, 348, 116, 10, 116, 2, 343, 129, 129, 132, 49, 351, 341, 204, 367,
+    /* 8590 */ 172, 135, 24, 300, 259, 175, 151, 374, 57, 327, 323, 360, 14, 388, 318, 350,
+    /* 85A0 */ 84, 69, 353, 104, 353, 304, 134, 116, 122, 285, 354, 361, 365, 7, 314, 304,
+    /* 85B0 */ 361, 75, 251, 343, 227, 40, 193, 279, 249, 321, 132, 381, 36, 392, 82, 221,
+    /* 85C0 */ 369, 97, 50, 352, 256, 83, 134, 358, 162, 132, 15, 67, 201, 167, 138, 25,
+    /* 85D0 */ 203, 264, 261, 350, 177, 238, 350, 315, 189, 367, 358, 353, 173, 367, 165, 171,
+    /* 85E0 */ 136, 65, 394, 11, 326, 365, 208, 127, 16, 84, 314, 322, 336, 264, 260, 343,
+    /* 85F0 */ 181, 129, 238, 97, 376, 10, 173, 304, 41, 2, 179, 381, 359, 262, 166, 131,
+    /* 8600 */ 338, 347, 282, 282, 256, 120, 185, 315, 336, 200, 376, 252, 373, 361, 132, 140,
+    /* 8610 */ 359, 208, 265, 315, 140, 246, 225, 20, 271, 367, 350, 373, 142, 175, 175, 368,
+    /* 8620 */ 259, 369, 183, 333, 125, 375, 180, 266, 365, 84, 198, 114, 162, 167, 132, 60,
+    /* 8630 */ 194, 171, 171, 129, 88, 394, 343, 162, 388, 126, 173, 132, 201, 171, 126, 188,
+    /* 8640 */ 132, 162, 185, 134, 285, 326, 171, 267, 352, 367, 186, 199, 17, 124, 124, 185,
+    /* 8650 */ 236, 189, 312, 352, 258, 41, 124, 358, 56, 92, 358, 358, 185, 124, 373, 116,
+    /* 8660 */ 136, 142, 111, 10, 363, 388, 388, 162, 18, 348, 304, 39, 265, 67, 132, 265,
+    /* 8670 */ 69, 302, 349, 144, 391, 298, 373, 114, 405, 122, 129, 200, 98, 317, 349, 31,
+    /* 8680 */ 302, 367, 192, 351, 85, 78, 6, 38, 258, 344, 344, 282, 9, 247, 375, 375,
+    /* 8690 */ 145, 256, 332, 368, 256, 24, 374, 144, 129, 262, 256, 395, 362, 116, 210, 342,
+    /* 86A0 */ 87, 87, 115, 102, 381, 92, 270, 137, 92, 38, 72, 10, 350, 221, 58, 265,
+    /* 86B0 */ 372, 386, 252, 38, 372, 117, 114, 142, 173, 92, 270, 386, 103, 247, 247, 350,
+    /* 86C0 */ 397, 67, 17, 19, 104, 388, 266, 298, 330, 180, 104, 59, 104, 369, 173, 37,
+    /* 86D0 */ 266, 209, 98, 49, 129, 129, 195, 92, 364, 339, 178, 397, 367, 350, 164, 136,
+    /* 86E0 */ 173, 367, 252, 256, 112, 298, 367, 342, 208, 264, 261, 109, 264, 394, 194, 169,
+    /* 86F0 */ 391, 133, 216, 312, 256, 355, 137, 265, 297, 371, 133, 336, 35, 11, 78, 114,
+    /* 8700 */ 304, 359, 88, 300, 300, 92, 350, 391, 347, 92, 173, 168, 14, 41, 374, 372,
+    /* 8710 */ 137, 59, 363, 331, 66, 336, 129, 346, 394, 313, 86, 142, 201, 256, 256, 373,
+    /* 8720 */ 145, 165, 200, 259, 312, 348, 187, 173, 68, 329, 324, 163, 114, 114, 373, 9,
+    /* 8730 */ 86, 247, 343, 76, 367, 374, 319, 267, 258, 282, 221, 263, 343, 176, 111, 341,
+    /* 8740 */ 71, 78, 8, 65, 342, 24, 364, 369, 111, 32, 69, 165, 151, 137, 353, 331,
+    /* 8750 */ 196, 358, 202, 373, 137, 302, 359, 128, 363, 15, 278, 343, 92, 374, 198, 343,
+    /* 8760 */ 92, 279, 353, 372, 265, 196, 349, 369, 302, 39, 323, 397, 406, 327, 92, 374,
+    /* 8770 */ 162, 200, 165, 73, 124, 265, 68, 173, 346, 376, 266, 214, 184, 47, 277, 369,
+    /* 8780 */ 135, 8, 168, 242, 312, 348, 49, 348, 374, 345, 175, 314, 8, 277, 277, 132,
+    /* 8790 */ 347, 357, 114, 262, 367, 14, 125, 323, 367, 73, 213, 117, 124, 109, 192, 206,
+    /* 87A0 */ 367, 344, 369, 325, 395, 25, 289, 256, 194, 329, 296, 302, 26, 38, 65, 5,
+    /* 87B0 */ 185, 343, 394, 323, 36, 249, 266, 247, 373, 134, 188, 184, 262, 395, 368, 135,
+    /* 87C0 */ 306, 344, 352, 341, 391, 391, 192, 192, 111, 181, 196, 348, 50, 173, 194, 352,
+    /* 87D0 */ 33, 389, 195, 351, 208, 410, 312, 265, 325, 394, 246, 246, 136, 266, 17, 177,
+    /* 87E0 */ 241, 109, 348, 132, 400, 128, 86, 169, 144, 144, 129, 368, 32, 136, 295, 216,
+    /* 87F0 */ 352, 347, 39, 361, 312, 41, 37, 60, 173, 353, 295, 367, 139, 57, 32, 256,
+    /* 8800 */ 49, 351, 298, 188, 262, 369, 31, 173, 383, 359, 175, 397, 382, 353, 195, 353,
+    /* 8810 */ 256, 277, 134, 200, 116, 279, 131, 404, 137, 251, 117, 204, 84, 171, 137, 165,
+    /* 8820 */ 205, 173, 47, 173, 265, 225, 185, 73, 352, 397, 183, 173, 183, 88, 366, 247,
+    /* 8830 */ 215, 104, 143, 369, 304, 348, 24, 266, 267, 73, 24, 194, 266, 137, 397, 404,
+    /* 8840 */ 360, 128, 235, 244, 235, 354, 395, 193, 82, 146, 204, 348, 355, 363, 148, 374,
+    /* 8850 */ 266, 180, 359, 304, 350, 332, 351, 137, 350, 362, 124, 343, 61, 39, 343, 61,
+    /* 8860 */ 403, 120, 266, 367, 367, 21, 95, 373, 16, 30, 367, 295, 36, 92, 110, 87,
+    /* 8870 */ 306, 137, 212, 395, 59, 367, 395, 395, 137, 394, 353, 270, 394, 274, 262, 138,
+    /* 8880 */ 145, 374, 198, 31, 5, 224, 129, 270, 133, 338, 180, 58, 10, 243, 365, 412,
+    /* 8890 */ 14, 297, 322, 142, 117, 360, 357, 392, 367, 239, 20, 65, 339, 92, 110, 394,
+    /* 88A0 */ 394, 270, 241, 367, 196, 338, 212, 103, 359, 391, 266, 11, 373, 348, 201, 20,
+    /* 88B0 */ 20, 92, 38, 38, 157, 274, 135, 257, 134, 20, 137, 82, 98, 279, 397, 109,
+    /* 88C0 */ 368, 23, 178, 146, 355, 401, 60, 358, 163, 153, 224, 304, 133, 163, 37, 173,
+    /* 88D0 */ 143, 300, 254, 98, 367, 373, 392, 181, 265, 269, 132, 367, 21, 401, 309, 293,
+    /* 88E0 */ 269, 173, 175, 175, 157, 134, 91, 32, 14, 163, 324, 374, 180, 38, 33, 40,
+    /* 88F0 */ 77, 16, 176, 296, 244, 244, 86, 374, 188, 111, 363, 73, 327, 394, 142, 367,
+    /* 8900 */ 256, 111, 105, 153, 256, 327, 327, 92, 39, 353, 15, 68, 163, 74, 357, 357,
+    /* 8910 */ 117, 374, 10, 10, 92, 373, 335, 363, 129, 11, 41, 189, 243, 59, 376, 320,
+    /* 8920 */ 103, 57, 126, 277, 374, 279, 213, 140, 319, 8, 336, 38, 288, 224, 369, 137,
+    /* 8930 */ 258, 126, 157, 175, 167, 173, 391, 302, 189, 367, 68, 353, 350, 343, 16, 26,
+    /* 8940 */ 132, 259, 291, 10, 351, 14, 92, 134, 400, 134, 54, 132, 59, 377, 84, 20,
+    /* 8950 */ 351, 354, 17, 272, 194, 167, 5, 382, 109, 26, 317, 229, 32, 175, 14, 138,
+    /* 8960 */ 60, 304, 322, 14, 167, 92, 279, 394, 75, 304, 339, 302, 7, 353, 20, 36,
+    /* 8970 */ 166, 183, 348, 350, 167, 391, 58, 142, 379, 302, 134, 241, 367, 167, 362, 348,
+    /* 8980 */ 348, 365, 88, 322, 92, 89, 92, 6, 117, 132, 132, 134, 107, 15, 363, 109,
+    /* 8990 */ 144, 248, 196, 201, 201, 204, 302, 312, 32, 188, 144, 201, 329, 175, 365, 394,
+    /* 89A0 */ 145, 348, 295, 343, 348, 328, 373, 167, 78, 73, 262, 242, 132, 206, 369, 103,
+    /* 89B0 */ 266, 388, 138, 107, 64, 134, 188, 266, 134, 343, 144, 266, 188, 167, 300, 65,
+    /* 89C0 */ 107, 134, 107, 363, 109, 201, 302, 32, 167, 144, 132, 348, 65, 328, 373, 103,
+    /* 89D0 */ 138, 266, 136, 265, 138, 52, 144, 394, 34, 132, 104, 59, 405, 65, 296, 125,
+    /* 89E0 */ 267, 98, 302, 137, 109, 102, 41, 137, 130, 265, 355, 315, 221, 132, 185, 394,
+    /* 89F0 */ 386, 14, 355, 124, 296, 102, 394, 360, 41, 348, 367, 173, 144, 348, 363, 348,
+    /* 8A00 */ 363, 363, 69, 92, 265, 265, 136, 122, 132, 84, 361, 67, 122, 31, 324, 358,
+    /* 8A10 */ 137, 367, 274, 361, 368, 295, 256, 338, 132, 361, 368, 78, 87, 362, 365, 313,
+    /* 8A20 */ 300, 368, 354, 144, 352, 217, 36, 372, 394, 356, 85, 354, 34, 298, 363, 285,
+    /* 8A30 */ 403, 358, 367, 367, 315, 38, 117, 300, 117, 358, 392, 397, 393, 103, 405, 405,
+    /* 8A40 */ 388, 104, 92, 134, 68, 180, 65, 364, 173, 216, 241, 396, 95, 367, 142, 365,
+    /* 8A50 */ 386, 367, 367, 266, 390, 252, 14, 356, 266, 6, 57, 408, 324, 397, 49, 391,
+    /* 8A60 */ 371, 358, 361, 367, 128, 117, 302, 30, 352, 302, 119, 30, 103, 109, 267, 129,
+    /* 8A70 */ 137, 125, 94, 351, 343, 300, 396, 332, 201, 388, 206, 78, 129, 363, 356, 105,
+    /* 8A80 */ 82, 19, 329, 367, 171, 397, 161, 158, 347, 373, 326, 132, 394, 274, 52, 168,
+    /* 8A90 */ 78, 161, 79, 302, 331, 59, 11, 32, 372, 154, 260, 262, 305, 3, 373, 352,
+    /* 8AA0 */ 37, 137, 350, 347, 347, 97, 313, 21, 129, 139, 311, 392, 311, 73, 125, 33,
+    /* 8AB0 */ 309, 137, 151, 266, 50, 352, 317, 342, 350, 86, 38, 320, 367, 221, 368, 67,
+    /* 8AC0 */ 247, 404, 32, 36, 403, 132, 256, 322, 402, 343, 142, 263, 71, 393, 382, 407,
+    /* 8AD0 */ 258, 404, 176, 134, 41, 116, 187, 300, 16, 125, 248, 373, 68, 358, 248, 302,
+    /* 8AE0 */ 359, 302, 130, 125, 78, 395, 65, 353, 92, 255, 331, 134, 256, 373, 405, 400,
+    /* 8AF0 */ 348, 129, 368, 3, 350, 214, 36, 88, 397, 364, 363, 128, 359, 98, 234, 256,
+    /* 8B00 */ 209, 366, 343, 355, 326, 396, 295, 134, 253, 162, 128, 131, 98, 369, 201, 352,
+    /* 8B10 */ 201, 348, 259, 36, 360, 327, 315, 9, 38, 258, 302, 135, 374, 353, 117, 324,
+    /* 8B20 */ 365, 365, 185, 373, 16, 50, 263, 173, 208, 208, 296, 391, 207, 134, 382, 137,
+    /* 8B30 */ 175, 184, 24, 238, 110, 348, 404, 5, 5, 138, 391, 367, 124, 135, 194, 34,
+    /* 8B40 */ 114, 125, 32, 358, 385, 290, 348, 386, 75, 393, 216, 167, 78, 369, 144, 132,
+    /* 8B50 */ 411, 136, 20, 129, 400, 347, 384, 386, 302, 260, 322, 384, 255, 301, 359, 381,
+    /* 8B60 */ 322, 60, 317, 350, 132, 136, 139, 388, 215, 367, 2, 388, 247, 129, 125, 367,
+    /* 8B70 */ 367, 295, 271, 230, 258, 75, 320, 124, 396, 116, 2, 369, 134, 373, 134, 129,
+    /* 8B80 */ 73, 391, 359, 379, 171, 300, 343, 32, 173, 367, 15, 391, 363, 78, 40, 343,
+    /* 8B90 */ 40, 365, 32, 271, 368, 167, 36, 353, 225, 127, 379, 367, 60, 388, 363, 73,
+    /* 8BA0 */ 363, 132, 69, 92, 274, 132, 137, 122, 324, 271, 295, 256, 338, 361, 367, 361,
+    /* 8BB0 */ 132, 274, 135, 129, 238, 142, 362, 217, 358, 78, 187, 356, 313, 88, 298, 85,
+    /* 8BC0 */ 144, 393, 104, 117, 252, 408, 302, 356, 386, 315, 392, 65, 396, 49, 266, 390,
+    /* 8BD0 */ 14, 367, 367, 161, 171, 302, 105, 302, 132, 129, 37, 397, 300, 125, 59, 103,
+    /* 8BE0 */ 267, 109, 361, 367, 393, 94, 351, 30, 130, 358, 396, 137, 347, 373, 260, 347,
+    /* 8BF0 */ 97, 372, 129, 161, 311, 313, 79, 263, 397, 407, 234, 73, 404, 86, 151, 343,
+    /* 8C00 */ 373, 299, 300, 67, 32, 176, 403, 317, 322, 300, 367, 209, 36, 68, 128, 134,
+    /* 8C10 */ 353, 360, 366, 343, 78, 373, 359, 32, 405, 3, 363, 65, 201, 248, 358, 208,
+    /* 8C20 */ 60, 315, 353, 365, 9, 302, 258, 201, 138, 194, 391, 134, 207, 322, 384, 260,
+    /* 8C30 */ 167, 255, 144, 363, 258, 388, 36, 104, 258, 122, 349, 132, 122, 114, 122, 348,
+    /* 8C40 */ 348, 131, 177, 114, 73, 183, 72, 135, 256, 302, 173, 64, 341, 14, 304, 350,
+    /* 8C50 */ 88, 394, 394, 363, 363, 302, 41, 129, 337, 367, 337, 367, 134, 6, 123, 78,
+    /* 8C60 */ 41, 351, 127, 134, 153, 94, 142, 92, 348, 18, 116, 373, 397, 133, 87, 348,
+    /* 8C70 */ 20, 344, 127, 18, 65, 406, 87, 367, 394, 10, 31, 3, 247, 212, 247, 103,
+    /* 8C80 */ 212, 372, 67, 208, 312, 357, 127, 163, 117, 116, 208, 3, 196, 173, 221, 14,
+    /* 8C90 */ 373, 133, 335, 196, 247, 348, 367, 142, 208, 41, 322, 127, 144, 11, 392, 374,
+    /* 8CA0 */ 92, 23, 102, 325, 367, 115, 341, 251, 131, 84, 322, 107, 382, 394, 82, 397,
+    /* 8CB0 */ 302, 14, 405, 82, 109, 248, 15, 193, 58, 301, 161, 86, 330, 367, 38, 196,
+    /* 8CC0 */ 117, 14, 185, 179, 129, 94, 248, 405, 133, 358, 383, 136, 94, 380, 134, 369,
+    /* 8CD0 */ 361, 392, 298, 18, 18, 265, 298, 44, 380, 396, 166, 379, 49, 36, 296, 328,
+    /* 8CE0 */ 244, 101, 350, 193, 134, 317, 92, 322, 50, 50, 394, 132, 389, 73, 138, 356,
+    /* 8CF0 */ 47, 376, 10, 378, 166, 88, 25, 132, 301, 367, 400, 92, 103, 286, 382, 177,
+    /* 8D00 */ 367, 7, 36, 341, 394, 402, 16, 376, 385, 59, 379, 363, 255, 295, 341, 369,
+    /* 8D10 */ 138, 95, 350, 380, 14, 73, 304, 363, 296, 359, 183, 95, 380, 11, 392, 92,
+    /* 8D20 */ 374, 102, 23, 382, 350, 7, 389, 131, 394, 84, 322, 251, 15, 103, 397, 107,
+    /* 8D30 */ 82, 134, 12, 302, 330, 109, 161, 58, 196, 86, 117, 367, 383, 394, 133, 129,
+    /* 8D40 */ 405, 179, 185, 380, 405, 94, 138, 265, 392, 166, 298, 92, 73, 132, 304, 296,
+    /* 8D50 */ 49, 14, 396, 101, 244, 59, 166, 88, 402, 92, 400, 286, 382, 363, 379, 376,
+    /* 8D60 */ 385, 295, 369, 95, 38, 348, 298, 214, 332, 348, 37, 117, 37, 391, 349, 323,
+    /* 8D70 */ 407, 407, 173, 141, 92, 390, 95, 256, 295, 264, 368, 350, 405, 144, 262, 38,
+    /* 8D80 */ 49, 36, 36, 68, 142, 34, 65, 348, 388, 144, 375, 266, 132, 38, 41, 105,
+    /* 8D90 */ 360, 405, 329, 77, 178, 95, 319, 52, 348, 390, 315, 368, 142, 134, 268, 323,
+    /* 8DA0 */ 48, 54, 185, 266, 60, 265, 405, 327, 266, 38, 128, 260, 260, 136, 381, 327,
+    /* 8DB0 */ 82, 379, 379, 408, 239, 10, 157, 151, 76, 144, 92, 36, 134, 85, 394, 320,
+    /* 8DC0 */ 375, 6, 256, 375, 259, 338, 321, 367, 222, 180, 198, 6, 68, 157, 338, 133,
+    /* 8DD0 */ 49, 243, 257, 397, 142, 66, 394, 92, 241, 142, 295, 20, 221, 142, 173, 100,
+    /* 8DE0 */ 367, 132, 77, 350, 136, 77, 397, 267, 158, 399, 109, 264, 162, 351, 38, 185,
+    /* 8DF0 */ 248, 394, 133, 329, 23, 134, 57, 260, 14, 350, 77, 132, 142, 132, 304, 334,
+    /* 8E00 */ 41, 139, 225, 352, 21, 360, 55, 210, 304, 176, 371, 136, 40, 260, 209, 320,
+    /* 8E10 */ 134, 256, 346, 343, 48, 137, 132, 225, 142, 225, 187, 185, 172, 126, 142, 38,
+    /* 8E20 */ 341, 267, 327, 20, 408, 261, 367, 52, 406, 23, 406, 246, 394, 393, 66, 394,
+    /* 8E30 */ 373, 77, 76, 44, 371, 395, 65, 386, 36, 43, 134, 105, 323, 142, 92, 408,
+    /* 8E40 */ 68, 248, 278, 234, 327, 30, 336, 134, 61, 56, 256, 320, 259, 222, 66, 327,
+    /* 8E50 */ 132, 225, 194, 181, 379, 14, 39, 185, 177, 52, 323, 58, 315, 348, 162, 132,
+    /* 8E60 */ 394, 259, 65, 241, 406, 175, 13, 381, 222, 17, 336, 142, 64, 29, 350, 84,
+    /* 8E70 */ 41, 395, 76, 20, 52, 52, 144, 144, 179, 320, 260, 144, 255, 177, 76, 53,
+    /* 8E80 */ 107, 381, 57, 14, 14, 397, 142, 41, 260, 76, 40, 132, 347, 375, 222, 179,
+    /* 8E90 */ 178, 394, 173, 394, 32, 41, 74, 343, 183, 179, 350, 343, 409, 167, 353, 271,
+    /* 8EA0 */ 285, 225, 320, 266, 132, 53, 56, 348, 162, 144, 179, 300, 102, 59, 87, 266,
+    /* 8EB0 */ 327, 77, 77, 102, 168, 274, 188, 2, 132, 142, 323, 155, 169, 363, 198, 149,
+    /* 8EC0 */ 266, 184, 169, 77, 394, 363, 327, 61, 369, 373, 35, 362, 109, 145, 343, 375,
+    /* 8ED0 */ 354, 58, 359, 84, 274, 295, 161, 304, 337, 36, 58, 78, 212, 256, 196, 281,
+    /* 8EE0 */ 161, 258, 400, 122, 124, 266, 161, 65, 180, 58, 5, 392, 84, 161, 364, 246,
+    /* 8EF0 */ 11, 104, 104, 243, 397, 277, 78, 6, 396, 394, 365, 151, 367, 394, 302, 252,
+    /* 8F00 */ 82, 102, 142, 136, 108, 117, 147, 267, 396, 378, 394, 298, 176, 373, 297, 372,
+    /* 8F10 */ 341, 368, 391, 341, 92, 263, 396, 221, 172, 391, 388, 176, 405, 129, 342, 48,
+    /* 8F20 */ 111, 148, 367, 246, 258, 110, 222, 252, 107, 11, 187, 240, 176, 281, 278, 132,
+    /* 8F30 */ 364, 350, 44, 51, 47, 98, 372, 122, 304, 92, 405, 92, 344, 12, 388, 373,
+    /* 8F40 */ 344, 324, 104, 392, 349, 374, 185, 136, 34, 400, 343, 130, 360, 391, 136, 388,
+    /* 8F50 */ 21, 169, 87, 84, 179, 98, 290, 148, 127, 367, 132, 402, 82, 373, 134, 122,
+    /* 8F60 */ 171, 244, 173, 173, 185, 179, 35, 362, 109, 359, 58, 274, 400, 78, 187, 281,
+    /* 8F70 */ 122, 104, 151, 185, 396, 394, 367, 124, 392, 173, 365, 263, 302, 378, 394, 136,
+    /* 8F80 */ 396, 267, 185, 136, 391, 92, 176, 222, 11, 129, 110, 342, 176, 48, 405, 51,
+    /* 8F90 */ 92, 132, 344, 304, 244, 374, 349, 222, 185, 391, 179, 354, 104, 49, 49, 247,
+    /* 8FA0 */ 410, 15, 165, 165, 49, 360, 8, 15, 15, 15, 360, 15, 8, 49, 15, 15,
+    /* 8FB0 */ 36, 279, 229, 229, 32, 48, 48, 367, 275, 15, 15, 302, 373, 177, 57, 32,
+    /* 8FC0 */ 95, 258, 373, 373, 256, 361, 367, 111, 193, 256, 377, 342, 334, 403, 369, 57,
+    /* 8FD0 */ 376, 138, 115, 362, 84, 347, 57, 78, 113, 391, 57, 138, 374, 343, 175, 38,
+    /* 8FE0 */ 35, 221, 329, 394, 367, 140, 133, 36, 58, 82, 65, 253, 397, 68, 382, 324,
+    /* 8FF0 */ 304, 338, 266, 139, 129, 71, 372, 201, 13, 132, 213, 367, 137, 402, 178, 361,
+    /* 9000 */ 336, 313, 302, 324, 242, 123, 221, 76, 140, 359, 361, 21, 372, 352, 265, 333,
+    /* 9010 */ 397, 265, 65, 65, 334, 139, 327, 72, 367, 391, 332, 108, 347, 302, 37, 315,
+    /* 9020 */ 381, 269, 88, 175, 319, 129, 173, 104, 166, 12, 56, 144, 13, 127, 58, 185,
+    /* 9030 */ 372, 396, 138, 373, 48, 162, 343, 327, 367, 57, 374, 188, 14, 234, 373, 60,
+    /* 9040 */ 317, 76, 317, 363, 44, 38, 327, 373, 302, 392, 372, 376, 78, 15, 111, 78,
+    /* 9050 */ 349, 128, 265, 61, 57, 343, 214, 367, 103, 365, 40, 181, 361, 320, 65, 38,
+    /* 9060 */ 374, 315, 320, 258, 192, 365, 107, 389, 5, 302, 22, 38, 315, 381, 391, 76,
+    /* 9070 */ 65, 184, 38, 56, 179, 411, 272, 258, 359, 373, 367, 78, 177, 142, 302, 14,
+    /* 9080 */ 365, 193, 353, 317, 113, 388, 326, 82, 203, 15, 15, 165, 173, 374, 365, 188,
+    /* 9090 */ 173, 367, 331, 64, 256, 371, 295, 114, 373, 195, 279, 264, 348, 161, 92, 149,
+    /* 90A0 */ 18, 85, 355, 212, 354, 300, 9, 374, 55, 131, 353, 9, 347, 142, 372, 114,
+    /* 90B0 */ 321, 265, 14, 247, 19, 297, 11, 339, 65, 407, 366, 179, 161, 109, 397, 302,
+    /* 90C0 */ 157, 373, 94, 117, 261, 394, 132, 127, 123, 355, 136, 348, 109, 234, 168, 133,
+    /* 90D0 */ 159, 393, 168, 376, 363, 37, 72, 348, 189, 92, 347, 92, 97, 116, 168, 133,
+    /* 90E0 */ 101, 145, 369, 20, 348, 11, 173, 376, 21, 352, 256, 247, 263, 111, 396, 322,
+    /* 90F0 */ 407, 252, 166, 221, 36, 372, 21, 351, 59, 142, 371, 260, 367, 72, 363, 198,
+    /* 9100 */ 284, 11, 78, 304, 143, 373, 376, 123, 162, 351, 351, 314, 323, 206, 348, 279,
+    /* 9110 */ 41, 405, 407, 366, 347, 351, 376, 116, 371, 14, 196, 34, 92, 177, 368, 400,
+    /* 9120 */ 124, 260, 363, 389, 194, 260, 358, 64, 14, 361, 14, 385, 343, 393, 196, 295,
+    /* 9130 */ 179, 253, 59, 200, 366, 26, 159, 88, 200, 407, 161, 175, 379, 32, 372, 132,
+    /* 9140 */ 363, 32, 56, 180, 127, 348, 88, 379, 173, 372, 69, 265, 404, 244, 396, 367,
+    /* 9150 */ 95, 373, 141, 363, 410, 196, 392, 358, 72, 392, 87, 374, 92, 376, 321, 328,
+    /* 9160 */ 257, 338, 52, 114, 104, 315, 253, 40, 378, 206, 169, 48, 40, 372, 332, 394,
+    /* 9170 */ 350, 135, 37, 368, 334, 136, 198, 157, 316, 171, 255, 410, 113, 363, 294, 223,
+    /* 9180 */ 343, 185, 167, 363, 324, 244, 388, 47, 322, 410, 402, 52, 163, 327, 350, 73,
+    /* 9190 */ 124, 358, 355, 322, 265, 47, 376, 253, 151, 314, 201, 267, 40, 56, 376, 371,
+    /* 91A0 */ 4, 386, 113, 323, 135, 249, 36, 373, 173, 381, 169, 367, 135, 21, 136, 348,
+    /* 91B0 */ 322, 83, 229, 367, 173, 142, 363, 367, 223, 279, 361, 40, 363, 180, 201, 201,
+    /* 91C0 */ 223, 354, 136, 294, 201, 363, 15, 23, 302, 372, 302, 302, 173, 395, 366, 176,
+    /* 91D0 */ 348, 138, 138, 265, 367, 177, 61, 390, 69, 253, 265, 6, 92, 392, 394, 6,
+    /* 91E0 */ 186, 92, 213, 67, 295, 260, 156, 44, 405, 84, 125, 125, 114, 96, 256, 195,
+    /* 91F0 */ 276, 65, 312, 348, 367, 31, 302, 334, 348, 235, 258, 265, 134, 247, 366, 138,
+    /* 9200 */ 6, 85, 36, 355, 72, 375, 258, 92, 247, 212, 354, 78, 144, 76, 103, 368,
+    /* 9210 */ 258, 8, 285, 274, 34, 228, 87, 376, 367, 262, 247, 111, 122, 368, 145, 67,
+    /* 9220 */ 367, 395, 348, 94, 276, 131, 321, 149, 374, 185, 78, 262, 77, 405, 221, 334,
+    /* 9230 */ 302, 205, 104, 151, 180, 19, 312, 104, 20, 247, 373, 312, 412, 21, 372, 328,
+    /* 9240 */ 133, 392, 302, 302, 394, 142, 32, 302, 302, 359, 390, 10, 117, 14, 301, 41,
+    /* 9250 */ 302, 20, 397, 38, 377, 253, 332, 258, 92, 387, 181, 258, 92, 173, 375, 247,
+    /* 9260 */ 364, 8, 20, 137, 103, 304, 393, 210, 348, 348, 65, 133, 210, 322, 127, 367,
+    /* 9270 */ 312, 161, 146, 11, 134, 332, 355, 122, 136, 38, 82, 188, 19, 302, 209, 133,
+    /* 9280 */ 368, 145, 396, 39, 351, 332, 208, 171, 132, 373, 358, 274, 411, 394, 264, 295,
+    /* 9290 */ 38, 350, 355, 267, 247, 330, 397, 351, 206, 158, 365, 350, 350, 357, 145, 30,
+    /* 92A0 */ 169, 132, 247, 279, 201, 367, 368, 108, 3, 70, 372, 290, 150, 258, 186, 312,
+    /* 92B0 */ 2, 67, 114, 282, 302, 154, 265, 352, 391, 357, 380, 327, 56, 105, 122, 395,
+    /* 92C0 */ 333, 189, 198, 168, 341, 354, 376, 11, 347, 315, 373, 32, 69, 20, 114, 133,
+    /* 92D0 */ 122, 53, 88, 32, 341, 394, 312, 359, 125, 373, 329, 161, 404, 190, 355, 262,
+    /* 92E0 */ 300, 114, 190, 366, 41, 385, 142, 350, 330, 195, 255, 173, 241, 282, 37, 97,
+    /* 92F0 */ 173, 325, 19, 397, 392, 334, 181, 410, 142, 33, 374, 134, 96, 67, 324, 33,
+    /* 9300 */ 187, 111, 180, 247, 185, 173, 259, 254, 143, 205, 410, 246, 3, 247, 350, 362,
+    /* 9310 */ 402, 171, 151, 155, 320, 163, 73, 218, 46, 405, 393, 12, 225, 406, 47, 322,
+    /* 9320 */ 69, 256, 258, 402, 132, 373, 138, 107, 196, 33, 328, 348, 175, 324, 104, 56,
+    /* 9330 */ 304, 392, 185, 200, 185, 125, 16, 93, 166, 153, 85, 347, 213, 341, 379, 124,
+    /* 9340 */ 62, 350, 248, 131, 176, 83, 199, 147, 369, 65, 175, 111, 350, 73, 334, 343,
+    /* 9350 */ 406, 92, 278, 132, 78, 145, 36, 327, 386, 124, 364, 74, 349, 373, 154, 301,
+    /* 9360 */ 128, 343, 92, 390, 30, 261, 302, 122, 162, 328, 209, 260, 260, 123, 333, 50,
+    /* 9370 */ 127, 366, 205, 134, 74, 134, 313, 162, 124, 359, 77, 137, 392, 15, 395, 405,
+    /* 9380 */ 357, 366, 198, 240, 2, 137, 258, 198, 319, 57, 9, 349, 175, 319, 147, 181,
+    /* 9390 */ 365, 366, 230, 345, 277, 323, 319, 259, 173, 311, 46, 20, 241, 57, 14, 288,
+    /* 93A0 */ 96, 405, 347, 369, 128, 329, 181, 147, 318, 293, 314, 341, 116, 392, 392, 168,
+    /* 93B0 */ 367, 374, 323, 225, 348, 133, 98, 192, 143, 313, 408, 319, 349, 88, 344, 212,
+    /* 93C0 */ 185, 319, 238, 408, 335, 357, 107, 359, 175, 303, 5, 194, 208, 188, 14, 343,
+    /* 93D0 */ 181, 65, 287, 406, 367, 185, 5, 154, 259, 54, 256, 33, 323, 194, 371, 32,
+    /* 93E0 */ 88, 139, 16, 304, 184, 357, 50, 183, 379, 134, 26, 173, 349, 348, 149, 308,
+    /* 93F0 */ 13, 389, 258, 37, 185, 125, 132, 255, 129, 259, 253, 179, 290, 357, 287, 37,
+    /* 9400 */ 162, 312, 181, 216, 128, 250, 317, 84, 260, 267, 364, 323, 351, 144, 136, 411,
+    /* 9410 */ 177, 261, 169, 75, 354, 379, 132, 134, 395, 64, 362, 369, 75, 144, 230, 379,
+    /* 9420 */ 255, 330, 84, 37, 69, 295, 147, 134, 86, 317, 185, 143, 129, 373, 175, 404,
+    /* 9430 */ 260, 134, 404, 171, 14, 330, 127, 366, 77, 111, 60, 142, 87, 57, 11, 367,
+    /* 9440 */ 2, 406, 361, 67, 397, 120, 402, 132, 225, 117, 131, 263, 18, 369, 162, 227,
+    /* 9450 */ 358, 134, 134, 258, 30, 394, 204, 173, 171, 132, 409, 161, 296, 246, 165, 73,
+    /* 9460 */ 311, 48, 189, 16, 10, 185, 350, 160, 183, 78, 185, 354, 134, 167, 20, 134,
+    /* 9470 */ 365, 32, 351, 134, 348, 107, 25, 225, 171, 53, 266, 241, 188, 409, 186, 381,
+    /* 9480 */ 225, 144, 323, 397, 167, 138, 93, 367, 392, 69, 390, 253, 177, 334, 258, 44,
+    /* 9490 */ 295, 285, 84, 67, 199, 235, 364, 31, 355, 94, 21, 321, 142, 76, 34, 395,
+    /* 94A0 */ 212, 11, 96, 8, 258, 365, 262, 145, 347, 103, 149, 85, 131, 333, 228, 6,
+    /* 94B0 */ 373, 258, 393, 258, 104, 20, 151, 253, 21, 20, 375, 409, 210, 322, 133, 66,
+    /* 94C0 */ 372, 330, 20, 180, 311, 258, 196, 10, 302, 359, 320, 14, 221, 247, 77, 355,
+    /* 94D0 */ 150, 169, 82, 195, 362, 372, 37, 133, 366, 216, 394, 60, 332, 189, 67, 368,
+    /* 94E0 */ 147, 386, 397, 348, 69, 70, 350, 125, 267, 293, 112, 67, 98, 206, 393, 290,
+    /* 94F0 */ 136, 367, 32, 39, 323, 3, 368, 279, 397, 169, 255, 347, 166, 325, 175, 154,
+    /* 9500 */ 352, 319, 173, 385, 41, 111, 97, 78, 357, 56, 190, 88, 354, 181, 147, 134,
+    /* 9510 */ 282, 327, 168, 262, 142, 1, 259, 391, 234, 56, 196, 12, 256, 62, 151, 163,
+    /* 9520 */ 33, 348, 104, 188, 46, 402, 138, 394, 350, 143, 131, 244, 322, 69, 134, 142,
+    /* 9530 */ 200, 405, 261, 369, 147, 259, 312, 78, 30, 260, 395, 74, 314, 128, 127, 2,
+    /* 9540 */ 73, 198, 184, 405, 86, 198, 208, 392, 20, 98, 225, 323, 143, 225, 212, 181,
+    /* 9550 */ 97, 9, 367, 133, 18, 277, 16, 323, 194, 188, 13, 371, 139, 65, 408, 359,
+    /* 9560 */ 181, 32, 144, 177, 255, 185, 75, 167, 255, 53, 259, 64, 131, 171, 127, 404,
+    /* 9570 */ 175, 367, 30, 16, 165, 32, 351, 389, 33, 141, 5, 68, 266, 177, 201, 389,
+    /* 9580 */ 199, 192, 307, 295, 131, 199, 363, 14, 114, 14, 295, 147, 149, 13, 122, 283,
+    /* 9590 */ 287, 350, 350, 134, 205, 349, 309, 72, 386, 216, 388, 246, 349, 180, 15, 14,
+    /* 95A0 */ 283, 2, 107, 98, 98, 83, 41, 122, 109, 205, 290, 163, 168, 189, 331, 293,
+    /* 95B0 */ 142, 375, 375, 32, 266, 179, 33, 294, 163, 363, 344, 363, 78, 130, 373, 344,
+    /* 95C0 */ 122, 10, 122, 266, 365, 344, 8, 3, 343, 368, 164, 268, 167, 73, 267, 88,
+    /* 95D0 */ 328, 225, 320, 147, 117, 268, 45, 107, 72, 256, 162, 323, 107, 249, 148, 348,
+    /* 95E0 */ 129, 32, 247, 60, 127, 320, 344, 320, 199, 307, 295, 363, 114, 14, 344, 45,
+    /* 95F0 */ 283, 343, 350, 122, 134, 205, 149, 199, 386, 216, 109, 344, 320, 205, 189, 147,
+    /* 9600 */ 83, 98, 117, 163, 141, 375, 168, 73, 373, 363, 33, 348, 344, 130, 363, 78,
+    /* 9610 */ 32, 167, 266, 129, 164, 268, 117, 328, 57, 268, 114, 127, 92, 92, 170, 75,
+    /* 9620 */ 354, 258, 347, 94, 394, 368, 364, 72, 78, 301, 8, 244, 154, 376, 281, 394,
+    /* 9630 */ 247, 139, 85, 364, 368, 392, 137, 37, 78, 266, 65, 408, 412, 66, 180, 1,
+    /* 9640 */ 338, 338, 11, 19, 92, 132, 185, 183, 36, 355, 77, 184, 208, 135, 304, 77,
+    /* 9650 */ 350, 82, 109, 373, 94, 295, 145, 260, 355, 47, 92, 14, 349, 295, 301, 394,
+    /* 9660 */ 255, 72, 374, 392, 41, 350, 61, 225, 376, 350, 244, 86, 407, 367, 75, 187,
+    /* 9670 */ 368, 142, 46, 36, 247, 180, 324, 350, 185, 301, 350, 368, 397, 364, 275, 349,
+    /* 9680 */ 39, 363, 368, 304, 65, 373, 183, 343, 343, 225, 75, 317, 3, 128, 137, 317,
+    /* 9690 */ 368, 94, 363, 129, 98, 376, 347, 162, 2, 348, 323, 132, 389, 61, 5, 348,
+    /* 96A0 */ 368, 285, 272, 179, 336, 64, 136, 317, 317, 5, 350, 87, 221, 82, 132, 61,
+    /* 96B0 */ 348, 368, 394, 129, 183, 348, 173, 173, 173, 402, 124, 394, 318, 143, 214, 367,
+    /* 96C0 */ 268, 363, 262, 258, 356, 362, 132, 104, 127, 394, 103, 143, 49, 371, 142, 41,
+    /* 96D0 */ 124, 377, 188, 373, 40, 67, 317, 114, 346, 308, 107, 41, 377, 371, 132, 348,
+    /* 96E0 */ 40, 181, 173, 214, 360, 377, 132, 132, 373, 373, 360, 212, 91, 290, 210, 344,
+    /* 96F0 */ 87, 242, 376, 173, 38, 364, 180, 171, 3, 10, 347, 66, 60, 124, 347, 67,
+    /* 9700 */ 358, 132, 210, 36, 352, 386, 331, 392, 244, 198, 180, 256, 396, 131, 293, 86,
+    /* 9710 */ 122, 388, 368, 221, 397, 337, 179, 180, 71, 369, 347, 180, 308, 180, 349, 122,
+    /* 9720 */ 368, 193, 193, 376, 181, 200, 18, 347, 343, 164, 368, 348, 367, 2, 59, 326,
+    /* 9730 */ 350, 373, 185, 183, 58, 132, 242, 364, 6, 247, 343, 88, 348, 132, 193, 200,
+    /* 9740 */ 200, 171, 173, 131, 2, 86, 58, 183, 180, 2, 88, 173, 10, 117, 117, 117,
+    /* 9750 */ 19, 263, 263, 139, 328, 392, 139, 37, 263, 139, 139, 66, 139, 328, 86, 86,
+    /* 9760 */ 150, 201, 202, 202, 10, 366, 328, 129, 366, 98, 69, 30, 258, 274, 65, 73,
+    /* 9770 */ 347, 274, 262, 138, 360, 228, 6, 368, 285, 212, 208, 408, 57, 8, 367, 365,
+    /* 9780 */ 324, 11, 137, 122, 243, 364, 19, 368, 98, 324, 137, 353, 3, 3, 119, 102,
+    /* 9790 */ 257, 57, 260, 331, 194, 369, 317, 329, 260, 359, 155, 13, 320, 296, 19, 164,
+    /* 97A0 */ 142, 165, 353, 278, 9, 81, 265, 265, 117, 260, 210, 142, 134, 15, 65, 134,
+    /* 97B0 */ 344, 324, 103, 320, 11, 353, 241, 98, 14, 164, 323, 184, 109, 260, 360, 132,
+    /* 97C0 */ 134, 135, 32, 57, 124, 350, 258, 73, 339, 134, 167, 343, 274, 92, 198, 267,
+    /* 97D0 */ 98, 343, 260, 114, 33, 164, 278, 376, 298, 343, 98, 7, 324, 103, 376, 97,
+    /* 97E0 */ 14, 343, 317, 73, 339, 73, 343, 274, 92, 114, 343, 376, 324, 141, 141, 350,
+    /* 97F0 */ 353, 350, 132, 368, 377, 376, 297, 170, 246, 128, 369, 376, 246, 3, 368, 351,
+    /* 9800 */ 124, 366, 69, 263, 162, 351, 310, 114, 358, 367, 358, 78, 313, 162, 256, 115,
+    /* 9810 */ 373, 341, 8, 76, 65, 59, 241, 253, 180, 35, 139, 171, 117, 260, 78, 78,
+    /* 9820 */ 343, 353, 164, 300, 367, 367, 113, 75, 373, 252, 171, 92, 133, 333, 129, 162,
+    /* 9830 */ 133, 188, 331, 37, 369, 376, 124, 114, 139, 336, 336, 251, 166, 336, 405, 405,
+    /* 9840 */ 46, 69, 166, 322, 114, 258, 151, 54, 359, 262, 367, 286, 327, 78, 78, 363,
+    /* 9850 */ 344, 148, 371, 400, 363, 350, 354, 367, 374, 288, 66, 66, 135, 162, 171, 169,
+    /* 9860 */ 249, 340, 194, 52, 365, 116, 260, 104, 361, 363, 129, 32, 279, 200, 18, 350,
+    /* 9870 */ 251, 185, 167, 225, 267, 366, 69, 263, 114, 351, 310, 358, 358, 341, 104, 76,
+    /* 9880 */ 256, 8, 313, 115, 373, 185, 180, 253, 139, 137, 133, 331, 117, 369, 140, 151,
+    /* 9890 */ 367, 251, 129, 336, 114, 369, 369, 151, 327, 371, 78, 400, 363, 78, 225, 194,
+    /* 98A0 */ 66, 288, 116, 171, 32, 279, 251, 267, 88, 16, 105, 92, 349, 388, 16, 285,
+    /* 98B0 */ 6, 321, 178, 105, 359, 297, 142, 16, 312, 343, 364, 365, 314, 147, 314, 84,
+    /* 98C0 */ 181, 348, 181, 249, 249, 181, 16, 16, 16, 177, 16, 290, 88, 357, 88, 364,
+    /* 98D0 */ 388, 16, 285, 142, 312, 314, 365, 181, 249, 16, 16, 86, 84, 86, 86, 302,
+    /* 98E0 */ 302, 24, 132, 69, 312, 338, 388, 318, 351, 337, 274, 373, 143, 38, 368, 84,
+    /* 98F0 */ 84, 318, 368, 333, 367, 412, 14, 137, 324, 10, 49, 330, 312, 10, 302, 77,
+    /* 9900 */ 113, 274, 328, 136, 133, 19, 365, 332, 49, 351, 364, 143, 82, 363, 170, 348,
+    /* 9910 */ 24, 20, 218, 78, 21, 145, 72, 315, 373, 302, 365, 130, 111, 302, 134, 402,
+    /* 9920 */ 19, 350, 21, 366, 322, 86, 389, 343, 107, 78, 232, 376, 124, 128, 330, 129,
+    /* 9930 */ 134, 123, 2, 323, 87, 343, 104, 30, 313, 323, 20, 97, 348, 162, 181, 314,
+    /* 9940 */ 324, 366, 344, 208, 323, 194, 14, 373, 357, 138, 287, 162, 400, 295, 38, 59,
+    /* 9950 */ 367, 132, 272, 37, 371, 324, 343, 351, 388, 87, 113, 200, 363, 208, 32, 351,
+    /* 9960 */ 188, 379, 215, 302, 69, 132, 338, 323, 337, 348, 274, 373, 38, 84, 368, 134,
+    /* 9970 */ 302, 10, 312, 77, 367, 82, 272, 351, 117, 170, 136, 348, 19, 20, 72, 78,
+    /* 9980 */ 373, 218, 145, 111, 130, 350, 107, 30, 162, 104, 314, 32, 366, 208, 20, 181,
+    /* 9990 */ 357, 138, 194, 287, 400, 215, 303, 162, 111, 351, 87, 20, 221, 14, 20, 334,
+    /* 99A0 */ 114, 86, 134, 3, 2, 92, 350, 376, 354, 87, 251, 354, 192, 373, 88, 114,
+    /* 99B0 */ 65, 338, 391, 38, 361, 397, 394, 244, 354, 276, 285, 376, 344, 394, 59, 189,
+    /* 99C0 */ 372, 20, 10, 144, 338, 367, 266, 344, 266, 140, 253, 390, 374, 244, 396, 142,
+    /* 99D0 */ 397, 231, 142, 247, 380, 133, 180, 392, 321, 92, 364, 302, 14, 338, 338, 312,
+    /* 99E0 */ 181, 192, 248, 324, 394, 277, 326, 71, 361, 267, 300, 140, 82, 113, 20, 397,
+    /* 99F0 */ 368, 188, 396, 59, 113, 181, 142, 313, 262, 195, 168, 114, 334, 359, 336, 145,
+    /* 9A00 */ 78, 37, 355, 2, 185, 402, 396, 298, 248, 163, 324, 166, 406, 151, 256, 256,
+    /* 9A10 */ 363, 86, 289, 363, 98, 365, 347, 248, 50, 248, 258, 86, 128, 258, 131, 373,
+    /* 9A20 */ 327, 267, 349, 406, 162, 278, 312, 105, 338, 109, 314, 258, 37, 394, 181, 246,
+    /* 9A30 */ 326, 348, 26, 73, 363, 374, 407, 289, 295, 256, 394, 308, 185, 348, 188, 389,
+    /* 9A40 */ 208, 5, 24, 16, 50, 266, 14, 394, 373, 358, 125, 20, 315, 352, 179, 388,
+    /* 9A50 */ 76, 181, 338, 29, 66, 136, 330, 363, 188, 388, 139, 367, 366, 338, 251, 396,
+    /* 9A60 */ 363, 183, 189, 326, 351, 132, 308, 142, 348, 127, 173, 16, 192, 373, 338, 361,
+    /* 9A70 */ 38, 266, 276, 20, 189, 380, 302, 312, 92, 142, 407, 397, 338, 231, 133, 367,
+    /* 9A80 */ 58, 352, 192, 368, 136, 125, 188, 113, 248, 16, 173, 37, 363, 355, 262, 145,
+    /* 9A90 */ 256, 256, 151, 402, 406, 315, 24, 248, 394, 162, 289, 347, 5, 181, 258, 295,
+    /* 9AA0 */ 16, 188, 50, 32, 396, 132, 308, 351, 104, 343, 343, 343, 373, 95, 367, 4,
+    /* 9AB0 */ 333, 137, 10, 11, 49, 327, 65, 157, 113, 260, 123, 158, 98, 336, 101, 248,
+    /* 9AC0 */ 14, 151, 257, 373, 317, 184, 20, 352, 9, 20, 49, 160, 18, 208, 177, 184,
+    /* 9AD0 */ 352, 73, 380, 317, 327, 18, 160, 185, 97, 97, 260, 150, 260, 169, 289, 16,
+    /* 9AE0 */ 163, 163, 65, 85, 357, 270, 196, 59, 163, 18, 83, 329, 247, 405, 83, 270,
+    /* 9AF0 */ 327, 10, 14, 196, 92, 82, 277, 266, 102, 357, 164, 132, 246, 398, 297, 319,
+    /* 9B00 */ 327, 173, 18, 406, 65, 246, 313, 393, 267, 406, 310, 134, 338, 124, 165, 141,
+    /* 9B10 */ 256, 175, 392, 18, 246, 192, 287, 194, 194, 292, 358, 178, 258, 258, 215, 127,
+    /* 9B20 */ 164, 227, 18, 178, 271, 72, 72, 216, 122, 348, 72, 114, 72, 72, 141, 33,
+    /* 9B30 */ 373, 373, 98, 363, 92, 262, 109, 406, 181, 109, 296, 373, 109, 198, 132, 256,
+    /* 9B40 */ 93, 162, 130, 6, 253, 198, 358, 363, 352, 176, 373, 336, 256, 342, 176, 343,
+    /* 9B50 */ 95, 38, 249, 14, 208, 132, 358, 40, 363, 388, 373, 61, 274, 137, 6, 122,
+    /* 9B60 */ 338, 67, 132, 358, 78, 78, 293, 115, 337, 208, 137, 300, 8, 374, 247, 185,
+    /* 9B70 */ 344, 124, 185, 377, 85, 87, 212, 372, 248, 208, 117, 349, 266, 114, 247, 180,
+    /* 9B80 */ 338, 20, 265, 252, 92, 14, 49, 343, 142, 67, 6, 372, 110, 247, 222, 355,
+    /* 9B90 */ 321, 10, 92, 386, 142, 104, 302, 71, 58, 320, 137, 304, 123, 351, 82, 3,
+    /* 9BA0 */ 343, 390, 397, 368, 178, 188, 332, 327, 367, 19, 343, 136, 157, 109, 350, 98,
+    /* 9BB0 */ 129, 169, 92, 150, 357, 77, 145, 327, 202, 297, 386, 319, 262, 373, 218, 391,
+    /* 9BC0 */ 110, 101, 315, 347, 265, 295, 255, 127, 329, 173, 293, 293, 150, 200, 37, 173,
+    /* 9BD0 */ 407, 348, 371, 300, 405, 256, 393, 351, 218, 47, 132, 67, 261, 104, 396, 71,
+    /* 9BE0 */ 166, 86, 221, 367, 163, 185, 141, 33, 139, 187, 180, 407, 173, 200, 406, 394,
+    /* 9BF0 */ 222, 124, 373, 65, 302, 300, 127, 327, 123, 355, 397, 165, 406, 383, 15, 15,
+    /* 9C00 */ 127, 267, 383, 343, 343, 373, 47, 278, 68, 128, 175, 363, 265, 265, 134, 14,
+    /* 9C10 */ 78, 364, 92, 286, 95, 349, 338, 124, 302, 284, 359, 344, 258, 116, 347, 85,
+    /* 9C20 */ 289, 181, 192, 302, 302, 107, 405, 326, 320, 365, 78, 371, 258, 256, 344, 284,
+    /* 9C30 */ 300, 175, 5, 170, 129, 205, 132, 329, 266, 134, 300, 194, 348, 265, 16, 132,
+    /* 9C40 */ 132, 397, 135, 357, 400, 371, 389, 149, 360, 17, 373, 266, 351, 20, 136, 361,
+    /* 9C50 */ 315, 128, 411, 295, 295, 84, 109, 179, 361, 203, 348, 385, 351, 87, 107, 123,
+    /* 9C60 */ 159, 383, 289, 388, 95, 109, 369, 173, 33, 171, 304, 2, 279, 132, 358, 124,
+    /* 9C70 */ 304, 173, 178, 173, 204, 392, 351, 78, 185, 107, 173, 350, 373, 61, 132, 372,
+    /* 9C80 */ 337, 185, 85, 6, 117, 6, 252, 222, 185, 372, 386, 92, 6, 10, 123, 247,
+    /* 9C90 */ 321, 109, 137, 150, 343, 82, 332, 383, 123, 159, 132, 136, 350, 386, 351, 361,
+    /* 9CA0 */ 101, 173, 175, 134, 173, 302, 329, 110, 293, 127, 145, 132, 371, 263, 180, 256,
+    /* 9CB0 */ 407, 86, 163, 33, 104, 221, 222, 67, 139, 300, 302, 405, 87, 68, 14, 33,
+    /* 9CC0 */ 327, 344, 343, 286, 78, 265, 92, 128, 267, 135, 15, 289, 5, 256, 320, 107,
+    /* 9CD0 */ 365, 242, 134, 170, 16, 360, 17, 194, 205, 371, 343, 348, 109, 295, 179, 411,
+    /* 9CE0 */ 124, 95, 173, 388, 107, 224, 367, 92, 173, 141, 21, 363, 92, 67, 132, 88,
+    /* 9CF0 */ 279, 95, 302, 88, 206, 10, 374, 394, 124, 262, 92, 8, 344, 134, 302, 373,
+    /* 9D00 */ 91, 365, 144, 144, 247, 127, 392, 10, 363, 362, 393, 85, 88, 344, 238, 58,
+    /* 9D10 */ 98, 279, 180, 204, 92, 338, 205, 173, 15, 394, 98, 374, 49, 266, 352, 38,
+    /* 9D20 */ 59, 142, 365, 104, 395, 373, 364, 373, 362, 330, 373, 328, 369, 75, 347, 82,
+    /* 9D30 */ 105, 2, 394, 363, 120, 352, 133, 178, 397, 364, 327, 122, 188, 279, 209, 98,
+    /* 9D40 */ 274, 136, 357, 396, 38, 188, 120, 222, 78, 186, 133, 132, 334, 127, 338, 21,
+    /* 9D50 */ 347, 143, 373, 20, 145, 145, 14, 348, 145, 142, 334, 139, 327, 78, 78, 161,
+    /* 9D60 */ 124, 347, 300, 166, 136, 241, 185, 247, 304, 92, 3, 404, 246, 262, 258, 11,
+    /* 9D70 */ 67, 185, 268, 134, 142, 334, 362, 374, 256, 173, 366, 402, 155, 77, 163, 301,
+    /* 9D80 */ 256, 139, 367, 367, 139, 405, 166, 71, 256, 47, 101, 142, 144, 367, 411, 132,
+    /* 9D90 */ 304, 369, 38, 203, 278, 3, 265, 327, 124, 327, 78, 137, 196, 92, 47, 334,
+    /* 9DA0 */ 363, 117, 374, 248, 163, 198, 124, 369, 44, 347, 142, 71, 25, 85, 117, 369,
+    /* 9DB0 */ 374, 350, 345, 302, 117, 41, 323, 349, 284, 181, 132, 104, 134, 318, 114, 49,
+    /* 9DC0 */ 49, 367, 365, 363, 132, 173, 328, 156, 327, 327, 367, 334, 192, 352, 97, 328,
+    /* 9DD0 */ 36, 132, 335, 391, 5, 365, 367, 238, 38, 394, 181, 371, 189, 14, 308, 404,
+    /* 9DE0 */ 373, 347, 144, 368, 327, 312, 136, 367, 125, 14, 369, 315, 128, 84, 136, 177,
+    /* 9DF0 */ 363, 97, 141, 350, 350, 334, 193, 411, 373, 369, 185, 335, 350, 360, 367, 247,
+    /* 9E00 */ 304, 188, 348, 367, 132, 382, 373, 388, 366, 364, 247, 227, 124, 201, 369, 200,
+    /* 9E10 */ 65, 375, 373, 171, 21, 185, 117, 183, 308, 375, 369, 107, 266, 173, 186, 224,
+    /* 9E20 */ 141, 132, 374, 206, 302, 238, 362, 25, 10, 392, 104, 71, 185, 362, 352, 364,
+    /* 9E30 */ 180, 38, 266, 374, 360, 338, 312, 394, 82, 105, 357, 120, 396, 98, 186, 122,
+    /* 9E40 */ 347, 20, 173, 143, 104, 78, 373, 350, 327, 347, 268, 203, 3, 163, 11, 246,
+    /* 9E50 */ 258, 47, 101, 374, 315, 124, 117, 78, 104, 265, 49, 198, 347, 367, 365, 345,
+    /* 9E60 */ 181, 132, 367, 134, 117, 367, 369, 391, 181, 177, 136, 141, 373, 185, 127, 388,
+    /* 9E70 */ 369, 124, 200, 107, 308, 185, 138, 180, 134, 350, 56, 134, 134, 363, 56, 185,
+    /* 9E80 */ 372, 52, 132, 243, 52, 243, 397, 145, 397, 134, 201, 201, 373, 181, 36, 145,
+    /* 9E90 */ 179, 221, 256, 185, 141, 145, 139, 173, 351, 350, 133, 201, 173, 298, 389, 179,
+    /* 9EA0 */ 139, 256, 180, 363, 52, 193, 193, 117, 34, 92, 202, 202, 92, 243, 266, 266,
+    /* 9EB0 */ 209, 92, 350, 166, 266, 202, 38, 88, 92, 266, 202, 192, 197, 208, 129, 208,
+    /* 9EC0 */ 407, 233, 87, 128, 128, 138, 108, 328, 333, 122, 125, 161, 122, 304, 173, 222,
+    /* 9ED0 */ 38, 118, 118, 367, 258, 59, 348, 337, 208, 208, 258, 58, 41, 372, 66, 367,
+    /* 9EE0 */ 349, 363, 266, 198, 363, 263, 375, 173, 60, 73, 24, 363, 363, 363, 59, 3,
+    /* 9EF0 */ 392, 58, 24, 367, 198, 388, 363, 73, 185, 394, 87, 92, 92, 202, 202, 374,
+    /* 9F00 */ 52, 266, 34, 339, 397, 394, 200, 5, 17, 338, 14, 374, 34, 338, 69, 201,
+    /* 9F10 */ 213, 69, 405, 104, 104, 71, 87, 324, 374, 247, 33, 97, 256, 374, 323, 326,
+    /* 9F20 */ 304, 304, 87, 86, 344, 6, 67, 338, 395, 266, 301, 302, 372, 302, 331, 347,
+    /* 9F30 */ 142, 139, 130, 142, 363, 334, 312, 348, 350, 363, 171, 14, 365, 265, 114, 347,
+    /* 9F40 */ 347, 123, 353, 78, 386, 357, 345, 386, 229, 215, 256, 387, 132, 405, 132, 132,
+    /* 9F50 */ 256, 132, 38, 36, 36, 117, 362, 368, 353, 10, 382, 353, 31, 38, 363, 142,
+    /* 9F60 */ 329, 180, 180, 41, 267, 353, 153, 225, 141, 365, 48, 376, 373, 41, 367, 221,
+    /* 9F70 */ 382, 407, 266, 376, 363, 238, 78, 346, 367, 49, 407, 66, 41, 138, 362, 38,
+    /* 9F80 */ 36, 117, 368, 142, 180, 10, 329, 405, 153, 373, 48, 266, 346, 183, 242, 102,
+    /* 9F90 */ 242, 363, 183, 183, 102, 148, 57, 180, 57, 183, 102, 148, 109, 265, 17, 109,
+    /* 9FA0 */ 375, 46, 117, 144, 353, 373,
+};
+
+struct Alternate {
+    uint16_t codepoint;
+    uint16_t syllable;
+};
+
+// Further readings of polyphones common in place names (重庆 chong, 厦门 xia, 长沙 chang, ...), sorted by codepoint
+const Alternate kAlternates[] = {
+    { 0x4E07, 208 }, // 万 mo
+    { 0x4E50, 375 }, // 乐 yue
+    { 0x4E58, 301 }, // 乘 sheng
+    { 0x4EC0, 302 }, // 什 shi
+    { 0x4EC7, 265 }, // 仇 qiu
+    { 0x4F1A, 159 }, // 会 kuai
+    { 0x4F3C, 312 }, // 似 si
+    { 0x4F5B, 90 }, // 佛 fo
+    { 0x4FBF, 248 }, // 便 pian
+    { 0x516D, 185 }, // 六 lu
+    { 0x533A, 238 }, // 区 ou
+    { 0x5355, 295 }, // 单 shan
+    { 0x53A6, 349 }, // 厦 xia
+    { 0x53E5, 103 }, // 句 gou
+    { 0x5408, 98 }, // 合 ge
+    { 0x5708, 143 }, // 圈 juan
+    { 0x5821, 21 }, // 堡 bu
+    { 0x5821, 255 }, // 堡 pu
+    { 0x5927, 58 }, // 大 dai
+    { 0x5947, 132 }, // 奇 ji
+    { 0x5BBF, 357 }, // 宿 xiu
+    { 0x5C09, 373 }, // 尉 yu
+    { 0x5C3E, 367 }, // 尾 yi
+    { 0x5C5E, 397 }, // 属 zhu
+    { 0x5DF7, 115 }, // 巷 hang
+    { 0x5F04, 183 }, // 弄 long
+    { 0x66FE, 385 }, // 曾 zeng
+    { 0x671D, 390 }, // 朝 zhao
+    { 0x679E, 406 }, // 枞 zong
+    { 0x67CF, 20 }, // 柏 bo
+    { 0x67E5, 386 }, // 查 zha
+    { 0x680E, 375 }, // 栎 yue
+    { 0x6B59, 348 }, // 歙 xi
+    { 0x6C64, 296 }, // 汤 shang
+    { 0x6C93, 320 }, // 沓 ta
+    { 0x6CCC, 14 }, // 泌 bi
+    { 0x6D1E, 332 }, // 洞 tong
+    { 0x6D5A, 361 }, // 浚 xun
+    { 0x6DA1, 111 }, // 涡 guo
+    { 0x7011, 10 }, // 瀑 bao
+    { 0x725F, 210 }, // 牟 mu
+    { 0x728D, 258 }, // 犍 qian
+    { 0x7387, 306 }, // 率 shuai
+    { 0x756A, 241 }, // 番 pan
+    { 0x76D6, 98 }, // 盖 ge
+    { 0x76DB, 37 }, // 盛 cheng
+    { 0x7701, 355 }, // 省 xing
+    { 0x7740, 390 }, // 着 zhao
+    { 0x7740, 404 }, // 着 zhuo
+    { 0x77F3, 59 }, // 石 dan
+    { 0x79D8, 14 }, // 秘 bi
+    { 0x7B60, 145 }, // 筠 jun
+    { 0x7CFB, 132 }, // 系 ji
+    { 0x7E41, 253 }, // 繁 po
+    { 0x8365, 369 }, // 荥 ying
+    { 0x839E, 341 }, // 莞 wan
+    { 0x851A, 373 }, // 蔚 yu
+    { 0x85CF, 380 }, // 藏 zang
+    { 0x868C, 13 }, // 蚌 beng
+    { 0x8840, 353 }, // 血 xie
+    { 0x884C, 115 }, // 行 hang
+    { 0x89E3, 353 }, // 解 xie
+    { 0x8F66, 142 }, // 车 ju
+    { 0x90FD, 73 }, // 都 du
+    { 0x91CD, 39 }, // 重 chong
+    { 0x94C5, 363 }, // 铅 yan
+    { 0x957F, 33 }, // 长 chang
+    { 0x963F, 78 }, // 阿 e
+    { 0x9646, 181 }, // 陆 liu
+    { 0x964D, 351 }, // 降 xiang
+    { 0x9732, 184 }, // 露 lou
+};
+
+} // namespace
+
+bool Pinyin::IsHan(uint32_t codepoint) {
+    return codepoint >= kFirstHan && codepoint <= kLastHan;
+}
+
+int Pinyin::Readings(uint32_t codepoint, const char** readings, int max) {
+    if (!IsHan(codepoint) || max <= 0) return 0;
+    const uint16_t primary = kReadings[codepoint - kFirstHan];
+    if (primary == 0) return 0;
+    int count = 0;
+    readings[count++] = kSyllables[primary];
+
+    const Alternate* end = kAlternates + sizeof(kAlternates) / sizeof(kAlternates[0]);
+    const Alternate* it = std::lower_bound(kAlternates, end, codepoint,
+        [](const Alternate& a, uint32_t cp) { return a.codepoint < cp; });
+    for (; it != end && it->codepoint == codepoint && count < max; ++it) {
+        readings[count++] = kSyllables[it->syllable];
+    }
+    return count;
+}
@@ -0,0 +1,20 @@
+// ====================================================================================
+// 模块名称: Pinyin (汉字拼音表)
+// 功能描述:
+//   常用汉字区 (CJK 统一汉字 U+4E00 - U+9FA5) 的无声调拼音，供地区名称的拼音/首字母搜索使用。
+//   ü 按输入法习惯写作 v (吕 = lv)；多音字先给出常用读音，再给出地名中出现的其他读音。
+// ====================================================================================
+
+#pragma once
+
+#include <cstdint>
+
+namespace Pinyin {
+
+bool IsHan(uint32_t codepoint);
+
+// Writes up to max lowercase syllables (static strings) for the character, the common one first.
+// Returns 0 for characters outside the table or without a known reading
+int Readings(uint32_t codepoint, const char** readings, int max);
+
+} // namespace Pinyin
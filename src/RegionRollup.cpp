@@ -0,0 +1,239 @@
+// ====================================================================================
+// 模块名称: RegionRollup Implementation
+// 功能描述:
+//   分组汇总的逐个地区重新相加 (对照)，以及层级汇总的基准测试。
+// ====================================================================================
+
+#include "RegionRollup.h"
+#include <algorithm>  // For std::min, std::max
+#include <chrono>
+#include <climits>    // For INT_MAX, INT_MIN
+#include <cstdio>     // For std::snprintf
+#include <cstring>    // For strncmp
+#include <random>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double MillisSince(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+bool UnderPath(const char* name, const std::string& path) {
+    if (path.empty()) return true;
+    return strncmp(name, path.c_str(), path.size()) == 0 && name[path.size()] == RegionTree::Separator;
+}
+
+void SetName(char* name, size_t size, int province, int city, size_t district) {
+    std::snprintf(name, size, "省%02d/市%02d-%02d/区%06zu", province, province, city, district);
+}
+
+} // namespace
+
+// --- Recomputation ---
+
+RollupCounts RegionRollup::RecomputeTotals(const std::vector<Region>& regions, const std::string& path) {
+    RollupCounts totals;
+    for (const Region& r : regions) {
+        if (!UnderPath(r.name, path)) continue;
+        totals.population += r.getPopulation();
+        totals.confirmed += r.getConfirmedCases();
+        totals.recovered += r.getRecoveredCases();
+        totals.deaths += r.getDeaths();
+    }
+    return totals;
+}
+
+// [算法] 逐日重新相加 (对照)
+// 逻辑: 每个路径匹配的地区把每条记录的数值加到 [记录日, 下一条记录日) 的每一天，最后一条延续到末日。
+void RegionRollup::RecomputeHistory(const std::vector<Region>& regions, const std::string& path, std::vector<RollupDay>& out) {
+    out.clear();
+    int firstDay = INT_MAX, lastDay = INT_MIN;
+    for (const Region& r : regions) {
+        if (r.history.empty() || !UnderPath(r.name, path)) continue;
+        firstDay = std::min(firstDay, r.history.front().day);
+        lastDay = std::max(lastDay, r.history.back().day);
+    }
+    if (firstDay > lastDay) return;
+
+    out.resize(static_cast<size_t>(lastDay - firstDay) + 1);
+    for (size_t i = 0; i < out.size(); ++i) out[i] = { firstDay + static_cast<int>(i), 0, 0, 0 };
+    for (const Region& r : regions) {
+        if (r.history.empty() || !UnderPath(r.name, path)) continue;
+        for (size_t k = 0; k < r.history.size(); ++k) {
+            const HistoricalRecord& record = r.history[k];
+            const int until = k + 1 < r.history.size() ? r.history[k + 1].day : lastDay + 1;
+            for (int d = record.day; d < until; ++d) {
+                RollupDay& day = out[d - firstDay];
+                day.confirmed += record.confirmed;
+                day.recovered += record.recovered;
+                day.deaths += record.deaths;
+            }
+        }
+    }
+}
+
+bool RegionRollup::SameHistory(const std::vector<RollupDay>& a, const std::vector<RollupDay>& b) {
+    // Both are dense and ascending; before its first day a series is zero, after its last it carries on
+    if (a.empty() || b.empty()) {
+        const std::vector<RollupDay>& rest = a.empty() ? b : a;
+        for (const RollupDay& d : rest) {
+            if (d.confirmed != 0 || d.recovered != 0 || d.deaths != 0) return false;
+        }
+        return true;
+    }
+    const int firstDay = std::min(a.front().day, b.front().day);
+    const int lastDay = std::max(a.back().day, b.back().day);
+    auto at = [](const std::vector<RollupDay>& s, int day) {
+        if (day < s.front().day) return RollupDay{ day, 0, 0, 0 };
+        if (day > s.back().day) return s.back();
+        return s[day - s.front().day];
+    };
+    for (int day = firstDay; day <= lastDay; ++day) {
+        const RollupDay x = at(a, day), y = at(b, day);
+        if (x.confirmed != y.confirmed || x.recovered != y.recovered || x.deaths != y.deaths) return false;
+    }
+    return true;
+}
+
+// --- Benchmark ---
+
+// [算法] 增量汇总与重新相加的对比
+// 逻辑:
+//   生成 34 个省、每省 10 个市、其余为区县的地区，每个区县 20 条左右的逐日记录 (批量载入，结束时整体重建)。
+//   然后通过 EpidemicData 的编辑接口做随机的记录增删改、人口修改与跨市改名 (汇总随之增量更新)，
+//   与每次都重新相加全国/一个省的用时对比；增删地区时持有一个快照 (删除会把历史移交给快照)；
+//   最后抽查全国、各省和部分市的汇总与重新相加的结果一致。
+RegionRollupBenchmarkResult RegionRollup::RunBenchmark(size_t regions) {
+    RegionRollupBenchmarkResult result;
+    result.regions = regions;
+    const int provinces = 34, cities = 10, days = 80;
+
+    EpidemicData data;
+    std::mt19937 rng(23);
+    std::uniform_int_distribution<int> populationDist(20000, 2000000);
+    std::uniform_int_distribution<int> startDist(0, days / 2);
+    std::uniform_int_distribution<int> growthDist(0, 40);
+    char name[64];
+    data.beginBulkUpdate();
+    data.reserveRegions(regions);
+    for (size_t i = 0; i < regions; ++i) {
+        SetName(name, sizeof(name), static_cast<int>(i % provinces), static_cast<int>(i / provinces % cities), i);
+        data.addRegion(name, populationDist(rng), 0, 0, 0);
+        HistorySeries& history = data.getMutableHistory(static_cast<int>(i));
+        int confirmed = 0, recovered = 0, deaths = 0;
+        for (int day = startDist(rng); day < days; day += 2) {
+            confirmed += growthDist(rng);
+            recovered = confirmed / 2;
+            deaths = confirmed / 40;
+            history.push_back({ day, confirmed, recovered, deaths });
+        }
+        data.setRegionCounts(static_cast<int>(i), confirmed, recovered, deaths);
+        result.records += history.size();
+    }
+    data.endBulkUpdate();
+
+    // The bulk end above already rolled everything up; time one more whole rebuild on its own
+    const std::vector<Region>& rows = data.getRegions();
+    {
+        RegionTree tree;
+        const auto t0 = Clock::now();
+        tree.rebuild(rows);
+        result.rebuildMs = MillisSince(t0);
+    }
+    const RegionTree& tree = data.getTree();
+    result.groups = tree.getGroupCount();
+
+    // Random edits through the data model
+    std::uniform_int_distribution<int> dayDist(0, days + 10);
+    std::uniform_int_distribution<int> kindDist(0, 9);
+    const int edits = 20000;
+    auto t0 = Clock::now();
+    for (int e = 0; e < edits; ++e) {
+        const int index = static_cast<int>(rng() % rows.size());
+        const int kind = kindDist(rng);
+        if (kind < 6) {
+            const int confirmed = growthDist(rng) * 50;
+            data.upsertHistoryRecord(index, { dayDist(rng), confirmed, confirmed / 2, confirmed / 40 });
+        } else if (kind < 8) {
+            const HistorySeries& history = rows[index].history;
+            if (!history.empty()) data.deleteHistoryRecord(index, history[rng() % history.size()].day);
+        } else {
+            data.setRegionPopulation(index, populationDist(rng));
+        }
+    }
+    result.editUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / edits;
+    result.edits = edits;
+
+    const int renames = 500;
+    t0 = Clock::now();
+    for (int e = 0; e < renames; ++e) {
+        const int index = static_cast<int>(rng() % rows.size());
+        SetName(name, sizeof(name), static_cast<int>(rng() % provinces), static_cast<int>(rng() % cities), regions + e);
+        data.renameRegion(index, name);
+    }
+    result.renameUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / renames;
+
+    // Some regions leave and arrive as well (untimed, exercises the delete bookkeeping), while a snapshot
+    // is live as during a session save: deletes hand the history over to it and must still be subtracted
+    std::shared_ptr<DataSnapshot> snapshot = data.captureSnapshot();
+    for (int e = 0; e < 200; ++e) {
+        if (e % 2 == 0) {
+            data.deleteRegion(static_cast<int>(rng() % rows.size()));
+        } else {
+            SetName(name, sizeof(name), static_cast<int>(rng() % provinces), static_cast<int>(rng() % cities), regions + renames + e);
+            data.addRegion(name, populationDist(rng), 0, 0, 0);
+            data.upsertHistoryRecord(static_cast<int>(rows.size()) - 1, { dayDist(rng), 500, 100, 5 });
+        }
+    }
+    snapshot.reset();
+
+    std::vector<RollupDay> fromTree, recomputed;
+    const int queries = 100;
+    t0 = Clock::now();
+    long long sink = 0;
+    for (int q = 0; q < queries; ++q) {
+        sink += tree.getGroup(RegionTree::Root).totals.confirmed;
+        tree.getHistory(RegionTree::Root, fromTree);
+    }
+    result.rootQueryUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / queries;
+
+    t0 = Clock::now();
+    RegionRollup::RecomputeTotals(rows, std::string());
+    RegionRollup::RecomputeHistory(rows, std::string(), recomputed);
+    result.recomputeRootMs = MillisSince(t0);
+    SetName(name, sizeof(name), 3, 0, 0);
+    const std::string province = RegionTree::ParentPath(RegionTree::ParentPath(name).c_str());
+    t0 = Clock::now();
+    RegionRollup::RecomputeTotals(rows, province);
+    RegionRollup::RecomputeHistory(rows, province, recomputed);
+    result.recomputeProvinceMs = MillisSince(t0);
+
+    // Check the root, every province and the first city of each against their recomputed sums
+    std::vector<std::string> paths(1);
+    for (int p = 0; p < provinces; ++p) {
+        SetName(name, sizeof(name), p, 0, 0);
+        const std::string city = RegionTree::ParentPath(name);
+        paths.push_back(RegionTree::ParentPath(city.c_str()));
+        paths.push_back(city);
+    }
+    bool verified = sink == queries * tree.getGroup(RegionTree::Root).totals.confirmed;
+    for (const std::string& path : paths) {
+        const int group = tree.findGroup(path);
+        if (group < 0) {
+            verified = verified && RegionRollup::RecomputeTotals(rows, path).population == 0;
+            continue;
+        }
+        const RollupCounts expected = RegionRollup::RecomputeTotals(rows, path);
+        const RollupCounts& totals = tree.getGroup(group).totals;
+        verified = verified && totals.population == expected.population && totals.confirmed == expected.confirmed &&
+                   totals.recovered == expected.recovered && totals.deaths == expected.deaths;
+        tree.getHistory(group, fromTree);
+        RegionRollup::RecomputeHistory(rows, path, recomputed);
+        verified = verified && RegionRollup::SameHistory(fromTree, recomputed);
+    }
+    result.verified = verified;
+    result.valid = true;
+    return result;
+}
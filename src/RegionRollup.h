@@ -0,0 +1,46 @@
+// ====================================================================================
+// 模块名称: RegionRollup (地区层级汇总)
+// 功能描述:
+//   EpidemicData::getTree() 按名称路径 (国家/省/市/区县) 把地区组织成分组，并在每次编辑时
+//   只更新被编辑地区的 O(深度) 个祖先分组的汇总。本模块提供:
+//     逐个地区重新相加的分组汇总 (对照与校验)
+//     基准测试: 十万个区县级地区上的整体重建、单次编辑的增量维护与逐个重新相加的对比
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <string>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] RegionRollupBenchmarkResult
+// 描述: 增量汇总与重新相加的对比 (编辑用时为多次随机编辑的平均值)
+// ------------------------------------------------------------------------------------
+struct RegionRollupBenchmarkResult {
+    bool valid = false;
+    size_t regions = 0;                 // Leaves (district level)
+    size_t groups = 0;                  // Country, provinces and cities
+    size_t records = 0;
+    double rebuildMs = 0;               // Whole tree from the regions (after a bulk load)
+    double editUs = 0;                  // One record upsert / delete or population change, including the rollups
+    double renameUs = 0;                // Moving a region to another city
+    double rootQueryUs = 0;             // Totals and daily history of the whole country from the tree
+    double recomputeRootMs = 0;         // The same by summing every region
+    double recomputeProvinceMs = 0;     // One province by summing every region (prefix match over all names)
+    size_t edits = 0;
+    bool verified = false;              // After the edits, sampled groups equal their recomputed sums
+};
+
+namespace RegionRollup {
+
+// Sums of the regions under path (every region when path is empty), recomputed from the regions
+RollupCounts RecomputeTotals(const std::vector<Region>& regions, const std::string& path);
+void RecomputeHistory(const std::vector<Region>& regions, const std::string& path, std::vector<RollupDay>& out);
+// Same carried-forward values on every day (ranges may differ by days on which nothing changes)
+bool SameHistory(const std::vector<RollupDay>& a, const std::vector<RollupDay>& b);
+
+// Synthetic province/city/district regions, built and edited on the calling thread
+RegionRollupBenchmarkResult RunBenchmark(size_t regions);
+
+} // namespace RegionRollup
@@ -0,0 +1,47 @@
+// ====================================================================================
+// 模块名称: RegionScan (地区表扫描)
+// 功能描述:
+//   汇总与风险等级筛选的扫描内核 (总览页读取 EpidemicData 增量维护的汇总，这里的汇总内核用于对照与校验)。
+//   每个内核都有两种版本:
+//     列式  读 EpidemicData::getColumns() 的四列连续 int32 (界面每帧使用)
+//     行式  逐个读 std::vector<Region> (对照: 每个地区一个数百字节的对象，只用其中 16 字节)
+//   以及比较两者 (和按缓存的风险等级链表筛选) 的基准测试 (默认 100 万个地区)。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <cstdint>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] RegionScanBenchmarkResult
+// 描述: 行式与列式扫描的对比 (每项为多次重复中的最短用时)
+// ------------------------------------------------------------------------------------
+struct RegionScanBenchmarkResult {
+    bool valid = false;
+    size_t regions = 0;
+    size_t regionBytes = 0;             // sizeof(Region)
+    size_t columnBytes = 0;             // Bytes per region in the hot columns
+    double rowTotalsMs = 0;
+    double columnTotalsMs = 0;
+    double rowFilterMs = 0;             // High-risk filter
+    double columnFilterMs = 0;
+    double bucketFilterMs = 0;          // Walking the cached high-risk bucket (no classification)
+    size_t matches = 0;
+    bool verified = false;              // Both layouts, the maintained totals and the bucket agree
+};
+
+namespace RegionScan {
+
+RegionTotals Totals(const RegionColumns& columns);
+RegionTotals Totals(const std::vector<Region>& regions);
+
+// Appends the indices of regions at the given risk level (same rule as EpidemicData::calculateRiskLevel)
+void FilterByRisk(const RegionColumns& columns, RiskLevel level, std::vector<uint32_t>& out);
+void FilterByRisk(const std::vector<Region>& regions, RiskLevel level, std::vector<uint32_t>& out);
+
+// Synthetic regions, both layouts timed on the calling thread (the UI runs it through BackgroundBenchmark)
+RegionScanBenchmarkResult RunBenchmark(size_t regions);
+
+} // namespace RegionScan
@@ -0,0 +1,491 @@
+// ====================================================================================
+// 模块名称: RegionSearch Implementation
+// 功能描述:
+//   可搜索文本的生成 (名称 + 拼音展开)、n-gram 倒排索引的增量维护与查询，以及基准测试。
+// ====================================================================================
+
+#include "RegionSearch.h"
+#include "Pinyin.h"
+#include "ThreadPool.h"
+#include <algorithm>  // For std::lower_bound, std::upper_bound, std::sort, std::min
+#include <chrono>
+#include <cstring>    // For std::strlen, std::strstr
+#include <random>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const char kSeparator = '\x1f';
+const int kMaxGram = 3;
+
+// ASCII letters fold to lowercase; other bytes (including UTF-8 sequences) are kept
+std::string Fold(const char* s) {
+    std::string out(s);
+    for (char& c : out) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    return out;
+}
+
+// Decodes one UTF-8 character. Malformed bytes decode as themselves, the same way in names and queries
+uint32_t NextCodepoint(const unsigned char*& p, const unsigned char* end) {
+    const uint32_t lead = *p++;
+    const int extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+    if (extra == 0 || end - p < extra) return lead;
+    uint32_t cp = lead & (0x3Fu >> extra);
+    for (int i = 0; i < extra; ++i) {
+        if ((p[i] & 0xC0) != 0x80) return lead;
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    p += extra;
+    return cp;
+}
+
+void Decode(const char* s, size_t length, std::vector<uint32_t>& out) {
+    out.clear();
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+    const unsigned char* end = p + length;
+    while (p < end) out.push_back(NextCodepoint(p, end));
+}
+
+// Up to three 21-bit code points packed into one key; shorter grams leave the high fields zero
+inline uint64_t Gram(const uint32_t* c, int n) {
+    uint64_t g = c[0];
+    if (n > 1) g |= static_cast<uint64_t>(c[1]) << 21;
+    if (n > 2) g |= static_cast<uint64_t>(c[2]) << 42;
+    return g;
+}
+
+// Distinct n-grams (n = 1..3) of every separator-delimited piece of a searchable text
+void CollectGrams(const std::string& text, std::vector<uint64_t>& grams) {
+    grams.clear();
+    std::vector<uint32_t> cps;
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        size_t end = text.find(kSeparator, begin);
+        if (end == std::string::npos) end = text.size();
+        Decode(text.data() + begin, end - begin, cps);
+        for (size_t i = 0; i < cps.size(); ++i) {
+            for (int n = 1; n <= kMaxGram && i + n <= cps.size(); ++n) grams.push_back(Gram(&cps[i], n));
+        }
+        begin = end + 1;
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+}
+
+// Keeps the candidates that also appear in list (both ascending). The cursor gallops forward
+// (1, 2, 4, ... entries) before a binary search, so a short candidate list skips most of a long one
+void IntersectInPlace(std::vector<uint32_t>& candidates, const std::vector<uint32_t>& list) {
+    const uint32_t* pos = list.data();
+    const uint32_t* end = pos + list.size();
+    size_t kept = 0;
+    for (uint32_t index : candidates) {
+        size_t step = 1;
+        const uint32_t* probe = pos;
+        while (probe < end && *probe < index) {
+            pos = probe + 1;
+            probe = pos + step < end ? pos + step : end;
+            step *= 2;
+        }
+        pos = std::lower_bound(pos, probe, index);
+        if (pos == end) break;
+        if (*pos == index) candidates[kept++] = index;
+    }
+    candidates.resize(kept);
+}
+
+} // namespace
+
+// --- Searchable text ---
+
+// [算法] 拼音展开
+// 逻辑:
+//   名称中的每个汉字取其全部读音 (常用读音在前)，英文字母与数字保留原样，其余字符跳过。
+//   读音组合按混合进制计数依次枚举，至多 MaxVariants 种；每种组合生成全拼与首字母两段，
+//   含 v 的读音 (吕 lv) 另生成一段写作 u 的全拼，两种输入习惯都能匹配。
+std::string RegionSearchIndex::SearchText(const char* name) {
+    std::string text = Fold(name);
+
+    struct Choice {
+        const char* readings[4];
+        int count;
+        char ascii;                     // Letter or digit kept as is when count == 0
+    };
+    std::vector<Choice> choices;
+    std::vector<uint32_t> cps;
+    Decode(text.data(), text.size(), cps);
+    bool hasHan = false;
+    for (uint32_t c : cps) {
+        Choice choice;
+        choice.count = Pinyin::Readings(c, choice.readings, 4);
+        choice.ascii = 0;
+        if (choice.count > 0) {
+            hasHan = true;
+        } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+            choice.ascii = static_cast<char>(c);
+        } else {
+            continue;
+        }
+        choices.push_back(choice);
+    }
+    if (!hasHan) return text;
+
+    int variants = 1;
+    for (const Choice& choice : choices) {
+        if (choice.count > 1) variants = std::min(variants * choice.count, MaxVariants);
+    }
+    std::string full, fullU, initials;
+    for (int v = 0; v < variants; ++v) {
+        full.clear();
+        fullU.clear();
+        initials.clear();
+        int rest = v;
+        for (const Choice& choice : choices) {
+            if (choice.count == 0) {
+                full += choice.ascii;
+                fullU += choice.ascii;
+                continue;
+            }
+            const char* syllable = choice.readings[rest % choice.count];
+            rest /= choice.count;
+            full += syllable;
+            for (const char* s = syllable; *s; ++s) fullU += *s == 'v' ? 'u' : *s;
+            initials += syllable[0];
+        }
+        text += kSeparator;
+        text += full;
+        if (fullU != full) {
+            text += kSeparator;
+            text += fullU;
+        }
+        text += kSeparator;
+        text += initials;
+    }
+    return text;
+}
+
+// --- Index maintenance ---
+
+RegionSearchIndex::RegionSearchIndex() : target(nullptr), postingCount(0) {}
+
+RegionSearchIndex::~RegionSearchIndex() {
+    detach();
+}
+
+void RegionSearchIndex::attach(EpidemicData& data) {
+    detach();
+    target = &data;
+    target->addChangeListener(this);
+    rebuild();
+}
+
+void RegionSearchIndex::detach() {
+    if (target) target->removeChangeListener(this);
+    target = nullptr;
+    texts.clear();
+    postings.clear();
+    postingCount = 0;
+}
+
+void RegionSearchIndex::rebuild() {
+    texts.clear();
+    postings.clear();
+    postingCount = 0;
+    if (!target) return;
+    // The texts are independent, so they are built on the thread pool; the lists are filled in index order
+    const std::vector<Region>& regions = target->getRegions();
+    texts.resize(regions.size());
+    ThreadPool::instance().parallelFor(regions.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) texts[i] = SearchText(regions[i].name);
+    }, 256);
+    for (size_t i = 0; i < texts.size(); ++i) indexText(static_cast<uint32_t>(i));
+}
+
+void RegionSearchIndex::appendRegion(const char* name) {
+    texts.push_back(SearchText(name));
+    indexText(static_cast<uint32_t>(texts.size() - 1));
+}
+
+void RegionSearchIndex::indexText(uint32_t index) {
+    // index is the largest so far, so it goes to the back of every list
+    std::vector<uint64_t> grams;
+    CollectGrams(texts[index], grams);
+    for (uint64_t g : grams) postings[g].push_back(index);
+    postingCount += grams.size();
+}
+
+void RegionSearchIndex::removeRegionGrams(uint32_t index) {
+    std::vector<uint64_t> grams;
+    CollectGrams(texts[index], grams);
+    for (uint64_t g : grams) {
+        auto it = postings.find(g);
+        if (it == postings.end()) continue;
+        std::vector<uint32_t>& list = it->second;
+        auto pos = std::lower_bound(list.begin(), list.end(), index);
+        if (pos == list.end() || *pos != index) continue;
+        list.erase(pos);
+        --postingCount;
+        if (list.empty()) postings.erase(it);
+    }
+}
+
+void RegionSearchIndex::onRegionAdded(int index, const Region& region) {
+    if (static_cast<size_t>(index) == texts.size()) {
+        appendRegion(region.name);
+    } else {
+        rebuild();
+    }
+}
+
+void RegionSearchIndex::onRegionDeleted(int index) {
+    if (index < 0 || static_cast<size_t>(index) >= texts.size()) {
+        rebuild();
+        return;
+    }
+    const uint32_t removed = static_cast<uint32_t>(index);
+    removeRegionGrams(removed);
+
+    // Mirrors the data model: the later regions move down by one, which keeps every list sorted
+    for (auto& entry : postings) {
+        std::vector<uint32_t>& list = entry.second;
+        for (auto it = std::upper_bound(list.begin(), list.end(), removed); it != list.end(); ++it) --*it;
+    }
+    texts.erase(texts.begin() + index);
+}
+
+void RegionSearchIndex::onRegionRenamed(int index, const char* name) {
+    if (index < 0 || static_cast<size_t>(index) >= texts.size()) {
+        rebuild();
+        return;
+    }
+    const uint32_t at = static_cast<uint32_t>(index);
+    removeRegionGrams(at);
+    texts[at] = SearchText(name);
+    std::vector<uint64_t> grams;
+    CollectGrams(texts[at], grams);
+    for (uint64_t g : grams) {
+        std::vector<uint32_t>& list = postings[g];
+        list.insert(std::lower_bound(list.begin(), list.end(), at), at);
+    }
+    postingCount += grams.size();
+}
+
+void RegionSearchIndex::onBulkChange() {
+    rebuild();
+}
+
+// --- Query ---
+
+// [算法] n-gram 查询
+// 逻辑:
+//   查询不超过 3 个字符时，其本身就是一个 n-gram，列表即结果 (n-gram 不跨越文本段，与子串匹配等价)。
+//   更长的查询取其全部 3-gram 的列表，从最短的一个开始按长度依次求交集 (跳跃查找)，
+//   交集中的地区再在可搜索文本中确认 (3-gram 都出现不代表它们相邻)。
+void RegionSearchIndex::find(const char* query, std::vector<uint32_t>& out) const {
+    const std::string q = Fold(query);
+    std::vector<uint32_t> cps;
+    Decode(q.data(), q.size(), cps);
+    if (cps.empty()) {
+        const size_t base = out.size();
+        out.resize(base + texts.size());
+        for (size_t i = 0; i < texts.size(); ++i) out[base + i] = static_cast<uint32_t>(i);
+        return;
+    }
+    if (cps.size() <= static_cast<size_t>(kMaxGram)) {
+        auto it = postings.find(Gram(cps.data(), static_cast<int>(cps.size())));
+        if (it != postings.end()) out.insert(out.end(), it->second.begin(), it->second.end());
+        return;
+    }
+
+    std::vector<const std::vector<uint32_t>*> lists;
+    for (size_t i = 0; i + kMaxGram <= cps.size(); ++i) {
+        auto it = postings.find(Gram(&cps[i], kMaxGram));
+        if (it == postings.end()) return;
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const std::vector<uint32_t>* a, const std::vector<uint32_t>* b) { return a->size() < b->size(); });
+    std::vector<uint32_t> candidates(lists[0]->begin(), lists[0]->end());
+    for (size_t k = 1; k < lists.size() && !candidates.empty(); ++k) {
+        IntersectInPlace(candidates, *lists[k]);
+    }
+    for (uint32_t index : candidates) {
+        if (texts[index].find(q) != std::string::npos) out.push_back(index);
+    }
+}
+
+// --- Benchmark ---
+
+namespace {
+
+// Characters common in Chinese place names, including several polyphones
+const char* const kPlaceChars[] = {
+    "京", "沪", "津", "渝", "冀", "晋", "辽", "吉", "黑", "苏", "浙", "皖", "闽", "赣", "鲁", "豫",
+    "鄂", "湘", "粤", "桂", "琼", "川", "贵", "云", "陕", "甘", "青", "宁", "新", "东", "南", "西",
+    "北", "中", "上", "下", "安", "平", "和", "兴", "长", "庆", "阳", "山", "江", "河", "湖", "海",
+    "州", "城", "口", "门", "关", "林", "原", "丰", "华", "德", "昌", "明", "光", "泉", "石", "水",
+    "溪", "岭", "峰", "湾", "岛", "沙", "田", "园", "重", "厦", "乐", "都", "六", "番", "莞", "吕",
+    "武", "汉", "广", "深", "圳", "杭", "宜", "昆", "福", "泰", "嘉", "绍", "温", "台", "金", "义",
+};
+const char* const kSuffixes[] = { "市", "县", "区", "镇" };
+
+std::string Encode(const uint32_t* c, size_t n) {
+    std::string s;
+    for (size_t i = 0; i < n; ++i) {
+        const uint32_t cp = c[i];
+        if (cp < 0x80) {
+            s += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            s += static_cast<char>(0xC0 | (cp >> 6));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            s += static_cast<char>(0xE0 | (cp >> 12));
+            s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            s += static_cast<char>(0xF0 | (cp >> 18));
+            s += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return s;
+}
+
+std::string RandomPlaceName(std::mt19937& rng) {
+    const size_t charCount = sizeof(kPlaceChars) / sizeof(kPlaceChars[0]);
+    std::string name;
+    const int length = 2 + static_cast<int>(rng() % 2);
+    for (int i = 0; i < length; ++i) name += kPlaceChars[rng() % charCount];
+    name += kSuffixes[rng() % 4];
+    return name;
+}
+
+// Reference result: every region whose searchable text contains the folded query
+void ScanTexts(const std::vector<std::string>& texts, const char* query, std::vector<uint32_t>& out) {
+    const std::string q = Fold(query);
+    for (size_t i = 0; i < texts.size(); ++i) {
+        if (texts[i].find(q) != std::string::npos) out.push_back(static_cast<uint32_t>(i));
+    }
+}
+
+} // namespace
+
+// [算法] 搜索索引基准测试
+// 逻辑:
+//   生成 regions 个 2-3 字加 市/县/区/镇 的地区名，从随机地区的名称中取查询:
+//   2 字与 4 字名称子串、前两个字的全拼、整个名称的首字母。子串查询同时计时逐个 strstr 的旧做法；
+//   之后在索引挂接的情况下随机新增、改名、删除地区，计时增量维护。
+//   更新前后的每个查询都与逐个扫描可搜索文本的结果比较。
+RegionSearchBenchmarkResult RegionSearchIndex::RunBenchmark(size_t regions) {
+    RegionSearchBenchmarkResult result;
+    result.regions = regions;
+
+    EpidemicData data;
+    data.reserveRegions(regions);
+    std::mt19937 rng(44);
+    for (size_t i = 0; i < regions; ++i) {
+        data.addRegion(RandomPlaceName(rng).c_str(), 100000, 0, 0, 0);
+    }
+
+    RegionSearchIndex index;
+    auto t0 = Clock::now();
+    index.attach(data);
+    result.buildMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    result.grams = index.getGramCount();
+    result.postings = index.getPostingCount();
+
+    // Queries taken from random regions
+    const int perKind = 100;
+    std::vector<std::string> substrings, pinyin, initials;
+    std::vector<uint32_t> cps;
+    const char* readings[4];
+    auto makeQueries = [&] {
+        substrings.clear();
+        pinyin.clear();
+        initials.clear();
+        const std::vector<Region>& rows = data.getRegions();
+        for (int q = 0; q < perKind; ++q) {
+            const char* name = rows[rng() % rows.size()].name;
+            Decode(name, std::strlen(name), cps);
+            substrings.push_back(Encode(cps.data(), 2));
+            substrings.push_back(Encode(cps.data(), std::min<size_t>(4, cps.size())));
+            std::string full, first;
+            for (size_t k = 0; k < cps.size(); ++k) {
+                if (Pinyin::Readings(cps[k], readings, 4) == 0) continue;
+                if (k < 2) full += readings[0];
+                first += readings[0][0];
+            }
+            pinyin.push_back(full);
+            initials.push_back(first);
+        }
+    };
+    std::vector<std::string> texts;
+    auto verify = [&] {
+        texts.clear();
+        for (const Region& r : data.getRegions()) texts.push_back(RegionSearchIndex::SearchText(r.name));
+        std::vector<uint32_t> expected, actual;
+        for (const std::vector<std::string>* kind : { &substrings, &pinyin, &initials }) {
+            for (const std::string& q : *kind) {
+                expected.clear();
+                actual.clear();
+                ScanTexts(texts, q.c_str(), expected);
+                index.find(q.c_str(), actual);
+                if (expected != actual) return false;
+            }
+        }
+        return true;
+    };
+    auto averageMicros = [&](const std::vector<std::string>& queries) {
+        std::vector<uint32_t> out;
+        const auto start = Clock::now();
+        for (const std::string& q : queries) {
+            out.clear();
+            index.find(q.c_str(), out);
+        }
+        return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / queries.size();
+    };
+
+    makeQueries();
+    result.queries = 4 * perKind;
+    result.substringUs = averageMicros(substrings);
+    result.pinyinUs = averageMicros(pinyin);
+    result.initialsUs = averageMicros(initials);
+    {
+        const std::vector<Region>& rows = data.getRegions();
+        std::vector<uint32_t> out;
+        const auto start = Clock::now();
+        for (const std::string& q : substrings) {
+            out.clear();
+            for (size_t i = 0; i < rows.size(); ++i) {
+                if (std::strstr(rows[i].name, q.c_str())) out.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        result.scanUs = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / substrings.size();
+    }
+    bool verified = verify();
+
+    // Incremental maintenance through the listener interface
+    const int updates = 2000;
+    t0 = Clock::now();
+    for (int u = 0; u < updates; ++u) {
+        const size_t count = data.getRegions().size();
+        const unsigned op = rng() % 10;
+        if (op < 4 && count > 0) {
+            data.renameRegion(static_cast<int>(rng() % count), RandomPlaceName(rng).c_str());
+        } else if (op < 7 || count == 0) {
+            data.addRegion(RandomPlaceName(rng).c_str(), 100000, 0, 0, 0);
+        } else {
+            data.deleteRegion(static_cast<int>(rng() % count));
+        }
+    }
+    result.updateUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / updates;
+    makeQueries();
+    verified = verify() && verified;
+
+    result.verified = verified;
+    result.valid = true;
+    return result;
+}
@@ -0,0 +1,86 @@
+// ====================================================================================
+// 模块名称: RegionSearch (地区名称搜索索引)
+// 功能描述:
+//   数据管理页的搜索框按名称查找地区，支持三种输入:
+//     名称子串    "武汉"、"汉 (W" (英文字母不区分大小写)
+//     全拼        "wuhan"、"hanw" (拼音串中的任意子串)
+//     首字母      "wh"
+//   每个地区的可搜索文本 = 小写名称 + 各种拼音读法的全拼与首字母 (多音字展开，最多 MaxVariants 种)。
+//   索引以字符 (UTF-8 解码后的码点) 为单位，记录每段文本中所有长度 1 - 3 的 n-gram 对应的地区下标。
+//   不超过 3 个字符的查询直接取对应 n-gram 的地区列表；更长的查询求各个 3-gram 列表的交集，
+//   再在候选地区的可搜索文本中确认。
+//   索引作为 EpidemicData 的变更监听器增量维护 (新增、改名、删除)，批量操作后整体重建。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] RegionSearchBenchmarkResult
+// 描述: 索引查询与逐个 strstr 扫描的对比 (查询用时为多次查询的平均值)
+// ------------------------------------------------------------------------------------
+struct RegionSearchBenchmarkResult {
+    bool valid = false;
+    size_t regions = 0;
+    size_t grams = 0;                   // Distinct n-grams
+    size_t postings = 0;                // Region entries over all n-grams
+    double buildMs = 0;
+    double scanUs = 0;                  // strstr over every name (the previous search), Chinese substring queries
+    double substringUs = 0;             // Index, Chinese substring queries of 2 and 4 characters
+    double pinyinUs = 0;                // Index, full pinyin queries
+    double initialsUs = 0;              // Index, initials queries
+    double updateUs = 0;                // Incremental maintenance per add / rename / delete
+    size_t queries = 0;
+    bool verified = false;              // Every query equals a scan over the searchable texts, before and after the updates
+};
+
+// ------------------------------------------------------------------------------------
+// [类] RegionSearchIndex
+// 描述: 地区名称的 n-gram + 拼音倒排索引
+// 作用:
+//   attach() 建立索引并注册为监听器；之后 find() 返回当前的地区下标 (升序)。只在 UI 线程使用。
+// ------------------------------------------------------------------------------------
+class RegionSearchIndex : public DataChangeListener {
+public:
+    static constexpr int MaxVariants = 8;   // Pinyin spellings per name (each polyphone multiplies them)
+
+    RegionSearchIndex();
+    ~RegionSearchIndex();
+
+    void attach(EpidemicData& data);
+    void detach();
+
+    // Appends the indices of the regions matching query, ascending. An empty query matches every region
+    void find(const char* query, std::vector<uint32_t>& out) const;
+
+    size_t getGramCount() const { return postings.size(); }
+    size_t getPostingCount() const { return postingCount; }
+
+    // Searchable text of a name: the lowercased name, then each pinyin spelling and its initials, '\x1f'-separated
+    static std::string SearchText(const char* name);
+
+    // Synthetic regions, index against strstr on the calling thread
+    static RegionSearchBenchmarkResult RunBenchmark(size_t regions);
+
+    // DataChangeListener
+    void onRegionAdded(int index, const Region& region) override;
+    void onRegionDeleted(int index) override;
+    void onRegionRenamed(int index, const char* name) override;
+    void onBulkChange() override;
+
+private:
+    void rebuild();
+    void appendRegion(const char* name);
+    void indexText(uint32_t index);                 // Appends index to the lists of texts[index]'s n-grams
+    void removeRegionGrams(uint32_t index);
+
+    EpidemicData* target;
+    std::vector<std::string> texts;                              // SearchText of each region, by index
+    std::unordered_map<uint64_t, std::vector<uint32_t>> postings; // n-gram -> ascending region indices
+    size_t postingCount;
+};
@@ -0,0 +1,199 @@
+// ====================================================================================
+// 模块名称: RenewalModel Implementation
+// 功能描述:
+//   实现每日新增序列重建、离散伽马卷积核、Richardson-Lucy 反卷积即时预测、
+//   R_t 估计以及基于更新方程的递推预测。
+// ====================================================================================
+
+#include "RenewalModel.h"
+#include "ThreadPool.h"
+#include <algorithm> // For std::max, std::min, std::reverse
+#include <cmath>     // For std::ceil, std::exp, std::log
+
+namespace {
+
+int KernelLength(double mean, double stddev) {
+    return std::max(2, static_cast<int>(std::ceil(mean + 5.0 * stddev)));
+}
+
+std::vector<double> WithLeadingZero(std::vector<double> values) {
+    values.insert(values.begin(), 0.0);
+    return values;
+}
+
+std::vector<double> Reversed(std::vector<double> values) {
+    std::reverse(values.begin(), values.end());
+    return values;
+}
+
+} // namespace
+
+RenewalModel::RenewalModel(const RenewalConfig& cfg, size_t maxSeriesLength)
+    : config(cfg),
+      generationKernel(WithLeadingZero(DiscreteGamma(cfg.generationMean, cfg.generationStd, 1,
+                                                     KernelLength(cfg.generationMean, cfg.generationStd)))),
+      delayKernel(DiscreteGamma(cfg.delayMean, cfg.delayStd, 0, KernelLength(cfg.delayMean, cfg.delayStd))),
+      delayReversed(Reversed(delayKernel)),
+      generationConvolver(generationKernel, maxSeriesLength),
+      delayConvolver(delayKernel, maxSeriesLength + std::max(0, cfg.horizon)),
+      delayCorrelator(delayReversed, maxSeriesLength) {
+    double cumulative = 0.0;
+    delayCumulative.reserve(delayKernel.size());
+    for (double d : delayKernel) {
+        cumulative += d;
+        delayCumulative.push_back(cumulative);
+    }
+}
+
+bool RenewalModel::usesFFT() const {
+    return generationConvolver.usesFFT() || delayConvolver.usesFFT() || delayCorrelator.usesFFT();
+}
+
+size_t RenewalModel::MaxSeriesLength(const std::vector<const Region*>& regions) {
+    size_t longest = 0;
+    for (const Region* r : regions) {
+        if (r->history.size() >= 2) {
+            longest = std::max(longest, static_cast<size_t>(r->history.back().day - r->history.front().day));
+        }
+    }
+    return longest;
+}
+
+// [算法] 离散伽马分布 (Discretized Gamma)
+// 逻辑: 形状 k = (mean/sd)^2，尺度 θ = sd^2/mean，在整数天上取概率密度后归一化。
+std::vector<double> RenewalModel::DiscreteGamma(double mean, double stddev, int first, int length) {
+    std::vector<double> values(std::max(1, length), 0.0);
+    const double shape = (mean / stddev) * (mean / stddev);
+    const double scale = stddev * stddev / mean;
+    double sum = 0.0;
+    for (size_t i = 0; i < values.size(); ++i) {
+        double x = std::max(0.5, static_cast<double>(first + static_cast<int>(i)));
+        values[i] = std::exp((shape - 1.0) * std::log(x) - x / scale);
+        sum += values[i];
+    }
+    for (auto& v : values) v = (sum > 0.0) ? v / sum : 1.0 / values.size();
+    return values;
+}
+
+// [算法] 每日新增 (Daily Incidence)
+// 逻辑:
+//   历史记录是累计值且可能缺天，先在缺失的天之间对累计确诊线性插值，再逐日差分。
+//   第一天没有前一天可供差分，因此序列从 history.front().day + 1 开始。
+std::vector<double> RenewalModel::DailyIncidence(const Region& region, int& firstDay) {
+    std::vector<double> incidence;
+    if (region.history.size() < 2) return incidence;
+
+    firstDay = region.history.front().day + 1;
+    incidence.reserve(region.history.back().day - region.history.front().day);
+
+    bool hasPrevious = false;
+    int previousDay = 0;
+    double previousCumulative = 0.0;
+    for (const auto& rec : region.history) {
+        if (hasPrevious) {
+            int gap = rec.day - previousDay;
+            if (gap <= 0) continue;
+            double perDay = std::max(0.0, (rec.confirmed - previousCumulative) / gap);
+            for (int d = 0; d < gap; ++d) incidence.push_back(perDay);
+        }
+        hasPrevious = true;
+        previousDay = rec.day;
+        previousCumulative = rec.confirmed;
+    }
+    return incidence;
+}
+
+// [算法] 更新方程预测 (Renewal Forecast)
+// 核心逻辑:
+//   1. 即时预测: 报告数 C = d * X (d 为报告延迟)。用 Richardson-Lucy 迭代反卷积，
+//      X_t <- X_t / q_t * Σ_s d_s C_{t+s} / (d*X)_{t+s}，q_t 为第 t 天感染至今已报告的比例，
+//      从而补齐最近几天尚未报告完整的感染数。
+//   2. R_t 估计: 感染压力 Λ_t = Σ_s w_s X_{t-s}，R_t = Σ_窗口 X / Σ_窗口 Λ。
+//   3. 递推预测: X_{T+h} = R * (历史部分的卷积 + 已预测部分的滑动窗口求和)。
+//   2、3 中的整段卷积以及最终的"预测报告数"都经由 Convolver 自动选择直接法或FFT。
+RenewalResult RenewalModel::forecast(const Region& region) const {
+    RenewalResult result;
+    result.reported = DailyIncidence(region, result.firstDay);
+    const size_t T = result.reported.size();
+    if (T < 2) return result;
+
+    const size_t D = delayKernel.size();
+    const size_t S = generationKernel.size();
+    const size_t H = static_cast<size_t>(std::max(0, config.horizon));
+    const std::vector<double>& reported = result.reported;
+
+    // --- 1. Nowcast via Richardson-Lucy deconvolution ---
+    std::vector<double>& X = result.nowcastInfections;
+    X.resize(T);
+    const size_t shift = static_cast<size_t>(config.delayMean + 0.5);
+    for (size_t t = 0; t < T; ++t) {
+        X[t] = std::max(1e-3, reported[std::min(T - 1, t + shift)]);
+    }
+    std::vector<double> expected(T + D - 1), ratio(T), correlation(T + D - 1);
+    for (int iter = 0; iter < config.deconvolutionIterations; ++iter) {
+        delayConvolver.convolve(X.data(), T, expected.data());
+        for (size_t u = 0; u < T; ++u) {
+            ratio[u] = (expected[u] > 0.0) ? reported[u] / expected[u] : 0.0;
+        }
+        delayCorrelator.convolve(ratio.data(), T, correlation.data());
+        for (size_t t = 0; t < T; ++t) {
+            double completeness = delayCumulative[std::min(T - 1 - t, D - 1)];
+            X[t] *= correlation[t + D - 1] / std::max(completeness, 1e-12);
+        }
+    }
+
+    // The most recent days are barely reported: hold the last well-identified value instead
+    size_t identified = T;
+    while (identified > 1 && delayCumulative[std::min(T - identified, D - 1)] < config.minCompleteness) {
+        --identified;
+    }
+    for (size_t t = identified; t < T; ++t) {
+        X[t] = X[identified - 1];
+    }
+
+    // --- 2. Reproduction number from the infection pressure ---
+    std::vector<double> pressure(T + S - 1);
+    generationConvolver.convolve(X.data(), T, pressure.data());
+    result.reproductionNumber.resize(T);
+    const size_t window = static_cast<size_t>(std::max(1, config.rtWindow));
+    for (size_t t = 0; t < T; ++t) {
+        double infections = 0.0, lambda = 0.0;
+        for (size_t u = (t + 1 > window ? t + 1 - window : 0); u <= t; ++u) {
+            infections += X[u];
+            lambda += pressure[u];
+        }
+        result.reproductionNumber[t] = (lambda > 0.0) ? infections / lambda : 0.0;
+    }
+    result.latestR = result.reproductionNumber[identified - 1];
+
+    // --- 3. Renewal recursion over the horizon ---
+    // pressure[T + h] already holds the contribution of observed days (h < S - 1)
+    result.forecastInfections.resize(H);
+    for (size_t h = 0; h < H; ++h) {
+        double lambda = (T + h < pressure.size()) ? pressure[T + h] : 0.0;
+        for (size_t s = 1; s <= std::min(h, S - 1); ++s) {
+            lambda += generationKernel[s] * result.forecastInfections[h - s];
+        }
+        result.forecastInfections[h] = result.latestR * lambda;
+    }
+
+    // Expected reports: convolve the whole infection course with the reporting delay
+    std::vector<double> course(X);
+    course.insert(course.end(), result.forecastInfections.begin(), result.forecastInfections.end());
+    std::vector<double> reports(course.size() + D - 1);
+    delayConvolver.convolve(course.data(), course.size(), reports.data());
+    result.forecastReports.assign(reports.begin() + T, reports.begin() + T + H);
+
+    result.valid = true;
+    return result;
+}
+
+std::vector<RenewalResult> RenewalModel::forecastBatch(const std::vector<const Region*>& regions) const {
+    std::vector<RenewalResult> results(regions.size());
+    ThreadPool::instance().parallelFor(regions.size(), [&](size_t begin, size_t end, unsigned) {
+        for (size_t i = begin; i < end; ++i) {
+            results[i] = forecast(*regions[i]);
+        }
+    }, 8);
+    return results;
+}
@@ -0,0 +1,84 @@
+// ====================================================================================
+// 模块名称: RenewalModel (更新方程预测与即时预测)
+// 功能描述:
+//   与 SIRModel 并列的另一种预测引擎，基于世代间隔的更新方程:
+//       X_t = R_t * Σ_s w_s X_{t-s}
+//   并通过报告延迟反卷积 (Richardson-Lucy) 对 Region::history 最近几天
+//   尚未报告完整的感染数做即时预测 (nowcasting)。
+//   所有整段序列卷积通过 Convolver 自动选择直接法或FFT，一批地区共享卷积核频谱并行处理。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include "Convolution.h"
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] RenewalConfig
+// 描述: 世代间隔、报告延迟(均为离散伽马分布)以及预测设置
+// ------------------------------------------------------------------------------------
+struct RenewalConfig {
+    double generationMean = 5.2;  // Days between successive infections in a chain
+    double generationStd = 1.7;
+    double delayMean = 7.0;       // Days from infection to the report appearing in history
+    double delayStd = 4.0;
+    int horizon = 60;             // Forecast days
+    int rtWindow = 7;             // Days used to estimate the latest reproduction number
+    int deconvolutionIterations = 30;
+    double minCompleteness = 0.1; // Days reported below this fraction hold the last identified value
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] RenewalResult
+// 描述: 单个地区的即时预测 + 预测结果 (均为每日新增，而非累计值)
+// ------------------------------------------------------------------------------------
+struct RenewalResult {
+    bool valid = false;
+    int firstDay = 0;                         // Day of reported[0]
+    std::vector<double> reported;             // Daily new confirmed cases from history
+    std::vector<double> nowcastInfections;    // Deconvolved infections, same length as reported
+    std::vector<double> reproductionNumber;   // R_t estimate per day
+    std::vector<double> forecastInfections;   // horizon values after the last history day
+    std::vector<double> forecastReports;      // Expected reports for the same days
+    double latestR = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [类] RenewalModel
+// 描述: 更新方程预测引擎
+// 作用:
+//   构造时离散化两个卷积核并为给定的最长序列准备好卷积器(自动选择直接法/FFT)；
+//   forecast() 处理单个地区，forecastBatch() 在线程池上处理一批地区。
+// ------------------------------------------------------------------------------------
+class RenewalModel {
+public:
+    RenewalModel(const RenewalConfig& config, size_t maxSeriesLength);
+
+    // Daily new cases reconstructed from cumulative history (gaps are linearly interpolated)
+    static std::vector<double> DailyIncidence(const Region& region, int& firstDay);
+
+    // Discretized gamma distribution on days [first, first + length), normalized to sum to 1
+    static std::vector<double> DiscreteGamma(double mean, double stddev, int first, int length);
+
+    RenewalResult forecast(const Region& region) const;
+    std::vector<RenewalResult> forecastBatch(const std::vector<const Region*>& regions) const;
+
+    bool usesFFT() const;
+    const std::vector<double>& getGenerationKernel() const { return generationKernel; }
+    const std::vector<double>& getDelayKernel() const { return delayKernel; }
+
+    // Longest history (in days) among the given regions, used to size the convolvers
+    static size_t MaxSeriesLength(const std::vector<const Region*>& regions);
+
+private:
+    RenewalConfig config;
+    std::vector<double> generationKernel; // w_0 = 0, w_s for s >= 1
+    std::vector<double> delayKernel;      // d_s for s >= 0
+    std::vector<double> delayReversed;
+    std::vector<double> delayCumulative;  // Fraction of infections reported within s days
+
+    Convolver generationConvolver;
+    Convolver delayConvolver;
+    Convolver delayCorrelator;
+};
@@ -0,0 +1,194 @@
+// ====================================================================================
+// 模块名称: SIREmulator Implementation
+// 功能描述:
+//   后台线程按需构建网格(每个网格点在线程池上独立运行一次SIRModel)，
+//   UI线程只比较预测起点和插值，不会被网格构建阻塞。
+// ====================================================================================
+
+#include "SIREmulator.h"
+#include "ThreadPool.h"
+#include <algorithm> // For std::min, std::max, std::fill
+#include <cmath>     // For std::floor
+
+namespace {
+
+uint64_t HandleKey(RegionHandle handle) {
+    return (static_cast<uint64_t>(handle.slot) << 32) | handle.generation;
+}
+
+} // namespace
+
+ResponseSurfaceEmulator::ResponseSurfaceEmulator() : useCounter(0), stopping(false) {
+    builder = std::thread(&ResponseSurfaceEmulator::builderLoop, this);
+}
+
+ResponseSurfaceEmulator::~ResponseSurfaceEmulator() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobCondition.notify_all();
+    builder.join();
+}
+
+ResponseSurfaceEmulator::Origin ResponseSurfaceEmulator::Origin::Of(const Region& region) {
+    Origin origin;
+    origin.population = region.getPopulation();
+    region.getForecastOrigin(origin.startDay, origin.infected, origin.removed);
+    return origin;
+}
+
+bool ResponseSurfaceEmulator::request(RegionHandle handle, const Region& region) {
+    if (region.getPopulation() <= 0) return false; // Nothing to simulate (e.g. imported without a population column)
+    const Origin origin = Origin::Of(region);
+    const uint64_t key = HandleKey(handle);
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto found = cache.find(key);
+    if (found == cache.end()) {
+        if (cache.size() >= MaxLattices) evictOldest();
+        found = cache.emplace(key, CacheEntry()).first;
+    }
+    CacheEntry& entry = found->second;
+    entry.lastUse = ++useCounter;
+    if (entry.origin == origin && (entry.lattice || entry.building)) {
+        return entry.lattice != nullptr;
+    }
+
+    // Forecast origin changed (or first request): drop the stale lattice and rebuild
+    entry.origin = origin;
+    entry.building = true;
+    entry.lattice.reset();
+
+    BuildJob job;
+    job.key = key;
+    job.origin = origin;
+    pendingJobs.erase(std::remove_if(pendingJobs.begin(), pendingJobs.end(),
+                                     [&](const BuildJob& j) { return j.key == key; }),
+                      pendingJobs.end());
+    pendingJobs.push_back(job);
+    jobCondition.notify_one();
+    return false;
+}
+
+// Drops the least recently requested lattice (and its build, if still queued); called with the mutex held
+void ResponseSurfaceEmulator::evictOldest() {
+    auto oldest = cache.begin();
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (it->second.lastUse < oldest->second.lastUse) oldest = it;
+    }
+    if (oldest == cache.end()) return;
+    const uint64_t key = oldest->first;
+    pendingJobs.erase(std::remove_if(pendingJobs.begin(), pendingJobs.end(),
+                                     [&](const BuildJob& j) { return j.key == key; }),
+                      pendingJobs.end());
+    cache.erase(oldest);
+}
+
+// [算法] 双线性插值 (Bilinear Interpolation)
+// 逻辑:
+//   找到 (beta, gamma) 所在的网格单元，对四个角点的轨迹逐日加权平均。
+//   易感者 S 由 N - I - R 还原，因此网格只需存储 I 和 R 两条曲线。
+bool ResponseSurfaceEmulator::interpolate(RegionHandle handle, const Region& region, double beta, double gamma,
+                                          int days, std::vector<SIRDataPoint>& out) {
+    const Origin origin = Origin::Of(region);
+    std::shared_ptr<const Lattice> lattice;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find(HandleKey(handle));
+        if (it == cache.end() || !(it->second.origin == origin)) return false;
+        lattice = it->second.lattice;
+    }
+    if (!lattice) return false;
+
+    days = std::max(0, std::min(days, MaxDays));
+    double fb = std::min(std::max(beta, 0.0), BetaMax) / BetaMax * (BetaSteps - 1);
+    double fg = std::min(std::max(gamma, 0.0), GammaMax) / GammaMax * (GammaSteps - 1);
+    int b0 = std::min(static_cast<int>(std::floor(fb)), BetaSteps - 2);
+    int g0 = std::min(static_cast<int>(std::floor(fg)), GammaSteps - 2);
+    float tb = static_cast<float>(fb - b0);
+    float tg = static_cast<float>(fg - g0);
+
+    const size_t stride = MaxDays + 1;
+    auto offset = [&](int bi, int gi) { return (static_cast<size_t>(bi) * GammaSteps + gi) * stride; };
+    const size_t o00 = offset(b0, g0), o01 = offset(b0, g0 + 1);
+    const size_t o10 = offset(b0 + 1, g0), o11 = offset(b0 + 1, g0 + 1);
+    const float w00 = (1 - tb) * (1 - tg), w01 = (1 - tb) * tg;
+    const float w10 = tb * (1 - tg), w11 = tb * tg;
+
+    out.resize(days + 1);
+    for (int t = 0; t <= days; ++t) {
+        double I = w00 * lattice->infected[o00 + t] + w01 * lattice->infected[o01 + t] +
+                   w10 * lattice->infected[o10 + t] + w11 * lattice->infected[o11 + t];
+        double R = w00 * lattice->removed[o00 + t] + w01 * lattice->removed[o01 + t] +
+                   w10 * lattice->removed[o10 + t] + w11 * lattice->removed[o11 + t];
+        out[t].day = lattice->startDay + t;
+        out[t].infected = I;
+        out[t].recovered = R;
+        out[t].susceptible = std::max(0.0, lattice->population - I - R);
+    }
+    return true;
+}
+
+std::shared_ptr<const ResponseSurfaceEmulator::Lattice> ResponseSurfaceEmulator::BuildLattice(const BuildJob& job) {
+    auto lattice = std::make_shared<Lattice>();
+    const Origin& origin = job.origin;
+    lattice->population = origin.population;
+    lattice->startDay = origin.startDay;
+
+    const size_t stride = MaxDays + 1;
+    const size_t points = static_cast<size_t>(BetaSteps) * GammaSteps;
+    lattice->infected.resize(points * stride);
+    lattice->removed.resize(points * stride);
+
+    ThreadPool& pool = ThreadPool::instance();
+    std::vector<SIRModel> models(pool.getWorkerCount());
+
+    pool.parallelFor(points, [&](size_t begin, size_t end, unsigned w) {
+        SIRModel& model = models[w];
+        for (size_t p = begin; p < end; ++p) {
+            int bi = static_cast<int>(p / GammaSteps);
+            int gi = static_cast<int>(p % GammaSteps);
+            model.setBeta(BetaMax * bi / (BetaSteps - 1));
+            model.setGamma(GammaMax * gi / (GammaSteps - 1));
+            model.reset(origin.population, origin.infected, origin.removed, origin.startDay);
+            model.run(MaxDays);
+
+            // The model stops recording if it cannot step; the remaining days hold its last state
+            const auto& history = model.getHistory();
+            const size_t recorded = std::min(stride, history.size());
+            float* I = &lattice->infected[p * stride];
+            float* R = &lattice->removed[p * stride];
+            for (size_t t = 0; t < recorded; ++t) {
+                I[t] = static_cast<float>(history[t].infected);
+                R[t] = static_cast<float>(history[t].recovered);
+            }
+            std::fill(I + recorded, I + stride, I[recorded - 1]);
+            std::fill(R + recorded, R + stride, R[recorded - 1]);
+        }
+    }, 16);
+    return lattice;
+}
+
+void ResponseSurfaceEmulator::builderLoop() {
+    for (;;) {
+        BuildJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobCondition.wait(lock, [this] { return stopping || !pendingJobs.empty(); });
+            if (stopping) return;
+            job = pendingJobs.front();
+            pendingJobs.erase(pendingJobs.begin());
+        }
+
+        std::shared_ptr<const Lattice> lattice = BuildLattice(job);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = cache.find(job.key);
+        // Only publish if the entry was neither evicted nor re-requested with a newer origin in the meantime
+        if (it != cache.end() && it->second.origin == job.origin) {
+            it->second.lattice = lattice;
+            it->second.building = false;
+        }
+    }
+}
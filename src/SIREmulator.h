@@ -0,0 +1,97 @@
+// ====================================================================================
+// 模块名称: SIREmulator (响应面代理模型)
+// 功能描述:
+//   在后台为每个地区预先计算 Beta x Gamma 网格上的SIR轨迹，拖动参数滑块时
+//   直接在网格点之间做双线性插值得到预览曲线，完全不需要运行模拟。
+//   网格按地区句柄缓存，记录构建时的预测起点 (人口、起始日、感染者、移出者)；起点变化时失效并重建。
+//   最多保留 MaxLattices 个网格 (每个约 2.5 MB)，超出时丢弃最久未请求的那个。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [类] ResponseSurfaceEmulator
+// 描述: SIR响应面代理模型
+// 作用:
+//   request() 每帧调用即可：预测起点未变时直接命中缓存，变化时把重建任务交给后台线程。
+//   interpolate() 在网格就绪后把任意 (beta, gamma, days) 插值成一条完整的SIR轨迹。
+// ------------------------------------------------------------------------------------
+class ResponseSurfaceEmulator {
+public:
+    // Lattice covers the same ranges as the Beta/Gamma/Days sliders on the prediction page
+    static constexpr int BetaSteps = 41;
+    static constexpr int GammaSteps = 21;
+    static constexpr double BetaMax = 2.0;
+    static constexpr double GammaMax = 1.0;
+    static constexpr int MaxDays = 365;
+    static constexpr size_t MaxLattices = 16;   // Least recently requested lattices are dropped beyond this
+
+    ResponseSurfaceEmulator();
+    ~ResponseSurfaceEmulator();
+
+    ResponseSurfaceEmulator(const ResponseSurfaceEmulator&) = delete;
+    ResponseSurfaceEmulator& operator=(const ResponseSurfaceEmulator&) = delete;
+
+    // Returns true when the region's lattice is ready; otherwise schedules a (re)build.
+    // A region without a population has no lattice and always returns false.
+    bool request(RegionHandle handle, const Region& region);
+
+    // Fills `out` with days + 1 interpolated points; returns false if the lattice is not ready
+    bool interpolate(RegionHandle handle, const Region& region, double beta, double gamma, int days,
+                     std::vector<SIRDataPoint>& out);
+
+private:
+    // Everything a lattice depends on: the region's forecast origin
+    struct Origin {
+        int population = 0;
+        int startDay = 0;
+        int infected = 0;
+        int removed = 0;
+
+        static Origin Of(const Region& region);
+        bool operator==(const Origin& o) const {
+            return population == o.population && startDay == o.startDay && infected == o.infected && removed == o.removed;
+        }
+    };
+
+    // Infected/removed trajectories for every lattice point, (MaxDays + 1) floats each
+    struct Lattice {
+        int population = 0;
+        int startDay = 0;
+        std::vector<float> infected;
+        std::vector<float> removed;
+    };
+
+    struct CacheEntry {
+        Origin origin;
+        bool building = false;
+        uint64_t lastUse = 0;
+        std::shared_ptr<const Lattice> lattice;
+    };
+
+    struct BuildJob {
+        uint64_t key;
+        Origin origin;
+    };
+
+    void builderLoop();
+    void evictOldest();
+    static std::shared_ptr<const Lattice> BuildLattice(const BuildJob& job);
+
+    std::unordered_map<uint64_t, CacheEntry> cache; // Keyed by region handle
+    uint64_t useCounter;
+    std::vector<BuildJob> pendingJobs;
+    std::mutex mutex;
+    std::condition_variable jobCondition;
+    bool stopping;
+    std::thread builder;
+};
@@ -0,0 +1,90 @@
+// ====================================================================================
+// 模块名称: SensitivityAnalysis (全局敏感性分析)
+// 功能描述:
+//   用 Saltelli 采样方案 + Sobol 低差异序列估计 Sobol 一阶指数与总效应指数，
+//   衡量 Beta、Gamma、初始感染人数对"峰值规模"和"峰值时间"的影响程度。
+//   所需的数千次 SIRModel 模拟按批次分发到线程池的所有核心上执行。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [类] SobolSequence
+// 描述: Sobol 低差异序列生成器 (Joe-Kuo 方向数, 最多 6 维)
+// 作用: 按格雷码顺序逐点生成 [0,1)^d 中均匀铺开的准随机点，比伪随机数收敛更快。
+// ------------------------------------------------------------------------------------
+class SobolSequence {
+public:
+    static constexpr int MaxDimensions = 6;
+
+    explicit SobolSequence(int dimensions);
+
+    // Writes the next point into `out` (dimensions values in [0, 1))
+    void next(double* out);
+
+private:
+    int dimensions;
+    uint32_t index;
+    uint32_t direction[MaxDimensions][32];
+    uint32_t state[MaxDimensions];
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] SobolConfig / SobolResult
+// 描述: 敏感性分析的参数范围与结果
+// ------------------------------------------------------------------------------------
+struct SobolConfig {
+    static constexpr int ParamCount = 3; // Beta, Gamma, initial infected
+
+    int population = 0;
+    int initialRemoved = 0;
+    int days = 180;
+    int baseSamples = 2048; // N, total model runs = N * (ParamCount + 2)
+    double betaMin = 0.05, betaMax = 1.0;
+    double gammaMin = 0.02, gammaMax = 0.5;
+    double infectedMin = 1, infectedMax = 1000;
+};
+
+struct SobolResult {
+    enum Output { PeakSize = 0, PeakDay = 1, OutputCount = 2 };
+
+    bool valid = false;
+    double firstOrder[OutputCount][SobolConfig::ParamCount] = {};
+    double totalOrder[OutputCount][SobolConfig::ParamCount] = {};
+    long long evaluations = 0;
+    double elapsedSeconds = 0;
+    double evaluationsPerSecond = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [类] SobolAnalyzer
+// 描述: Sobol 敏感性分析器
+// 作用: run() 同步计算；start() 在后台线程计算，UI 轮询 isRunning()/getProgress()。
+// ------------------------------------------------------------------------------------
+class SobolAnalyzer {
+public:
+    SobolAnalyzer();
+    ~SobolAnalyzer();
+
+    static SobolResult run(const SobolConfig& config, std::atomic<long long>* evaluationsOut = nullptr);
+
+    void start(const SobolConfig& config);
+    bool isRunning() const;
+    float getProgress() const;
+    SobolResult getResult();
+
+private:
+    std::thread worker;
+    std::mutex resultMutex;
+    SobolResult result;
+    std::atomic<bool> running;
+    std::atomic<long long> evaluations;
+    long long totalEvaluations;
+};
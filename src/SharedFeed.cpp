@@ -0,0 +1,640 @@
+// ====================================================================================
+// 模块名称: SharedFeed Implementation
+// 功能描述:
+//   命名共享内存 (CreateFileMapping / shm_open)、生产者写入、接收线程 (取空环形缓冲区、
+//   排序合并)、UI 线程批次写入，以及端到端吞吐基准测试。
+// ====================================================================================
+
+#include "SharedFeed.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>  // For std::stable_sort, std::nth_element, std::min
+#include <cstdio>
+#include <cstring>    // For std::memcpy
+#include <new>        // Placement new of the ring header
+
+namespace {
+
+const size_t kLatencyRing = 1024;
+
+double Percentile(std::vector<float>& values, double q) {
+    if (values.empty()) return 0;
+    size_t k = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+std::string SystemName(const std::string& name) {
+#ifdef _WIN32
+    return "Local\\" + name;
+#else
+    return "/" + name;
+#endif
+}
+
+bool IsPowerOfTwo(size_t n) { return n != 0 && (n & (n - 1)) == 0; }
+
+// Copies count records starting at sequence number `from` out of the ring (handles the wrap-around)
+void CopyOut(const FeedRecord* slots, uint32_t capacity, uint64_t from, size_t count, FeedRecord* out) {
+    const size_t first = static_cast<size_t>(from & (capacity - 1));
+    const size_t part = std::min(count, capacity - first);
+    std::memcpy(out, slots + first, part * sizeof(FeedRecord));
+    std::memcpy(out + part, slots, (count - part) * sizeof(FeedRecord));
+}
+
+void CopyIn(FeedRecord* slots, uint32_t capacity, uint64_t to, const FeedRecord* records, size_t count) {
+    const size_t first = static_cast<size_t>(to & (capacity - 1));
+    const size_t part = std::min(count, capacity - first);
+    std::memcpy(slots + first, records, part * sizeof(FeedRecord));
+    std::memcpy(slots, records + part, (count - part) * sizeof(FeedRecord));
+}
+
+} // namespace
+
+// --- SharedMemory ---
+
+#ifdef _WIN32
+
+SharedMemory::SharedMemory() : data(nullptr), size(0), owner(false), mappingHandle(nullptr) {}
+
+bool SharedMemory::create(const std::string& name, size_t bytes, std::string* error) {
+    close();
+    systemName = SystemName(name);
+    const unsigned long long total = bytes;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                        static_cast<DWORD>(total >> 32), static_cast<DWORD>(total & 0xFFFFFFFFu),
+                                        systemName.c_str());
+    if (mapping == NULL) {
+        if (error) *error = "CreateFileMapping 失败: " + systemName;
+        return false;
+    }
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        CloseHandle(mapping);
+        if (error) *error = "共享内存已被其他实例使用: " + systemName;
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+    if (view == NULL) {
+        CloseHandle(mapping);
+        if (error) *error = "MapViewOfFile 失败";
+        return false;
+    }
+    mappingHandle = mapping;
+    data = static_cast<unsigned char*>(view);
+    size = bytes;
+    owner = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name, std::string* error) {
+    close();
+    systemName = SystemName(name);
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, systemName.c_str());
+    if (mapping == NULL) {
+        if (error) *error = "共享内存不存在 (应用是否已启动通道?): " + systemName;
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (view == NULL || VirtualQuery(view, &info, sizeof(info)) == 0) {
+        if (view) UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        if (error) *error = "MapViewOfFile 失败";
+        return false;
+    }
+    mappingHandle = mapping;
+    data = static_cast<unsigned char*>(view);
+    size = info.RegionSize;
+    owner = false;
+    return true;
+}
+
+void SharedMemory::close() {
+    // The name disappears with the last handle, so the owner has nothing extra to remove
+    if (data) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+    data = nullptr;
+    size = 0;
+    owner = false;
+    mappingHandle = nullptr;
+}
+
+#else
+
+SharedMemory::SharedMemory() : data(nullptr), size(0), owner(false), fd(-1) {}
+
+bool SharedMemory::create(const std::string& name, size_t bytes, std::string* error) {
+    close();
+    systemName = SystemName(name);
+    shm_unlink(systemName.c_str()); // Left behind by a previous run that did not shut down cleanly
+    int handle = shm_open(systemName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (handle < 0) {
+        if (error) *error = "shm_open 失败: " + systemName;
+        return false;
+    }
+    if (ftruncate(handle, static_cast<off_t>(bytes)) != 0) {
+        ::close(handle);
+        shm_unlink(systemName.c_str());
+        if (error) *error = "无法分配共享内存";
+        return false;
+    }
+    void* view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+    if (view == MAP_FAILED) {
+        ::close(handle);
+        shm_unlink(systemName.c_str());
+        if (error) *error = "mmap 失败";
+        return false;
+    }
+    fd = handle;
+    data = static_cast<unsigned char*>(view);
+    size = bytes;
+    owner = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name, std::string* error) {
+    close();
+    systemName = SystemName(name);
+    int handle = shm_open(systemName.c_str(), O_RDWR, 0600);
+    if (handle < 0) {
+        if (error) *error = "共享内存不存在 (应用是否已启动通道?): " + systemName;
+        return false;
+    }
+    struct stat st;
+    if (fstat(handle, &st) != 0 || st.st_size <= 0) {
+        ::close(handle);
+        if (error) *error = "无法获取共享内存大小";
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+    if (view == MAP_FAILED) {
+        ::close(handle);
+        if (error) *error = "mmap 失败";
+        return false;
+    }
+    fd = handle;
+    data = static_cast<unsigned char*>(view);
+    size = static_cast<size_t>(st.st_size);
+    owner = false;
+    return true;
+}
+
+void SharedMemory::close() {
+    if (data) munmap(data, size);
+    if (fd >= 0) ::close(fd);
+    if (owner) shm_unlink(systemName.c_str());
+    data = nullptr;
+    size = 0;
+    owner = false;
+    fd = -1;
+}
+
+#endif
+
+SharedMemory::~SharedMemory() {
+    close();
+}
+
+// --- Producer ---
+
+SharedFeedProducer::SharedFeedProducer() : ring(nullptr), slots(nullptr), head(0), cachedTail(0) {}
+
+bool SharedFeedProducer::open(const std::string& name, std::string* error) {
+    close();
+    if (!memory.open(name, error)) return false;
+    FeedRingHeader* header = reinterpret_cast<FeedRingHeader*>(memory.getData());
+    if (memory.getSize() < sizeof(FeedRingHeader) || header->magic != FeedRingHeader::Magic ||
+        header->version != FeedRingHeader::Version || header->recordSize != sizeof(FeedRecord) ||
+        !IsPowerOfTwo(header->capacity) ||
+        memory.getSize() < sizeof(FeedRingHeader) + static_cast<size_t>(header->capacity) * sizeof(FeedRecord)) {
+        memory.close();
+        if (error) *error = "共享内存格式不匹配";
+        return false;
+    }
+    ring = header;
+    slots = reinterpret_cast<FeedRecord*>(memory.getData() + sizeof(FeedRingHeader));
+    head = ring->head.load(std::memory_order_relaxed);
+    cachedTail = ring->tail.load(std::memory_order_acquire);
+    return true;
+}
+
+void SharedFeedProducer::close() {
+    memory.close();
+    ring = nullptr;
+    slots = nullptr;
+}
+
+bool SharedFeedProducer::isConsumerActive() const {
+    return ring && ring->consumerActive.load(std::memory_order_acquire) != 0;
+}
+
+// [算法] 单生产者写入
+// 逻辑:
+//   空闲空间 = capacity - (head - tail)。先用上次读到的 tail 计算，不够时才重新读取共享的 tail，
+//   避免每次写入都去读消费者那条缓存行。记录写进槽位后再以 release 语义发布新的 head，
+//   消费者以 acquire 读到 head 时这些记录一定已经可见。
+size_t SharedFeedProducer::push(const FeedRecord* records, size_t count) {
+    if (!ring || count == 0) return 0;
+    const uint32_t capacity = ring->capacity;
+    size_t free = capacity - static_cast<size_t>(head - cachedTail);
+    if (free < count) {
+        cachedTail = ring->tail.load(std::memory_order_acquire);
+        free = capacity - static_cast<size_t>(head - cachedTail);
+    }
+    const size_t n = std::min(count, free);
+    if (n == 0) return 0;
+    CopyIn(slots, capacity, head, records, n);
+    head += n;
+    ring->head.store(head, std::memory_order_release);
+    return n;
+}
+
+// --- Consumer ---
+
+SharedFeed::SharedFeed()
+    : target(nullptr), ring(nullptr), slots(nullptr), stopRequested(false), queuedRecords(0),
+      applyMsTotal(0), latencyNext(0), rateApplied(0), backlogOffset(0), backlogRecords(0) {}
+
+SharedFeed::~SharedFeed() {
+    stop();
+}
+
+bool SharedFeed::start(EpidemicData& data, const std::string& name, size_t capacity, std::string* error) {
+    stop();
+    if (!IsPowerOfTwo(capacity) || capacity > (1u << 30)) {
+        if (error) *error = "容量必须是2的幂";
+        return false;
+    }
+    if (!memory.create(name, sizeof(FeedRingHeader) + capacity * sizeof(FeedRecord), error)) return false;
+
+    ring = new (memory.getData()) FeedRingHeader();
+    ring->magic = FeedRingHeader::Magic;
+    ring->version = FeedRingHeader::Version;
+    ring->capacity = static_cast<uint32_t>(capacity);
+    ring->recordSize = sizeof(FeedRecord);
+    ring->head.store(0, std::memory_order_relaxed);
+    ring->tail.store(0, std::memory_order_relaxed);
+    ring->consumerActive.store(1, std::memory_order_release);
+    slots = reinterpret_cast<FeedRecord*>(memory.getData() + sizeof(FeedRingHeader));
+
+    target = &data;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = false;
+        queue.clear();
+        queuedRecords = 0;
+        backlog.clear();
+        backlogOffset = 0;
+        backlogRecords = 0;
+        stats = SharedFeedStats();
+        stats.running = true;
+        stats.name = name;
+        stats.capacity = capacity;
+        applyMsTotal = 0;
+        latencyMs.clear();
+        latencyNext = 0;
+    }
+    rateStart = Clock::now();
+    rateApplied = 0;
+    receiver = std::thread(&SharedFeed::receiveLoop, this);
+    return true;
+}
+
+void SharedFeed::stop() {
+    if (receiver.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopRequested = true;
+        }
+        wake.notify_all();
+        receiver.join();
+    }
+    if (ring) ring->consumerActive.store(0, std::memory_order_release);
+    memory.close();
+    ring = nullptr;
+    slots = nullptr;
+    target = nullptr;
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.clear();
+    queuedRecords = 0;
+    backlog.clear();
+    backlogOffset = 0;
+    backlogRecords = 0;
+    stats.running = false;
+}
+
+// [算法] 接收线程
+// 逻辑:
+//   1. 以 acquire 读取 head，把 [tail, head) 的记录拷出共享内存 (每次最多 DrainChunk 条)，
+//      随即以 release 推进 tail，生产者马上可以复用这些槽位。
+//   2. 拷出的一组记录按 (地区, 天) 稳定排序，同一地区同一天只保留最后写入的一条，
+//      UI 线程写入时每个地区的历史记录按天顺序追加，缓存友好。
+//   3. 环形缓冲区空时等待 IdleMillis 毫秒；UI 线程积压超过 MaxQueuedRecords 时暂停取数，
+//      环形缓冲区随之变满，生产者的 push() 返回 0，形成反压。
+void SharedFeed::receiveLoop() {
+    const uint32_t capacity = ring->capacity;
+    uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    std::vector<FeedRecord> chunk;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (stopRequested) return;
+            if (queuedRecords >= MaxQueuedRecords) {
+                wake.wait_for(lock, std::chrono::milliseconds(IdleMillis), [this] { return stopRequested; });
+                continue;
+            }
+        }
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        if (head == tail) {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait_for(lock, std::chrono::milliseconds(IdleMillis), [this] { return stopRequested; });
+            continue;
+        }
+        const auto received = Clock::now();
+        const size_t waiting = static_cast<size_t>(std::min<uint64_t>(head - tail, capacity));
+
+        chunk.resize(DrainChunk);
+        size_t taken = 0;
+        while (head != tail && taken < DrainChunk) {
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(std::min<uint64_t>(head - tail, capacity), DrainChunk - taken));
+            CopyOut(slots, capacity, tail, n, chunk.data() + taken);
+            taken += n;
+            tail += n;
+            ring->tail.store(tail, std::memory_order_release);
+            head = ring->head.load(std::memory_order_acquire);
+        }
+        chunk.resize(taken);
+
+        std::stable_sort(chunk.begin(), chunk.end(), [](const FeedRecord& a, const FeedRecord& b) {
+            return a.region != b.region ? a.region < b.region : a.day < b.day;
+        });
+        size_t unique = 0;
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            if (unique > 0 && chunk[unique - 1].region == chunk[i].region && chunk[unique - 1].day == chunk[i].day) {
+                chunk[unique - 1] = chunk[i]; // Later update of the same day wins
+            } else {
+                chunk[unique++] = chunk[i];
+            }
+        }
+        Batch batch;
+        batch.records.assign(chunk.begin(), chunk.begin() + unique);
+        batch.received = received;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.received += taken;
+        stats.coalesced += taken - unique;
+        stats.ringHighWater = std::max(stats.ringHighWater, waiting);
+        queuedRecords += unique;
+        queue.push_back(std::move(batch));
+    }
+}
+
+// --- Applying batches (UI thread) ---
+
+// [算法] 批次写入
+// 逻辑:
+//   新到的批次接在积压队列之后，按顺序写入 (地区下标越界、天或计数为负的记录计入 rejected)。
+//   批次按 (地区, 天) 排好序，同一地区连续的一段 (至多 1024 条) 经 upsertHistoryRecords 一次合并。
+//   约每 1024 条检查一次用时，超过 ApplyBudgetMillis 就停下，剩余部分 (可能是半个批次) 留到下一帧，
+//   大量推送时界面帧率不受影响。积压超过 BulkRecords 条时这一帧包在 begin/endBulkUpdate 之间:
+//   不逐条通知监听器，编辑日志在结束时改做一次检查点；少量更新则照常逐条记录日志。
+//   被更新的地区随后按最新状态重置模拟的初始条件。
+size_t SharedFeed::poll() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (Batch& batch : queue) {
+            backlogRecords += batch.records.size();
+            backlog.push_back(std::move(batch));
+        }
+        queue.clear();
+    }
+
+    size_t applied = 0, rejected = 0, consumed = 0;
+    const auto t0 = Clock::now();
+    if (!backlog.empty() && target) {
+        const auto budget = t0 + std::chrono::milliseconds(ApplyBudgetMillis);
+        const bool bulk = backlogRecords > BulkRecords;
+        if (bulk) target->beginBulkUpdate();
+
+        auto& regions = target->getRegions();
+        const int count = static_cast<int>(regions.size());
+        int current = -1;
+        auto resetSimulation = [&](int index) {
+            Region& region = regions[index];
+            const int removed = region.getRecoveredCases() + region.getDeaths();
+            region.simulation.reset(region.getPopulation(), region.getConfirmedCases() - removed, removed);
+        };
+        auto valid = [count](const FeedRecord& rec) {
+            return rec.region >= 0 && rec.region < count && rec.day >= 0 &&
+                   rec.confirmed >= 0 && rec.recovered >= 0 && rec.deaths >= 0;
+        };
+        std::vector<Clock::time_point> finished;
+        std::vector<HistoricalRecord> run;
+        size_t checkAt = 1023;
+        bool overBudget = false;
+        while (!backlog.empty() && !overBudget) {
+            const Batch& batch = backlog.front();
+            const size_t size = batch.records.size();
+            size_t i = backlogOffset;
+            while (i < size) {
+                if (consumed >= checkAt) {
+                    if (Clock::now() >= budget) {
+                        overBudget = true;
+                        break;
+                    }
+                    checkAt = consumed + 1024;
+                }
+                const FeedRecord& rec = batch.records[i];
+                if (!valid(rec)) {
+                    ++rejected;
+                    ++consumed;
+                    ++i;
+                    continue;
+                }
+                run.clear();
+                size_t j = i;
+                for (; j < size && j - i < 1024 && batch.records[j].region == rec.region && valid(batch.records[j]); ++j) {
+                    const FeedRecord& r = batch.records[j];
+                    run.push_back(HistoricalRecord{ r.day, r.confirmed, r.recovered, r.deaths });
+                }
+                if (rec.region != current) {
+                    if (current >= 0) resetSimulation(current);
+                    current = rec.region;
+                }
+                target->upsertHistoryRecords(rec.region, run.data(), run.size());
+                applied += run.size();
+                consumed += run.size();
+                i = j;
+            }
+            if (i < batch.records.size()) {
+                backlogOffset = i;
+            } else {
+                finished.push_back(batch.received);
+                backlog.pop_front();
+                backlogOffset = 0;
+            }
+        }
+        if (current >= 0) resetSimulation(current);
+        if (bulk) target->endBulkUpdate();
+        backlogRecords -= consumed;
+
+        const auto now = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queuedRecords -= consumed;
+            stats.applied += applied;
+            stats.rejected += rejected;
+            stats.batches++;
+            if (bulk) stats.bulkBatches++;
+            stats.lastApplyMs = std::chrono::duration<double, std::milli>(now - t0).count();
+            applyMsTotal += stats.lastApplyMs;
+            if (latencyMs.size() < kLatencyRing) latencyMs.resize(kLatencyRing);
+            for (const auto& received : finished) {
+                latencyMs[latencyNext % kLatencyRing] = std::chrono::duration<float, std::milli>(now - received).count();
+                ++latencyNext;
+            }
+        }
+        wake.notify_all();
+    }
+
+    rateApplied += applied;
+    const double window = std::chrono::duration<double>(Clock::now() - rateStart).count();
+    if (window >= 1.0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.recordsPerSecond = rateApplied / window;
+        rateApplied = 0;
+        rateStart = Clock::now();
+    }
+    return applied;
+}
+
+SharedFeedStats SharedFeed::getStats() {
+    SharedFeedStats copy;
+    std::vector<float> samples;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        copy = stats;
+        copy.queued = queuedRecords;
+        if (stats.batches > 0) copy.meanApplyMs = applyMsTotal / stats.batches;
+        samples.assign(latencyMs.begin(), latencyMs.begin() + std::min(latencyNext, latencyMs.size()));
+    }
+    copy.latencyP50Ms = Percentile(samples, 0.50);
+    copy.latencyP99Ms = Percentile(samples, 0.99);
+    return copy;
+}
+
+// --- Benchmark ---
+
+// [算法] 端到端吞吐基准测试
+// 逻辑:
+//   建立 regions 个空地区的数据集并以独立的名称启动通道。生产者线程经由共享内存 (与外部进程
+//   相同的 open/push 路径) 逐天为所有地区推送累计数，缓冲区满时让出 CPU 后重试；
+//   本线程模拟 UI，每 16 ms 调用一次 poll()。吞吐 = 记录数 / (首次推送 -> 最后一条写入数据模型)。
+//   结束后逐个地区核对全部记录。
+SharedFeedBenchmarkResult SharedFeed::RunBenchmark(size_t regions, int days) {
+    SharedFeedBenchmarkResult result;
+    result.regions = regions;
+    result.days = days;
+    const size_t total = regions * static_cast<size_t>(days);
+
+    EpidemicData data;
+    data.clearRegions();
+    data.reserveRegions(regions);
+    char name[32];
+    for (size_t r = 0; r < regions; ++r) {
+        std::snprintf(name, sizeof(name), "Feed %zu", r);
+        data.addRegion(name, 1000000, 0, 0, 0);
+    }
+#ifdef _WIN32
+    const std::string channel = "EpidemicFeedBench" + std::to_string(GetCurrentProcessId());
+#else
+    const std::string channel = "EpidemicFeedBench" + std::to_string(getpid());
+#endif
+    SharedFeed feed;
+    if (!feed.start(data, channel, DefaultCapacity, &result.error)) return result;
+    SharedFeedProducer producer;
+    if (!producer.open(channel, &result.error)) return result;
+
+    auto valueOf = [](size_t region, int day) { return static_cast<int>(region % 97 + 1) * (day + 1); };
+    const auto t0 = Clock::now();
+    std::atomic<bool> produced(false);
+    std::atomic<bool> abandon(false);
+    std::thread writer([&] {
+        std::vector<FeedRecord> block(4096);
+        size_t filled = 0;
+        auto flush = [&] {
+            for (size_t sent = 0; sent < filled;) {
+                const size_t n = producer.push(block.data() + sent, filled - sent);
+                if (n == 0) {
+                    if (abandon) return;
+                    std::this_thread::yield();
+                }
+                sent += n;
+            }
+            filled = 0;
+        };
+        for (int day = 0; day < days; ++day) {
+            for (size_t r = 0; r < regions; ++r) {
+                const int c = valueOf(r, day);
+                block[filled++] = FeedRecord{ static_cast<int32_t>(r), day, c, c / 2, c / 50 };
+                if (filled == block.size()) flush();
+            }
+        }
+        flush();
+        result.producerSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+        produced = true;
+    });
+
+    double maxApplyMs = 0;
+    const auto deadline = t0 + std::chrono::seconds(60);
+    auto finished = t0;
+    for (;;) {
+        const auto frame = Clock::now();
+        feed.poll();
+        maxApplyMs = std::max(maxApplyMs, std::chrono::duration<double, std::milli>(Clock::now() - frame).count());
+        SharedFeedStats stats = feed.getStats();
+        if (produced && stats.received >= total && stats.applied + stats.rejected + stats.coalesced >= total) {
+            finished = Clock::now();
+            break;
+        }
+        if (Clock::now() > deadline) {
+            result.error = "超时: 数据没有全部写入";
+            abandon = true;
+            break;
+        }
+        std::this_thread::sleep_until(frame + std::chrono::milliseconds(16));
+    }
+    writer.join();
+    SharedFeedStats stats = feed.getStats();
+    producer.close();
+    feed.stop();
+
+    const auto& all = data.getRegions();
+    bool ok = result.error.empty() && stats.rejected == 0;
+    for (size_t r = 0; ok && r < regions; ++r) {
+        const auto& h = all[r].history;
+        ok = h.size() == static_cast<size_t>(days);
+        for (int d = 0; ok && d < days; ++d) {
+            const int c = valueOf(r, d);
+            ok = h[d].day == d && h[d].confirmed == c && h[d].recovered == c / 2 && h[d].deaths == c / 50;
+        }
+    }
+    result.verified = ok;
+    result.records = stats.applied;
+    result.producerRecordsPerSecond = result.producerSeconds > 0 ? total / result.producerSeconds : 0.0;
+    result.totalSeconds = std::chrono::duration<double>(finished - t0).count();
+    result.recordsPerSecond = result.totalSeconds > 0 ? stats.applied / result.totalSeconds : 0.0;
+    result.meanApplyMs = stats.meanApplyMs;
+    result.maxApplyMs = maxApplyMs;
+    result.valid = result.error.empty() && stats.applied > 0;
+    if (!result.valid && result.error.empty()) result.error = "没有收到任何记录";
+    return result;
+}
@@ -0,0 +1,225 @@
+// ====================================================================================
+// 模块名称: SharedFeed (共享内存数据通道)
+// 功能描述:
+//   外部 ETL 进程不经过文件或套接字，直接把每日更新写进一块命名共享内存
+//   (Windows 下为 CreateFileMapping 命名映射，其他平台为 POSIX shm_open)。
+//   共享内存是单生产者/单消费者的环形缓冲区，元素为定长的 FeedRecord
+//   (地区下标、天、确诊、治愈、死亡)，头尾位置各占一条缓存行，读写双方都不加锁。
+//   接收线程持续取空环形缓冲区，把记录按 (地区, 天) 排序并合并同一天的重复更新；
+//   UI 线程每帧调用 poll() 把整理好的批次写入 EpidemicData。
+//
+//   生产者: SharedFeedProducer::open(name) 后反复调用 push()，返回实际写入的条数
+//   (缓冲区满时少于请求数，由生产者决定重试或等待)。其他语言的生产者按下面的
+//   FeedRingHeader / FeedRecord 布局直接读写同一块内存即可。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] FeedRecord
+// 描述: 一条更新记录 (20 字节，小端)，对应地区某一天的累计数
+// ------------------------------------------------------------------------------------
+struct FeedRecord {
+    int32_t region;     // Index into EpidemicData::getRegions()
+    int32_t day;
+    int32_t confirmed;
+    int32_t recovered;
+    int32_t deaths;
+};
+static_assert(sizeof(FeedRecord) == 20, "FeedRecord is part of the shared-memory layout");
+
+// ------------------------------------------------------------------------------------
+// [结构体] FeedRingHeader
+// 描述: 共享内存开头的环形缓冲区头，记录数组紧随其后 (偏移 sizeof(FeedRingHeader))
+// 作用:
+//   head/tail 是单调递增的记录序号，下标为 序号 & (capacity - 1)。
+//   生产者写好记录后以 release 语义推进 head；消费者读完后以 release 语义推进 tail。
+// ------------------------------------------------------------------------------------
+struct FeedRingHeader {
+    static constexpr uint32_t Magic = 0x44465045;  // "EPFD"
+    static constexpr uint32_t Version = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;                          // Records, power of two
+    uint32_t recordSize;                        // sizeof(FeedRecord)
+    std::atomic<uint32_t> consumerActive;       // Cleared when the app stops reading
+    alignas(64) std::atomic<uint64_t> head;     // Written by the producer only
+    alignas(64) std::atomic<uint64_t> tail;     // Written by the consumer only
+    alignas(64) char reserved[64];
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring positions must be address-free atomics");
+
+// ------------------------------------------------------------------------------------
+// [类] SharedMemory
+// 描述: RAII 封装的命名共享内存 (可读写)
+// 作用: create() 由应用 (消费者) 调用并负责销毁名称；open() 由生产者调用，映射已存在的共享内存。
+// ------------------------------------------------------------------------------------
+class SharedMemory {
+public:
+    SharedMemory();
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    bool create(const std::string& name, size_t size, std::string* error = nullptr);
+    bool open(const std::string& name, std::string* error = nullptr);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    unsigned char* getData() const { return data; }
+    size_t getSize() const { return size; }
+
+private:
+    unsigned char* data;
+    size_t size;
+    bool owner;
+    std::string systemName;
+#ifdef _WIN32
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+};
+
+// ------------------------------------------------------------------------------------
+// [类] SharedFeedProducer
+// 描述: 生产者一端 (ETL 进程或基准测试)
+// ------------------------------------------------------------------------------------
+class SharedFeedProducer {
+public:
+    SharedFeedProducer();
+
+    bool open(const std::string& name, std::string* error = nullptr);
+    void close();
+    bool isOpen() const { return ring != nullptr; }
+    bool isConsumerActive() const;
+
+    // Non-blocking: copies as many records as fit and returns how many were written
+    size_t push(const FeedRecord* records, size_t count);
+
+private:
+    SharedMemory memory;
+    FeedRingHeader* ring;
+    FeedRecord* slots;
+    uint64_t head;              // Local copy: only this producer advances it
+    uint64_t cachedTail;        // Last tail seen; re-read only when the ring looks full
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] SharedFeedStats
+// 描述: 通道状态与吞吐/延迟统计 (UI 每帧读取)
+// ------------------------------------------------------------------------------------
+struct SharedFeedStats {
+    bool running = false;
+    std::string name;
+    size_t capacity = 0;
+    size_t received = 0;            // Records taken out of the ring
+    size_t coalesced = 0;           // Of which superseded by a later update of the same region and day
+    size_t applied = 0;             // Written to the data model
+    size_t rejected = 0;            // Unknown region index, negative day or count
+    size_t batches = 0;             // poll() calls that applied something
+    size_t bulkBatches = 0;         // Of which large enough to go through begin/endBulkUpdate
+    size_t ringHighWater = 0;       // Most records seen waiting in the ring
+    size_t queued = 0;              // Sorted records waiting for the UI thread
+    double lastApplyMs = 0;
+    double meanApplyMs = 0;
+    double latencyP50Ms = 0;        // Taken out of the ring -> applied to the data model
+    double latencyP99Ms = 0;
+    double recordsPerSecond = 0;    // Applied, over the last second
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] SharedFeedBenchmarkResult
+// 描述: 基准测试: 生产者线程经由共享内存为每个地区逐天推送累计数，
+//       "UI 线程" 以 60 帧/秒调用 poll()，测量端到端吞吐
+// ------------------------------------------------------------------------------------
+struct SharedFeedBenchmarkResult {
+    bool valid = false;
+    std::string error;
+    size_t regions = 0;
+    int days = 0;
+    size_t records = 0;
+    double producerSeconds = 0;
+    double producerRecordsPerSecond = 0;   // push() rate, including waits on a full ring
+    double totalSeconds = 0;               // First push -> last record applied
+    double recordsPerSecond = 0;           // End to end
+    double meanApplyMs = 0;                // UI-thread time per frame that applied records
+    double maxApplyMs = 0;
+    bool verified = false;                 // Every region ends with exactly the pushed records
+};
+
+// ------------------------------------------------------------------------------------
+// [类] SharedFeed
+// 描述: 共享内存数据通道的消费者一端
+// 作用:
+//   start() 创建共享内存并启动接收线程；poll() 在 UI 线程每帧调用，每帧最多占用 ApplyBudgetMillis 毫秒，
+//   积压较多时放在 begin/endBulkUpdate 之间写入，编辑日志改为整体检查点而不是逐条记录。
+// ------------------------------------------------------------------------------------
+class SharedFeed {
+public:
+    static constexpr size_t DefaultCapacity = 1 << 20;       // Records (20 MB)
+    static constexpr size_t DrainChunk = 1 << 16;            // Records sorted and handed over at a time
+    static constexpr size_t MaxQueuedRecords = 8 << 20;      // Beyond this the ring fills and the producer waits
+    static constexpr size_t BulkRecords = 16384;
+    static constexpr int IdleMillis = 1;
+    static constexpr int ApplyBudgetMillis = 4;              // UI time per poll(); the rest waits for the next frame
+
+    SharedFeed();
+    ~SharedFeed();
+
+    bool start(EpidemicData& data, const std::string& name, size_t capacity = DefaultCapacity, std::string* error = nullptr);
+    void stop();
+    bool isRunning() const { return receiver.joinable(); }
+
+    // UI thread, once per frame. Returns the number of records applied
+    size_t poll();
+    SharedFeedStats getStats();
+
+    // Producer thread and consumer in this process, on the calling thread
+    static SharedFeedBenchmarkResult RunBenchmark(size_t regions, int days);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Batch {
+        std::vector<FeedRecord> records;    // Sorted by (region, day), one record per pair
+        Clock::time_point received;
+    };
+
+    void receiveLoop();
+
+    EpidemicData* target;
+    SharedMemory memory;
+    FeedRingHeader* ring;
+    FeedRecord* slots;
+
+    std::thread receiver;
+    std::mutex mutex;                                 // Guards queue, queuedRecords and stats
+    std::condition_variable wake;
+    bool stopRequested;
+    std::vector<Batch> queue;
+    size_t queuedRecords;                             // In queue and backlog: the receiver stops draining above MaxQueuedRecords
+    SharedFeedStats stats;
+    double applyMsTotal;
+    std::vector<float> latencyMs;                     // Ring of the most recent batch latencies
+    size_t latencyNext;
+    Clock::time_point rateStart;                      // Window for recordsPerSecond
+    size_t rateApplied;
+
+    std::deque<Batch> backlog;                        // UI thread only: batches taken from queue, not yet fully applied
+    size_t backlogOffset;                             // Records of backlog.front() already applied
+    size_t backlogRecords;
+};
@@ -0,0 +1,132 @@
+// ====================================================================================
+// 模块名称: SnapshotSaver Implementation
+// 功能描述:
+//   UI线程截取快照并计时，写出线程持有快照直到文件落盘，然后释放 (释放后被共享的
+//   历史缓冲区才允许再被原地修改)。
+// ====================================================================================
+
+#include "SnapshotSaver.h"
+#include "ColumnarStore.h"
+#include <chrono>
+#include <filesystem> // For std::filesystem::file_size
+
+SnapshotSaver::SnapshotSaver() : running(false) {}
+
+SnapshotSaver::~SnapshotSaver() {
+    wait();
+}
+
+bool SnapshotSaver::start(EpidemicData& data, const std::string& path, uint64_t journalSequence) {
+    if (running) return false;
+    if (worker.joinable()) worker.join();
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::shared_ptr<DataSnapshot> snapshot = data.captureSnapshot();
+    double pauseMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    running = true;
+    worker = std::thread([this, snapshot = std::move(snapshot), path, journalSequence, pauseMs]() mutable {
+        SnapshotSaveResult r;
+        r.path = path;
+        r.regions = snapshot->rows.size();
+        r.records = snapshot->recordCount;
+        r.journalSequence = journalSequence;
+        r.pauseMs = pauseMs;
+
+        auto t1 = std::chrono::steady_clock::now();
+        r.valid = ColumnarStore::Write(path.c_str(), *snapshot, &r.error, journalSequence);
+        snapshot.reset(); // Edits may now modify the shared histories in place again
+        r.writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+
+        std::error_code ec;
+        if (r.valid) r.bytes = static_cast<size_t>(std::filesystem::file_size(path, ec));
+        if (r.writeSeconds > 0) r.megabytesPerSecond = r.bytes / 1048576.0 / r.writeSeconds;
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        result = r;
+        running = false;
+    });
+    return true;
+}
+
+bool SnapshotSaver::isRunning() const {
+    return running;
+}
+
+void SnapshotSaver::wait() {
+    if (worker.joinable()) worker.join();
+}
+
+SnapshotSaveResult SnapshotSaver::getResult() {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    return result;
+}
+
+// --- SnapshotLoader ---
+
+SnapshotLoader::SnapshotLoader() : finished(false), running(false) {}
+
+SnapshotLoader::~SnapshotLoader() {
+    if (worker.joinable()) worker.join();
+}
+
+bool SnapshotLoader::start(const std::string& path) {
+    if (running) return false;
+    if (worker.joinable()) worker.join();
+
+    running = true;
+    worker = std::thread([this, path] {
+        SnapshotLoadResult r;
+        r.path = path;
+        std::unique_ptr<EpidemicData> data;
+
+        auto t0 = std::chrono::steady_clock::now();
+        ColumnarStore store;
+        if (store.open(path.c_str(), &r.error) && store.verify(&r.error)) {
+            data.reset(new EpidemicData());
+            store.materialize(*data);
+            r.valid = true;
+            r.regions = store.getRegionCount();
+            r.records = store.getRecordCount();
+            r.bytes = store.getFileSize();
+        }
+        store.close();
+        r.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (r.loadSeconds > 0) r.megabytesPerSecond = r.bytes / 1048576.0 / r.loadSeconds;
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        result = r;
+        loaded = std::move(data);
+        finished = true;
+    });
+    return true;
+}
+
+bool SnapshotLoader::isRunning() const {
+    return running;
+}
+
+bool SnapshotLoader::poll(EpidemicData& data) {
+    std::unique_ptr<EpidemicData> ready;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        if (!finished) return false;
+        finished = false;
+        ready = std::move(loaded);
+    }
+    if (ready) {
+        auto t0 = std::chrono::steady_clock::now();
+        data.adoptRegions(*ready);
+        ready.reset(); // Only the emptied model and the previous arena (unless a snapshot holds it) are freed
+        const double swapMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        std::lock_guard<std::mutex> lock(resultMutex);
+        result.swapMs = swapMs;
+    }
+    running = false;
+    return true;
+}
+
+SnapshotLoadResult SnapshotLoader::getResult() {
+    std::lock_guard<std::mutex> lock(resultMutex);
+    return result;
+}
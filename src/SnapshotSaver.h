@@ -0,0 +1,102 @@
+// ====================================================================================
+// 模块名称: SnapshotSaver (后台会话保存与载入)
+// 功能描述:
+//   在UI线程上截取 EpidemicData 的写时复制快照 (只复制名称和当前计数，历史记录共享)，
+//   然后在后台线程把快照写成带校验和的列式文件 (ColumnarStore)。
+//   写出期间用户可以继续编辑: 被修改的地区会先复制一份，快照看到的仍是截取时的数据。
+//   载入反过来: 后台线程映射、校验并构建一份完整的 EpidemicData，UI 线程只做整体换入。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// ------------------------------------------------------------------------------------
+// [结构体] SnapshotSaveResult
+// 描述: 一次保存的结果与耗时
+// ------------------------------------------------------------------------------------
+struct SnapshotSaveResult {
+    bool valid = false;
+    std::string error;
+    std::string path;
+    size_t regions = 0;
+    size_t records = 0;
+    size_t bytes = 0;
+    uint64_t journalSequence = 0;
+    double pauseMs = 0;             // UI-thread time spent capturing the snapshot
+    double writeSeconds = 0;        // Background serialization + fsync + replace
+    double megabytesPerSecond = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [类] SnapshotSaver
+// 描述: 后台快照写出器
+// 作用:
+//   start() 在UI线程截取快照并启动写出线程 (上一次尚未完成时返回 false)；
+//   UI 通过 isRunning()/getResult() 轮询。同一时间只写一个文件。
+// ------------------------------------------------------------------------------------
+class SnapshotSaver {
+public:
+    SnapshotSaver();
+    ~SnapshotSaver();
+
+    bool start(EpidemicData& data, const std::string& path, uint64_t journalSequence = 0);
+    bool isRunning() const;
+    void wait();
+    SnapshotSaveResult getResult();
+
+private:
+    std::thread worker;
+    std::mutex resultMutex;
+    SnapshotSaveResult result;
+    std::atomic<bool> running;
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] SnapshotLoadResult
+// 描述: 一次载入的结果与耗时
+// ------------------------------------------------------------------------------------
+struct SnapshotLoadResult {
+    bool valid = false;
+    std::string error;
+    std::string path;
+    size_t regions = 0;
+    size_t records = 0;
+    size_t bytes = 0;
+    double loadSeconds = 0;         // Background map + verify + materialize
+    double megabytesPerSecond = 0;
+    double swapMs = 0;              // UI-thread time taking the regions over
+};
+
+// ------------------------------------------------------------------------------------
+// [类] SnapshotLoader
+// 描述: 后台会话载入器
+// 作用:
+//   start() 启动载入线程: 映射并校验列式文件，再 materialize 到一份新的 EpidemicData
+//   (校验与历史复制照常经由 ThreadPool 并行)。UI 每帧调用 poll()，载入成功时在 UI 线程用
+//   EpidemicData::adoptRegions 把它换入目标数据并返回 true；失败时同样返回 true，结果里带错误信息。
+// ------------------------------------------------------------------------------------
+class SnapshotLoader {
+public:
+    SnapshotLoader();
+    ~SnapshotLoader();
+
+    bool start(const std::string& path);    // False while a load is still running or waiting for poll()
+    bool isRunning() const;                 // From start() until poll() has taken the load
+    bool poll(EpidemicData& data);          // UI thread; true once per finished load
+    SnapshotLoadResult getResult();
+
+private:
+    std::thread worker;
+    std::mutex resultMutex;
+    SnapshotLoadResult result;
+    std::unique_ptr<EpidemicData> loaded;   // Finished load, not yet taken over
+    bool finished;                          // Guarded by resultMutex
+    std::atomic<bool> running;
+};
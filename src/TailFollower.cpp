@@ -0,0 +1,427 @@
+// ====================================================================================
+// 模块名称: TailFollower Implementation
+// 功能描述:
+//   读取线程 (文件增长检测、按行切分、增量解析)、UI 线程批次应用 (逐条合并 upsert 或批量导入)、
+//   名称索引维护，以及端到端延迟基准测试。
+// ====================================================================================
+
+#include "TailFollower.h"
+#include <algorithm>  // For std::nth_element, std::min
+#include <cstdio>
+#include <cstring>    // For std::strcmp
+#include <filesystem> // For std::filesystem::file_size, temp_directory_path
+
+namespace {
+
+const size_t kLatencyRing = 1024;
+
+double Percentile(std::vector<float>& values, double q) {
+    if (values.empty()) return 0;
+    size_t k = std::min(values.size() - 1, static_cast<size_t>(q * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+bool SeekFile(std::FILE* f, uint64_t offset) {
+#ifdef _WIN32
+    return _fseeki64(f, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(f, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+// Appends up to `bytes` bytes starting at `offset` to out; returns the number read
+size_t ReadRange(const std::string& path, uint64_t offset, size_t bytes, std::string& out) {
+    std::FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return 0;
+    size_t got = 0;
+    if (SeekFile(f, offset)) {
+        const size_t base = out.size();
+        out.resize(base + bytes);
+        got = std::fread(&out[base], 1, bytes, f);
+        out.resize(base + got);
+    }
+    std::fclose(f);
+    return got;
+}
+
+} // namespace
+
+TailFollower::TailFollower()
+    : target(nullptr), nameIndexValid(false), generation(0), bulkGeneration(0),
+      stopRequested(false), applyMsTotal(0), latencyNext(0) {}
+
+TailFollower::~TailFollower() {
+    stop();
+}
+
+bool TailFollower::start(EpidemicData& data, const std::string& path, const CsvImportOptions& options, std::string* error) {
+    stop();
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        if (error) *error = "文件不存在: " + path;
+        return false;
+    }
+    target = &data;
+    target->addChangeListener(this);
+    nameIndexValid = false;
+    regionGeneration.assign(data.getRegions().size(), 0);
+    changed.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = false;
+        queue.clear();
+        stats = TailFollowStats();
+        stats.following = true;
+        stats.path = path;
+        applyMsTotal = 0;
+        latencyMs.clear();
+        latencyNext = 0;
+    }
+    reader = std::thread(&TailFollower::readerLoop, this, path, options);
+    return true;
+}
+
+void TailFollower::stop() {
+    if (reader.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopRequested = true;
+        }
+        wake.notify_all();
+        reader.join();
+    }
+    if (target) {
+        target->removeChangeListener(this);
+        target = nullptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    queue.clear();
+    stats.following = false;
+}
+
+// [算法] 增量读取 (Tail Follow)
+// 逻辑:
+//   1. 每 PollMillis 毫秒取一次文件大小；变小说明文件被重写，从头重新读取 (保留日期原点)。
+//   2. 变大时只读取 [offset, size) 的新字节 (单次最多 MaxReadBytes)，拼在上次剩下的半行之后。
+//   3. 第一行是表头，保存下来；之后只把完整的行 (到最后一个换行符为止) 接在表头后面交给
+//      CsvImporter::Parse，不完整的末行留到下一次。
+//   4. 第一批确定日期原点后固定下来，之后各批次的天数与首批 (即整个文件导入) 一致。
+void TailFollower::readerLoop(std::string path, CsvImportOptions options) {
+    uint64_t offset = 0;
+    std::string header;
+    std::string buffer;   // Partial last line carried over, followed by the new bytes
+    std::string text;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (stopRequested) return;
+        }
+        std::error_code ec;
+        const uint64_t size = std::filesystem::file_size(path, ec);
+        if (!ec && size < offset) {
+            offset = 0;
+            header.clear();
+            buffer.clear();
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.truncations++;
+        }
+        if (ec || size == offset) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (ec) stats.error = "无法读取文件: " + path;
+            wake.wait_for(lock, std::chrono::milliseconds(PollMillis), [this] { return stopRequested; });
+            continue;
+        }
+
+        const Clock::time_point detected = Clock::now();
+        const size_t want = static_cast<size_t>(std::min<uint64_t>(size - offset, MaxReadBytes));
+        const size_t got = ReadRange(path, offset, want, buffer);
+        offset += got;
+
+        size_t begin = 0;
+        if (header.empty()) {
+            size_t nl = buffer.find('\n');
+            if (nl == std::string::npos) continue;
+            header.assign(buffer, 0, nl);
+            begin = nl + 1;
+        }
+        size_t last = buffer.rfind('\n');
+        if (last == std::string::npos || last < begin) {
+            buffer.erase(0, begin);
+            continue;
+        }
+        text.assign(header);
+        text.push_back('\n');
+        text.append(buffer, begin, last + 1 - begin);
+        buffer.erase(0, last + 1);
+
+        Batch batch;
+        batch.result = CsvImporter::Parse(text.data(), text.size(), options);
+        batch.detected = detected;
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.offset = offset - buffer.size();
+        if (!batch.result.valid) {
+            stats.error = batch.result.error;
+            continue;
+        }
+        stats.error.clear();
+        if (options.dateOrigin == INT_MIN) options.dateOrigin = batch.result.dateOrigin;
+        queue.push_back(std::move(batch));
+    }
+}
+
+// --- Applying batches (UI thread) ---
+
+size_t TailFollower::poll() {
+    changed.clear();
+    std::vector<Batch> batches;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batches.swap(queue);
+    }
+    if (batches.empty() || !target) return 0;
+
+    ++generation;
+    for (Batch& batch : batches) {
+        auto t0 = Clock::now();
+        const size_t rows = batch.result.rows;
+        const size_t before = changed.size();
+        size_t records = batch.result.records;
+        bool bulk = false;
+        if (batch.result.records > BulkRecords) {
+            // onBulkChange() marks every region as changed
+            CsvImporter::Apply(batch.result, *target, false);
+            bulk = true;
+        } else {
+            records = 0;
+            for (const auto& r : batch.result.regions) records += r.history.size();
+            applyIncremental(batch.result);
+        }
+        auto now = Clock::now();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.batches++;
+        if (bulk) stats.bulkBatches++;
+        stats.rows += rows;
+        stats.records += records;
+        stats.lastRegions = bulk ? target->getRegions().size() : changed.size() - before;
+        stats.lastApplyMs = std::chrono::duration<double, std::milli>(now - t0).count();
+        applyMsTotal += stats.lastApplyMs;
+        if (latencyMs.size() < kLatencyRing) latencyMs.resize(kLatencyRing);
+        latencyMs[latencyNext % kLatencyRing] = std::chrono::duration<float, std::milli>(now - batch.detected).count();
+        ++latencyNext;
+    }
+    return changed.size();
+}
+
+// [算法] 增量合并
+// 逻辑:
+//   逐个地区按名称找到下标 (新名称则添加地区)，逐条记录与已有的同一天合并:
+//   文件没有提供的字段保留原值，新的一天则沿用前一天的累计值 (与 CsvImporter::Apply 的合并规则一致)。
+//   与已有记录完全相同的记录跳过，因此重新读取已导入过的文件不会产生多余的编辑日志。
+//   一个地区的改动收集后经 upsertHistoryRecords 一次合并，编辑日志照常逐条记录；只有被修改的地区重置模拟状态。
+void TailFollower::applyIncremental(CsvImportResult& result) {
+    char name[sizeof(Region::name)];
+    std::vector<HistoricalRecord> changes;
+    for (auto& incoming : result.regions) {
+        if (incoming.history.empty() && incoming.population <= 0) continue;
+        CsvImporter::CopyRegionName(incoming.name, name, sizeof(name));
+        int index = findRegion(name);
+        if (index < 0) {
+            HistoricalRecord last = incoming.history.empty() ? HistoricalRecord{ 0, 0, 0, 0 } : incoming.history.back();
+            target->addRegion(name, incoming.population, last.confirmed, last.recovered, last.deaths);
+            index = static_cast<int>(target->getRegions().size()) - 1;
+        }
+
+        // Incoming days are sorted: a new day carries forward the previous record, which may itself be incoming
+        changes.clear();
+        const HistorySeries& history = target->getRegions()[index].history;
+        for (const HistoricalRecord& rec : incoming.history) {
+            const size_t at = history.lowerBound(rec.day);
+            const bool exists = at < history.size() && history[at].day == rec.day;
+            HistoricalRecord merged = exists ? history[at] : HistoricalRecord{ 0, 0, 0, 0 };
+            if (!exists) {
+                if (!changes.empty() && (at == 0 || changes.back().day >= history[at - 1].day)) merged = changes.back();
+                else if (at > 0) merged = history[at - 1];
+            }
+            merged.day = rec.day;
+            if (result.fields & CsvField_Confirmed) merged.confirmed = rec.confirmed;
+            if (result.fields & CsvField_Recovered) merged.recovered = rec.recovered;
+            if (result.fields & CsvField_Deaths) merged.deaths = rec.deaths;
+            if (exists && merged.confirmed == history[at].confirmed && merged.recovered == history[at].recovered &&
+                merged.deaths == history[at].deaths) {
+                continue;
+            }
+            changes.push_back(merged);
+        }
+        bool modified = !changes.empty();
+        target->upsertHistoryRecords(index, changes.data(), changes.size());
+        Region& region = target->getRegions()[index];
+        if (incoming.population > 0 && incoming.population != region.getPopulation()) {
+            target->setRegionPopulation(index, incoming.population);
+            modified = true;
+        }
+        if (!modified) continue;
+        const int removed = region.getRecoveredCases() + region.getDeaths();
+        region.simulation.reset(region.getPopulation(), region.getConfirmedCases() - removed, removed);
+        markChanged(index);
+    }
+}
+
+int TailFollower::findRegion(const char* name) {
+    auto& regions = target->getRegions();
+    if (!nameIndexValid) {
+        nameIndex.clear();
+        nameIndex.reserve(regions.size());
+        for (size_t i = 0; i < regions.size(); ++i) nameIndex.emplace(regions[i].name, static_cast<int>(i));
+        nameIndexValid = true;
+    }
+    auto it = nameIndex.find(name);
+    return it == nameIndex.end() ? -1 : it->second;
+}
+
+void TailFollower::markChanged(int index) {
+    if (regionGeneration.size() <= static_cast<size_t>(index)) regionGeneration.resize(index + 1, 0);
+    regionGeneration[index] = generation;
+    changed.push_back(index);
+}
+
+uint64_t TailFollower::getRegionGeneration(int index) const {
+    uint64_t own = (index >= 0 && static_cast<size_t>(index) < regionGeneration.size()) ? regionGeneration[index] : 0;
+    return std::max(own, bulkGeneration);
+}
+
+TailFollowStats TailFollower::getStats() {
+    TailFollowStats copy;
+    std::vector<float> samples;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        copy = stats;
+        if (stats.batches > 0) copy.meanApplyMs = applyMsTotal / stats.batches;
+        samples.assign(latencyMs.begin(), latencyMs.begin() + std::min(latencyNext, latencyMs.size()));
+    }
+    copy.latencyP50Ms = Percentile(samples, 0.50);
+    copy.latencyP99Ms = Percentile(samples, 0.99);
+    copy.latencyMaxMs = samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+    return copy;
+}
+
+// --- DataChangeListener ---
+
+void TailFollower::onRegionAdded(int index, const Region& region) {
+    if (nameIndexValid) nameIndex.emplace(region.name, index);
+    if (regionGeneration.size() < static_cast<size_t>(index)) regionGeneration.resize(index, 0);
+    regionGeneration.insert(regionGeneration.begin() + index, 0);
+}
+
+void TailFollower::onRegionDeleted(int index) {
+    nameIndexValid = false;
+    // Mirrors the data model: the later regions bring their entries along
+    if (static_cast<size_t>(index) < regionGeneration.size()) regionGeneration.erase(regionGeneration.begin() + index);
+}
+
+void TailFollower::onRegionRenamed(int /*index*/, const char* /*name*/) {
+    nameIndexValid = false;
+}
+
+void TailFollower::onBulkChange() {
+    nameIndexValid = false;
+    regionGeneration.assign(target ? target->getRegions().size() : 0, 0);
+    bulkGeneration = generation;
+}
+
+// --- Benchmark ---
+
+// [算法] 端到端延迟基准测试
+// 逻辑:
+//   在临时目录建立长表文件并开始跟踪一个空数据集。写入线程每 intervalMillis 毫秒
+//   为所有地区追加一天 (一次 fwrite + fflush) 并记下写入时刻；本线程模拟 UI，
+//   每 16 ms 调用一次 poll()，最后一个地区拿到某一天的记录即视为这一天全部可见，
+//   延迟 = 可见时刻 - 写入时刻。结束后逐个地区核对记录。
+TailFollowBenchmarkResult TailFollower::RunBenchmark(size_t regions, int ticks, int intervalMillis) {
+    namespace fs = std::filesystem;
+    TailFollowBenchmarkResult result;
+    result.regions = regions;
+    result.ticks = ticks;
+    std::error_code ec;
+    fs::path directory = fs::temp_directory_path(ec);
+    if (ec) directory = ".";
+    const std::string path = (directory / "epidemic_tail_bench.csv").string();
+
+    std::FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        result.error = "无法创建文件: " + path;
+        return result;
+    }
+    std::fputs("region,day,confirmed,recovered,deaths\n", f);
+    std::fflush(f);
+
+    auto valueOf = [](size_t region, int day) { return static_cast<int>(region % 97 + 1) * (day + 1); };
+    std::vector<Clock::time_point> written(ticks);
+    std::atomic<int> writtenTicks(0);
+    std::thread writer([&] {
+        std::string lines;
+        char line[96];
+        for (int day = 0; day < ticks; ++day) {
+            lines.clear();
+            for (size_t r = 0; r < regions; ++r) {
+                const int c = valueOf(r, day);
+                int n = std::snprintf(line, sizeof(line), "Feed %zu,%d,%d,%d,%d\n", r, day, c, c / 2, c / 50);
+                lines.append(line, n);
+            }
+            std::fwrite(lines.data(), 1, lines.size(), f);
+            std::fflush(f);
+            written[day] = Clock::now();
+            writtenTicks.store(day + 1, std::memory_order_release);
+            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMillis));
+        }
+    });
+
+    EpidemicData data;
+    data.clearRegions();
+    TailFollower follower;
+    CsvImportOptions options;
+    options.layout = CsvLayout::Long;
+    follower.start(data, path, options, &result.error);
+
+    std::vector<float> latencies;
+    int visible = 0;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(static_cast<long long>(ticks) * intervalMillis + 5000);
+    while (visible < ticks && Clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(16));
+        follower.poll();
+        const auto now = Clock::now();
+        auto& all = data.getRegions();
+        if (all.size() < regions || all[regions - 1].history.empty()) continue;
+        const int lastDay = all[regions - 1].history.back().day;
+        const int ready = std::min(lastDay + 1, writtenTicks.load(std::memory_order_acquire));
+        for (; visible < ready; ++visible) {
+            latencies.push_back(std::chrono::duration<float, std::milli>(now - written[visible]).count());
+        }
+    }
+    writer.join();
+    std::fclose(f);
+    TailFollowStats stats = follower.getStats();
+    follower.stop();
+    fs::remove(path, ec);
+
+    const auto& all = data.getRegions();
+    bool ok = all.size() == regions && visible == ticks;
+    for (size_t r = 0; ok && r < regions; ++r) {
+        const auto& h = all[r].history;
+        ok = h.size() == static_cast<size_t>(ticks);
+        for (int d = 0; ok && d < ticks; ++d) {
+            const int c = valueOf(r, d);
+            ok = h[d].day == d && h[d].confirmed == c && h[d].recovered == c / 2 && h[d].deaths == c / 50;
+        }
+    }
+    result.verified = ok;
+    result.records = stats.records;
+    result.meanApplyMs = stats.meanApplyMs;
+    result.latencyP50Ms = Percentile(latencies, 0.50);
+    result.latencyP99Ms = Percentile(latencies, 0.99);
+    result.latencyMaxMs = latencies.empty() ? 0.0 : *std::max_element(latencies.begin(), latencies.end());
+    result.valid = !latencies.empty();
+    if (!result.valid && result.error.empty()) result.error = "没有检测到追加的数据";
+    return result;
+}
@@ -0,0 +1,132 @@
+// ====================================================================================
+// 模块名称: TailFollower (实时跟踪追加写入的数据文件)
+// 功能描述:
+//   上游任务持续向一个 CSV 时间序列文件 (长表或宽表，格式同 CsvImporter) 追加行。
+//   后台线程每 10 ms 检查文件大小，只读取新增的字节，凑成完整的行后交给
+//   CsvImporter::Parse 解析 (固定日期原点，保证各批次的天数一致)；
+//   UI 线程每帧调用 poll()，把解析好的批次逐条 upsert 进对应地区的历史记录，
+//   只有被更新的地区会刷新当前状态并记录新的变更代数 (generation)，
+//   预测页据此只重算所选地区的模拟与更新方程预测。首次追上大文件时走批量导入路径。
+// ====================================================================================
+
+#pragma once
+
+#include "CsvImporter.h"
+#include "DataModel.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] TailFollowStats
+// 描述: 跟踪状态与延迟统计 (UI 每帧读取)
+// ------------------------------------------------------------------------------------
+struct TailFollowStats {
+    bool following = false;
+    std::string path;
+    std::string error;
+    uint64_t offset = 0;            // Bytes of the file consumed so far
+    size_t batches = 0;             // Batches applied to the data model
+    size_t bulkBatches = 0;         // Of which large enough to go through CsvImporter::Apply
+    size_t rows = 0;
+    size_t records = 0;             // Records parsed from the new lines
+    size_t truncations = 0;         // File shrank (rotated/rewritten) and was re-read from the start
+    size_t lastRegions = 0;         // Regions changed by the most recent batch
+    double lastApplyMs = 0;
+    double meanApplyMs = 0;
+    double latencyP50Ms = 0;        // New bytes detected -> applied to the data model
+    double latencyP99Ms = 0;
+    double latencyMaxMs = 0;
+};
+
+// ------------------------------------------------------------------------------------
+// [结构体] TailFollowBenchmarkResult
+// 描述: 基准测试: 模拟的上游任务按固定间隔为每个地区追加一天数据，
+//       UI 线程以 60 帧/秒调用 poll()，测量 "追加写入 -> 数据可见" 的端到端延迟
+// ------------------------------------------------------------------------------------
+struct TailFollowBenchmarkResult {
+    bool valid = false;
+    std::string error;
+    size_t regions = 0;
+    int ticks = 0;
+    size_t records = 0;
+    double latencyP50Ms = 0;
+    double latencyP99Ms = 0;
+    double latencyMaxMs = 0;
+    double meanApplyMs = 0;         // UI-thread time per applied batch
+    bool verified = false;          // Every region ends with exactly the appended records
+};
+
+// ------------------------------------------------------------------------------------
+// [类] TailFollower
+// 描述: 追加文件跟踪器
+// 作用:
+//   start() 注册为 EpidemicData 的变更监听器 (维护名称索引与每个地区的变更代数) 并启动读取线程；
+//   poll() 在 UI 线程每帧调用；getRegionGeneration() 变化说明该地区的数据被更新过。
+// ------------------------------------------------------------------------------------
+class TailFollower : public DataChangeListener {
+public:
+    static constexpr int PollMillis = 10;
+    static constexpr size_t MaxReadBytes = 64 << 20;   // Per read, so catching up on a large file is applied in parts
+    static constexpr size_t BulkRecords = 200000;      // Batches above this use the bulk import path
+
+    TailFollower();
+    ~TailFollower();
+
+    bool start(EpidemicData& data, const std::string& path, const CsvImportOptions& options, std::string* error = nullptr);
+    void stop();
+    bool isFollowing() const { return reader.joinable(); }
+
+    // UI thread, once per frame. Returns the number of regions changed by this call
+    size_t poll();
+    const std::vector<int>& getChangedRegions() const { return changed; } // By the last poll()
+    uint64_t getGeneration() const { return generation; }
+    uint64_t getRegionGeneration(int index) const;
+    TailFollowStats getStats();
+
+    // DataChangeListener: keeps the name index and per-region generations aligned with the regions
+    void onRegionAdded(int index, const Region& region) override;
+    void onRegionDeleted(int index) override;
+    void onRegionRenamed(int index, const char* name) override;
+    void onBulkChange() override;
+
+    // Writer thread appending to a scratch file while a follower tracks it, on the calling thread
+    static TailFollowBenchmarkResult RunBenchmark(size_t regions, int ticks, int intervalMillis);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Batch {
+        CsvImportResult result;
+        Clock::time_point detected;
+    };
+
+    void readerLoop(std::string path, CsvImportOptions options);
+    void applyIncremental(CsvImportResult& result);
+    int findRegion(const char* name);
+    void markChanged(int index);
+
+    EpidemicData* target;
+    std::unordered_map<std::string, int> nameIndex;  // UI thread only
+    bool nameIndexValid;
+    std::vector<uint64_t> regionGeneration;           // By region index, UI thread only
+    uint64_t generation;
+    uint64_t bulkGeneration;                          // Every region counts as changed at this generation
+    std::vector<int> changed;
+
+    std::thread reader;
+    std::mutex mutex;                                 // Guards queue and stats
+    std::condition_variable wake;
+    bool stopRequested;
+    std::vector<Batch> queue;
+    TailFollowStats stats;
+    double applyMsTotal;
+    std::vector<float> latencyMs;                     // Ring of the most recent batch latencies
+    size_t latencyNext;
+};
@@ -0,0 +1,107 @@
+// ====================================================================================
+// 模块名称: ThreadPool Implementation
+// 功能描述:
+//   实现常驻工作线程 + 原子计数器分块的 parallelFor。
+// ====================================================================================
+
+#include "ThreadPool.h"
+#include <algorithm> // For std::min
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : currentJob(nullptr), jobCount(0), jobGrain(1), nextChunk(0),
+      activeWorkers(0), jobGeneration(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Worker 0 is the calling thread, so only threadCount - 1 threads are spawned
+    for (unsigned i = 1; i < threadCount; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+unsigned ThreadPool::getWorkerCount() const {
+    return static_cast<unsigned>(threads.size()) + 1;
+}
+
+void ThreadPool::runChunks(unsigned workerIndex) {
+    const size_t chunkCount = (jobCount + jobGrain - 1) / jobGrain;
+    for (;;) {
+        size_t chunk = nextChunk.fetch_add(1, std::memory_order_relaxed);
+        if (chunk >= chunkCount) break;
+        size_t begin = chunk * jobGrain;
+        size_t end = std::min(jobCount, begin + jobGrain);
+        (*currentJob)(begin, end, workerIndex);
+    }
+}
+
+// [算法] 并行循环 (Parallel For)
+// 核心逻辑:
+//   所有线程从同一个原子计数器领取块编号，先做完的线程自动多领，天然负载均衡。
+//   调用线程同样领取任务，全部块完成且所有工作线程退出本轮后才返回。
+void ThreadPool::parallelFor(size_t count, const RangeFunction& fn, size_t grain) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+
+    // Busy (another caller or a nested call): run inline on this thread
+    std::unique_lock<std::mutex> jobLock(jobMutex, std::try_to_lock);
+    if (!jobLock.owns_lock() || threads.empty()) {
+        for (size_t begin = 0; begin < count; begin += grain) {
+            fn(begin, std::min(count, begin + grain), 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        currentJob = &fn;
+        jobCount = count;
+        jobGrain = grain;
+        nextChunk.store(0, std::memory_order_relaxed);
+        activeWorkers = static_cast<unsigned>(threads.size());
+        ++jobGeneration;
+    }
+    wakeCondition.notify_all();
+
+    runChunks(0);
+
+    std::unique_lock<std::mutex> lock(stateMutex);
+    doneCondition.wait(lock, [this] { return activeWorkers == 0; });
+    currentJob = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned workerIndex) {
+    unsigned long long seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            wakeCondition.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = jobGeneration;
+        }
+
+        runChunks(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (--activeWorkers == 0) {
+                doneCondition.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,63 @@
+// ====================================================================================
+// 模块名称: ThreadPool (并行计算线程池)
+// 功能描述:
+//   为批量模拟(参数校准、敏感性分析、优化器等)提供一个常驻的工作线程池。
+//   只提供 parallelFor 这一种用法：把 [0, count) 切块后分发到所有核心，调用方阻塞等待完成。
+// ====================================================================================
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [类] ThreadPool
+// 描述: 固定大小的工作线程池
+// 作用:
+//   调用线程本身也参与计算(工作线程编号为0)，因此每个任务可以按 getWorkerCount()
+//   预先分配好"每线程一份"的缓冲区，内层循环无需加锁也无需分配内存。
+//   如果线程池正被别的线程占用(或在任务内部嵌套调用)，parallelFor 会退化为在当前线程串行执行，
+//   保证UI线程永远不会被后台任务阻塞。
+// ------------------------------------------------------------------------------------
+class ThreadPool {
+public:
+    // fn(begin, end, workerIndex), workerIndex in [0, getWorkerCount())
+    using RangeFunction = std::function<void(size_t, size_t, unsigned)>;
+
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Shared pool sized to the number of hardware threads
+    static ThreadPool& instance();
+
+    unsigned getWorkerCount() const;
+
+    // Splits [0, count) into chunks of `grain` items and blocks until all are done
+    void parallelFor(size_t count, const RangeFunction& fn, size_t grain = 1);
+
+private:
+    void workerLoop(unsigned workerIndex);
+    void runChunks(unsigned workerIndex);
+
+    std::vector<std::thread> threads;
+    std::mutex jobMutex;   // Serializes parallelFor callers
+    std::mutex stateMutex; // Guards the fields below
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+
+    const RangeFunction* currentJob;
+    size_t jobCount;
+    size_t jobGrain;
+    std::atomic<size_t> nextChunk;
+    unsigned activeWorkers;
+    unsigned long long jobGeneration;
+    bool stopping;
+};
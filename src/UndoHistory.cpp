@@ -0,0 +1,444 @@
+// ====================================================================================
+// 模块名称: UndoHistory Implementation
+// 功能描述:
+//   编辑步骤的记录、撤销与重做，以及长时间编辑会话的基准测试。
+// ====================================================================================
+
+#include "UndoHistory.h"
+#include <algorithm>  // For std::sort
+#include <chrono>
+#include <cstdio>     // For std::snprintf
+#include <cstring>    // For std::strcmp
+#include <random>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+uint64_t HandleKey(RegionHandle handle) {
+    return (static_cast<uint64_t>(handle.slot) << 32) | handle.generation;
+}
+
+} // namespace
+
+UndoHistory::UndoHistory()
+    : target(nullptr), undoSteps(0), redoSteps(0), nextStep(0), stepDepth(0), stepOpen(false) {}
+
+UndoHistory::~UndoHistory() {
+    detach();
+}
+
+void UndoHistory::attach(EpidemicData& data) {
+    detach();
+    target = &data;
+    target->addChangeListener(this);
+}
+
+void UndoHistory::detach() {
+    if (target) target->removeChangeListener(this);
+    target = nullptr;
+    clear();
+}
+
+void UndoHistory::clear() {
+    undoActions.clear();
+    redoActions.clear();
+    undoSteps = 0;
+    redoSteps = 0;
+    stepOpen = false;
+    regionHandles.clear();
+    handleIds.clear();
+}
+
+void UndoHistory::onBulkChange() {
+    clear();
+}
+
+// --- Region ids ---
+
+uint32_t UndoHistory::regionId(int index) {
+    const RegionHandle handle = target->getHandle(index);
+    auto it = handleIds.find(HandleKey(handle));
+    if (it != handleIds.end()) return it->second;
+    const uint32_t id = static_cast<uint32_t>(regionHandles.size());
+    regionHandles.push_back(handle);
+    handleIds.emplace(HandleKey(handle), id);
+    return id;
+}
+
+int UndoHistory::indexOf(uint32_t region) const {
+    return region < regionHandles.size() ? target->resolve(regionHandles[region]) : -1;
+}
+
+// Adds the region back at the end and points its id at the new handle
+void UndoHistory::recreate(const Action& action, bool withHistory) {
+    const std::string& name = action.kind == Kind::AddRegion ? action.newName : action.oldName;
+    target->addRegion(name.c_str(), action.counts[0], action.counts[1], action.counts[2], action.counts[3]);
+    const int index = static_cast<int>(target->getRegions().size()) - 1;
+    if (withHistory && !action.history.empty()) {
+        target->upsertHistoryRecords(index, action.history.data(), action.history.size());
+        restoreCounts(action, index);
+    }
+    const RegionHandle handle = target->getHandle(index);
+    regionHandles[action.region] = handle;
+    handleIds[HandleKey(handle)] = action.region;
+}
+
+// A history edit refreshes the current state from the last record (or leaves it when the history empties)
+void UndoHistory::SaveCounts(Action& action, const Region& region) {
+    action.counts[1] = region.getConfirmedCases();
+    action.counts[2] = region.getRecoveredCases();
+    action.counts[3] = region.getDeaths();
+}
+
+void UndoHistory::restoreCounts(const Action& action, int index) {
+    const Region& region = target->getRegions()[index];
+    if (region.getConfirmedCases() != action.counts[1] || region.getRecoveredCases() != action.counts[2] ||
+        region.getDeaths() != action.counts[3]) {
+        target->setRegionCounts(index, action.counts[1], action.counts[2], action.counts[3]);
+    }
+}
+
+// --- Recording ---
+
+void UndoHistory::beginStep() {
+    if (stepDepth++ == 0) stepOpen = false;
+}
+
+void UndoHistory::endStep() {
+    if (stepDepth > 0) --stepDepth;
+}
+
+// [算法] 记录一步
+// 逻辑:
+//   同一步的动作带相同的步号并在撤销栈中相邻；不在 begin/end 之间的动作各自成一步。
+//   新的编辑使重做栈失效。步数超过 MaxSteps 时从最旧的一步整体丢弃。
+void UndoHistory::record(Action&& action) {
+    if (stepDepth == 0 || !stepOpen) {
+        ++nextStep;
+        ++undoSteps;
+        stepOpen = stepDepth > 0;
+    }
+    action.step = nextStep;
+    undoActions.push_back(std::move(action));
+    redoActions.clear();
+    redoSteps = 0;
+
+    while (undoSteps > MaxSteps) {
+        const uint32_t oldest = undoActions.front().step;
+        while (!undoActions.empty() && undoActions.front().step == oldest) undoActions.pop_front();
+        --undoSteps;
+    }
+}
+
+void UndoHistory::addRegion(const char* name, int population, int confirmed, int recovered, int deaths) {
+    if (!target) return;
+    target->addRegion(name, population, confirmed, recovered, deaths);
+    const int index = static_cast<int>(target->getRegions().size()) - 1;
+    Action action;
+    action.kind = Kind::AddRegion;
+    action.region = regionId(index);
+    action.newName = target->getRegions()[index].name;
+    action.counts[0] = population;
+    action.counts[1] = confirmed;
+    action.counts[2] = recovered;
+    action.counts[3] = deaths;
+    record(std::move(action));
+}
+
+void UndoHistory::deleteRegion(int index) {
+    Region* region = target ? target->getRegion(index) : nullptr;
+    if (!region) return;
+    Action action;
+    action.kind = Kind::DeleteRegion;
+    action.region = regionId(index);
+    action.oldName = region->name;
+    action.counts[0] = region->getPopulation();
+    action.counts[1] = region->getConfirmedCases();
+    action.counts[2] = region->getRecoveredCases();
+    action.counts[3] = region->getDeaths();
+    action.history.assign(region->history.begin(), region->history.end());
+    target->deleteRegion(index);
+    record(std::move(action));
+}
+
+void UndoHistory::renameRegion(int index, const char* name) {
+    Region* region = target ? target->getRegion(index) : nullptr;
+    if (!region || std::strcmp(region->name, name) == 0) return;
+    Action action;
+    action.kind = Kind::Rename;
+    action.region = regionId(index);
+    action.oldName = region->name;
+    target->renameRegion(index, name);
+    action.newName = target->getRegion(index)->name;    // As stored (truncated to the name buffer)
+    record(std::move(action));
+}
+
+void UndoHistory::setRegionPopulation(int index, int population) {
+    Region* region = target ? target->getRegion(index) : nullptr;
+    if (!region || region->getPopulation() == population) return;
+    Action action;
+    action.kind = Kind::Population;
+    action.region = regionId(index);
+    action.before = region->getPopulation();
+    action.after = population;
+    target->setRegionPopulation(index, population);
+    record(std::move(action));
+}
+
+void UndoHistory::upsertHistoryRecord(int index, const HistoricalRecord& rec) {
+    Region* region = target ? target->getRegion(index) : nullptr;
+    if (!region) return;
+    Action action;
+    action.kind = Kind::UpsertHistory;
+    action.region = regionId(index);
+    if (const HistoricalRecord* old = region->history.find(rec.day)) {
+        action.existed = true;
+        action.oldRecord = *old;
+    }
+    action.newRecord = rec;
+    SaveCounts(action, *region);
+    target->upsertHistoryRecord(index, rec);
+    record(std::move(action));
+}
+
+void UndoHistory::deleteHistoryRecord(int index, int day) {
+    Region* region = target ? target->getRegion(index) : nullptr;
+    if (!region) return;
+    const HistoricalRecord* old = region->history.find(day);
+    if (!old) return;
+    Action action;
+    action.kind = Kind::DeleteHistory;
+    action.region = regionId(index);
+    action.oldRecord = *old;
+    SaveCounts(action, *region);
+    target->deleteHistoryRecord(index, day);
+    record(std::move(action));
+}
+
+// --- Undo / redo ---
+
+bool UndoHistory::applyUndo(const Action& a) {
+    if (a.kind == Kind::DeleteRegion) {
+        recreate(a, true);
+        return true;
+    }
+    const int index = indexOf(a.region);
+    if (index < 0) return false;   // Deleted by another source
+    switch (a.kind) {
+    case Kind::AddRegion: target->deleteRegion(index); break;
+    case Kind::Rename: target->renameRegion(index, a.oldName.c_str()); break;
+    case Kind::Population: target->setRegionPopulation(index, a.before); break;
+    case Kind::UpsertHistory:
+        if (a.existed) target->upsertHistoryRecord(index, a.oldRecord);
+        else target->deleteHistoryRecord(index, a.newRecord.day);
+        restoreCounts(a, index);
+        break;
+    case Kind::DeleteHistory:
+        target->upsertHistoryRecord(index, a.oldRecord);
+        restoreCounts(a, index);
+        break;
+    default: break;
+    }
+    return true;
+}
+
+bool UndoHistory::applyRedo(const Action& a) {
+    if (a.kind == Kind::AddRegion) {
+        recreate(a, false);
+        return true;
+    }
+    const int index = indexOf(a.region);
+    if (index < 0) return false;
+    switch (a.kind) {
+    case Kind::DeleteRegion: target->deleteRegion(index); break;
+    case Kind::Rename: target->renameRegion(index, a.newName.c_str()); break;
+    case Kind::Population: target->setRegionPopulation(index, a.after); break;
+    case Kind::UpsertHistory: target->upsertHistoryRecord(index, a.newRecord); break;
+    case Kind::DeleteHistory: target->deleteHistoryRecord(index, a.oldRecord.day); break;
+    default: break;
+    }
+    return true;
+}
+
+// [算法] 撤销/重做一步
+// 逻辑:
+//   撤销从栈顶起按相反顺序逆向执行该步的全部动作，并依次压入重做栈，
+//   因此重做栈顶是该步的第一个动作，重做时按原顺序执行并依次压回撤销栈。
+bool UndoHistory::undo() {
+    if (!target || undoActions.empty()) return false;
+    const uint32_t step = undoActions.back().step;
+    while (!undoActions.empty() && undoActions.back().step == step) {
+        applyUndo(undoActions.back());
+        redoActions.push_back(std::move(undoActions.back()));
+        undoActions.pop_back();
+    }
+    --undoSteps;
+    ++redoSteps;
+    stepOpen = false;
+    return true;
+}
+
+bool UndoHistory::redo() {
+    if (!target || redoActions.empty()) return false;
+    const uint32_t step = redoActions.back().step;
+    while (!redoActions.empty() && redoActions.back().step == step) {
+        applyRedo(redoActions.back());
+        undoActions.push_back(std::move(redoActions.back()));
+        redoActions.pop_back();
+    }
+    --redoSteps;
+    ++undoSteps;
+    stepOpen = false;
+    return true;
+}
+
+// --- Memory ---
+
+size_t UndoHistory::ActionBytes(const Action& a) {
+    return sizeof(Action) + a.oldName.capacity() + a.newName.capacity() + a.history.capacity() * sizeof(HistoricalRecord);
+}
+
+size_t UndoHistory::getMemoryBytes() const {
+    size_t bytes = regionHandles.capacity() * sizeof(RegionHandle);
+    // Node per entry (key, value, next pointer) plus the bucket array
+    bytes += handleIds.size() * (sizeof(std::pair<const uint64_t, uint32_t>) + sizeof(void*)) + handleIds.bucket_count() * sizeof(void*);
+    for (const Action& a : undoActions) bytes += ActionBytes(a);
+    for (const Action& a : redoActions) bytes += ActionBytes(a);
+    return bytes;
+}
+
+// --- Benchmark ---
+
+namespace {
+
+struct RegionState {
+    std::string name;
+    int population, confirmed, recovered, deaths;
+    std::vector<HistoricalRecord> history;
+};
+
+// Order-independent view of the data: undoing a delete adds the region back at the end
+std::vector<RegionState> CaptureState(EpidemicData& data) {
+    std::vector<RegionState> out;
+    out.reserve(data.getRegions().size());
+    for (const Region& r : data.getRegions()) {
+        out.push_back({ r.name, r.getPopulation(), r.getConfirmedCases(), r.getRecoveredCases(), r.getDeaths(),
+                        std::vector<HistoricalRecord>(r.history.begin(), r.history.end()) });
+    }
+    std::sort(out.begin(), out.end(), [](const RegionState& a, const RegionState& b) { return a.name < b.name; });
+    return out;
+}
+
+bool SameState(const std::vector<RegionState>& a, const std::vector<RegionState>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const RegionState& x = a[i];
+        const RegionState& y = b[i];
+        if (x.name != y.name || x.population != y.population || x.confirmed != y.confirmed ||
+            x.recovered != y.recovered || x.deaths != y.deaths || x.history.size() != y.history.size()) {
+            return false;
+        }
+        for (size_t k = 0; k < x.history.size(); ++k) {
+            const HistoricalRecord& p = x.history[k];
+            const HistoricalRecord& q = y.history[k];
+            if (p.day != q.day || p.confirmed != q.confirmed || p.recovered != q.recovered || p.deaths != q.deaths) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// [算法] 编辑会话基准测试
+// 逻辑:
+//   合成 N 个地区 (四分之三各有 60 天记录，其余只有手工录入的当前数)，经 UndoHistory 做若干步随机编辑 (改记录、追加、删记录、改名、改人口、
+//   增删地区，每十步有一步同时改名与人口)，统计撤销栈的内存；然后全部撤销，与编辑前比较，再全部重做，与编辑后比较。
+UndoHistoryBenchmarkResult UndoHistory::RunBenchmark(size_t regions, size_t steps) {
+    UndoHistoryBenchmarkResult result;
+    result.regions = regions;
+    steps = std::min(steps, UndoHistory::MaxSteps);
+    result.steps = steps;
+
+    EpidemicData data;
+    std::mt19937 rng(53);
+    char name[64];
+    data.beginBulkUpdate();
+    data.reserveRegions(regions);
+    for (size_t i = 0; i < regions; ++i) {
+        std::snprintf(name, sizeof(name), "R%06zu", i);
+        if (i % 4 == 3) {
+            // Entered by hand, no history yet: the first record replaces these counts and undo brings them back
+            data.addRegion(name, 1000000, 50 + static_cast<int>(i % 7), 10, 1);
+            continue;
+        }
+        data.addRegion(name, 1000000, 0, 0, 0);
+        HistorySeries& history = data.getMutableHistory(static_cast<int>(i));
+        int confirmed = 0;
+        for (int day = 0; day < 60; ++day) {
+            confirmed += static_cast<int>(rng() % 40);
+            history.push_back({ day, confirmed, confirmed / 2, confirmed / 50 });
+        }
+        data.setRegionCounts(static_cast<int>(i), history.back().confirmed, history.back().recovered, history.back().deaths);
+        result.records += history.size();
+    }
+    data.endBulkUpdate();
+    result.datasetBytes = regions * sizeof(Region) + result.records * sizeof(HistoricalRecord);
+    result.fullCopyBytes = result.datasetBytes * steps;
+
+    const std::vector<RegionState> before = CaptureState(data);
+    UndoHistory undo;
+    undo.attach(data);
+
+    auto t0 = Clock::now();
+    for (size_t s = 0; s < steps; ++s) {
+        const int count = static_cast<int>(data.getRegions().size());
+        const int index = static_cast<int>(rng() % count);
+        const Region& region = data.getRegions()[index];
+        const int lastDay = region.history.empty() ? 0 : region.history.back().day;
+        const int kind = static_cast<int>(rng() % 10);
+        if (s % 10 == 9) {
+            undo.beginStep();
+            std::snprintf(name, sizeof(name), "R%06d-s%zu", index, s);
+            undo.renameRegion(index, name);
+            undo.setRegionPopulation(index, region.getPopulation() + 1);
+            undo.endStep();
+        } else if (kind < 3) {
+            const int day = region.history.empty() ? 0 : region.history[rng() % region.history.size()].day;
+            undo.upsertHistoryRecord(index, { day, static_cast<int>(rng() % 100000), 0, 0 });
+        } else if (kind < 5) {
+            undo.upsertHistoryRecord(index, { lastDay + 1, static_cast<int>(rng() % 100000), 0, 0 });
+        } else if (kind < 6) {
+            if (!region.history.empty()) undo.deleteHistoryRecord(index, region.history[rng() % region.history.size()].day);
+            else undo.setRegionPopulation(index, region.getPopulation() + 1);
+        } else if (kind < 7) {
+            std::snprintf(name, sizeof(name), "R%06d-s%zu", index, s);
+            undo.renameRegion(index, name);
+        } else if (kind < 8) {
+            undo.setRegionPopulation(index, region.getPopulation() + 1);
+        } else if (kind < 9) {
+            std::snprintf(name, sizeof(name), "N%06zu", s);
+            undo.addRegion(name, 50000, 10, 0, 0);
+        } else {
+            undo.deleteRegion(index);
+        }
+    }
+    result.editUs = std::chrono::duration<double, std::micro>(Clock::now() - t0).count() / std::max<size_t>(1, steps);
+    result.undoBytes = undo.getMemoryBytes();
+    const bool allRecorded = undo.getUndoSteps() == steps;
+    const std::vector<RegionState> after = CaptureState(data);
+
+    t0 = Clock::now();
+    while (undo.undo()) {}
+    result.undoAllMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    const bool undone = SameState(CaptureState(data), before);
+
+    t0 = Clock::now();
+    while (undo.redo()) {}
+    result.redoAllMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    const bool redone = SameState(CaptureState(data), after);
+
+    result.verified = allRecorded && undone && redone;
+    result.valid = true;
+    return result;
+}
@@ -0,0 +1,121 @@
+// ====================================================================================
+// 模块名称: UndoHistory (数据管理页的撤销/重做)
+// 功能描述:
+//   记录数据管理页的每一次编辑 (新增/删除地区、改名、改人口、历史记录的增改/删除)，可逐步撤销与重做。
+//   每一步只保存被修改的那部分数据的前后值 (一条记录、一个名字、一个人口数；删除地区时保存该地区的历史)，
+//   而不是整份地区列表的副本: 记录一步是 O(1) (删除地区为 O(该地区的记录数))，
+//   上千步的编辑会话占用的内存与改动量成正比，与数据集大小无关。
+//   撤销与重做都通过 EpidemicData 的编辑接口完成，汇总、索引、编辑日志等监听器照常收到通知。
+//   步骤按 UndoHistory 自己的地区编号引用地区 (撤销删除时地区会以新的句柄重新加入末尾)。
+//   其他来源的批量修改 (导入、载入数据文件) 之后清空全部步骤；其他来源删掉的地区，其步骤在撤销时跳过。
+//   历史记录的编辑会改写地区的当前数，撤销时把当前数恢复为编辑前的值。
+// ====================================================================================
+
+#pragma once
+
+#include "DataModel.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ------------------------------------------------------------------------------------
+// [结构体] UndoHistoryBenchmarkResult
+// 描述: 长时间编辑会话的内存占用与撤销/重做用时
+// ------------------------------------------------------------------------------------
+struct UndoHistoryBenchmarkResult {
+    bool valid = false;
+    size_t regions = 0;
+    size_t records = 0;
+    size_t steps = 0;
+    size_t datasetBytes = 0;            // Regions and their histories
+    size_t undoBytes = 0;               // Undo stack after every step
+    size_t fullCopyBytes = 0;           // What a deep copy of the data per step would take
+    double editUs = 0;                  // Per step, recording and applying
+    double undoAllMs = 0;
+    double redoAllMs = 0;
+    bool verified = false;              // Undoing everything restores the start, redoing restores the end
+};
+
+// ------------------------------------------------------------------------------------
+// [类] UndoHistory
+// 描述: 编辑步骤的撤销栈与重做栈
+// 作用:
+//   attach() 之后，界面用本类的编辑接口代替 EpidemicData 的同名接口；
+//   beginStep()/endStep() 之间的多个编辑合为一步 (如修改对话框同时改名与人口)。
+// ------------------------------------------------------------------------------------
+class UndoHistory : public DataChangeListener {
+public:
+    static constexpr size_t MaxSteps = 10000;           // The oldest steps are dropped beyond this
+
+    UndoHistory();
+    ~UndoHistory();
+
+    void attach(EpidemicData& data);
+    void detach();
+
+    // Edits (recorded, then applied to the attached data)
+    void addRegion(const char* name, int population, int confirmed, int recovered, int deaths);
+    void deleteRegion(int index);
+    void renameRegion(int index, const char* name);
+    void setRegionPopulation(int index, int population);
+    void upsertHistoryRecord(int index, const HistoricalRecord& record);
+    void deleteHistoryRecord(int index, int day);
+    void beginStep();
+    void endStep();
+
+    bool canUndo() const { return !undoActions.empty(); }
+    bool canRedo() const { return !redoActions.empty(); }
+    bool undo();                                    // Returns false if nothing was undone
+    bool redo();
+    void clear();
+
+    size_t getUndoSteps() const { return undoSteps; }
+    size_t getRedoSteps() const { return redoSteps; }
+    size_t getMemoryBytes() const;                  // Both stacks and the region id table
+
+    // Random edits on synthetic data, then undo and redo everything, on the calling thread
+    static UndoHistoryBenchmarkResult RunBenchmark(size_t regions, size_t steps);
+
+    // DataChangeListener: a bulk change from another source invalidates every step
+    void onBulkChange() override;
+
+private:
+    enum class Kind : uint8_t { AddRegion, DeleteRegion, Rename, Population, UpsertHistory, DeleteHistory };
+
+    struct Action {
+        Kind kind = Kind::Rename;
+        bool existed = false;                       // UpsertHistory: the day already had a record
+        uint32_t step = 0;
+        uint32_t region = 0;                        // Id in regionHandles
+        int counts[4] = { 0, 0, 0, 0 };             // AddRegion/DeleteRegion: population, confirmed, recovered, deaths;
+                                                    // history edits: confirmed, recovered, deaths before the edit in [1..3]
+        int before = 0, after = 0;                  // Population
+        HistoricalRecord oldRecord = { 0, 0, 0, 0 };
+        HistoricalRecord newRecord = { 0, 0, 0, 0 };
+        std::string oldName, newName;               // Rename; AddRegion uses newName, DeleteRegion oldName
+        std::vector<HistoricalRecord> history;      // DeleteRegion
+    };
+
+    uint32_t regionId(int index);
+    int indexOf(uint32_t region) const;             // -1 if the region is gone
+    void recreate(const Action& action, bool withHistory);
+    static void SaveCounts(Action& action, const Region& region);
+    void restoreCounts(const Action& action, int index);
+    void record(Action&& action);
+    bool applyUndo(const Action& action);
+    bool applyRedo(const Action& action);
+    static size_t ActionBytes(const Action& action);
+
+    EpidemicData* target;
+    std::deque<Action> undoActions;                 // Oldest first; a step is a run of equal step numbers
+    std::deque<Action> redoActions;                 // Next to redo last
+    size_t undoSteps;
+    size_t redoSteps;
+    uint32_t nextStep;
+    int stepDepth;
+    bool stepOpen;                                  // The current begin/end step already holds an action
+    std::vector<RegionHandle> regionHandles;        // Current handle of each region id
+    std::unordered_map<uint64_t, uint32_t> handleIds;
+};
@@ -9,8 +9,9 @@
 #include <numeric> // For std::accumulate
 #include <algorithm> // For std::sort
 #include <cmath> // For std::exp, std::pow
-#include <fstream> // For file export
 #include <ctime> // For timestamp
+#include <chrono> // For timing batch runs
+#include <csignal> // For stopping the headless server with Ctrl+C
 #include <windows.h> // For GetCurrentDirectory and system commands
 
 // ====================================================================================
@@ -22,6 +23,28 @@
 // ====================================================================================
 
 #include "DataModel.h"
+#include "ABCCalibrator.h"
+#include "SIREmulator.h"
+#include "SensitivityAnalysis.h"
+#include "InterventionOptimizer.h"
+#include "RenewalModel.h"
+#include "ColumnarStore.h"
+#include "CsvImporter.h"
+#include "DataExporter.h"
+#include "Journal.h"
+#include "SnapshotSaver.h"
+#include "TailFollower.h"
+#include "ApiServer.h"
+#include "SharedFeed.h"
+#include "NumpyIO.h"
+#include "RegionScan.h"
+#include "RegionSearch.h"
+#include "RegionRollup.h"
+#include "AggregateQuery.h"
+#include "MemoryArena.h"
+#include "UndoHistory.h"
+#include "ThreadPool.h"
+#include "BackgroundBenchmark.h"
 
 // ------------------------------------------------------------------------------------
 // [全局状态]
@@ -33,6 +56,44 @@
 // The single source of truth for all epidemic data
 EpidemicData g_EpidemicData;
 
+// Background CSV export; the main loop feeds it region data a few milliseconds per frame
+DataExporter g_DataExporter;
+
+// Write-ahead journal of data edits: replayed on top of the session snapshot at startup
+Journal g_Journal;
+JournalRecovery g_JournalRecovery;
+const char* kSessionSnapshotPath = "epidemic_session.epcol";
+const char* kSessionJournalPath = "epidemic_session.wal";
+
+// Explicit session saves and loads: captured or swapped in on the UI thread, written or built in the background
+SnapshotSaver g_SessionSaver;
+SnapshotLoader g_SessionLoader;
+
+// Live ingestion of a CSV file that an upstream job keeps appending to; applied once per frame
+TailFollower g_TailFollower;
+
+// Local HTTP/JSON API: reads are served from snapshots, edits are applied on the UI thread
+ApiServer g_ApiServer;
+
+// Shared-memory ring that an external ETL process pushes daily updates into; applied once per frame
+SharedFeed g_SharedFeed;
+
+// NumPy .npy/.npz exports for Python post-processing (written on a background thread)
+NumpyIO g_NumpyIO;
+
+// Name search of the data table (substring, pinyin, initials); follows edits as a change listener
+RegionSearchIndex g_RegionSearch;
+
+// Daily aggregates across region subsets (dashboard query); follows edits as a change listener
+AggregateQueryEngine g_AggregateQuery;
+
+// Scratch memory for containers built and dropped within one frame (reset after ImGui::NewFrame)
+FrameArena g_FrameArena;
+FrameMemoryCounter g_FrameMemory;
+
+// Undo/redo of the edits made on the data page; cleared by imports and file loads
+UndoHistory g_UndoHistory;
+
 // Enum for managing which page is currently visible
 enum AppState {
     State_Dashboard,    // Homepage/Dashboard
@@ -42,6 +103,8 @@ enum AppState {
 
 // Global variable to control the currently displayed page
 static AppState g_CurrentState = State_Dashboard;
+// Benchmark window (developer tool, outside the pages), toggled from the sidebar
+static bool g_ShowBenchmarks = false;
 
 // --- Data Initialization ---
 
@@ -52,6 +115,9 @@ static AppState g_CurrentState = State_Dashboard;
 // ------------------------------------------------------------------------------------
 // Function to populate our data model with some initial test data
 void InitializeData() {
+    // The histories below are pushed straight into the regions; the bulk end rebuilds the rollups from them
+    g_EpidemicData.beginBulkUpdate();
+
     // 添加一个专门用于演示的城市 - 使用真实SIR模型生成数据
     g_EpidemicData.addRegion("★ 演示城市 (Demo)", 1000000, 5000, 3000, 100);
     g_EpidemicData.addRegion("武汉 (Wuhan)", 11000000, 50340, 46464, 3869);
@@ -108,9 +174,7 @@ void InitializeData() {
         // 更新城市当前状态为Day 60的数据（历史最后一天）
         if (!demo.history.empty()) {
             const auto& lastDay = demo.history.back();
-            demo.confirmedCases = lastDay.confirmed;
-            demo.recoveredCases = lastDay.recovered;
-            demo.deaths = lastDay.deaths;
+            g_EpidemicData.setRegionCounts(0, lastDay.confirmed, lastDay.recovered, lastDay.deaths);
         }
     }
     
@@ -133,9 +197,7 @@ void InitializeData() {
         // 更新城市当前状态为最后一天的数据
         if (!wuhan.history.empty()) {
             const auto& lastDay = wuhan.history.back();
-            wuhan.confirmedCases = lastDay.confirmed;
-            wuhan.recoveredCases = lastDay.recovered;
-            wuhan.deaths = lastDay.deaths;
+            g_EpidemicData.setRegionCounts(1, lastDay.confirmed, lastDay.recovered, lastDay.deaths);
         }
     }
     
@@ -154,16 +216,33 @@ void InitializeData() {
         // 更新城市当前状态为最后一天的数据
         if (!shanghai.history.empty()) {
             const auto& lastDay = shanghai.history.back();
-            shanghai.confirmedCases = lastDay.confirmed;
-            shanghai.recoveredCases = lastDay.recovered;
-            shanghai.deaths = lastDay.deaths;
+            g_EpidemicData.setRegionCounts(2, lastDay.confirmed, lastDay.recovered, lastDay.deaths);
         }
     }
+
+    g_EpidemicData.endBulkUpdate();
 }
 
 
 // --- UI Component Functions (responsible for drawing only) ---
 
+// Tree of region groups (groups only; a group's own regions are counted in its label)
+static void ShowRegionGroupNode(const RegionTree& tree, int id, std::string& selected_path) {
+    const RegionTree::Group& group = tree.getGroup(id);
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth;
+    if (group.children.empty()) flags |= ImGuiTreeNodeFlags_Leaf;
+    if (id == RegionTree::Root) flags |= ImGuiTreeNodeFlags_DefaultOpen;
+    if (group.path == selected_path) flags |= ImGuiTreeNodeFlags_Selected;
+    const char* label = id == RegionTree::Root ? "全部地区" : RegionTree::LeafName(group.path.c_str());
+    const bool open = ImGui::TreeNodeEx(reinterpret_cast<void*>(static_cast<intptr_t>(id)), flags, "%s  (%zu 个地区，确诊 %lld)",
+                                        label, group.regions, group.totals.confirmed);
+    if (ImGui::IsItemClicked() && !ImGui::IsItemToggledOpen()) selected_path = group.path;
+    if (open) {
+        for (int32_t child : group.children) ShowRegionGroupNode(tree, child, selected_path);
+        ImGui::TreePop();
+    }
+}
+
 // ------------------------------------------------------------------------------------
 // [UI组件] Dashboard (总览仪表盘)
 // 描述: 首页统计显示
@@ -175,19 +254,15 @@ void ShowDashboardPage() {
     ImGui::Separator();
 
     auto& regions = g_EpidemicData.getRegions();
+    const RegionColumns& columns = g_EpidemicData.getColumns();
 
-    // Calculate totals
-    long long total_pop = 0;
-    long long total_confirmed = 0;
-    long long total_recovered = 0;
-    long long total_deaths = 0;
-    for(const auto& r : regions) {
-        total_pop += r.population;
-        total_confirmed += r.confirmedCases;
-        total_recovered += r.recoveredCases;
-        total_deaths += r.deaths;
-    }
-    long long total_active = total_confirmed - total_recovered - total_deaths;
+    // Totals are maintained by every edit: reading them is O(1) however many regions there are
+    const RegionTotals totals = g_EpidemicData.getTotals();
+    long long total_pop = totals.population;
+    long long total_confirmed = totals.confirmed;
+    long long total_recovered = totals.recovered;
+    long long total_deaths = totals.deaths;
+    long long total_active = totals.active();
 
     // Display totals
     ImGui::Text("核心数据统计");
@@ -197,7 +272,130 @@ void ShowDashboardPage() {
     ImGui::BulletText("累计治愈病例: %lld", total_recovered);
     ImGui::BulletText("累计死亡病例: %lld", total_deaths);
     ImGui::BulletText("现存活跃病例: %lld", total_active);
-    
+    ImGui::BulletText("风险等级: 高 %zu / 中 %zu / 低 %zu", columns.riskCount(RiskLevel::High),
+                      columns.riskCount(RiskLevel::Medium), columns.riskCount(RiskLevel::Low));
+
+    // Hierarchy rollups: every level is read from the tree, nothing is summed per frame
+    if (ImGui::CollapsingHeader("地区层级汇总")) {
+        static std::string selected_path;
+        static std::vector<RollupDay> group_history;
+        const RegionTree& tree = g_EpidemicData.getTree();
+        ImGui::TextDisabled("名称中用 '/' 分隔层级，如 \"湖北省/武汉市/江岸区\"。共 %zu 个分组。", tree.getGroupCount());
+
+        ImGui::BeginChild("GroupTree", ImVec2(ImGui::GetContentRegionAvail().x * 0.4f, 260), true);
+        ShowRegionGroupNode(tree, RegionTree::Root, selected_path);
+        ImGui::EndChild();
+        ImGui::SameLine();
+
+        int selected = tree.findGroup(selected_path);
+        if (selected < 0) {
+            selected_path.clear();
+            selected = RegionTree::Root;
+        }
+        const RegionTree::Group& group = tree.getGroup(selected);
+        ImGui::BeginChild("GroupDetails", ImVec2(0, 260), true);
+        ImGui::Text("%s", selected == RegionTree::Root ? "全部地区" : group.path.c_str());
+        ImGui::Text("地区 %zu 个，人口 %lld", group.regions, group.totals.population);
+        ImGui::Text("确诊 %lld，治愈 %lld，死亡 %lld，现存 %lld", group.totals.confirmed, group.totals.recovered,
+                    group.totals.deaths, group.totals.confirmed - group.totals.recovered - group.totals.deaths);
+        tree.getHistory(selected, group_history);
+        if (!group_history.empty() && ImPlot::BeginPlot("##GroupHistory", ImVec2(-1, -1))) {
+            ImPlot::SetupAxes("天", "人数", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+            const int count = static_cast<int>(group_history.size());
+            const double first_day = group_history.front().day;
+            ImPlot::PlotLine("累计确诊", &group_history[0].confirmed, count, 1, first_day, 0, 0, sizeof(RollupDay));
+            ImPlot::PlotLine("累计治愈", &group_history[0].recovered, count, 1, first_day, 0, 0, sizeof(RollupDay));
+            ImPlot::PlotLine("累计死亡", &group_history[0].deaths, count, 1, first_day, 0, 0, sizeof(RollupDay));
+            ImPlot::EndPlot();
+        }
+        ImGui::EndChild();
+    }
+
+    // Daily aggregates over a region subset, answered from the query engine's cached columns
+    if (ImGui::CollapsingHeader("跨地区逐日汇总查询")) {
+        static int query_metric = 3;
+        static int query_reduce = 0;
+        static int query_subset = 0;
+        static int query_from = 0, query_to = 1000;
+        static char query_name[64] = "";
+        static std::vector<uint32_t> query_regions;
+        static SeriesResult query_result;
+        static bool query_ok = false;
+        static uint64_t query_version = UINT64_MAX;
+        static double query_us = 0;
+        static int shown_metric = -1, shown_reduce = -1, shown_subset = -1, shown_from = 0, shown_to = 0;
+        static std::string shown_name;
+
+        const char* metrics[] = { "累计确诊", "累计治愈", "累计死亡", "现存病例" };
+        const char* reduces[] = { "合计", "平均", "最大" };
+        const char* subsets[] = { "全部地区", "高风险地区", "中风险地区", "低风险地区", "名称搜索" };
+        ImGui::SetNextItemWidth(110);
+        ImGui::Combo("指标##Query", &query_metric, metrics, IM_ARRAYSIZE(metrics));
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(80);
+        ImGui::Combo("逐日##Query", &query_reduce, reduces, IM_ARRAYSIZE(reduces));
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(120);
+        ImGui::Combo("地区##Query", &query_subset, subsets, IM_ARRAYSIZE(subsets));
+        if (query_subset == 4) {
+            ImGui::SameLine();
+            ImGui::SetNextItemWidth(140);
+            ImGui::InputTextWithHint("##QueryName", "名称/拼音/首字母", query_name, sizeof(query_name));
+        }
+        ImGui::SetNextItemWidth(240);
+        ImGui::DragIntRange2("天数范围##Query", &query_from, &query_to, 1.0f, -1000, 10000, "第 %d 天", "第 %d 天");
+
+        // Re-query only when an input or the data changed
+        if (query_metric != shown_metric || query_reduce != shown_reduce || query_subset != shown_subset ||
+            query_from != shown_from || query_to != shown_to || shown_name != query_name ||
+            g_AggregateQuery.getVersion() != query_version) {
+            query_regions.clear();
+            if (query_subset >= 1 && query_subset <= 3) {
+                const RiskLevel levels[] = { RiskLevel::High, RiskLevel::Medium, RiskLevel::Low };
+                columns.collectRisk(levels[query_subset - 1], query_regions);
+                std::sort(query_regions.begin(), query_regions.end());
+            } else if (query_subset == 4) {
+                g_RegionSearch.find(query_name, query_regions);
+            }
+            SeriesQuery query;
+            query.metric = static_cast<SeriesMetric>(query_metric);
+            query.reduce = static_cast<SeriesReduce>(query_reduce);
+            query.firstDay = query_from;
+            query.lastDay = query_to;
+            if (query_subset != 0) {
+                query.regions = query_regions.data();
+                query.regionCount = query_regions.size();
+            }
+            const auto t0 = std::chrono::steady_clock::now();
+            query_ok = g_AggregateQuery.query(query, query_result);
+            query_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+            shown_metric = query_metric;
+            shown_reduce = query_reduce;
+            shown_subset = query_subset;
+            shown_from = query_from;
+            shown_to = query_to;
+            shown_name = query_name;
+            query_version = g_AggregateQuery.getVersion();
+        }
+
+        if (!query_ok) {
+            ImGui::TextDisabled("所选地区在该范围内没有历史记录。");
+        } else {
+            const size_t selected = query_subset == 0 ? regions.size() : query_regions.size();
+            ImGui::Text("%zu 个地区，第 %d - %d 天: 峰值 %.1f (第 %d 天)，逐日平均 %.1f  (查询 %.0f us，缓存 %.1f MB)",
+                        selected, query_result.firstDay, query_result.firstDay + (int)query_result.values.size() - 1,
+                        query_result.peak, query_result.peakDay, query_result.mean, query_us,
+                        g_AggregateQuery.getMemoryBytes() / (1024.0 * 1024.0));
+            if (ImPlot::BeginPlot("##QueryPlot", ImVec2(-1, 220))) {
+                ImPlot::SetupAxes("天", "人数", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+                char label[32];
+                snprintf(label, sizeof(label), "%s (%s)", metrics[query_metric], reduces[query_reduce]);
+                ImPlot::PlotLine(label, query_result.values.data(), (int)query_result.values.size(), 1, query_result.firstDay);
+                ImPlot::EndPlot();
+            }
+        }
+    }
+
     ImGui::Separator();
     ImGui::Text("各地区确诊数条形图");
     static bool fit_axes = true;
@@ -212,18 +410,18 @@ void ShowDashboardPage() {
 
     // Bar Chart
     if (!regions.empty()) {
-        std::vector<const char*> names;
-        std::vector<double> confirmed_data;
-        std::vector<double> recovered_data;
-        std::vector<double> active_data;
-        std::vector<double> positions;
+        std::pmr::vector<const char*> names(g_FrameArena.resource());
+        std::pmr::vector<double> confirmed_data(g_FrameArena.resource());
+        std::pmr::vector<double> recovered_data(g_FrameArena.resource());
+        std::pmr::vector<double> active_data(g_FrameArena.resource());
+        std::pmr::vector<double> positions(g_FrameArena.resource());
 
         for (int i = 0; i < regions.size(); ++i) {
             names.push_back(regions[i].name);
             positions.push_back(static_cast<double>(i));
-            confirmed_data.push_back(static_cast<double>(regions[i].confirmedCases));
-            recovered_data.push_back(static_cast<double>(regions[i].recoveredCases));
-            active_data.push_back(static_cast<double>(regions[i].confirmedCases - regions[i].recoveredCases - regions[i].deaths));
+            confirmed_data.push_back(static_cast<double>(columns.confirmed[i]));
+            recovered_data.push_back(static_cast<double>(columns.recovered[i]));
+            active_data.push_back(static_cast<double>(columns.confirmed[i] - columns.recovered[i] - columns.deaths[i]));
         }
         
         if (fit_axes) {
@@ -286,10 +484,74 @@ void ShowSidebar() {
         }
     }
     
+    ImGui::Checkbox("基准测试窗口", &g_ShowBenchmarks);
+
     ImGui::Spacing();
     ImGui::Separator();
     ImGui::Text("系统状态: 正常");
     ImGui::Text("用户: Admin");
+
+    // --- Session save/load (background snapshot) ---
+    static char sessionPath[260] = "epidemic_saved.epcol";
+    static std::string sessionStatus;
+    static bool sessionError = false;
+    static bool saveWasRunning = false;
+
+    ImGui::Spacing();
+    ImGui::Separator();
+    ImGui::TextDisabled("会话");
+    ImGui::SetNextItemWidth(-1);
+    ImGui::InputText("##SessionPath", sessionPath, IM_ARRAYSIZE(sessionPath));
+    const bool saving = g_SessionSaver.isRunning();
+    if (saving) {
+        ImGui::BeginDisabled();
+        ImGui::Button("正在后台保存...", ImVec2(-1, 0));
+        ImGui::EndDisabled();
+    } else if (ImGui::Button("保存会话", ImVec2(-1, 0))) {
+        g_SessionSaver.start(g_EpidemicData, sessionPath);
+    }
+    if (g_SessionLoader.isRunning()) {
+        ImGui::BeginDisabled();
+        ImGui::Button("正在后台载入...", ImVec2(-1, 0));
+        ImGui::EndDisabled();
+    } else if (ImGui::Button("载入会话", ImVec2(-1, 0))) {
+        g_SessionLoader.start(sessionPath);
+    }
+    // The file is mapped, verified and built on the loader thread; only the swap happens here
+    if (g_SessionLoader.poll(g_EpidemicData)) {
+        SnapshotLoadResult loadedSession = g_SessionLoader.getResult();
+        sessionError = !loadedSession.valid;
+        if (loadedSession.valid) {
+            char buf[200];
+            snprintf(buf, sizeof(buf), "已载入 %zu 个地区\n后台校验+构建 %.1f ms (%.0f MB/s)\n界面切换 %.2f ms",
+                     loadedSession.regions, loadedSession.loadSeconds * 1000.0, loadedSession.megabytesPerSecond, loadedSession.swapMs);
+            sessionStatus = buf;
+        } else {
+            sessionStatus = loadedSession.error;
+        }
+    }
+    if (saveWasRunning && !saving) {
+        SnapshotSaveResult saved = g_SessionSaver.getResult();
+        sessionError = !saved.valid;
+        if (saved.valid) {
+            char buf[200];
+            snprintf(buf, sizeof(buf), "已保存 %zu 个地区\n界面暂停 %.2f ms\n后台写出 %.1f MB, %.0f MB/s",
+                     saved.regions, saved.pauseMs, saved.bytes / 1048576.0, saved.megabytesPerSecond);
+            sessionStatus = buf;
+        } else {
+            sessionStatus = saved.error;
+        }
+    }
+    saveWasRunning = saving;
+    if (!sessionStatus.empty()) {
+        ImGui::PushTextWrapPos(0.0f);
+        ImGui::TextColored(sessionError ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", sessionStatus.c_str());
+        ImGui::PopTextWrapPos();
+    }
+    JournalStats journal = g_Journal.getStats();
+    if (journal.compactions > 0) {
+        ImGui::TextDisabled("自动检查点: 暂停 %.2f ms", journal.lastCompactPauseMs);
+    }
     
     ImGui::EndChild();
 }
@@ -321,58 +583,79 @@ void ShowDataPage() {
     
     if (ImGui::Button("录入新城市 (+)")) { ImGui::OpenPopup("Add New Region"); }
     ImGui::SameLine();
+
+    // Undo/redo (Ctrl+Z / Ctrl+Y outside text fields, and not while a dialog may be editing a region)
+    const bool shortcuts = !ImGui::GetIO().WantTextInput && !ImGui::IsPopupOpen(nullptr, ImGuiPopupFlags_AnyPopupId);
+    ImGui::BeginDisabled(!g_UndoHistory.canUndo());
+    if (ImGui::Button("撤销") || (shortcuts && g_UndoHistory.canUndo() && ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_Z))) {
+        g_UndoHistory.undo();
+    }
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    ImGui::BeginDisabled(!g_UndoHistory.canRedo());
+    if (ImGui::Button("重做") || (shortcuts && g_UndoHistory.canRedo() && ImGui::IsKeyChordPressed(ImGuiMod_Ctrl | ImGuiKey_Y))) {
+        g_UndoHistory.redo();
+    }
+    ImGui::EndDisabled();
+    if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+        ImGui::SetTooltip("可撤销 %zu 步，可重做 %zu 步 (占用 %.1f KB)", g_UndoHistory.getUndoSteps(),
+                          g_UndoHistory.getRedoSteps(), g_UndoHistory.getMemoryBytes() / 1024.0);
+    }
+    ImGui::SameLine();
     
-    // Export to CSV button
-    if (ImGui::Button("导出 Excel (CSV)")) {
-        auto& regions = g_EpidemicData.getRegions();
-        
+    // Export to CSV button (formatting and file writes run on a background thread)
+    DataExporter& exporter = g_DataExporter;
+    static ExportOptions export_options;
+    static bool export_was_running = false;
+    static std::string exportStatus;
+    if (exporter.isRunning()) {
+        ImGui::ProgressBar(static_cast<float>(exporter.getProgress()), ImVec2(150, 0), "导出中...");
+        ImGui::SameLine();
+        if (ImGui::SmallButton("取消导出")) { exporter.cancel(); }
+    } else if (ImGui::Button("导出 Excel (CSV)")) {
         // Generate filename with timestamp
         std::time_t now = std::time(nullptr);
         char timestamp[32];
         std::strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", std::localtime(&now));
-        std::string filename = std::string("epidemic_data_") + timestamp + ".csv";
-        
-        // Get full path (Windows)
-        char fullPath[MAX_PATH];
-        GetCurrentDirectoryA(MAX_PATH, fullPath);
-        exportedFilePath = std::string(fullPath) + "\\" + filename;
-        
-        // Open file for writing
-        std::ofstream file(filename);
-        if (file.is_open()) {
-            // Write CSV header with BOM for Excel UTF-8 support
-            file << "\xEF\xBB\xBF"; // UTF-8 BOM
-            file << "城市名称,总人口,累计确诊,累计治愈,累计死亡,活跃病例,风险等级\n";
-            
-            // Write data rows
-            for (const auto& r : regions) {
-                int active = r.confirmedCases - r.recoveredCases - r.deaths;
-                RiskLevel level = EpidemicData::calculateRiskLevel(r);
-                const char* riskStr = EpidemicData::getRiskLevelString(level);
-                
-                file << r.name << ","
-                     << r.population << ","
-                     << r.confirmedCases << ","
-                     << r.recoveredCases << ","
-                     << r.deaths << ","
-                     << active << ","
-                     << riskStr << "\n";
-            }
-            
-            file.close();
-            exportSuccess = true;
-        }
+        export_options.pathPrefix = std::string("epidemic_data_") + timestamp;
+
+        exportSuccess = false;
+        exporter.start(g_EpidemicData, export_options);
     }
     if (ImGui::IsItemHovered()) {
         ImGui::SetTooltip("导出城市数据为CSV文件（可用Excel打开）");
     }
-    
+    ImGui::SameLine();
+    if (ImGui::ArrowButton("##ExportOptions", ImGuiDir_Down)) { ImGui::OpenPopup("ExportOptions"); }
+    if (ImGui::BeginPopup("ExportOptions")) {
+        ImGui::Checkbox("汇总表", &export_options.summary);
+        ImGui::Checkbox("完整历史记录 (每城市每天一行)", &export_options.history);
+        ImGui::Checkbox("SIR 模拟轨迹", &export_options.trajectories);
+        ImGui::EndPopup();
+    }
+
+    if (export_was_running && !exporter.isRunning()) {
+        ExportResult r = exporter.getResult();
+        exportSuccess = r.valid;
+        char buf[160];
+        snprintf(buf, sizeof(buf), "%zu 个文件, %.1f MB, 用时 %.2f s (%.0f MB/s)",
+                 r.files.size(), r.bytes / 1e6, r.seconds, r.megabytesPerSecond);
+        exportStatus = r.valid ? buf : r.error;
+        if (r.valid && !r.files.empty()) {
+            // Get full path (Windows)
+            char fullPath[MAX_PATH];
+            GetCurrentDirectoryA(MAX_PATH, fullPath);
+            exportedFilePath = std::string(fullPath) + "\\" + r.files.front();
+        }
+    }
+    export_was_running = exporter.isRunning();
+
     // Show export success message
     if (exportSuccess) {
         ImGui::SameLine();
         ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "[导出成功!]");
         if (ImGui::IsItemHovered()) {
-            ImGui::SetTooltip("%s", exportedFilePath.c_str());
+            ImGui::SetTooltip("%s\n%s", exportedFilePath.c_str(), exportStatus.c_str());
         }
         ImGui::SameLine();
         if (ImGui::SmallButton("打开文件夹")) {
@@ -383,12 +666,16 @@ void ShowDataPage() {
         ImGui::SameLine();
         if (ImGui::SmallButton("X")) {
             exportSuccess = false;
+            exportStatus.clear();
         }
+    } else if (!exportStatus.empty() && !exporter.isRunning()) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", exportStatus.c_str());
     }
     
     ImGui::SameLine();
     static char searchBuffer[128] = "";
-    ImGui::InputTextWithHint("##Search", "输入城市名查询...", searchBuffer, IM_ARRAYSIZE(searchBuffer));
+    ImGui::InputTextWithHint("##Search", "城市名 / 拼音 / 首字母...", searchBuffer, IM_ARRAYSIZE(searchBuffer));
     
     // 风险等级筛选
     ImGui::SameLine();
@@ -399,6 +686,333 @@ void ShowDataPage() {
     ImGui::SetNextItemWidth(120);
     ImGui::Combo("##RiskFilter", &riskFilter, riskItems, IM_ARRAYSIZE(riskItems));
 
+    // --- Columnar data file (memory-mapped) ---
+    if (ImGui::CollapsingHeader("数据文件 (列式二进制)")) {
+        static ColumnarStore store;
+        static char storePath[260] = "epidemic_data.epcol";
+        static std::string storeStatus;
+        static bool storeError = false;
+
+        ImGui::SetNextItemWidth(300);
+        ImGui::InputText("文件路径##ColumnarStore", storePath, IM_ARRAYSIZE(storePath));
+        ImGui::SameLine();
+        if (g_SessionSaver.isRunning()) {
+            ImGui::BeginDisabled();
+            ImGui::Button("正在保存...");
+            ImGui::EndDisabled();
+        } else if (ImGui::Button("保存当前数据")) {
+            store.close(); // The mapping must be released before the file can be replaced
+            g_SessionSaver.start(g_EpidemicData, storePath);
+            storeStatus = "已在后台保存，进度与耗时见左侧状态栏";
+            storeError = false;
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("映射打开")) {
+            std::string error;
+            auto t0 = std::chrono::steady_clock::now();
+            storeError = !store.open(storePath, &error);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            char buf[160];
+            snprintf(buf, sizeof(buf), "已映射 %zu 个地区 / %zu 条历史记录 (%.1f MB)，用时 %.2f ms",
+                     store.getRegionCount(), store.getRecordCount(), store.getFileSize() / 1048576.0, ms);
+            storeStatus = storeError ? error : buf;
+        }
+        if (store.isOpen()) {
+            ImGui::SameLine();
+            if (ImGui::Button("载入到数据模型")) {
+                std::string error;
+                auto t0 = std::chrono::steady_clock::now();
+                storeError = !store.verify(&error);
+                double verifyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                if (!storeError) {
+                    store.materialize(g_EpidemicData);
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                    char buf[160];
+                    snprintf(buf, sizeof(buf), "已载入 %zu 个地区，用时 %.1f ms (其中校验 %.1f ms)",
+                             store.getRegionCount(), ms, verifyMs);
+                    storeStatus = buf;
+                } else {
+                    storeStatus = error;
+                }
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("替换当前全部地区数据");
+            }
+        }
+        if (!storeStatus.empty()) {
+            ImGui::TextColored(storeError ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", storeStatus.c_str());
+        }
+    }
+
+    // --- Edit journal (crash recovery) ---
+    if (ImGui::CollapsingHeader("编辑日志 (崩溃恢复)")) {
+        const JournalRecovery& rec = g_JournalRecovery;
+        if (rec.recovered) {
+            ImGui::Text("启动恢复: 快照 %zu 个地区 (%.1f ms)，重放 %zu 条日志 (%.1f ms, %.0f 条/秒)",
+                        rec.regions, rec.snapshotSeconds * 1000.0, rec.replayedRecords,
+                        rec.replaySeconds * 1000.0, rec.recordsPerSecond);
+        } else {
+            ImGui::TextDisabled("启动时没有可恢复的会话，已从演示数据开始");
+        }
+        if (!rec.error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "%s", rec.error.c_str());
+        }
+
+        JournalStats stats = g_Journal.getStats();
+        if (stats.open) {
+            ImGui::Text("已记录 %zu 次编辑 (LSN %llu，已落盘 %llu)，日志 %.1f KB，%zu 次 fsync",
+                        stats.edits, (unsigned long long)stats.appendedLsn, (unsigned long long)stats.durableLsn,
+                        stats.journalBytes / 1024.0, stats.batches);
+            ImGui::Text("单次编辑追加 %.2f us，提交延迟 p50 %.2f ms / p99 %.2f ms",
+                        stats.appendMicros, stats.commitP50Ms, stats.commitP99Ms);
+            ImGui::Text("快照 LSN %llu，已压缩 %zu 次%s (最近一次暂停 %.2f ms，后台写出 %.2f s)",
+                        (unsigned long long)stats.snapshotLsn, stats.compactions, stats.compacting ? " (进行中)" : "",
+                        stats.lastCompactPauseMs, stats.lastCompactSeconds);
+        } else {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "编辑日志未打开，本次修改不会被保存");
+        }
+        if (!stats.error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", stats.error.c_str());
+        }
+        if (stats.open && ImGui::Button("立即压缩")) {
+            g_Journal.compact();
+        }
+    }
+
+    // --- Live tail-follow of an appending CSV file ---
+    if (ImGui::CollapsingHeader("实时跟踪追加文件")) {
+        static char tail_path[260] = "feed.csv";
+        static std::string tail_error;
+
+        ImGui::TextWrapped("上游任务持续向文件追加行 (长表或宽表，格式同CSV导入)。每10毫秒检查一次文件，"
+                           "只解析新增的完整行并合并进对应地区，只有被更新的地区会重新计算。");
+        ImGui::InputText("文件路径##Tail", tail_path, sizeof(tail_path));
+        if (!g_TailFollower.isFollowing()) {
+            if (ImGui::Button("开始跟踪")) {
+                tail_error.clear();
+                g_TailFollower.start(g_EpidemicData, tail_path, CsvImportOptions(), &tail_error);
+            }
+        } else if (ImGui::Button("停止跟踪")) {
+            g_TailFollower.stop();
+        }
+        if (!tail_error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", tail_error.c_str());
+        }
+
+        TailFollowStats tail = g_TailFollower.getStats();
+        if (tail.following || tail.batches > 0) {
+            ImGui::Text("%s: 已读取 %.1f KB，%zu 批 (%zu 批走批量导入)，%zu 行 / %zu 条记录",
+                        tail.following ? "跟踪中" : "已停止", tail.offset / 1024.0, tail.batches, tail.bulkBatches,
+                        tail.rows, tail.records);
+            ImGui::Text("最近一批更新 %zu 个地区，合并用时 %.2f ms (平均 %.2f ms)",
+                        tail.lastRegions, tail.lastApplyMs, tail.meanApplyMs);
+            ImGui::Text("检测到追加 -> 已更新: p50 %.1f ms / p99 %.1f ms / 最大 %.1f ms",
+                        tail.latencyP50Ms, tail.latencyP99Ms, tail.latencyMaxMs);
+            if (tail.truncations > 0) {
+                ImGui::TextDisabled("文件被重写 %zu 次，已从头重新读取", tail.truncations);
+            }
+        }
+        if (!tail.error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "%s", tail.error.c_str());
+        }
+    }
+
+    // --- Local HTTP/JSON API ---
+    if (ImGui::CollapsingHeader("本地 HTTP 接口服务")) {
+        static int api_port = ApiServer::DefaultPort;
+        static std::string api_error;
+
+        ImGui::TextWrapped("在 127.0.0.1 上提供 JSON 接口 (/api/summary、/api/regions、/api/forecast 等)，"
+                           "供其他工具查询与修改数据。读请求直接读取数据快照，写请求在界面线程执行并写入编辑日志。"
+                           "也可以用 --serve [端口] 参数无界面运行。");
+        ImGui::SetNextItemWidth(120);
+        ImGui::InputInt("端口##Api", &api_port);
+        api_port = std::max(1, std::min(api_port, 65535));
+        ImGui::SameLine();
+        if (!g_ApiServer.isRunning()) {
+            if (ImGui::Button("启动服务")) {
+                api_error.clear();
+                g_ApiServer.start(g_EpidemicData, api_port, 0, &api_error);
+            }
+        } else if (ImGui::Button("停止服务")) {
+            g_ApiServer.stop();
+        }
+        if (!api_error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", api_error.c_str());
+        }
+
+        ApiServerStats api = g_ApiServer.getStats();
+        if (api.running) {
+            ImGui::Text("监听 http://127.0.0.1:%d/api/ ，%u 个工作线程，当前 %zu 个连接 (累计 %zu)",
+                        api.port, api.workers, api.openConnections, api.acceptedConnections);
+            ImGui::Text("已响应 %zu 个请求 (%zu 个客户端错误)，执行 %zu 次修改，发布快照 %zu 次 (最近 %.2f ms)",
+                        api.requests, api.clientErrors, api.mutations, api.snapshotsPublished, api.lastPublishMs);
+            ImGui::Text("服务端延迟: p50 %.2f ms / p99 %.2f ms", api.latencyP50Ms, api.latencyP99Ms);
+        }
+    }
+
+    // --- Shared-memory feed from an external producer ---
+    if (ImGui::CollapsingHeader("共享内存数据通道")) {
+        static char feed_name[64] = "EpidemicFeed";
+        static std::string feed_error;
+
+        ImGui::TextWrapped("外部 ETL 进程通过命名共享内存推送定长记录 (地区下标、天、确诊、治愈、死亡)，"
+                           "接收线程整理后每帧写入数据，每帧最多占用 %d 毫秒。", SharedFeed::ApplyBudgetMillis);
+        ImGui::InputText("通道名称##Feed", feed_name, sizeof(feed_name));
+        if (!g_SharedFeed.isRunning()) {
+            if (ImGui::Button("启动通道")) {
+                feed_error.clear();
+                g_SharedFeed.start(g_EpidemicData, feed_name, SharedFeed::DefaultCapacity, &feed_error);
+            }
+        } else if (ImGui::Button("关闭通道")) {
+            g_SharedFeed.stop();
+        }
+        if (!feed_error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", feed_error.c_str());
+        }
+
+        SharedFeedStats feed = g_SharedFeed.getStats();
+        if (feed.running || feed.received > 0) {
+            ImGui::Text("%s: 容量 %zu 条，已接收 %zu 条 (合并重复 %zu)，已写入 %zu 条，拒绝 %zu 条",
+                        feed.running ? "运行中" : "已关闭", feed.capacity, feed.received, feed.coalesced,
+                        feed.applied, feed.rejected);
+            ImGui::Text("写入速度 %.0f 条/秒，等待写入 %zu 条，缓冲区最高占用 %zu 条",
+                        feed.recordsPerSecond, feed.queued, feed.ringHighWater);
+            ImGui::Text("每帧写入 %.2f ms (平均 %.2f ms，%zu 帧走批量路径)，接收 -> 写入: p50 %.1f ms / p99 %.1f ms",
+                        feed.lastApplyMs, feed.meanApplyMs, feed.bulkBatches, feed.latencyP50Ms, feed.latencyP99Ms);
+        }
+    }
+
+    // --- NumPy .npy/.npz export and import ---
+    if (ImGui::CollapsingHeader("NumPy 导出/导入 (.npy/.npz)")) {
+        static char npz_path[260] = "history.npz";
+        static std::string npz_load_message;
+        static bool numpy_was_running = false;
+        static NumpyIoResult numpy_result;
+
+        ImGui::TextWrapped("历史记录导出为 np.load 可直接读取的 .npz (names, population, confirmed, recovered, deaths, "
+                           "offsets, history)，地区 i 的记录为 history[offsets[i]:offsets[i+1]]。"
+                           "数据按内存原样写出，导入时内存映射文件。");
+        ImGui::InputText("文件路径##Npz", npz_path, sizeof(npz_path));
+        if (g_NumpyIO.isRunning()) {
+            ImGui::TextDisabled("后台写入中...");
+        } else {
+            if (ImGui::Button("导出历史记录 (.npz)")) {
+                g_NumpyIO.startHistoryExport(g_EpidemicData.captureSnapshot(), npz_path);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("导入历史记录 (.npz)")) {
+                std::string error;
+                auto t0 = std::chrono::steady_clock::now();
+                if (NumpyIO::LoadHistory(npz_path, g_EpidemicData, &error)) {
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                    npz_load_message = "已导入 " + std::to_string(g_EpidemicData.getRegions().size()) + " 个地区，用时 " +
+                                       std::to_string(static_cast<int>(ms)) + " ms";
+                } else {
+                    npz_load_message = "导入失败: " + error;
+                }
+            }
+        }
+        if (numpy_was_running && !g_NumpyIO.isRunning()) {
+            numpy_result = g_NumpyIO.getResult();
+        }
+        numpy_was_running = g_NumpyIO.isRunning();
+        if (numpy_result.valid) {
+            ImGui::Text("已写出 %s: %.1f MB，用时 %.1f ms (%.0f MB/s)", numpy_result.path.c_str(),
+                        numpy_result.bytes / 1048576.0, numpy_result.seconds * 1000.0, numpy_result.megabytesPerSecond);
+        } else if (!numpy_result.error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", numpy_result.error.c_str());
+        }
+        if (!npz_load_message.empty()) {
+            ImGui::TextWrapped("%s", npz_load_message.c_str());
+        }
+    }
+
+    // --- CSV time-series import (wide JHU / long layouts) ---
+    if (ImGui::CollapsingHeader("CSV 时间序列导入")) {
+        static CsvImporter csv_importer;
+        static CsvImportOptions csv_options;
+        static char csvPath[260] = "time_series_covid19_confirmed_global.csv";
+        static int csv_layout = 0;      // 0=自动, 1=宽表, 2=长表
+        static int csv_wide_field = 0;  // 0=确诊, 1=治愈, 2=死亡
+        static bool csv_replace = false;
+        static bool csv_was_running = false;
+        static bool csv_benchmark = false;
+        static std::string csvStatus;
+        static bool csvError = false;
+
+        ImGui::SetNextItemWidth(300);
+        ImGui::InputText("文件路径##CsvImport", csvPath, IM_ARRAYSIZE(csvPath));
+        const char* layoutItems[] = { "自动识别", "宽表 (JHU, 每天一列)", "长表 (每行一天)" };
+        const char* fieldItems[] = { "累计确诊", "累计治愈", "累计死亡" };
+        ImGui::SetNextItemWidth(180);
+        ImGui::Combo("布局##CsvImport", &csv_layout, layoutItems, IM_ARRAYSIZE(layoutItems));
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(120);
+        ImGui::Combo("宽表数值含义", &csv_wide_field, fieldItems, IM_ARRAYSIZE(fieldItems));
+        ImGui::SameLine();
+        ImGui::Checkbox("替换现有数据", &csv_replace);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("不勾选时按城市名称合并: 同名城市按天更新所导入的字段");
+        }
+        csv_options.layout = static_cast<CsvLayout>(csv_layout);
+        csv_options.wideField = 1 << csv_wide_field;
+
+        if (csv_importer.isRunning()) {
+            if (csv_importer.isGenerating()) {
+                ImGui::Text("正在生成基准测试文件...");
+            } else {
+                ImGui::ProgressBar(static_cast<float>(csv_importer.getProgress()), ImVec2(300, 0));
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("取消导入")) { csv_importer.cancel(); }
+        } else {
+            if (ImGui::Button("导入 CSV")) {
+                csv_benchmark = false;
+                csv_importer.start(csvPath, csv_options);
+            }
+            ImGui::SameLine();
+            if (ImGui::Button("吞吐量测试 (1 GB)")) {
+                csv_benchmark = true;
+                CsvLayout layout = (csv_options.layout == CsvLayout::Long) ? CsvLayout::Long : CsvLayout::Wide;
+                csv_importer.startBenchmark("csv_benchmark.csv", layout, size_t(1) << 30, csv_options);
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("生成约1GB的合成文件 (按所选布局) 并测量解析吞吐量，结果不载入数据模型");
+            }
+        }
+
+        if (csv_was_running && !csv_importer.isRunning()) {
+            CsvImportResult r = csv_importer.takeResult();
+            csvError = !r.valid;
+            if (r.valid) {
+                char buf[256];
+                snprintf(buf, sizeof(buf), "%s: %.1f MB, %zu 行, %zu 个地区, %zu 条记录, 用时 %.2f s (%.0f MB/s, %u 线程)",
+                         r.layout == CsvLayout::Wide ? "宽表" : "长表", r.bytes / 1e6, r.rows, r.regions.size(),
+                         r.records, r.parseSeconds, r.megabytesPerSecond, ThreadPool::instance().getWorkerCount());
+                csvStatus = buf;
+                if (r.skippedRows > 0) {
+                    snprintf(buf, sizeof(buf), ", 跳过 %zu 行", r.skippedRows);
+                    csvStatus += buf;
+                }
+                if (!csv_benchmark) {
+                    auto t0 = std::chrono::steady_clock::now();
+                    CsvImporter::Apply(r, g_EpidemicData, csv_replace);
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                    snprintf(buf, sizeof(buf), ", 合并用时 %.1f ms", ms);
+                    csvStatus += buf;
+                }
+            } else {
+                csvStatus = r.error;
+            }
+        }
+        csv_was_running = csv_importer.isRunning();
+
+        if (!csvStatus.empty()) {
+            ImGui::TextColored(csvError ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f) : ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "%s", csvStatus.c_str());
+        }
+    }
+
     // --- Popup for "Add New Region" ---
     if (ImGui::BeginPopupModal("Add New Region", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
         static char name[128] = "";
@@ -425,7 +1039,7 @@ void ShowDataPage() {
                 error_text = "累计确诊数不能少于治愈与死亡数之和。";
             } else {
                 error_text = "";
-                g_EpidemicData.addRegion(name, pop, confirmed, recovered, deaths);
+                g_UndoHistory.addRegion(name, pop, confirmed, recovered, deaths);
                 memset(name, 0, sizeof(name)); pop = confirmed = recovered = deaths = 0;
                 ImGui::CloseCurrentPopup();
             }
@@ -446,7 +1060,9 @@ void ShowDataPage() {
     }
 
     // --- Popup for "Edit Region" (Merged with History Management) ---
-    static int edit_index = -1;
+    // Handles, not indices: deleting another region (here, via the API or a journal replay) moves indices
+    static RegionHandle edit_handle;
+    int edit_index = g_EpidemicData.resolve(edit_handle);
     if (edit_index != -1) { ImGui::OpenPopup("Edit Region"); }
     
     if (ImGui::BeginPopupModal("Edit Region", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
@@ -455,11 +1071,16 @@ void ShowDataPage() {
         static const char* error_text = "";
         
         Region* region = g_EpidemicData.getRegion(edit_index);
+        if (!region) {
+            // The region was deleted while the dialog was open
+            edit_handle = RegionHandle();
+            ImGui::CloseCurrentPopup();
+        }
         
         if (ImGui::IsWindowAppearing() && region) {
             error_text = "";
             strncpy(name, region->name, 128);
-            pop = region->population;
+            pop = region->getPopulation();
         }
         
         if (region) {
@@ -503,52 +1124,38 @@ void ShowDataPage() {
                     ImGui::InputInt("死亡数", &h_deaths);
                     
                     if (ImGui::Button("添加/更新记录")) {
-                        bool found = false;
-                        for (auto& rec : region->history) {
-                            if (rec.day == day) {
-                                rec.confirmed = h_confirmed;
-                                rec.recovered = h_recovered;
-                                rec.deaths = h_deaths;
-                                found = true;
-                                break;
-                            }
-                        }
-                        if (!found) {
-                            region->history.push_back({day, h_confirmed, h_recovered, h_deaths});
-                            std::sort(region->history.begin(), region->history.end(), 
-                                [](const HistoricalRecord& a, const HistoricalRecord& b){ return a.day < b.day; });
-                        }
-                        
-                        // Update current state from last history record
-                        if (!region->history.empty()) {
-                            const auto& lastDay = region->history.back();
-                            region->confirmedCases = lastDay.confirmed;
-                            region->recoveredCases = lastDay.recovered;
-                            region->deaths = lastDay.deaths;
-                        }
+                        // Keeps history sorted and updates the current state from the last record
+                        g_UndoHistory.upsertHistoryRecord(edit_index, {day, h_confirmed, h_recovered, h_deaths});
                     }
                     
                     ImGui::Dummy(ImVec2(0, 10));
-                    ImGui::Text("已有历史记录 (%zu 条):", region->history.size());
+                    // Day range filter: years of records stay cheap to browse (range lookup + clipped list)
+                    static int range_from = 0, range_to = 100000;
+                    ImGui::SetNextItemWidth(100);
+                    ImGui::InputInt("起始天##HistoryRange", &range_from, 0);
+                    ImGui::SameLine(); ImGui::SetNextItemWidth(100);
+                    ImGui::InputInt("结束天##HistoryRange", &range_to, 0);
+                    const HistorySeries::Range shown = region->history.range(range_from, range_to);
+                    ImGui::Text("已有历史记录 (%zu 条，范围内 %zu 条):", region->history.size(), shown.size());
                     if (ImGui::BeginChild("HistoryList", ImVec2(500, 250), true)) {
-                        for (int i = 0; i < region->history.size(); ++i) {
-                            auto& rec = region->history[i];
-                            ImGui::Text("Day %d: 确诊:%d 治愈:%d 死亡:%d", 
-                                rec.day, rec.confirmed, rec.recovered, rec.deaths);
-                            ImGui::SameLine();
-                            if (ImGui::SmallButton((std::string("删除##") + std::to_string(i)).c_str())) {
-                                region->history.erase(region->history.begin() + i);
-                                
-                                // Update current state from new last record
-                                if (!region->history.empty()) {
-                                    const auto& lastDay = region->history.back();
-                                    region->confirmedCases = lastDay.confirmed;
-                                    region->recoveredCases = lastDay.recovered;
-                                    region->deaths = lastDay.deaths;
+                        int delete_day = -1;
+                        bool delete_clicked = false;
+                        ImGuiListClipper clipper;
+                        clipper.Begin(static_cast<int>(shown.size()));
+                        while (clipper.Step()) {
+                            for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                                const HistoricalRecord& rec = shown.first[i];
+                                ImGui::Text("Day %d: 确诊:%d 治愈:%d 死亡:%d",
+                                    rec.day, rec.confirmed, rec.recovered, rec.deaths);
+                                ImGui::SameLine();
+                                if (ImGui::SmallButton((std::string("删除##") + std::to_string(rec.day)).c_str())) {
+                                    delete_day = rec.day;
+                                    delete_clicked = true;
                                 }
-                                i--;
                             }
                         }
+                        // Deleting may reallocate the history, so it happens after the list is drawn
+                        if (delete_clicked) g_UndoHistory.deleteHistoryRecord(edit_index, delete_day);
                         ImGui::EndChild();
                     }
                     
@@ -569,16 +1176,19 @@ void ShowDataPage() {
                     error_text = "总人口必须大于0。";
                 } else {
                     error_text = "";
-                    strncpy(region->name, name, 128);
-                    region->population = pop;
-                    edit_index = -1;
+                    // One undo step for both fields
+                    g_UndoHistory.beginStep();
+                    g_UndoHistory.renameRegion(edit_index, name);
+                    g_UndoHistory.setRegionPopulation(edit_index, pop);
+                    g_UndoHistory.endStep();
+                    edit_handle = RegionHandle();
                     ImGui::CloseCurrentPopup();
                 }
             }
             ImGui::SameLine();
             if (ImGui::Button("取消", ImVec2(120, 0))) {
                 error_text = "";
-                edit_index = -1;
+                edit_handle = RegionHandle();
                 ImGui::CloseCurrentPopup();
             }
             
@@ -593,7 +1203,8 @@ void ShowDataPage() {
     ImGui::Spacing();
 
     // --- 历史记录查询弹窗 ---
-    static int history_view_index = -1;
+    static RegionHandle history_view_handle;
+    const int history_view_index = g_EpidemicData.resolve(history_view_handle);
     if (history_view_index != -1) { 
         ImGui::OpenPopup("View History"); 
     }
@@ -608,7 +1219,9 @@ void ShowDataPage() {
             
             if (!region.history.empty()) {
                 // 显示历史数据趋势图
-                std::vector<double> hist_days, hist_confirmed, hist_recovered, hist_deaths, hist_active;
+                std::pmr::memory_resource* scratch = g_FrameArena.resource();
+                std::pmr::vector<double> hist_days(scratch), hist_confirmed(scratch), hist_recovered(scratch),
+                    hist_deaths(scratch), hist_active(scratch);
                 for (const auto& rec : region.history) {
                     hist_days.push_back(static_cast<double>(rec.day));
                     hist_confirmed.push_back(static_cast<double>(rec.confirmed));
@@ -673,8 +1286,8 @@ void ShowDataPage() {
         }
         
         ImGui::Spacing();
-        if (ImGui::Button("关闭", ImVec2(120, 0))) {
-            history_view_index = -1;
+        if (ImGui::Button("关闭", ImVec2(120, 0)) || history_view_index == -1) {
+            history_view_handle = RegionHandle();
             ImGui::CloseCurrentPopup();
         }
         
@@ -694,52 +1307,80 @@ void ShowDataPage() {
         ImGui::TableHeadersRow();
 
         auto& regions = g_EpidemicData.getRegions();
+        const RegionColumns& columns = g_EpidemicData.getColumns();
         int region_to_delete = -1;
 
-        for (int i = 0; i < regions.size(); ++i) {
-            // 应用搜索筛选
-            if (searchBuffer[0] != '\0' && strstr(regions[i].name, searchBuffer) == nullptr) continue;
-            
-            // 应用风险等级筛选
-            RiskLevel level = EpidemicData::calculateRiskLevel(regions[i]);
-            if (riskFilter == 1 && level != RiskLevel::High) continue;
-            if (riskFilter == 2 && level != RiskLevel::Medium) continue;
-            if (riskFilter == 3 && level != RiskLevel::Low) continue;
-            
-            ImGui::PushID(i);
-            ImGui::TableNextRow();
-            Region& region = regions[i];
-
-            ImGui::TableSetColumnIndex(0); ImGui::Text("%s", region.name);
-            ImGui::TableSetColumnIndex(1); ImGui::Text("%d", region.population);
-            ImGui::TableSetColumnIndex(2); ImGui::Text("%d", region.confirmedCases);
-            ImGui::TableSetColumnIndex(3); ImGui::Text("%d", region.recoveredCases);
-            ImGui::TableSetColumnIndex(4); ImGui::Text("%d", region.deaths);
-
-            ImGui::TableSetColumnIndex(5);
-            ImGui::TextColored(EpidemicData::getRiskLevelColor(level), "%s", EpidemicData::getRiskLevelString(level));
+        // 有搜索词时先查名称索引，再只对匹配的地区检查 (缓存的) 风险等级；
+        // 只按风险等级筛选时取该等级的链表，成员变化后才重新排成表格顺序
+        static std::vector<uint32_t> visible;
+        static std::vector<uint32_t> bucket_rows;
+        static uint64_t bucket_version = 0;
+        static int bucket_filter = 0;
+        visible.clear();
+        const RiskLevel wanted = riskFilter == 1 ? RiskLevel::High : riskFilter == 2 ? RiskLevel::Medium : RiskLevel::Low;
+        if (searchBuffer[0] != '\0') {
+            g_RegionSearch.find(searchBuffer, visible);
+            if (riskFilter != 0) {
+                visible.erase(std::remove_if(visible.begin(), visible.end(),
+                    [&](uint32_t i) { return columns.risk[i] != wanted; }), visible.end());
+            }
+        } else if (riskFilter == 0) {
+            visible.resize(regions.size());
+            for (size_t i = 0; i < visible.size(); ++i) visible[i] = static_cast<uint32_t>(i);
+        } else {
+            if (bucket_filter != riskFilter || bucket_version != columns.getRiskVersion()) {
+                bucket_rows.clear();
+                columns.collectRisk(wanted, bucket_rows);
+                std::sort(bucket_rows.begin(), bucket_rows.end());
+                bucket_filter = riskFilter;
+                bucket_version = columns.getRiskVersion();
+            }
+            visible.assign(bucket_rows.begin(), bucket_rows.end());
+        }
 
-            ImGui::TableSetColumnIndex(6);
-            if (!region.history.empty()) {
-                ImGui::Text("%zu 条", region.history.size());
-                ImGui::SameLine();
-                if (ImGui::SmallButton("查看")) { 
-                    history_view_index = i; 
+        // Only the rows in view are submitted
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(visible.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const int i = static_cast<int>(visible[row]);
+                const RiskLevel level = columns.risk[i];
+
+                ImGui::PushID(i);
+                ImGui::TableNextRow();
+                Region& region = regions[i];
+
+                ImGui::TableSetColumnIndex(0); ImGui::Text("%s", region.name);
+                ImGui::TableSetColumnIndex(1); ImGui::Text("%d", region.getPopulation());
+                ImGui::TableSetColumnIndex(2); ImGui::Text("%d", region.getConfirmedCases());
+                ImGui::TableSetColumnIndex(3); ImGui::Text("%d", region.getRecoveredCases());
+                ImGui::TableSetColumnIndex(4); ImGui::Text("%d", region.getDeaths());
+
+                ImGui::TableSetColumnIndex(5);
+                ImGui::TextColored(EpidemicData::getRiskLevelColor(level), "%s", EpidemicData::getRiskLevelString(level));
+
+                ImGui::TableSetColumnIndex(6);
+                if (!region.history.empty()) {
+                    ImGui::Text("%zu 条", region.history.size());
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("查看")) { 
+                        history_view_handle = g_EpidemicData.getHandle(i); 
+                    }
+                } else {
+                    ImGui::TextDisabled("无");
                 }
-            } else {
-                ImGui::TextDisabled("无");
-            }
 
-            ImGui::TableSetColumnIndex(7);
-            if (ImGui::Button("修改")) { edit_index = i; }
-            ImGui::SameLine();
-            if (ImGui::Button("删除")) { region_to_delete = i; }
+                ImGui::TableSetColumnIndex(7);
+                if (ImGui::Button("修改")) { edit_handle = g_EpidemicData.getHandle(i); }
+                ImGui::SameLine();
+                if (ImGui::Button("删除")) { region_to_delete = i; }
             
-            ImGui::PopID();
+                ImGui::PopID();
+            }
         }
 
         if (region_to_delete != -1) {
-            g_EpidemicData.deleteRegion(region_to_delete);
+            g_UndoHistory.deleteRegion(region_to_delete);
         }
 
         ImGui::EndTable();
@@ -749,9 +1390,10 @@ void ShowDataPage() {
 // Helper struct for ImPlot's PlotLine function
 struct PlotData {
     std::vector<double> days, s, i, r;
-    void FromHistory(const std::vector<SIRDataPoint>& history) {
+    void FromHistory(const SIRDataPoint* history, size_t count) {
         days.clear(); s.clear(); i.clear(); r.clear();
-        for (const auto& p : history) {
+        for (size_t k = 0; k < count; ++k) {
+            const SIRDataPoint& p = history[k];
             days.push_back(p.day); s.push_back(p.susceptible);
             i.push_back(p.infected); r.push_back(p.recovered);
         }
@@ -803,9 +1445,27 @@ void ShowPredictionPage() {
         ImGui::Separator();
     }
 
-    static int selected_region_idx = 0;
+    static RegionHandle selected_region; // Follows the city while others are added or deleted
     static bool auto_fit_plot = true; // Control axis fitting
+    static ResponseSurfaceEmulator emulator; // Beta x Gamma lattice per region, built in the background
+    static std::vector<SIRDataPoint> preview_points;
+    static bool show_preview = false;
+    static InterventionOptimizer intervention_optimizer; // Searches beta(t) schedules in the background
+    static InterventionConfig intervention_config;
+    static InterventionPlan intervention_plan;
+    static bool intervention_was_running = false;
+    static bool show_intervention = false;
+    static RenewalResult renewal_result; // Nowcast + renewal forecast of the selected region
+    static RenewalConfig renewal_config;
+    static bool show_renewal = false;
+    static uint64_t seen_generation = 0; // Tail-follow generation of the selected region last simulated
     auto& regions = g_EpidemicData.getRegions();
+    int selected_region_idx = g_EpidemicData.resolve(selected_region);
+    const bool selection_lost = selected_region_idx < 0; // First frame, or the selected city was deleted
+    if (selection_lost) {
+        selected_region_idx = 0;
+        selected_region = g_EpidemicData.getHandle(0);
+    }
     ImGui::Columns(2, "PredCols", false); ImGui::SetColumnWidth(0, 320);
 
     // --- Left side: Controls ---
@@ -815,13 +1475,15 @@ void ShowPredictionPage() {
         const char* current_name = (selected_region_idx < regions.size()) ? regions[selected_region_idx].name : "无";
         
         static bool first_run = true;
-        bool should_run_sim = false;
+        bool should_run_sim = selection_lost && !regions.empty();
+        if (selection_lost) auto_fit_plot = true;
 
         if (ImGui::BeginCombo("选择城市", current_name)) {
             for (int i = 0; i < regions.size(); ++i) {
                 if (ImGui::Selectable(regions[i].name, selected_region_idx == i)) { 
                     if (selected_region_idx != i) {
                         selected_region_idx = i;
+                        selected_region = g_EpidemicData.getHandle(i);
                         should_run_sim = true; 
                         auto_fit_plot = true; // City changed, so fit the plot
                     }
@@ -846,12 +1508,91 @@ void ShowPredictionPage() {
             if (ImGui::IsItemHovered()) {
                 ImGui::SetTooltip("根据已录入的历史确诊/治愈/死亡数据，自动估算平均传染率(Beta)和恢复率(Gamma)。\n至少需要2天的历史记录。");
             }
+
+            // --- ABC-SMC 校准 (后台线程并行模拟粒子) ---
+            static ABCSMCCalibrator abc_calibrator;
+            static ABCConfig abc_config;
+            static ABCResult abc_result;
+            static bool abc_was_running = false;
+            static uint64_t abc_generation = 0; // Data generation the calibration was started on
+
+            if (ImGui::CollapsingHeader("ABC-SMC 贝叶斯校准")) {
+                int model_kind = static_cast<int>(abc_config.model);
+                const char* model_items[] = { "确定性 SIR", "随机链式二项 SIR" };
+                ImGui::Combo("模型", &model_kind, model_items, IM_ARRAYSIZE(model_items));
+                abc_config.model = static_cast<ABCConfig::ModelKind>(model_kind);
+                ImGui::SliderInt("粒子数", &abc_config.particleCount, 100, 5000);
+                ImGui::SliderInt("最大代数", &abc_config.maxGenerations, 1, 20);
+
+                if (abc_calibrator.isRunning()) {
+                    ImGui::Text("运行中: 第 %d 代, 已接受 %lld 个粒子", abc_calibrator.getGeneration() + 1, abc_calibrator.getAcceptedCount());
+                    if (ImGui::Button("取消校准")) { abc_calibrator.cancel(); }
+                } else {
+                    const Region& r = regions[selected_region_idx];
+                    if (r.history.size() < 2 || r.getPopulation() <= 0) {
+                        ImGui::TextDisabled("至少需要2天的历史记录。");
+                    } else if (ImGui::Button("开始 ABC-SMC 校准")) {
+                        abc_calibrator.start(ObservedSeries::FromRegion(r), abc_config);
+                        abc_generation = g_TailFollower.getRegionGeneration(selected_region_idx);
+                    }
+                }
+
+                if (abc_result.valid) {
+                    ImGui::Text("Beta  = %.4f ± %.4f", abc_result.betaMean, abc_result.betaStd);
+                    ImGui::Text("Gamma = %.4f ± %.4f", abc_result.gammaMean, abc_result.gammaStd);
+                    ImGui::Text("容差 ε = %.4f (%d 代, %lld 次模拟)", abc_result.epsilon, abc_result.generations, abc_result.totalSimulations);
+                    ImGui::Text("接受粒子: %.0f 个/秒", abc_result.acceptedPerSecond);
+                    if (g_TailFollower.getRegionGeneration(selected_region_idx) != abc_generation) {
+                        ImGui::TextDisabled("校准后该地区又收到了新数据，可重新校准");
+                    }
+                    if (ImGui::Button("应用后验均值")) {
+                        beta = (float)abc_result.betaMean;
+                        gamma = (float)abc_result.gammaMean;
+                        should_run_sim = true;
+                    }
+                    ImGui::SameLine();
+                    if (!g_NumpyIO.isRunning() && ImGui::Button("导出后验集合 (.npz)")) {
+                        // One trajectory per particle over the current horizon; written in the background
+                        g_NumpyIO.startEnsembleExport(
+                            SIREnsemble::FromPosterior(regions[selected_region_idx], abc_result.particles, days), "ensemble.npz");
+                    }
+                }
+            }
+            // Pick up the result once the background run finishes
+            if (abc_was_running && !abc_calibrator.isRunning()) {
+                abc_result = abc_calibrator.getResult();
+            }
+            abc_was_running = abc_calibrator.isRunning();
         }
-        
-        params_changed |= ImGui::SliderFloat("传染率 (Beta)", &beta, 0.0f, 2.0f, "%.3f");
-        params_changed |= ImGui::SliderFloat("恢复率 (Gamma)", &gamma, 0.0f, 1.0f, "%.3f");
+
+        // Beta/Gamma: while a slider is being dragged, show the emulator's interpolated curve;
+        // the exact simulation only runs once the slider is released.
+        bool emulator_ready = (selected_region_idx < regions.size()) && emulator.request(selected_region, regions[selected_region_idx]);
+        bool slider_changed = false, slider_dragging = false, slider_released = false;
+
+        slider_changed |= ImGui::SliderFloat("传染率 (Beta)", &beta, 0.0f, 2.0f, "%.3f");
+        slider_dragging |= ImGui::IsItemActive();
+        slider_released |= ImGui::IsItemDeactivatedAfterEdit();
+        slider_changed |= ImGui::SliderFloat("恢复率 (Gamma)", &gamma, 0.0f, 1.0f, "%.3f");
+        slider_dragging |= ImGui::IsItemActive();
+        slider_released |= ImGui::IsItemDeactivatedAfterEdit();
         params_changed |= ImGui::SliderInt("预测天数", &days, 10, 365);
 
+        show_preview = slider_dragging && emulator_ready;
+        if (show_preview) {
+            emulator.interpolate(selected_region, regions[selected_region_idx], beta, gamma, days, preview_points);
+        } else if (slider_changed) {
+            params_changed = true; // Lattice not built yet: fall back to the exact simulation
+        }
+        if (slider_released) {
+            params_changed = true;
+        }
+        if (show_preview) {
+            ImGui::TextDisabled("拖动中: 显示响应面插值预览");
+        } else if (!emulator_ready) {
+            ImGui::TextDisabled("响应面网格构建中...");
+        }
+
         if (params_changed) {
             should_run_sim = true;
             // auto_fit_plot = true; // Parameters changed, so fit the plot. Let user click "Reset View" instead.
@@ -862,26 +1603,30 @@ void ShowPredictionPage() {
             auto_fit_plot = true;
         }
 
+        // Rows appended to a followed file changed the selected region: re-run only its forecasts
+        if (selected_region_idx < regions.size()) {
+            uint64_t region_generation = g_TailFollower.getRegionGeneration(selected_region_idx);
+            if (region_generation != seen_generation) {
+                seen_generation = region_generation;
+                should_run_sim = true;
+                if (renewal_result.valid) {
+                    std::vector<const Region*> batch = { &regions[selected_region_idx] };
+                    RenewalModel model(renewal_config, RenewalModel::MaxSeriesLength(batch));
+                    renewal_result = model.forecast(regions[selected_region_idx]);
+                }
+            }
+        }
+
         if (first_run || should_run_sim) {
             if (selected_region_idx < regions.size()) {
                 Region& r = regions[selected_region_idx];
                 r.simulation.setBeta(beta);
                 r.simulation.setGamma(gamma);
                 
-                // 如果有历史数据，从历史末端继续预测
-                if (!r.history.empty()) {
-                    const auto& lastHistory = r.history.back();
-                    int startDay = lastHistory.day + 1;  // 从历史最后一天的下一天开始
-                    int active = lastHistory.confirmed - lastHistory.recovered - lastHistory.deaths;
-                    int removed = lastHistory.recovered + lastHistory.deaths;
-                    
-                    r.simulation.reset(r.population, active > 0 ? active : 1, removed, startDay);
-                } else {
-                    // 没有历史数据，从当前状态开始（Day 0）
-                    int active = r.confirmedCases - r.recoveredCases - r.deaths;
-                    r.simulation.reset(r.population, active > 0 ? active : 1, r.recoveredCases + r.deaths, 0);
-                }
-                
+                // 如果有历史数据，从历史末端继续预测；否则从当前状态开始（Day 0）
+                int startDay, active, removed;
+                r.getForecastOrigin(startDay, active, removed);
+                r.simulation.reset(r.getPopulation(), active, removed, startDay);
                 r.simulation.run(days);
             }
             if (first_run) { auto_fit_plot = true; } // Also auto-fit on the very first run
@@ -895,7 +1640,154 @@ void ShowPredictionPage() {
             Region& r = regions[selected_region_idx];
             ImGui::Text("Model Beta: %.3f", r.simulation.getBeta());
             ImGui::Text("Model Gamma: %.3f", r.simulation.getGamma());
+            static std::string trajectory_message;
+            if (ImGui::Button("保存当前轨迹 (.npy)")) {
+                std::string error;
+                trajectory_message = NumpyIO::SaveTrajectory("trajectory.npy", r.simulation.getHistory().data(), r.simulation.getHistory().size(), &error)
+                                         ? "已保存 trajectory.npy" : error;
+            }
+            if (!trajectory_message.empty()) {
+                ImGui::SameLine();
+                ImGui::TextDisabled("%s", trajectory_message.c_str());
+            }
+        }
+
+        // --- 全局敏感性分析 (Sobol 指数) ---
+        static SobolAnalyzer sobol_analyzer;
+        static SobolConfig sobol_config;
+        static SobolResult sobol_result;
+        static bool sobol_was_running = false;
+
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("全局敏感性分析 (Sobol)")) {
+            ImGui::SliderInt("基础样本数 N", &sobol_config.baseSamples, 256, 16384);
+            ImGui::TextDisabled("共需 %d 次模型运行", sobol_config.baseSamples * (SobolConfig::ParamCount + 2));
+
+            if (sobol_analyzer.isRunning()) {
+                ImGui::ProgressBar(sobol_analyzer.getProgress(), ImVec2(-1, 0));
+            } else if (selected_region_idx < regions.size() && ImGui::Button("计算 Sobol 指数", ImVec2(-1, 0))) {
+                const Region& r = regions[selected_region_idx];
+                int startDay, active, removed;
+                r.getForecastOrigin(startDay, active, removed);
+                sobol_config.population = r.getPopulation();
+                sobol_config.initialRemoved = removed;
+                sobol_config.days = days;
+                sobol_config.infectedMin = 1;
+                sobol_config.infectedMax = std::max(10, active * 4);
+                sobol_analyzer.start(sobol_config);
+            }
+
+            if (sobol_result.valid) {
+                ImGui::Text("%lld 次模型运行, %.0f 次/秒", sobol_result.evaluations, sobol_result.evaluationsPerSecond);
+
+                static const char* param_labels[] = { "Beta", "Gamma", "I0" };
+                static const char* index_labels[] = { "一阶 S1", "总效应 ST" };
+                static const double param_positions[] = { 0, 1, 2 };
+                const char* output_titles[] = { "峰值规模##Sobol", "峰值时间##Sobol" };
+                for (int o = 0; o < SobolResult::OutputCount; ++o) {
+                    double values[2 * SobolConfig::ParamCount];
+                    for (int i = 0; i < SobolConfig::ParamCount; ++i) {
+                        values[i] = sobol_result.firstOrder[o][i];
+                        values[SobolConfig::ParamCount + i] = sobol_result.totalOrder[o][i];
+                    }
+                    if (ImPlot::BeginPlot(output_titles[o], ImVec2(-1, 160), ImPlotFlags_NoMouseText)) {
+                        ImPlot::SetupAxes(nullptr, nullptr, ImPlotAxisFlags_None, ImPlotAxisFlags_AutoFit);
+                        ImPlot::SetupAxisTicks(ImAxis_X1, param_positions, SobolConfig::ParamCount, param_labels);
+                        ImPlot::PlotBarGroups(index_labels, values, 2, SobolConfig::ParamCount);
+                        ImPlot::EndPlot();
+                    }
+                }
+            }
+        }
+        // --- 干预方案优化 (sep-CMA-ES) ---
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("干预方案优化 (CMA-ES)")) {
+            static float capacity = 10000.0f;
+            ImGui::InputFloat("活跃病例上限", &capacity, 1000.0f, 10000.0f, "%.0f");
+            if (capacity < 1.0f) capacity = 1.0f;
+            ImGui::SliderInt("分段天数", &intervention_config.segmentDays, 7, 60);
+
+            if (intervention_optimizer.isRunning()) {
+                ImGui::Text("优化中: 第 %d 代", intervention_optimizer.getGeneration() + 1);
+                if (ImGui::Button("取消优化")) { intervention_optimizer.cancel(); }
+            } else if (selected_region_idx < regions.size() && ImGui::Button("搜索最低代价方案", ImVec2(-1, 0))) {
+                const Region& r = regions[selected_region_idx];
+                r.getForecastOrigin(intervention_config.startDay, intervention_config.initialInfected, intervention_config.initialRemoved);
+                intervention_config.population = r.getPopulation();
+                intervention_config.baseBeta = beta;
+                intervention_config.gamma = gamma;
+                intervention_config.days = days;
+                intervention_config.capacity = capacity;
+                intervention_optimizer.start(intervention_config);
+            }
+
+            if (intervention_plan.valid) {
+                ImGui::TextColored(intervention_plan.feasible ? ImVec4(0.0f, 1.0f, 0.0f, 1.0f) : ImVec4(1.0f, 0.0f, 0.0f, 1.0f),
+                                   intervention_plan.feasible ? "方案可行" : "未找到可行方案");
+                ImGui::Text("峰值: %.0f (无干预 %.0f)", intervention_plan.peakInfected, intervention_plan.uncontrolledPeak);
+                ImGui::Text("代价: %.2f 强度²·天", intervention_plan.cost);
+                ImGui::Text("%d 代, %lld 次评估, %.2f 秒 (%.0f 次/秒)", intervention_plan.generations,
+                            intervention_plan.evaluations, intervention_plan.elapsedSeconds, intervention_plan.evaluationsPerSecond);
+                ImGui::Checkbox("在图表中显示干预曲线", &show_intervention);
+            }
+        }
+        if (intervention_was_running && !intervention_optimizer.isRunning()) {
+            intervention_plan = intervention_optimizer.getResult();
+            show_intervention = intervention_plan.valid;
+        }
+        intervention_was_running = intervention_optimizer.isRunning();
+
+        // --- 更新方程预测 (世代间隔 + 报告延迟反卷积) ---
+        ImGui::Separator();
+        if (ImGui::CollapsingHeader("更新方程预测 (Renewal)")) {
+            static double batch_ms = 0.0;
+            static int batch_regions = 0;
+            static bool batch_fft = false;
+
+            float gi_mean = (float)renewal_config.generationMean, gi_std = (float)renewal_config.generationStd;
+            float delay_mean = (float)renewal_config.delayMean, delay_std = (float)renewal_config.delayStd;
+            ImGui::SliderFloat("世代间隔均值", &gi_mean, 1.0f, 15.0f, "%.1f 天");
+            ImGui::SliderFloat("世代间隔标准差", &gi_std, 0.5f, 10.0f, "%.1f 天");
+            ImGui::SliderFloat("报告延迟均值", &delay_mean, 0.5f, 60.0f, "%.1f 天");
+            ImGui::SliderFloat("报告延迟标准差", &delay_std, 0.5f, 40.0f, "%.1f 天");
+            renewal_config.generationMean = gi_mean; renewal_config.generationStd = gi_std;
+            renewal_config.delayMean = delay_mean; renewal_config.delayStd = delay_std;
+            renewal_config.horizon = days;
+
+            if (selected_region_idx < regions.size() && ImGui::Button("即时预测 + 预测所选城市", ImVec2(-1, 0))) {
+                std::vector<const Region*> batch = { &regions[selected_region_idx] };
+                RenewalModel model(renewal_config, RenewalModel::MaxSeriesLength(batch));
+                renewal_result = model.forecast(regions[selected_region_idx]);
+                show_renewal = renewal_result.valid;
+            }
+            if (ImGui::Button("批量预测全部地区", ImVec2(-1, 0))) {
+                std::vector<const Region*> batch;
+                batch.reserve(regions.size());
+                for (const auto& r : regions) batch.push_back(&r);
+
+                auto t0 = std::chrono::steady_clock::now();
+                RenewalModel model(renewal_config, RenewalModel::MaxSeriesLength(batch));
+                std::vector<RenewalResult> results = model.forecastBatch(batch);
+                batch_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                batch_regions = (int)results.size();
+                batch_fft = model.usesFFT();
+            }
+            if (batch_regions > 0) {
+                ImGui::Text("%d 个地区, %.1f ms (%s)", batch_regions, batch_ms, batch_fft ? "FFT卷积" : "直接卷积");
+            }
+
+            if (renewal_result.valid) {
+                ImGui::Text("最新有效再生数 R_t = %.3f", renewal_result.latestR);
+                ImGui::Checkbox("在图表中显示更新方程预测", &show_renewal);
+            } else if (selected_region_idx < regions.size() && regions[selected_region_idx].history.size() < 2) {
+                ImGui::TextDisabled("至少需要2天的历史记录。");
+            }
+        }
+
+        if (sobol_was_running && !sobol_analyzer.isRunning()) {
+            sobol_result = sobol_analyzer.getResult();
         }
+        sobol_was_running = sobol_analyzer.isRunning();
         ImGui::EndChild();
     }
     ImGui::NextColumn();
@@ -904,8 +1796,11 @@ void ShowPredictionPage() {
     {
         ImGui::Text("数据可视化结果");
         static PlotData plot_data;
-        if (selected_region_idx < regions.size()) {
-            plot_data.FromHistory(regions[selected_region_idx].simulation.getHistory());
+        if (show_preview) {
+            plot_data.FromHistory(preview_points.data(), preview_points.size());
+        } else if (selected_region_idx < regions.size()) {
+            const SIRTrajectory& trajectory = regions[selected_region_idx].simulation.getHistory();
+            plot_data.FromHistory(trajectory.data(), trajectory.size());
         }
         
         // Conditionally fit the plot to the data, then give control to the user.
@@ -914,7 +1809,9 @@ void ShowPredictionPage() {
             auto_fit_plot = false; // Consume the flag, handing control to user until next reset.
         }
 
-        if (ImPlot::BeginPlot("SIR Model", ImVec2(-1,-1))) {
+        bool draw_renewal = show_renewal && renewal_result.valid;
+        float sir_plot_height = draw_renewal ? ImGui::GetContentRegionAvail().y * 0.55f : -1.0f;
+        if (ImPlot::BeginPlot("SIR Model", ImVec2(-1, sir_plot_height))) {
             ImPlot::SetupAxes("天 (Days)", "人数 (Population)");
             if (!plot_data.days.empty()) {
                 ImPlot::PlotLine("易感者 (S)", plot_data.days.data(), plot_data.s.data(), plot_data.days.size());
@@ -922,11 +1819,20 @@ void ShowPredictionPage() {
                 ImPlot::PlotLine("移出者 (R)", plot_data.days.data(), plot_data.r.data(), plot_data.days.size());
             }
 
+            // Optimized intervention: controlled infections, beta(t) reductions and the capacity limit
+            if (show_intervention && intervention_plan.valid) {
+                static PlotData intervention_data;
+                intervention_data.FromHistory(intervention_plan.trajectory.data(), intervention_plan.trajectory.size());
+                ImPlot::PlotLine("干预后感染者 (I)", intervention_data.days.data(), intervention_data.i.data(), intervention_data.days.size());
+                double capacity_line = intervention_config.capacity;
+                ImPlot::PlotInfLines("活跃病例上限", &capacity_line, 1, ImPlotInfLinesFlags_Horizontal);
+            }
+
             // Draw historical data scatter points
             if (selected_region_idx < regions.size()) {
                 Region& r = regions[selected_region_idx];
                 if (!r.history.empty()) {
-                    std::vector<double> h_days, h_I, h_R;
+                    std::pmr::vector<double> h_days(g_FrameArena.resource()), h_I(g_FrameArena.resource()), h_R(g_FrameArena.resource());
                     h_days.reserve(r.history.size());
                     h_I.reserve(r.history.size());
                     h_R.reserve(r.history.size());
@@ -951,13 +1857,421 @@ void ShowPredictionPage() {
             }
             ImPlot::EndPlot();
         }
+
+        // Renewal model: daily reports, deconvolved infections and the forecast beyond the last history day
+        if (draw_renewal && ImPlot::BeginPlot("更新方程 (每日新增)", ImVec2(-1, -1))) {
+            ImPlot::SetupAxes("天 (Days)", "每日新增");
+            const RenewalResult& rr = renewal_result;
+            std::pmr::vector<double> obs_days(rr.reported.size(), g_FrameArena.resource());
+            std::pmr::vector<double> future_days(rr.forecastInfections.size(), g_FrameArena.resource());
+            for (size_t t = 0; t < obs_days.size(); ++t) obs_days[t] = rr.firstDay + (double)t;
+            for (size_t h = 0; h < future_days.size(); ++h) future_days[h] = rr.firstDay + (double)(obs_days.size() + h);
+
+            ImPlot::SetNextMarkerStyle(ImPlotMarker_Circle);
+            ImPlot::PlotScatter("报告新增", obs_days.data(), rr.reported.data(), (int)obs_days.size());
+            ImPlot::PlotLine("即时预测感染", obs_days.data(), rr.nowcastInfections.data(), (int)obs_days.size());
+            ImPlot::PlotLine("预测感染", future_days.data(), rr.forecastInfections.data(), (int)future_days.size());
+            ImPlot::PlotLine("预测报告", future_days.data(), rr.forecastReports.data(), (int)future_days.size());
+            ImPlot::EndPlot();
+        }
     }
     ImGui::Columns(1);
 }
 
+// --- Benchmark Window ---
+
+// ------------------------------------------------------------------------------------
+// [函数] ShowBenchmarkPanel
+// 描述: 基准测试窗口中的一个折叠面板
+// 作用:
+//   options() 绘制说明与参数；按下按钮时由 launch() 按当前参数生成要在后台执行的函数
+//   (参数在此按值取走，后台线程不读取界面的变量)；show(result) 绘制最近一次的结果，
+//   从未运行过时 result.valid 为 false。
+// ------------------------------------------------------------------------------------
+template <typename Result, typename Options, typename Launch, typename Show>
+static void ShowBenchmarkPanel(const char* title, const char* button, BackgroundBenchmark<Result>& benchmark,
+                               Options options, Launch launch, Show show) {
+    if (!ImGui::CollapsingHeader(title)) return;
+    ImGui::PushID(title);
+    options();
+    if (benchmark.isRunning()) {
+        ImGui::TextDisabled("基准测试运行中...");
+    } else if (ImGui::Button(button)) {
+        benchmark.start(launch());
+    }
+    show(benchmark.getResult());
+    ImGui::PopID();
+}
+
+// ------------------------------------------------------------------------------------
+// [UI组件] Benchmark Window (基准测试窗口)
+// 描述: 各模块的基准测试与内部计数，由侧边栏的开关打开
+// 作用: 供开发与调优使用，不放在数据管理页中。每个测试在自己的后台线程上运行，关闭窗口不会中断正在运行的测试。
+// ------------------------------------------------------------------------------------
+void ShowBenchmarkWindow(bool* open) {
+    static BackgroundBenchmark<JournalBenchmarkResult> journal_bench;
+    static BackgroundBenchmark<TailFollowBenchmarkResult> tail_bench;
+    static BackgroundBenchmark<ApiLoadTestResult> api_bench;
+    static BackgroundBenchmark<SharedFeedBenchmarkResult> feed_bench;
+    static BackgroundBenchmark<NumpyBenchmarkResult> numpy_bench;
+    static BackgroundBenchmark<RegionScanBenchmarkResult> scan_bench;
+    static BackgroundBenchmark<RegionSearchBenchmarkResult> search_bench;
+    static BackgroundBenchmark<RegionRollupBenchmarkResult> rollup_bench;
+    static BackgroundBenchmark<AggregateQueryBenchmarkResult> query_bench;
+    static BackgroundBenchmark<MemoryArenaBenchmarkResult> arena_bench;
+    static BackgroundBenchmark<UndoHistoryBenchmarkResult> undo_bench;
+
+    static size_t journal_edits = 200000;
+    static int tail_regions = 5000, tail_ticks = 50, tail_interval = 100;
+    static int load_connections = 16, load_requests = 50000;
+    static int feed_regions = 10000, feed_days = 300;
+    static int numpy_members = 10000, numpy_days = 365;
+    static int scan_regions = 1000000;
+    static int search_regions = 100000;
+    static int rollup_regions = 100000;
+    static int query_regions = 100000;
+    static int arena_regions = 20000;
+    static int undo_regions = 20000, undo_steps = 5000;
+
+    ImGui::SetNextWindowSize(ImVec2(760, 600), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("基准测试", open)) {
+        ImGui::End();
+        return;
+    }
+    const ImVec4 red(1.0f, 0.3f, 0.3f, 1.0f);
+
+    // --- Edit journal ---
+    ShowBenchmarkPanel("编辑日志 (崩溃恢复)", "运行日志基准测试", journal_bench,
+        [] {
+            ImGui::SetNextItemWidth(160);
+            ImGui::InputScalar("编辑次数", ImGuiDataType_U64, &journal_edits);
+            journal_edits = std::max<size_t>(1000, std::min<size_t>(journal_edits, 5000000));
+        },
+        [] { return [edits = journal_edits] { return Journal::RunBenchmark(edits); }; },
+        [&](const JournalBenchmarkResult& r) {
+            if (r.valid) {
+                ImGui::Text("%zu 次编辑: %.0f 次/秒，追加 %.2f us，提交 p50 %.2f ms / p99 %.2f ms",
+                            r.edits, r.editsPerSecond, r.appendMicros, r.commitP50Ms, r.commitP99Ms);
+                ImGui::Text("%zu 批 fsync (平均每批 %.1f 次编辑)，日志 %.1f MB",
+                            r.batches, r.editsPerBatch, r.journalBytes / 1048576.0);
+                ImGui::Text("重放 %zu 条记录用时 %.1f ms (%.0f 条/秒)，恢复结果%s",
+                            r.replayedRecords, r.replaySeconds * 1000.0, r.recordsPerSecond,
+                            r.verified ? "与原数据一致" : "不一致!");
+            } else if (!r.error.empty()) {
+                ImGui::TextColored(red, "%s", r.error.c_str());
+            }
+        });
+
+    // --- Tail-follow latency ---
+    ShowBenchmarkPanel("实时跟踪追加文件", "运行跟踪延迟基准测试", tail_bench,
+        [] {
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("地区数", &tail_regions);
+            ImGui::SameLine(); ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("天数", &tail_ticks);
+            ImGui::SameLine(); ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("间隔 ms", &tail_interval);
+            tail_regions = std::max(1, std::min(tail_regions, 200000));
+            tail_ticks = std::max(1, std::min(tail_ticks, 1000));
+            tail_interval = std::max(10, std::min(tail_interval, 5000));
+        },
+        [] {
+            return [regions = tail_regions, ticks = tail_ticks, interval = tail_interval] {
+                return TailFollower::RunBenchmark(regions, ticks, interval);
+            };
+        },
+        [&](const TailFollowBenchmarkResult& r) {
+            if (r.valid) {
+                ImGui::Text("%zu 个地区 x %d 天 (%zu 条记录)，每批合并 %.2f ms",
+                            r.regions, r.ticks, r.records, r.meanApplyMs);
+                ImGui::Text("追加写入 -> 数据可见: p50 %.1f ms / p99 %.1f ms / 最大 %.1f ms，结果%s",
+                            r.latencyP50Ms, r.latencyP99Ms, r.latencyMaxMs, r.verified ? "一致" : "不一致!");
+            } else if (!r.error.empty()) {
+                ImGui::TextColored(red, "%s", r.error.c_str());
+            }
+        });
+
+    // --- HTTP API load test ---
+    ShowBenchmarkPanel("本地 HTTP 接口压测", "运行压测 (只读请求)", api_bench,
+        [] {
+            if (!g_ApiServer.isRunning()) {
+                ImGui::TextDisabled("压测连接正在运行的接口服务，请先在数据管理页启动服务");
+            }
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("并发连接", &load_connections);
+            ImGui::SameLine(); ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("请求数", &load_requests);
+            load_connections = std::max(1, std::min(load_connections, 256));
+            load_requests = std::max(100, std::min(load_requests, 5000000));
+        },
+        [] {
+            return [port = g_ApiServer.getStats().port, connections = load_connections,
+                    requests = static_cast<size_t>(load_requests)] {
+                return ApiServer::RunLoadTest(port, connections, requests);
+            };
+        },
+        [&](const ApiLoadTestResult& r) {
+            if (r.valid) {
+                ImGui::Text("%d 个连接完成 %zu 个请求 (%zu 个失败)，用时 %.2f 秒，%.0f 请求/秒",
+                            r.connections, r.requests, r.failures, r.seconds, r.requestsPerSecond);
+                ImGui::Text("客户端延迟: p50 %.2f ms / p99 %.2f ms / 最大 %.2f ms",
+                            r.latencyP50Ms, r.latencyP99Ms, r.latencyMaxMs);
+            } else if (!r.error.empty()) {
+                ImGui::TextColored(red, "%s", r.error.c_str());
+            }
+        });
+
+    // --- Shared-memory feed throughput ---
+    ShowBenchmarkPanel("共享内存数据通道", "运行通道吞吐基准测试", feed_bench,
+        [] {
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("地区数", &feed_regions);
+            ImGui::SameLine(); ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("天数", &feed_days);
+            feed_regions = std::max(1, std::min(feed_regions, 200000));
+            feed_days = std::max(1, std::min(feed_days, 3650));
+        },
+        [] {
+            return [regions = static_cast<size_t>(feed_regions), days = feed_days] {
+                return SharedFeed::RunBenchmark(regions, days);
+            };
+        },
+        [&](const SharedFeedBenchmarkResult& r) {
+            if (r.valid) {
+                ImGui::Text("%zu 个地区 x %d 天 (%zu 条记录): 生产者 %.0f 条/秒，端到端 %.0f 条/秒 (%.2f 秒)",
+                            r.regions, r.days, r.records, r.producerRecordsPerSecond, r.recordsPerSecond,
+                            r.totalSeconds);
+                ImGui::Text("每帧写入平均 %.2f ms / 最大 %.2f ms，结果%s",
+                            r.meanApplyMs, r.maxApplyMs, r.verified ? "一致" : "不一致!");
+            } else if (!r.error.empty()) {
+                ImGui::TextColored(red, "%s", r.error.c_str());
+            }
+        });
+
+    // --- NumPy ensemble round trip ---
+    ShowBenchmarkPanel("NumPy 导出/导入 (.npy/.npz)", "运行集合往返基准测试", numpy_bench,
+        [] {
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("成员数", &numpy_members);
+            ImGui::SameLine(); ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("天数", &numpy_days);
+            numpy_members = std::max(1, std::min(numpy_members, 100000));
+            numpy_days = std::max(1, std::min(numpy_days, 3650));
+        },
+        [] {
+            return [members = static_cast<size_t>(numpy_members), days = numpy_days] {
+                return NumpyIO::RunBenchmark(members, days);
+            };
+        },
+        [&](const NumpyBenchmarkResult& r) {
+            if (r.valid) {
+                ImGui::Text("%zu 成员 x %d 天 x 3 (%.1f MB)", r.members, r.days, r.megabytes);
+                ImGui::Text("写入: .npz %.0f MB/s，原始 fwrite %.0f MB/s", r.writeMBps, r.rawWriteMBps);
+                ImGui::Text("读取: 映射 .npz %.0f MB/s，原始 fread %.0f MB/s，结果%s", r.readMBps,
+                            r.rawReadMBps, r.verified ? "一致" : "不一致!");
+            } else if (!r.error.empty()) {
+                ImGui::TextColored(red, "%s", r.error.c_str());
+            }
+        });
+
+    // --- Row vs column region scans ---
+    ShowBenchmarkPanel("地区表扫描 (行式 vs 列式)", "运行扫描基准测试", scan_bench,
+        [] {
+            ImGui::TextWrapped("总览统计与风险筛选只读人口与三个累计数。这四个字段另外按列连续存放，"
+                               "与逐个读取完整的地区对象比较汇总与筛选用时。");
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("地区数", &scan_regions);
+            scan_regions = std::max(1000, std::min(scan_regions, 5000000));
+        },
+        [] { return [regions = static_cast<size_t>(scan_regions)] { return RegionScan::RunBenchmark(regions); }; },
+        [](const RegionScanBenchmarkResult& r) {
+            if (!r.valid) return;
+            ImGui::Text("%zu 个地区: 每个地区对象 %zu 字节，热数据列 %zu 字节", r.regions, r.regionBytes, r.columnBytes);
+            ImGui::Text("汇总: 行式 %.2f ms，列式 %.2f ms (%.1fx)", r.rowTotalsMs, r.columnTotalsMs,
+                        r.columnTotalsMs > 0 ? r.rowTotalsMs / r.columnTotalsMs : 0.0);
+            ImGui::Text("高风险筛选 (%zu 个): 行式 %.2f ms，列式 %.2f ms (%.1fx)，风险等级链表 %.2f ms，结果%s",
+                        r.matches, r.rowFilterMs, r.columnFilterMs,
+                        r.columnFilterMs > 0 ? r.rowFilterMs / r.columnFilterMs : 0.0,
+                        r.bucketFilterMs, r.verified ? "一致" : "不一致!");
+        });
+
+    // --- Region name search (n-gram + pinyin index) ---
+    ShowBenchmarkPanel("名称搜索索引 (n-gram + 拼音)", "运行搜索基准测试", search_bench,
+        [] {
+            ImGui::TextWrapped("搜索框支持名称子串、全拼 (wuhan) 与首字母 (wh)。名称与各种拼音读法按 1-3 个字的 n-gram 建立倒排索引，"
+                               "随新增、改名、删除增量更新。当前索引: %zu 个 n-gram，%zu 条地区记录。",
+                               g_RegionSearch.getGramCount(), g_RegionSearch.getPostingCount());
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("地区数", &search_regions);
+            search_regions = std::max(1000, std::min(search_regions, 1000000));
+        },
+        [] {
+            return [regions = static_cast<size_t>(search_regions)] { return RegionSearchIndex::RunBenchmark(regions); };
+        },
+        [](const RegionSearchBenchmarkResult& r) {
+            if (!r.valid) return;
+            ImGui::Text("%zu 个地区: 建立索引 %.0f ms，%zu 个 n-gram，%zu 条记录", r.regions, r.buildMs, r.grams, r.postings);
+            ImGui::Text("名称子串: 逐个 strstr %.0f us，索引 %.1f us (%.0fx)", r.scanUs, r.substringUs,
+                        r.substringUs > 0 ? r.scanUs / r.substringUs : 0.0);
+            ImGui::Text("全拼 %.1f us，首字母 %.1f us (每次查询平均，共 %zu 次)", r.pinyinUs, r.initialsUs, r.queries);
+            ImGui::Text("增量更新 %.1f us / 次，结果%s", r.updateUs, r.verified ? "与逐个扫描一致" : "与逐个扫描不一致!");
+        });
+
+    // --- Region hierarchy rollups ---
+    ShowBenchmarkPanel("地区层级汇总 (增量维护)", "运行汇总基准测试", rollup_bench,
+        [] {
+            ImGui::TextWrapped("按名称路径把地区组织为 国家 → 省 → 市 → 区县，每个分组保存其下地区的当前累计数与逐日累计数之和 "
+                               "(按逐日变化量存储)。每次编辑只更新被编辑地区的各级祖先，不再逐个地区重新相加。");
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("区县数", &rollup_regions);
+            rollup_regions = std::max(1000, std::min(rollup_regions, 1000000));
+        },
+        [] { return [regions = static_cast<size_t>(rollup_regions)] { return RegionRollup::RunBenchmark(regions); }; },
+        [](const RegionRollupBenchmarkResult& r) {
+            if (!r.valid) return;
+            ImGui::Text("%zu 个区县，%zu 个分组，%zu 条记录: 整体重建 %.1f ms", r.regions, r.groups, r.records, r.rebuildMs);
+            ImGui::Text("增量维护: 每次编辑 %.2f us (共 %zu 次)，跨市改名 %.1f us", r.editUs, r.edits, r.renameUs);
+            ImGui::Text("全国汇总与逐日序列: 读取 %.1f us，逐个地区重新相加 %.1f ms；一个省重新相加 %.1f ms",
+                        r.rootQueryUs, r.recomputeRootMs, r.recomputeProvinceMs);
+            ImGui::Text("结果%s", r.verified ? "与重新相加一致" : "与重新相加不一致!");
+        });
+
+    // --- Cross-region daily aggregate queries ---
+    ShowBenchmarkPanel("跨地区逐日汇总查询引擎", "运行查询基准测试", query_bench,
+        [] {
+            ImGui::TextWrapped("每个指标建立一张 地区 × 天 的对齐矩阵 (记录之间沿用上一条)，按 %zu 个地区分块缓存逐日的和与最大值，"
+                               "并保存块前缀和。全国曲线是前缀和的一行，子集中的整块连续段用前缀和相减，其余地区逐行累加。"
+                               "编辑历史只重写一行，查询前再重算脏块。",
+                               AggregateQueryEngine::BlockSize);
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("地区数", &query_regions);
+            query_regions = std::max(1000, std::min(query_regions, 500000));
+        },
+        [] {
+            return [regions = static_cast<size_t>(query_regions)] { return AggregateQueryEngine::RunBenchmark(regions); };
+        },
+        [](const AggregateQueryBenchmarkResult& r) {
+            if (!r.valid) return;
+            ImGui::Text("%zu 个地区 × %d 天，%zu 条记录: 建立一个指标 %.0f ms，四个指标共 %.0f MB", r.regions,
+                        r.days, r.records, r.buildMs, r.memoryBytes / (1024.0 * 1024.0));
+            ImGui::Text("全国合计: 引擎 %.2f us，逐个遍历历史 %.1f ms", r.nationalUs, r.directNationalMs);
+            ImGui::Text("随机十分之一地区: 引擎 %.0f us，逐个遍历 %.1f ms；连续十分之一 (最大值) %.0f us",
+                        r.subsetUs, r.directSubsetMs, r.rangeUs);
+            ImGui::Text("修改一条记录后再查询全国: %.0f us，结果%s", r.updateUs,
+                        r.verified ? "与逐个遍历一致" : "与逐个遍历不一致!");
+        });
+
+    // --- Region arena and per-frame scratch arena ---
+    ShowBenchmarkPanel("内存池与每帧分配", "运行内存池基准测试", arena_bench,
+        [] {
+            ImGui::TextWrapped("地区的历史记录与模型轨迹从数据模型的分级内存池中分配；每帧的图表临时数组在帧内存池上顺序分配，"
+                               "NewFrame 之后整体重置。下面是最近 %d 帧的平均值 (包含所有线程的分配)。",
+                               FrameMemoryCounter::Window);
+            bool frame_arena = g_FrameArena.isEnabled();
+            if (ImGui::Checkbox("启用帧内存池", &frame_arena)) {
+                g_FrameArena.setEnabled(frame_arena);
+                g_FrameMemory.restart();
+            }
+            ImGui::Text("每帧分配 %.1f 次，页错误 %.1f 次 (%d 帧)", g_FrameMemory.getAllocationsPerFrame(),
+                        g_FrameMemory.getPageFaultsPerFrame(), g_FrameMemory.getFrames());
+            ImGui::Text("帧内存池: 容量 %.0f KB，上一帧使用 %.1f KB，扩容 %zu 次", g_FrameArena.getCapacity() / 1024.0,
+                        g_FrameArena.getLastFrameBytes() / 1024.0, g_FrameArena.getGrowCount());
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("地区数", &arena_regions);
+            arena_regions = std::max(1000, std::min(arena_regions, 100000));
+        },
+        [] { return [regions = static_cast<size_t>(arena_regions)] { return MemoryArena::RunBenchmark(regions); }; },
+        [](const MemoryArenaBenchmarkResult& r) {
+            if (!r.valid) return;
+            ImGui::Text("建立 %zu 个地区 (历史 + 90 天轨迹): 普通堆 %llu 次分配 / %llu 次页错误 / %.1f ms",
+                        r.regions, (unsigned long long)r.heapAllocations, (unsigned long long)r.heapFaults, r.heapMs);
+            ImGui::Text("地区内存池: %llu 次分配 / %llu 次页错误 / %.1f ms，内容%s",
+                        (unsigned long long)r.arenaAllocations, (unsigned long long)r.arenaFaults,
+                        r.arenaMs, r.verified ? "一致" : "不一致!");
+            ImGui::Text("每帧图表数组 (1000 个地区): 普通堆 %.1f 次分配 %.1f us，帧内存池 %.2f 次分配 %.1f us",
+                        r.frameHeapAllocations, r.frameHeapUs, r.frameArenaAllocations, r.frameArenaUs);
+        });
+
+    // --- Undo/redo history ---
+    ShowBenchmarkPanel("撤销/重做历史", "运行撤销基准测试", undo_bench,
+        [] {
+            ImGui::TextWrapped("每一步只保存被修改数据的前后值 (删除地区时保存该地区的历史)，撤销与重做经由数据模型的编辑接口完成；"
+                               "内存随编辑步数增长，与数据集大小无关。最多保留 %zu 步。",
+                               UndoHistory::MaxSteps);
+            ImGui::Text("当前: 可撤销 %zu 步，可重做 %zu 步，占用 %.1f KB", g_UndoHistory.getUndoSteps(),
+                        g_UndoHistory.getRedoSteps(), g_UndoHistory.getMemoryBytes() / 1024.0);
+            ImGui::SameLine();
+            if (ImGui::SmallButton("清空")) g_UndoHistory.clear();
+            ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("地区数", &undo_regions);
+            undo_regions = std::max(100, std::min(undo_regions, 200000));
+            ImGui::SameLine(); ImGui::SetNextItemWidth(120);
+            ImGui::InputInt("编辑步数", &undo_steps);
+            undo_steps = std::max(100, std::min(undo_steps, static_cast<int>(UndoHistory::MaxSteps)));
+        },
+        [] {
+            return [regions = static_cast<size_t>(undo_regions), steps = static_cast<size_t>(undo_steps)] {
+                return UndoHistory::RunBenchmark(regions, steps);
+            };
+        },
+        [](const UndoHistoryBenchmarkResult& r) {
+            if (!r.valid) return;
+            ImGui::Text("%zu 个地区 (%zu 条记录，%.1f MB)，%zu 步随机编辑: 每步 %.2f us", r.regions,
+                        r.records, r.datasetBytes / (1024.0 * 1024.0), r.steps, r.editUs);
+            ImGui::Text("撤销栈 %.1f KB (每步整体复制需 %.0f MB)", r.undoBytes / 1024.0, r.fullCopyBytes / (1024.0 * 1024.0));
+            ImGui::Text("全部撤销 %.1f ms，全部重做 %.1f ms，结果%s", r.undoAllMs, r.redoAllMs,
+                        r.verified ? "与编辑前后一致" : "不一致!");
+        });
+
+    ImGui::End();
+}
+
+// --- Headless API Server ---
+
+static volatile std::sig_atomic_t g_StopRequested = 0;
+static void RequestStop(int) { g_StopRequested = 1; }
+
+// ------------------------------------------------------------------------------------
+// [函数] RunHeadlessServer
+// 描述: --serve [端口] 模式: 不创建窗口，只恢复会话数据并提供 HTTP 接口，Ctrl+C 退出
+// 作用: 主线程承担 UI 线程的职责 (执行写请求、维护编辑日志)，与界面模式共用同一份会话文件。
+// ------------------------------------------------------------------------------------
+int RunHeadlessServer(int port) {
+    g_JournalRecovery = Journal::Recover(kSessionSnapshotPath, kSessionJournalPath, g_EpidemicData);
+    if (!g_JournalRecovery.recovered) {
+        InitializeData();
+    }
+    g_Journal.start(g_EpidemicData, kSessionSnapshotPath, kSessionJournalPath, g_JournalRecovery);
+
+    std::string error;
+    if (!g_ApiServer.start(g_EpidemicData, port, 0, &error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        g_Journal.stop();
+        return 1;
+    }
+    printf("Serving %zu regions on http://127.0.0.1:%d/api/ (Ctrl+C to stop)\n",
+           g_EpidemicData.getRegions().size(), g_ApiServer.getStats().port);
+    fflush(stdout);
+
+    std::signal(SIGINT, RequestStop);
+    std::signal(SIGTERM, RequestStop);
+    while (!g_StopRequested) {
+        g_ApiServer.waitForWork(50);
+        g_ApiServer.pump();
+        g_Journal.maintain();
+    }
+    g_ApiServer.stop();
+    g_Journal.stop();
+    return 0;
+}
+
 // --- Main Program ---
-int main(int, char**)
+int main(int argc, char** argv)
 {
+    if (argc > 1 && strcmp(argv[1], "--serve") == 0) {
+        return RunHeadlessServer(argc > 2 ? atoi(argv[2]) : ApiServer::DefaultPort);
+    }
+
     glfwInit();
     const char* glsl_version = "#version 330";
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -970,6 +2284,7 @@ int main(int, char**)
     glfwSwapInterval(1);
 
     IMGUI_CHECKVERSION();
+    MemoryArena::CountImGuiAllocations();
     ImGui::CreateContext();
     ImPlot::CreateContext();
 
@@ -980,7 +2295,14 @@ int main(int, char**)
     ImGui_ImplGlfw_InitForOpenGL(window, true);
     ImGui_ImplOpenGL3_Init(glsl_version);
 
-    InitializeData();
+    g_JournalRecovery = Journal::Recover(kSessionSnapshotPath, kSessionJournalPath, g_EpidemicData);
+    if (!g_JournalRecovery.recovered) {
+        InitializeData();
+    }
+    g_Journal.start(g_EpidemicData, kSessionSnapshotPath, kSessionJournalPath, g_JournalRecovery);
+    g_RegionSearch.attach(g_EpidemicData);
+    g_AggregateQuery.attach(g_EpidemicData);
+    g_UndoHistory.attach(g_EpidemicData);
 
     while (!glfwWindowShouldClose(window))
     {
@@ -988,6 +2310,12 @@ int main(int, char**)
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
+        g_FrameArena.reset();  // Last frame's scratch containers are all gone
+        g_FrameMemory.sample();
+
+        g_TailFollower.poll(); // Appended rows become visible in this frame
+        g_ApiServer.pump();    // Edits received over HTTP, before this frame draws the data
+        g_SharedFeed.poll();   // Records pushed through shared memory, within a per-frame time budget
 
         ImGui::SetNextWindowPos(ImVec2(0, 0));
         ImGui::SetNextWindowSize(io.DisplaySize);
@@ -1008,6 +2336,10 @@ int main(int, char**)
         }
         ImGui::EndChild();
         ImGui::End();
+        if (g_ShowBenchmarks) ShowBenchmarkWindow(&g_ShowBenchmarks);
+
+        g_DataExporter.pump(g_EpidemicData);
+        g_Journal.maintain();
 
         ImGui::Render();
         int display_w, display_h;
@@ -1019,6 +2351,11 @@ int main(int, char**)
         glfwSwapBuffers(window);
     }
 
+    g_TailFollower.stop();
+    g_SharedFeed.stop();
+    g_ApiServer.stop();
+    g_Journal.stop();
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImPlot::DestroyContext();